@@ -4,43 +4,202 @@
 #include <cstring>
 #include <string>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
 #include "app_error_check.h"
 #include "nvs.h"
 
 namespace {
 
-static constexpr size_t CONFIG_STORE_MAX_ITEMS = 64;
 static constexpr size_t CONFIG_STORE_MAX_SECTIONS = 16;
 static constexpr size_t CONFIG_STORE_MAX_SECTION_NAME_LEN = 31;
+// Indexy podle adresy a podle klice (otevrene adresovani, dvojnasobek poctu polozek).
+static constexpr size_t CONFIG_STORE_ITEM_SLOTS = 2 * CONFIG_STORE_MAX_ITEMS;
+static constexpr size_t CONFIG_STORE_MAX_SUBSCRIBERS = 16;
+
+typedef uint16_t subscriber_mask_t;
 
+// Hodnota polozky v RAM; nacte se z NVS jednou (config_store_load nebo prvni get).
 struct config_store_item_entry_t {
     const config_item_t *item;
+    uint32_t key_hash;                  // FNV-1a klice, pred strcmp se porovna hash
     uint8_t section_index;
+    bool loaded;
+    subscriber_mask_t subscribers;      // bit i = odberatel i chce zmeny teto polozky
+    union {
+        int32_t i32;
+        float f;
+        bool b;
+    } value;
+    std::string string_value;
 };
 
 struct config_store_ctx_t {
     config_store_item_entry_t items[CONFIG_STORE_MAX_ITEMS];
     size_t item_count;
+    size_t loaded_count;
+    uint8_t item_slots[CONFIG_STORE_ITEM_SLOTS];     // index + 1, 0 = volno
+    uint8_t key_slots[CONFIG_STORE_ITEM_SLOTS];      // index + 1, 0 = volno
     char sections[CONFIG_STORE_MAX_SECTIONS][CONFIG_STORE_MAX_SECTION_NAME_LEN + 1];
     size_t section_count;
     bool has_current_section;
     uint8_t current_section_index;
     char nvs_namespace[16];
+    // Jeden handle po celou dobu behu; commit se odklada, dokud bezi davka.
+    bool nvs_opened;
+    nvs_handle_t nvs_handle;
+    uint32_t batch_depth;
+    bool commit_pending;
+    // Odberatele zmen; zmeny se oznamuji az po davce a jen jednim taskem naraz.
+    struct {
+        config_store_change_cb_t callback;
+        void *ctx;
+    } subscribers[CONFIG_STORE_MAX_SUBSCRIBERS];
+    size_t subscriber_count;
+    subscriber_mask_t section_subscribers[CONFIG_STORE_MAX_SECTIONS];
+    subscriber_mask_t pending_notify;
+    bool notifying;
+    bool restart_required;
 };
 
-config_store_ctx_t s_ctx = {};
+config_store_ctx_t s_ctx;
+StaticSemaphore_t s_mutex_buffer;
+SemaphoreHandle_t s_mutex = nullptr;
+
+// Zamek tabulky a NVS handle; get/set se volaji z vice tasku (webapp, cidla, MQTT).
+class ctx_lock_t {
+public:
+    ctx_lock_t() : held_(s_mutex != nullptr)
+    {
+        if (held_) {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+        }
+    }
+
+    ~ctx_lock_t()
+    {
+        release();
+    }
+
+    // Uvolni zamek pred koncem bloku (napr. pred volanim odberatelu).
+    void release()
+    {
+        if (held_) {
+            xSemaphoreGive(s_mutex);
+            held_ = false;
+        }
+    }
+
+    ctx_lock_t(const ctx_lock_t &) = delete;
+    ctx_lock_t &operator=(const ctx_lock_t &) = delete;
+
+private:
+    bool held_;
+};
 
 bool is_valid_item(const config_item_t &item)
 {
     return item.key != nullptr && strlen(item.key) > 0 && strlen(item.key) <= 15;
 }
 
-esp_err_t open_nvs(nvs_open_mode_t mode, nvs_handle_t *out_handle)
+size_t item_slot(const config_item_t *item)
+{
+    const uintptr_t address = reinterpret_cast<uintptr_t>(item);
+    return static_cast<size_t>((address >> 2) * 2654435761u) % CONFIG_STORE_ITEM_SLOTS;
+}
+
+void index_item(const config_item_t *item, size_t index)
+{
+    size_t slot = item_slot(item);
+    while (s_ctx.item_slots[slot] != 0) {
+        slot = (slot + 1) % CONFIG_STORE_ITEM_SLOTS;
+    }
+    s_ctx.item_slots[slot] = static_cast<uint8_t>(index + 1);
+}
+
+uint32_t fnv1a32(const char *text)
+{
+    uint32_t hash = 2166136261u;
+    while (*text != '\0') {
+        hash ^= static_cast<uint8_t>(*text);
+        hash *= 16777619u;
+        ++text;
+    }
+    return hash;
+}
+
+void index_key(uint32_t key_hash, size_t index)
+{
+    size_t slot = key_hash % CONFIG_STORE_ITEM_SLOTS;
+    while (s_ctx.key_slots[slot] != 0) {
+        slot = (slot + 1) % CONFIG_STORE_ITEM_SLOTS;
+    }
+    s_ctx.key_slots[slot] = static_cast<uint8_t>(index + 1);
+}
+
+config_store_item_entry_t *find_entry_by_hash(const char *key, uint32_t key_hash)
+{
+    size_t slot = key_hash % CONFIG_STORE_ITEM_SLOTS;
+    while (s_ctx.key_slots[slot] != 0) {
+        config_store_item_entry_t &entry = s_ctx.items[s_ctx.key_slots[slot] - 1U];
+        if (entry.key_hash == key_hash && strcmp(entry.item->key, key) == 0) {
+            return &entry;
+        }
+        slot = (slot + 1) % CONFIG_STORE_ITEM_SLOTS;
+    }
+    return nullptr;
+}
+
+// Polozka podle klice (O(1), tabulka je nejvys z poloviny plna).
+config_store_item_entry_t *find_entry_by_key(const char *key)
+{
+    return find_entry_by_hash(key, fnv1a32(key));
+}
+
+// Polozka podle adresy (O(1)); kopie config_item_t se dohleda podle klice.
+config_store_item_entry_t *find_entry(const config_item_t *item)
+{
+    if (item == nullptr || !config_store_is_ready()) {
+        return nullptr;
+    }
+
+    size_t slot = item_slot(item);
+    while (s_ctx.item_slots[slot] != 0) {
+        config_store_item_entry_t &entry = s_ctx.items[s_ctx.item_slots[slot] - 1U];
+        if (entry.item == item) {
+            return &entry;
+        }
+        slot = (slot + 1) % CONFIG_STORE_ITEM_SLOTS;
+    }
+    return item->key != nullptr ? find_entry_by_key(item->key) : nullptr;
+}
+
+esp_err_t open_nvs_locked()
 {
     if (!config_store_is_ready()) {
         return ESP_ERR_INVALID_STATE;
     }
-    return nvs_open(s_ctx.nvs_namespace, mode, out_handle);
+    if (s_ctx.nvs_opened) {
+        return ESP_OK;
+    }
+    esp_err_t result = nvs_open(s_ctx.nvs_namespace, NVS_READWRITE, &s_ctx.nvs_handle);
+    if (result == ESP_OK) {
+        s_ctx.nvs_opened = true;
+    }
+    return result;
+}
+
+esp_err_t commit_locked()
+{
+    if (!s_ctx.commit_pending || s_ctx.batch_depth > 0) {
+        return ESP_OK;
+    }
+    esp_err_t result = nvs_commit(s_ctx.nvs_handle);
+    if (result == ESP_OK) {
+        s_ctx.commit_pending = false;
+    }
+    return result;
 }
 
 esp_err_t nvs_set_float(nvs_handle_t handle, const char *key, float value)
@@ -64,9 +223,249 @@ float clamp_float(const config_item_t *item, float value)
     return std::max(item->min_float, std::min(item->max_float, value));
 }
 
-void check_or_abort(const char *error_code, esp_err_t result)
+std::string normalize_string(const config_item_t *item, const char *value)
+{
+    std::string normalized = value != nullptr ? value : "";
+    if (item->max_string_len > 0 && normalized.size() > item->max_string_len) {
+        normalized = normalized.substr(0, item->max_string_len);
+    }
+    return normalized;
+}
+
+// Zapise hodnotu entry do NVS (bez commitu).
+esp_err_t store_entry_locked(const config_store_item_entry_t &entry)
+{
+    const config_item_t *item = entry.item;
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    switch (item->type) {
+    case CONFIG_VALUE_INT32:
+        result = nvs_set_i32(s_ctx.nvs_handle, item->key, entry.value.i32);
+        break;
+    case CONFIG_VALUE_FLOAT:
+        result = nvs_set_float(s_ctx.nvs_handle, item->key, entry.value.f);
+        break;
+    case CONFIG_VALUE_BOOL:
+        result = nvs_set_u8(s_ctx.nvs_handle, item->key, entry.value.b ? 1 : 0);
+        break;
+    case CONFIG_VALUE_STRING:
+        result = nvs_set_str(s_ctx.nvs_handle, item->key, entry.string_value.c_str());
+        break;
+    }
+    if (result == ESP_OK) {
+        s_ctx.commit_pending = true;
+    }
+    return result;
+}
+
+// Nacte hodnotu z NVS; chybejici polozka dostane vychozi hodnotu a zapise se (commit pozdeji).
+esp_err_t load_entry_locked(config_store_item_entry_t &entry)
+{
+    const config_item_t *item = entry.item;
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    switch (item->type) {
+    case CONFIG_VALUE_INT32:
+        result = nvs_get_i32(s_ctx.nvs_handle, item->key, &entry.value.i32);
+        if (result == ESP_ERR_NVS_NOT_FOUND) {
+            entry.value.i32 = clamp_i32(item, item->default_int);
+        }
+        break;
+    case CONFIG_VALUE_FLOAT:
+        result = nvs_get_float(s_ctx.nvs_handle, item->key, &entry.value.f);
+        if (result == ESP_ERR_NVS_NOT_FOUND) {
+            entry.value.f = clamp_float(item, item->default_float);
+        }
+        break;
+    case CONFIG_VALUE_BOOL: {
+        uint8_t raw = 0;
+        result = nvs_get_u8(s_ctx.nvs_handle, item->key, &raw);
+        entry.value.b = result == ESP_ERR_NVS_NOT_FOUND ? item->default_bool : (raw != 0);
+        break;
+    }
+    case CONFIG_VALUE_STRING: {
+        size_t required_size = 0;
+        result = nvs_get_str(s_ctx.nvs_handle, item->key, nullptr, &required_size);
+        if (result == ESP_OK) {
+            entry.string_value.assign(required_size > 0 ? required_size - 1 : 0, '\0');
+            result = nvs_get_str(s_ctx.nvs_handle, item->key, &entry.string_value[0], &required_size);
+        } else if (result == ESP_ERR_NVS_NOT_FOUND) {
+            entry.string_value = normalize_string(item, item->default_string);
+        }
+        break;
+    }
+    }
+
+    if (result == ESP_ERR_NVS_NOT_FOUND) {
+        result = store_entry_locked(entry);
+    }
+    if (result == ESP_OK) {
+        entry.loaded = true;
+        s_ctx.loaded_count += 1;
+    }
+    return result;
+}
+
+// Jeden pruchod NVS pro vsechny dosud nenactene polozky a jeden commit vychozich hodnot.
+esp_err_t load_pending_locked()
+{
+    if (s_ctx.loaded_count == s_ctx.item_count) {
+        return ESP_OK;
+    }
+
+    esp_err_t result = open_nvs_locked();
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    for (size_t index = 0; index < s_ctx.item_count; ++index) {
+        config_store_item_entry_t &entry = s_ctx.items[index];
+        if (entry.loaded) {
+            continue;
+        }
+        result = load_entry_locked(entry);
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+    return commit_locked();
+}
+
+// Polozka pro get: typ, registrace a nactena hodnota, jinak abort s prislusnym kodem.
+config_store_item_entry_t &entry_for_get(const config_item_t *item,
+                                         config_value_type_t type,
+                                         const char *type_error_code,
+                                         const char *not_found_error_code,
+                                         const char *load_error_code)
+{
+    APP_ERROR_CHECK(type_error_code, (item != nullptr && item->type == type) ? ESP_OK : ESP_ERR_INVALID_ARG);
+    config_store_item_entry_t *entry = find_entry(item);
+    APP_ERROR_CHECK(not_found_error_code, entry != nullptr ? ESP_OK : ESP_ERR_NOT_FOUND);
+    if (!entry->loaded) {
+        APP_ERROR_CHECK(load_error_code, load_pending_locked());
+    }
+    return *entry;
+}
+
+// Polozka pro set; nenactena se nejdriv nacte (kvuli porovnani s ulozenou hodnotou).
+esp_err_t entry_for_set(const config_item_t *item, config_value_type_t type, config_store_item_entry_t **out_entry)
+{
+    if (item == nullptr || item->type != type) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config_store_item_entry_t *entry = find_entry(item);
+    if (entry == nullptr) {
+        return config_store_is_ready() ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t result = entry->loaded ? open_nvs_locked() : load_pending_locked();
+    if (result != ESP_OK) {
+        return result;
+    }
+    *out_entry = entry;
+    return ESP_OK;
+}
+
+// Zapis do NVS jen pri zmene; po selhani zustane v RAM puvodni hodnota.
+esp_err_t write_through_locked(config_store_item_entry_t &entry, const config_store_item_entry_t &previous)
+{
+    esp_err_t result = store_entry_locked(entry);
+    if (result == ESP_OK) {
+        result = commit_locked();
+    }
+    if (result != ESP_OK) {
+        entry.value = previous.value;
+        entry.string_value = previous.string_value;
+        return result;
+    }
+
+    // Zmenu bez odberatele prevezme modul az po restartu.
+    if (entry.subscribers == 0) {
+        s_ctx.restart_required = true;
+    }
+    s_ctx.pending_notify = static_cast<subscriber_mask_t>(s_ctx.pending_notify | entry.subscribers);
+    return ESP_OK;
+}
+
+// Zavola odberatele zmenenych polozek (mimo zamek). Kdyz uz oznamuje jiny task (nebo
+// callback sam neco nastavil), jen se pridaji bity a oznami je ten, kdo uz bezi.
+void notify_subscribers()
+{
+    {
+        ctx_lock_t lock;
+        if (s_ctx.notifying) {
+            return;
+        }
+        s_ctx.notifying = true;
+    }
+
+    for (;;) {
+        subscriber_mask_t mask = 0;
+        {
+            ctx_lock_t lock;
+            if (s_ctx.batch_depth == 0) {
+                mask = s_ctx.pending_notify;
+                s_ctx.pending_notify = 0;
+            }
+            if (mask == 0) {
+                s_ctx.notifying = false;
+                return;
+            }
+        }
+
+        for (size_t index = 0; index < CONFIG_STORE_MAX_SUBSCRIBERS; ++index) {
+            if ((mask & (1U << index)) != 0) {
+                s_ctx.subscribers[index].callback(s_ctx.subscribers[index].ctx);
+            }
+        }
+    }
+}
+
+esp_err_t add_subscriber_locked(config_store_change_cb_t callback, void *ctx, size_t *out_index)
+{
+    if (callback == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ctx.subscriber_count >= CONFIG_STORE_MAX_SUBSCRIBERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    *out_index = s_ctx.subscriber_count;
+    s_ctx.subscribers[*out_index].callback = callback;
+    s_ctx.subscribers[*out_index].ctx = ctx;
+    s_ctx.subscriber_count += 1;
+    return ESP_OK;
+}
+
+void reset_ctx()
 {
-    APP_ERROR_CHECK(error_code, result);
+    if (s_ctx.nvs_opened) {
+        nvs_close(s_ctx.nvs_handle);
+    }
+    for (config_store_item_entry_t &entry : s_ctx.items) {
+        entry.item = nullptr;
+        entry.key_hash = 0;
+        entry.section_index = 0;
+        entry.loaded = false;
+        entry.subscribers = 0;
+        entry.value.i32 = 0;
+        entry.string_value.clear();
+    }
+    s_ctx.item_count = 0;
+    s_ctx.loaded_count = 0;
+    memset(s_ctx.item_slots, 0, sizeof(s_ctx.item_slots));
+    memset(s_ctx.key_slots, 0, sizeof(s_ctx.key_slots));
+    memset(s_ctx.sections, 0, sizeof(s_ctx.sections));
+    s_ctx.section_count = 0;
+    s_ctx.has_current_section = false;
+    s_ctx.current_section_index = 0;
+    memset(s_ctx.nvs_namespace, 0, sizeof(s_ctx.nvs_namespace));
+    s_ctx.nvs_opened = false;
+    s_ctx.nvs_handle = 0;
+    s_ctx.batch_depth = 0;
+    s_ctx.commit_pending = false;
+    memset(s_ctx.subscribers, 0, sizeof(s_ctx.subscribers));
+    s_ctx.subscriber_count = 0;
+    memset(s_ctx.section_subscribers, 0, sizeof(s_ctx.section_subscribers));
+    s_ctx.pending_notify = 0;
+    s_ctx.notifying = false;
+    s_ctx.restart_required = false;
 }
 
 } // namespace
@@ -80,7 +479,15 @@ esp_err_t config_store_prepare(const char *nvs_namespace)
         return ESP_ERR_INVALID_ARG;
     }
 
-    memset(&s_ctx, 0, sizeof(s_ctx));
+    if (s_mutex == nullptr) {
+        s_mutex = xSemaphoreCreateMutexStatic(&s_mutex_buffer);
+        if (s_mutex == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ctx_lock_t lock;
+    reset_ctx();
     strncpy(s_ctx.nvs_namespace, nvs_namespace, sizeof(s_ctx.nvs_namespace) - 1);
 
     return ESP_OK;
@@ -97,6 +504,7 @@ esp_err_t config_store_begin_section(const char *section_name)
         return ESP_ERR_INVALID_ARG;
     }
 
+    ctx_lock_t lock;
     for (size_t index = 0; index < s_ctx.section_count; ++index) {
         if (strcmp(s_ctx.sections[index], section_name) == 0) {
             s_ctx.current_section_index = static_cast<uint8_t>(index);
@@ -124,23 +532,131 @@ esp_err_t config_store_register_item(const config_item_t *item)
         return ESP_ERR_INVALID_ARG;
     }
 
-    for (size_t index = 0; index < s_ctx.item_count; ++index) {
-        const config_item_t *existing = s_ctx.items[index].item;
-        if (existing != nullptr && strcmp(existing->key, item->key) == 0) {
-            return ESP_OK;
-        }
+    ctx_lock_t lock;
+    const uint32_t key_hash = fnv1a32(item->key);
+    const config_store_item_entry_t *existing = find_entry_by_hash(item->key, key_hash);
+    if (existing != nullptr) {
+        // Opakovana registrace stejne polozky je v poradku, jina polozka se stejnym klicem ne
+        // (sdilela by hodnotu v NVS).
+        return existing->item == item ? ESP_OK : ESP_ERR_INVALID_STATE;
     }
 
     if (s_ctx.item_count >= CONFIG_STORE_MAX_ITEMS) {
         return ESP_ERR_NO_MEM;
     }
 
-    s_ctx.items[s_ctx.item_count].item = item;
-    s_ctx.items[s_ctx.item_count].section_index = s_ctx.current_section_index;
+    config_store_item_entry_t &entry = s_ctx.items[s_ctx.item_count];
+    entry.item = item;
+    entry.key_hash = key_hash;
+    entry.section_index = s_ctx.current_section_index;
+    entry.loaded = false;
+    entry.subscribers = s_ctx.section_subscribers[s_ctx.current_section_index];
+    index_item(item, s_ctx.item_count);
+    index_key(key_hash, s_ctx.item_count);
     s_ctx.item_count += 1;
     return ESP_OK;
 }
 
+esp_err_t config_store_load(void)
+{
+    if (!config_store_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ctx_lock_t lock;
+    return load_pending_locked();
+}
+
+esp_err_t config_store_begin_batch(void)
+{
+    if (!config_store_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ctx_lock_t lock;
+    s_ctx.batch_depth += 1;
+    return ESP_OK;
+}
+
+esp_err_t config_store_commit_batch(void)
+{
+    if (!config_store_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t result = ESP_OK;
+    {
+        ctx_lock_t lock;
+        if (s_ctx.batch_depth == 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        s_ctx.batch_depth -= 1;
+        result = commit_locked();
+    }
+    notify_subscribers();
+    return result;
+}
+
+esp_err_t config_store_subscribe_item(const config_item_t *item, config_store_change_cb_t callback, void *ctx)
+{
+    ctx_lock_t lock;
+    config_store_item_entry_t *entry = find_entry(item);
+    if (entry == nullptr) {
+        return config_store_is_ready() ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+    }
+
+    // Stejny callback a ctx u vice polozek = jeden odberatel (jedno volani na davku).
+    for (size_t index = 0; index < s_ctx.subscriber_count; ++index) {
+        if (s_ctx.subscribers[index].callback == callback && s_ctx.subscribers[index].ctx == ctx) {
+            entry->subscribers = static_cast<subscriber_mask_t>(entry->subscribers | (1U << index));
+            return ESP_OK;
+        }
+    }
+
+    size_t index = 0;
+    esp_err_t result = add_subscriber_locked(callback, ctx, &index);
+    if (result == ESP_OK) {
+        entry->subscribers = static_cast<subscriber_mask_t>(entry->subscribers | (1U << index));
+    }
+    return result;
+}
+
+esp_err_t config_store_subscribe_section(const char *section_name, config_store_change_cb_t callback, void *ctx)
+{
+    if (section_name == nullptr || !config_store_is_ready()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ctx_lock_t lock;
+    size_t section_index = 0;
+    while (section_index < s_ctx.section_count && strcmp(s_ctx.sections[section_index], section_name) != 0) {
+        ++section_index;
+    }
+    if (section_index >= s_ctx.section_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t index = 0;
+    esp_err_t result = add_subscriber_locked(callback, ctx, &index);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    const subscriber_mask_t bit = static_cast<subscriber_mask_t>(1U << index);
+    s_ctx.section_subscribers[section_index] = static_cast<subscriber_mask_t>(s_ctx.section_subscribers[section_index] | bit);
+    for (size_t item_index = 0; item_index < s_ctx.item_count; ++item_index) {
+        config_store_item_entry_t &entry = s_ctx.items[item_index];
+        if (entry.section_index == section_index) {
+            entry.subscribers = static_cast<subscriber_mask_t>(entry.subscribers | bit);
+        }
+    }
+    return ESP_OK;
+}
+
+bool config_store_restart_required(void)
+{
+    ctx_lock_t lock;
+    return s_ctx.restart_required;
+}
+
 bool config_store_is_ready(void)
 {
     return s_ctx.nvs_namespace[0] != '\0';
@@ -152,13 +668,8 @@ const config_item_t *config_store_find_item(const char *key)
         return nullptr;
     }
 
-    for (size_t index = 0; index < s_ctx.item_count; ++index) {
-        const config_item_t *item = s_ctx.items[index].item;
-        if (item != nullptr && strcmp(item->key, key) == 0) {
-            return item;
-        }
-    }
-    return nullptr;
+    const config_store_item_entry_t *entry = find_entry_by_key(key);
+    return entry != nullptr ? entry->item : nullptr;
 }
 
 size_t config_store_item_count(void)
@@ -190,197 +701,117 @@ const char *config_store_section_for_item_at(size_t index)
 
 int32_t config_store_get_i32_item(const config_item_t *item)
 {
-    check_or_abort("E301", (item != nullptr && item->type == CONFIG_VALUE_INT32) ? ESP_OK : ESP_ERR_INVALID_ARG);
-    check_or_abort("E302", config_store_find_item(item->key) != nullptr ? ESP_OK : ESP_ERR_NOT_FOUND);
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
-    check_or_abort("E303", result);
-
-    int32_t value = 0;
-    result = nvs_get_i32(nvs_handle, item->key, &value);
-    if (result == ESP_ERR_NVS_NOT_FOUND) {
-        value = clamp_i32(item, item->default_int);
-        result = nvs_set_i32(nvs_handle, item->key, value);
-        if (result == ESP_OK) {
-            result = nvs_commit(nvs_handle);
-        }
-    }
-
-    nvs_close(nvs_handle);
-    check_or_abort("E304", result);
-    return value;
+    ctx_lock_t lock;
+    return entry_for_get(item, CONFIG_VALUE_INT32, "E301", "E302", "E303").value.i32;
 }
 
 float config_store_get_float_item(const config_item_t *item)
 {
-    check_or_abort("E305", (item != nullptr && item->type == CONFIG_VALUE_FLOAT) ? ESP_OK : ESP_ERR_INVALID_ARG);
-    check_or_abort("E306", config_store_find_item(item->key) != nullptr ? ESP_OK : ESP_ERR_NOT_FOUND);
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
-    check_or_abort("E307", result);
-
-    float value = 0.0f;
-    result = nvs_get_float(nvs_handle, item->key, &value);
-    if (result == ESP_ERR_NVS_NOT_FOUND) {
-        value = clamp_float(item, item->default_float);
-        result = nvs_set_float(nvs_handle, item->key, value);
-        if (result == ESP_OK) {
-            result = nvs_commit(nvs_handle);
-        }
-    }
-
-    nvs_close(nvs_handle);
-    check_or_abort("E308", result);
-    return value;
+    ctx_lock_t lock;
+    return entry_for_get(item, CONFIG_VALUE_FLOAT, "E305", "E306", "E307").value.f;
 }
 
 bool config_store_get_bool_item(const config_item_t *item)
 {
-    check_or_abort("E309", (item != nullptr && item->type == CONFIG_VALUE_BOOL) ? ESP_OK : ESP_ERR_INVALID_ARG);
-    check_or_abort("E310", config_store_find_item(item->key) != nullptr ? ESP_OK : ESP_ERR_NOT_FOUND);
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
-    check_or_abort("E311", result);
-
-    bool value = false;
-    uint8_t raw = 0;
-    result = nvs_get_u8(nvs_handle, item->key, &raw);
-    if (result == ESP_ERR_NVS_NOT_FOUND) {
-        raw = item->default_bool ? 1 : 0;
-        result = nvs_set_u8(nvs_handle, item->key, raw);
-        if (result == ESP_OK) {
-            result = nvs_commit(nvs_handle);
-        }
-    }
-
-    nvs_close(nvs_handle);
-    check_or_abort("E312", result);
-    value = (raw != 0);
-    return value;
+    ctx_lock_t lock;
+    return entry_for_get(item, CONFIG_VALUE_BOOL, "E309", "E310", "E311").value.b;
 }
 
 void config_store_get_string_item(const config_item_t *item, char *buffer, size_t buffer_len)
 {
-    check_or_abort("E313", (item != nullptr && item->type == CONFIG_VALUE_STRING) ? ESP_OK : ESP_ERR_INVALID_ARG);
-    check_or_abort("E314", (buffer != nullptr && buffer_len > 0) ? ESP_OK : ESP_ERR_INVALID_ARG);
-    check_or_abort("E315", config_store_find_item(item->key) != nullptr ? ESP_OK : ESP_ERR_NOT_FOUND);
+    APP_ERROR_CHECK("E314", (buffer != nullptr && buffer_len > 0) ? ESP_OK : ESP_ERR_INVALID_ARG);
 
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
-    check_or_abort("E316", result);
-
-    size_t required_size = buffer_len;
-    result = nvs_get_str(nvs_handle, item->key, buffer, &required_size);
-    if (result == ESP_ERR_NVS_NOT_FOUND) {
-        std::string normalized = item->default_string != nullptr ? item->default_string : "";
-        if (item->max_string_len > 0 && normalized.size() > item->max_string_len) {
-            normalized = normalized.substr(0, item->max_string_len);
-        }
-
-        check_or_abort("E317", (normalized.size() + 1 <= buffer_len) ? ESP_OK : ESP_ERR_NVS_INVALID_LENGTH);
-
-        result = nvs_set_str(nvs_handle, item->key, normalized.c_str());
-        if (result == ESP_OK) {
-            result = nvs_commit(nvs_handle);
-        }
-        if (result == ESP_OK) {
-            memcpy(buffer, normalized.c_str(), normalized.size() + 1);
-        }
-    }
-
-    nvs_close(nvs_handle);
-    check_or_abort("E318", result);
+    ctx_lock_t lock;
+    const config_store_item_entry_t &entry = entry_for_get(item, CONFIG_VALUE_STRING, "E313", "E315", "E316");
+    const size_t length = entry.string_value.size();
+    APP_ERROR_CHECK("E318", (length + 1 <= buffer_len) ? ESP_OK : ESP_ERR_NVS_INVALID_LENGTH);
+    memcpy(buffer, entry.string_value.c_str(), length + 1);
 }
 
 esp_err_t config_store_set_i32_item(const config_item_t *item, int32_t value)
 {
-    if (item == nullptr || item->type != CONFIG_VALUE_INT32) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    const int32_t clamped = clamp_i32(item, value);
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
+    ctx_lock_t lock;
+    config_store_item_entry_t *entry = nullptr;
+    esp_err_t result = entry_for_set(item, CONFIG_VALUE_INT32, &entry);
     if (result != ESP_OK) {
         return result;
     }
 
-    result = nvs_set_i32(nvs_handle, item->key, clamped);
-    if (result == ESP_OK) {
-        result = nvs_commit(nvs_handle);
-    }
-    nvs_close(nvs_handle);
+    const int32_t clamped = clamp_i32(item, value);
+    if (entry->value.i32 == clamped) {
+        return ESP_OK;
+    }
+    const config_store_item_entry_t previous = *entry;
+    entry->value.i32 = clamped;
+    result = write_through_locked(*entry, previous);
+    lock.release();
+    notify_subscribers();
     return result;
 }
 
 esp_err_t config_store_set_float_item(const config_item_t *item, float value)
 {
-    if (item == nullptr || item->type != CONFIG_VALUE_FLOAT) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    const float clamped = clamp_float(item, value);
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
+    ctx_lock_t lock;
+    config_store_item_entry_t *entry = nullptr;
+    esp_err_t result = entry_for_set(item, CONFIG_VALUE_FLOAT, &entry);
     if (result != ESP_OK) {
         return result;
     }
 
-    result = nvs_set_float(nvs_handle, item->key, clamped);
-    if (result == ESP_OK) {
-        result = nvs_commit(nvs_handle);
-    }
-    nvs_close(nvs_handle);
+    const float clamped = clamp_float(item, value);
+    if (memcmp(&entry->value.f, &clamped, sizeof(clamped)) == 0) {
+        return ESP_OK;
+    }
+    const config_store_item_entry_t previous = *entry;
+    entry->value.f = clamped;
+    result = write_through_locked(*entry, previous);
+    lock.release();
+    notify_subscribers();
     return result;
 }
 
 esp_err_t config_store_set_bool_item(const config_item_t *item, bool value)
 {
-    if (item == nullptr || item->type != CONFIG_VALUE_BOOL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
+    ctx_lock_t lock;
+    config_store_item_entry_t *entry = nullptr;
+    esp_err_t result = entry_for_set(item, CONFIG_VALUE_BOOL, &entry);
     if (result != ESP_OK) {
         return result;
     }
 
-    result = nvs_set_u8(nvs_handle, item->key, value ? 1 : 0);
-    if (result == ESP_OK) {
-        result = nvs_commit(nvs_handle);
+    if (entry->value.b == value) {
+        return ESP_OK;
     }
-    nvs_close(nvs_handle);
+    const config_store_item_entry_t previous = *entry;
+    entry->value.b = value;
+    result = write_through_locked(*entry, previous);
+    lock.release();
+    notify_subscribers();
     return result;
 }
 
 esp_err_t config_store_set_string_item(const config_item_t *item, const char *value)
 {
-    if (item == nullptr || value == nullptr || item->type != CONFIG_VALUE_STRING) {
+    if (value == nullptr) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    std::string normalized = value;
-    if (item->max_string_len > 0 && normalized.size() > item->max_string_len) {
-        normalized = normalized.substr(0, item->max_string_len);
-    }
-
-    nvs_handle_t nvs_handle;
-    esp_err_t result = open_nvs(NVS_READWRITE, &nvs_handle);
+    ctx_lock_t lock;
+    config_store_item_entry_t *entry = nullptr;
+    esp_err_t result = entry_for_set(item, CONFIG_VALUE_STRING, &entry);
     if (result != ESP_OK) {
         return result;
     }
 
-    result = nvs_set_str(nvs_handle, item->key, normalized.c_str());
-    if (result == ESP_OK) {
-        result = nvs_commit(nvs_handle);
+    std::string normalized = normalize_string(item, value);
+    if (entry->string_value == normalized) {
+        return ESP_OK;
     }
-    nvs_close(nvs_handle);
+    const config_store_item_entry_t previous = *entry;
+    entry->string_value = std::move(normalized);
+    result = write_through_locked(*entry, previous);
+    lock.release();
+    notify_subscribers();
     return result;
 }
 
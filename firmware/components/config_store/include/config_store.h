@@ -3,10 +3,36 @@
 #include "config_types.h"
 #include "esp_err.h"
 
+// Nejvyssi pocet registrovanych polozek.
+static constexpr size_t CONFIG_STORE_MAX_ITEMS = 64;
+
 esp_err_t config_store_prepare(const char *nvs_namespace);
 esp_err_t config_store_begin_section(const char *section_name);
+// Opakovana registrace stejne polozky vraci ESP_OK; jina polozka se stejnym klicem
+// ESP_ERR_INVALID_STATE.
 esp_err_t config_store_register_item(const config_item_t *item);
 
+// Hodnoty polozek se drzi v RAM. config_store_load() po registraci nacte vsechny dosud
+// nenactene polozky jednim pruchodem NVS (chybejici zapise s vychozi hodnotou, jeden commit);
+// jinak se to stane pri prvnim get. Get je pak jen cteni z RAM.
+esp_err_t config_store_load(void);
+
+// Set zapisuje hned do NVS (jen pri zmene hodnoty); commit se mezi begin a commit_batch
+// odlozi a provede jednou na konci (napr. ulozeni celeho formulare webapp).
+esp_err_t config_store_begin_batch(void);
+esp_err_t config_store_commit_batch(void);
+
+// Odber zmen za behu. Callback se zavola po kazdem set, ktery hodnotu zmenil (v davce
+// jednou po config_store_commit_batch), v tasku, ktery zmenu provedl, mimo zamek
+// config_store; smi tedy volat config_store_get_*. Stejny callback a ctx u vice polozek
+// je jeden odberatel. Odber sekce plati i pro polozky zaregistrovane pozdeji.
+typedef void (*config_store_change_cb_t)(void *ctx);
+esp_err_t config_store_subscribe_item(const config_item_t *item, config_store_change_cb_t callback, void *ctx);
+esp_err_t config_store_subscribe_section(const char *section_name, config_store_change_cb_t callback, void *ctx);
+
+// Zmenila se od startu polozka, kterou zadny odberatel neprevezme za behu.
+bool config_store_restart_required(void);
+
 bool config_store_is_ready(void);
 const config_item_t *config_store_find_item(const char *key);
 size_t config_store_item_count(void);
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -20,6 +21,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "config_store.h"
+#include "json_reader.hpp"
 
 static const char *TAG = "config_webapp";
 static bool s_has_restart_info = false;
@@ -35,28 +37,114 @@ static config_webapp_network_info_t s_network_info = {
 };
 static std::string s_network_ssid_storage;
 
+static constexpr size_t STATUS_CARD_MAX = 4;
+static constexpr size_t STATUS_CARD_BUFFER_LEN = 1536;
+
+typedef struct {
+    const char *title;
+    config_webapp_card_render_fn_t render;
+} status_card_t;
+
+static status_card_t s_status_cards[STATUS_CARD_MAX] = {};
+static size_t s_status_card_count = 0;
+
+static constexpr size_t JSON_SECTION_MAX = 8;
+static constexpr size_t API_KEY_LEN = 32;
+
+typedef struct {
+    config_webapp_api_t api;
+    const char *name;
+    config_webapp_json_render_fn_t render;
+} json_section_t;
+
+static json_section_t s_json_sections[JSON_SECTION_MAX] = {};
+static size_t s_json_section_count = 0;
+
 typedef struct {
     httpd_handle_t server;
 } config_webapp_ctx_t;
 
 static config_webapp_ctx_t s_ctx = {};
 
-static std::string html_escape(const std::string &input)
-{
-    std::string output;
-    output.reserve(input.size());
-    for (char ch : input) {
-        switch (ch) {
-            case '&': output += "&amp;"; break;
-            case '<': output += "&lt;"; break;
-            case '>': output += "&gt;"; break;
-            case '"': output += "&quot;"; break;
-            case '\'': output += "&#39;"; break;
-            default: output.push_back(ch); break;
+static constexpr size_t HTML_CHUNK_LEN = 1024;
+
+// Stranka se posila po castech (chunked transfer) z pevneho bufferu na stacku handleru,
+// takze spicka heapu pri renderovani nezavisi na poctu polozek konfigurace.
+class html_writer_t {
+public:
+    explicit html_writer_t(httpd_req_t *req) : req_(req), len_(0), result_(ESP_OK) {}
+
+    void raw(const char *text)
+    {
+        raw(text, strlen(text));
+    }
+
+    void raw(const char *text, size_t len)
+    {
+        while (len > 0 && result_ == ESP_OK) {
+            if (len_ == sizeof(buffer_)) {
+                flush();
+                continue;
+            }
+            const size_t part = std::min(len, sizeof(buffer_) - len_);
+            memcpy(buffer_ + len_, text, part);
+            len_ += part;
+            text += part;
+            len -= part;
         }
     }
-    return output;
-}
+
+    void escaped(const char *text)
+    {
+        for (; *text != '\0'; ++text) {
+            switch (*text) {
+                case '&': raw("&amp;", 5); break;
+                case '<': raw("&lt;", 4); break;
+                case '>': raw("&gt;", 4); break;
+                case '"': raw("&quot;", 6); break;
+                case '\'': raw("&#39;", 5); break;
+                default: raw(text, 1); break;
+            }
+        }
+    }
+
+    // Kratky neescapovany text (cisla), nejvys 63 znaku.
+    void format(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char text[64];
+        va_list args;
+        va_start(args, fmt);
+        const int len = vsnprintf(text, sizeof(text), fmt, args);
+        va_end(args);
+        if (len > 0) {
+            raw(text, std::min(static_cast<size_t>(len), sizeof(text) - 1));
+        }
+    }
+
+    // Odesle zbytek bufferu a ukonceni chunked odpovedi.
+    esp_err_t finish()
+    {
+        flush();
+        if (result_ == ESP_OK) {
+            result_ = httpd_resp_send_chunk(req_, nullptr, 0);
+        }
+        return result_;
+    }
+
+private:
+    void flush()
+    {
+        if (len_ > 0 && result_ == ESP_OK) {
+            result_ = httpd_resp_send_chunk(req_, buffer_, static_cast<ssize_t>(len_));
+        }
+        len_ = 0;
+    }
+
+    httpd_req_t *req_;
+    char buffer_[HTML_CHUNK_LEN];
+    size_t len_;
+    esp_err_t result_;
+};
 
 static const char *reset_reason_to_str(esp_reset_reason_t reason)
 {
@@ -80,7 +168,7 @@ static const char *reset_reason_to_str(esp_reset_reason_t reason)
     }
 }
 
-static std::string format_unix_time(int64_t unix_time)
+static const char *format_unix_time(int64_t unix_time, char *buffer, size_t buffer_len)
 {
     if (unix_time <= 0) {
         return "neznamy";
@@ -92,8 +180,7 @@ static std::string format_unix_time(int64_t unix_time)
         return "neznamy";
     }
 
-    char buffer[32] = {0};
-    if (strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm_info) == 0) {
+    if (strftime(buffer, buffer_len, "%Y-%m-%d %H:%M:%S", &tm_info) == 0) {
         return "neznamy";
     }
     return buffer;
@@ -159,50 +246,48 @@ static std::map<std::string, std::string> parse_form_encoded(const std::string &
     return out;
 }
 
-static std::string read_value_for_html(const config_item_t &item)
+static constexpr size_t HTML_VALUE_LEN = 256;
+
+static const char *read_value_for_html(const config_item_t &item, char *out, size_t out_len)
 {
+    out[0] = '\0';
     switch (item.type) {
-        case CONFIG_VALUE_STRING: {
-            char buffer[256] = {0};
-            config_store_get_string_item(&item, buffer, sizeof(buffer));
-            return buffer;
-        }
-        case CONFIG_VALUE_INT32: {
-            int32_t value = config_store_get_i32_item(&item);
-            return std::to_string(value);
-        }
-        case CONFIG_VALUE_FLOAT: {
-            float value = config_store_get_float_item(&item);
-            char out[32] = {0};
-            snprintf(out, sizeof(out), "%.3f", value);
-            return out;
-        }
-        case CONFIG_VALUE_BOOL: {
-            bool value = config_store_get_bool_item(&item);
-            return value ? "1" : "0";
-        }
+        case CONFIG_VALUE_STRING:
+            config_store_get_string_item(&item, out, out_len);
+            break;
+        case CONFIG_VALUE_INT32:
+            snprintf(out, out_len, "%ld", static_cast<long>(config_store_get_i32_item(&item)));
+            break;
+        case CONFIG_VALUE_FLOAT:
+            snprintf(out, out_len, "%.3f", config_store_get_float_item(&item));
+            break;
+        case CONFIG_VALUE_BOOL:
+            snprintf(out, out_len, "%s", config_store_get_bool_item(&item) ? "1" : "0");
+            break;
         default:
-            return "";
+            break;
     }
+    return out;
 }
 
-static std::string default_value_for_html(const config_item_t &item)
+static const char *default_value_for_html(const config_item_t &item, char *out, size_t out_len)
 {
+    out[0] = '\0';
     switch (item.type) {
         case CONFIG_VALUE_STRING:
             return (item.default_string != nullptr) ? item.default_string : "";
         case CONFIG_VALUE_INT32:
-            return std::to_string(item.default_int);
-        case CONFIG_VALUE_FLOAT: {
-            char out[32] = {0};
-            snprintf(out, sizeof(out), "%.3f", item.default_float);
-            return out;
-        }
+            snprintf(out, out_len, "%ld", static_cast<long>(item.default_int));
+            break;
+        case CONFIG_VALUE_FLOAT:
+            snprintf(out, out_len, "%.3f", item.default_float);
+            break;
         case CONFIG_VALUE_BOOL:
             return item.default_bool ? "1" : "0";
         default:
-            return "";
+            break;
     }
+    return out;
 }
 
 static bool has_default_value_for_html(const config_item_t &item)
@@ -213,33 +298,40 @@ static bool has_default_value_for_html(const config_item_t &item)
     return true;
 }
 
-static std::string build_config_page_html()
+static const char *project_name_for_html(const esp_app_desc_t *app_desc)
 {
-    const esp_app_desc_t *app_desc = esp_app_get_description();
-    const std::string project_name = (app_desc != nullptr && app_desc->project_name[0] != '\0') ? app_desc->project_name : "projekt";
-
-    std::string html;
-    html.reserve(4096);
-    html += "<!doctype html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>";
-    html += "<title>" + html_escape(project_name) + " - Konfigurace</title>";
-    html += "<style>body{font-family:sans-serif;max-width:760px;margin:20px auto;padding:0 12px;}";
-    html += "label{font-weight:600;display:block;margin-bottom:4px;}";
-    html += "small{display:block;color:#666;margin-top:4px;}";
-    html += ".item-key{color:#8b8b8b;font-size:.82rem;font-family:monospace;font-weight:400;margin-left:6px;}";
-    html += "input[type=text],input[type=number]{width:100%;padding:8px;box-sizing:border-box;}";
-    html += ".item{border:1px solid #ddd;border-radius:8px;padding:12px;margin-bottom:12px;}";
-    html += ".section{margin-bottom:18px;padding:12px;border:1px solid #eee;border-radius:10px;background:#fafafa;}";
-    html += ".section h2{margin:0 0 12px 0;font-size:1.1rem;}";
-    html += ".actions{display:flex;gap:8px;flex-wrap:wrap;}";
-    html += "button{padding:10px 14px;border:0;border-radius:8px;cursor:pointer;}";
-    html += "</style></head><body>";
-    html += "<h1>Konfigurace zařízení - " + html_escape(project_name) + "</h1>";
-    html += "<p><a href='/'>← Zpět na systémový přehled</a></p>";
-    html += "<form id='cfgForm' method='post' action='/config/save'>";
+    return (app_desc != nullptr && app_desc->project_name[0] != '\0') ? app_desc->project_name : "projekt";
+}
 
+static void render_config_page_html(html_writer_t &html)
+{
+    const char *project_name = project_name_for_html(esp_app_get_description());
+
+    html.raw("<!doctype html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>");
+    html.raw("<title>");
+    html.escaped(project_name);
+    html.raw(" - Konfigurace</title>");
+    html.raw("<style>body{font-family:sans-serif;max-width:760px;margin:20px auto;padding:0 12px;}"
+             "label{font-weight:600;display:block;margin-bottom:4px;}"
+             "small{display:block;color:#666;margin-top:4px;}"
+             ".item-key{color:#8b8b8b;font-size:.82rem;font-family:monospace;font-weight:400;margin-left:6px;}"
+             "input[type=text],input[type=number]{width:100%;padding:8px;box-sizing:border-box;}"
+             ".item{border:1px solid #ddd;border-radius:8px;padding:12px;margin-bottom:12px;}"
+             ".section{margin-bottom:18px;padding:12px;border:1px solid #eee;border-radius:10px;background:#fafafa;}"
+             ".section h2{margin:0 0 12px 0;font-size:1.1rem;}"
+             ".actions{display:flex;gap:8px;flex-wrap:wrap;}"
+             "button{padding:10px 14px;border:0;border-radius:8px;cursor:pointer;}"
+             "</style></head><body>");
+    html.raw("<h1>Konfigurace zařízení - ");
+    html.escaped(project_name);
+    html.raw("</h1>");
+    html.raw("<p><a href='/'>← Zpět na systémový přehled</a></p>");
+    html.raw("<form id='cfgForm' method='post' action='/config/save'>");
+
+    char current_value_buffer[HTML_VALUE_LEN];
+    char default_value_buffer[32];
     const size_t item_count = config_store_item_count();
-    std::string current_section;
-    bool section_open = false;
+    const char *current_section = nullptr;
     for (size_t index = 0; index < item_count; ++index) {
         const config_item_t *item_ptr = config_store_item_at(index);
         if (item_ptr == nullptr) {
@@ -247,134 +339,186 @@ static std::string build_config_page_html()
         }
 
         const char *section_name_ptr = config_store_section_for_item_at(index);
-        std::string section_name = (section_name_ptr != nullptr && section_name_ptr[0] != '\0') ? section_name_ptr : "Konfigurace";
-        if (!section_open || section_name != current_section) {
-            if (section_open) {
-                html += "</div>";
+        const char *section_name = (section_name_ptr != nullptr && section_name_ptr[0] != '\0') ? section_name_ptr : "Konfigurace";
+        if (current_section == nullptr || strcmp(section_name, current_section) != 0) {
+            if (current_section != nullptr) {
+                html.raw("</div>");
             }
-            html += "<div class='section'><h2>" + html_escape(section_name) + "</h2>";
+            html.raw("<div class='section'><h2>");
+            html.escaped(section_name);
+            html.raw("</h2>");
             current_section = section_name;
-            section_open = true;
         }
 
         const config_item_t &item = *item_ptr;
-        std::string current_value = read_value_for_html(item);
-        std::string default_value = default_value_for_html(item);
+        const char *current_value = read_value_for_html(item, current_value_buffer, sizeof(current_value_buffer));
+        const char *default_value = default_value_for_html(item, default_value_buffer, sizeof(default_value_buffer));
         const bool has_default_value = has_default_value_for_html(item);
 
-        html += "<div class='item'>";
-        html += "<label for='" + html_escape(item.key) + "'>" + html_escape(item.label != nullptr ? item.label : item.key);
-        html += "<span class='item-key'>" + html_escape(item.key) + "</span></label>";
-
-        if (item.type == CONFIG_VALUE_STRING) {
-            html += "<input type='text' id='" + html_escape(item.key) + "' name='" + html_escape(item.key) + "' value='" + html_escape(current_value) + "'";
-            html += " data-default-type='string' data-default='" + html_escape(default_value) + "'";
-            if (item.max_string_len > 0) {
-                html += " maxlength='" + std::to_string(item.max_string_len) + "'";
+        html.raw("<div class='item'>");
+        html.raw("<label for='");
+        html.escaped(item.key);
+        html.raw("'>");
+        html.escaped(item.label != nullptr ? item.label : item.key);
+        html.raw("<span class='item-key'>");
+        html.escaped(item.key);
+        html.raw("</span></label>");
+
+        const char *input_attrs = nullptr;
+        const char *default_type = nullptr;
+        switch (item.type) {
+            case CONFIG_VALUE_STRING: input_attrs = "type='text'"; default_type = "string"; break;
+            case CONFIG_VALUE_INT32: input_attrs = "type='number' step='1'"; default_type = "int"; break;
+            case CONFIG_VALUE_FLOAT: input_attrs = "type='number' step='any'"; default_type = "float"; break;
+            case CONFIG_VALUE_BOOL: input_attrs = "type='checkbox'"; default_type = "bool"; break;
+        }
+        if (input_attrs != nullptr) {
+            html.raw("<input ");
+            html.raw(input_attrs);
+            html.raw(" id='");
+            html.escaped(item.key);
+            html.raw("' name='");
+            html.escaped(item.key);
+            html.raw("'");
+            if (item.type != CONFIG_VALUE_BOOL) {
+                html.raw(" value='");
+                html.escaped(current_value);
+                html.raw("'");
             }
-            html += ">";
-        } else if (item.type == CONFIG_VALUE_INT32) {
-            html += "<input type='number' step='1' id='" + html_escape(item.key) + "' name='" + html_escape(item.key) + "' value='" + html_escape(current_value) + "'";
-            html += " data-default-type='int' data-default='" + html_escape(default_value) + "'";
-            html += " min='" + std::to_string(item.min_int) + "' max='" + std::to_string(item.max_int) + "'>";
-        } else if (item.type == CONFIG_VALUE_FLOAT) {
-            html += "<input type='number' step='any' id='" + html_escape(item.key) + "' name='" + html_escape(item.key) + "' value='" + html_escape(current_value) + "'";
-            html += " data-default-type='float' data-default='" + html_escape(default_value) + "'";
-            html += " min='" + std::to_string(item.min_float) + "' max='" + std::to_string(item.max_float) + "'>";
-        } else if (item.type == CONFIG_VALUE_BOOL) {
-            bool checked = (current_value == "1");
-            html += "<input type='checkbox' id='" + html_escape(item.key) + "' name='" + html_escape(item.key) + "'";
-            html += " data-default-type='bool' data-default='" + html_escape(default_value) + "'";
-            if (checked) {
-                html += " checked";
+            html.raw(" data-default-type='");
+            html.raw(default_type);
+            html.raw("' data-default='");
+            html.escaped(default_value);
+            html.raw("'");
+
+            if (item.type == CONFIG_VALUE_STRING && item.max_string_len > 0) {
+                html.format(" maxlength='%u'", static_cast<unsigned>(item.max_string_len));
+            } else if (item.type == CONFIG_VALUE_INT32) {
+                html.format(" min='%ld' max='%ld'", static_cast<long>(item.min_int), static_cast<long>(item.max_int));
+            } else if (item.type == CONFIG_VALUE_FLOAT) {
+                html.format(" min='%f' max='%f'", item.min_float, item.max_float);
+            } else if (item.type == CONFIG_VALUE_BOOL && strcmp(current_value, "1") == 0) {
+                html.raw(" checked");
             }
-            html += ">";
+            html.raw(">");
         }
 
-        std::string desc_prefix = (item.description != nullptr && item.description[0] != '\0') ? item.description : "napr.";
-        std::string desc_suffix = has_default_value ? default_value : "napr.";
-        html += "<small>" + html_escape(desc_prefix) + " (" + html_escape(desc_suffix) + ")</small>";
-        html += "</div>";
+        html.raw("<small>");
+        html.escaped((item.description != nullptr && item.description[0] != '\0') ? item.description : "napr.");
+        html.raw(" (");
+        html.escaped(has_default_value ? default_value : "napr.");
+        html.raw(")</small>");
+        html.raw("</div>");
     }
 
-    if (section_open) {
-        html += "</div>";
+    if (current_section != nullptr) {
+        html.raw("</div>");
     }
 
-    html += "<div class='actions'>";
-    html += "<button type='submit'>Uložit</button>";
-    html += "<button type='button' onclick='window.location.href=\"/config\"'>Obnovit</button>";
-    html += "<button type='button' onclick='loadFactoryDefaults()'>Načíst tovární nastavení</button>";
-    html += "</div></form>";
-    html += "<script>function loadFactoryDefaults(){";
-    html += "var fields=document.querySelectorAll('[data-default-type]');";
-    html += "for(var i=0;i<fields.length;i++){var el=fields[i];var t=el.getAttribute('data-default-type');var d=el.getAttribute('data-default')||'';";
-    html += "if(t==='bool'){el.checked=(d==='1');}else{el.value=d;}}}";
-    html += "</script></body></html>";
-    return html;
+    html.raw("<div class='actions'>"
+             "<button type='submit'>Uložit</button>"
+             "<button type='button' onclick='window.location.href=\"/config\"'>Obnovit</button>"
+             "<button type='button' onclick='loadFactoryDefaults()'>Načíst tovární nastavení</button>"
+             "</div></form>"
+             "<script>function loadFactoryDefaults(){"
+             "var fields=document.querySelectorAll('[data-default-type]');"
+             "for(var i=0;i<fields.length;i++){var el=fields[i];var t=el.getAttribute('data-default-type');var d=el.getAttribute('data-default')||'';"
+             "if(t==='bool'){el.checked=(d==='1');}else{el.value=d;}}}"
+             "</script></body></html>");
 }
 
-static std::string build_root_page_html()
+static void render_root_page_html(html_writer_t &html)
 {
     esp_chip_info_t chip_info = {};
     esp_chip_info(&chip_info);
 
     const esp_app_desc_t *app_desc = esp_app_get_description();
-    const std::string project_name = (app_desc != nullptr && app_desc->project_name[0] != '\0') ? app_desc->project_name : "projekt";
+    const char *project_name = project_name_for_html(app_desc);
     uint32_t uptime_seconds = static_cast<uint32_t>(esp_timer_get_time() / 1000000ULL);
 
-    std::string html;
-    html.reserve(3000);
-    html += "<!doctype html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>";
-    html += "<title>" + html_escape(project_name) + " - Systémový přehled</title>";
-    html += "<style>body{font-family:sans-serif;max-width:760px;margin:20px auto;padding:0 12px;}";
-    html += ".card{border:1px solid #ddd;border-radius:8px;padding:12px;margin-bottom:12px;}";
-    html += "h1,h2{margin-top:0;}";
-    html += "ul{padding-left:18px;margin:0;}";
-    html += "li{margin-bottom:6px;}";
-    html += "a.button{display:inline-block;padding:10px 14px;border-radius:8px;border:1px solid #333;text-decoration:none;color:#111;}";
-    html += "</style></head><body>";
-    html += "<h1>Systémový přehled - " + html_escape(project_name) + "</h1>";
+    html.raw("<!doctype html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>");
+    html.raw("<title>");
+    html.escaped(project_name);
+    html.raw(" - Systémový přehled</title>");
+    html.raw("<style>body{font-family:sans-serif;max-width:760px;margin:20px auto;padding:0 12px;}"
+             ".card{border:1px solid #ddd;border-radius:8px;padding:12px;margin-bottom:12px;}"
+             "h1,h2{margin-top:0;}"
+             "ul{padding-left:18px;margin:0;}"
+             "li{margin-bottom:6px;}"
+             "table{border-collapse:collapse;width:100%;}th,td{border-bottom:1px solid #eee;padding:4px;text-align:right;}"
+             "a.button{display:inline-block;padding:10px 14px;border-radius:8px;border:1px solid #333;text-decoration:none;color:#111;}"
+             "</style></head><body>");
+    html.raw("<h1>Systémový přehled - ");
+    html.escaped(project_name);
+    html.raw("</h1>");
 
     if (s_has_network_info) {
-        html += "<div class='card'><h2>Síťový režim</h2><ul>";
-        html += "<li>Aktivní režim: <strong>" + std::string(s_network_info.is_ap_mode ? "AP (konfigurační hotspot)" : "STA (klient)") + "</strong></li>";
+        html.raw("<div class='card'><h2>Síťový režim</h2><ul>");
+        html.raw("<li>Aktivní režim: <strong>");
+        html.raw(s_network_info.is_ap_mode ? "AP (konfigurační hotspot)" : "STA (klient)");
+        html.raw("</strong></li>");
         if (!s_network_ssid_storage.empty()) {
-            html += "<li>SSID: <strong>" + html_escape(s_network_ssid_storage) + "</strong></li>";
+            html.raw("<li>SSID: <strong>");
+            html.escaped(s_network_ssid_storage.c_str());
+            html.raw("</strong></li>");
         }
-        html += "</ul></div>";
+        html.raw("</ul></div>");
     }
 
     if (s_has_restart_info) {
-        html += "<div class='card'><h2>Restarty</h2><ul>";
-        html += "<li>Počet restartů: <strong>" + std::to_string(s_restart_info.boot_count) + "</strong></li>";
-        html += "<li>Důvod posledního restartu: <strong>" + std::string(reset_reason_to_str(static_cast<esp_reset_reason_t>(s_restart_info.last_reason))) + "</strong></li>";
-        html += "<li>Čas posledního restartu: <strong>" + format_unix_time(s_restart_info.last_restart_unix) + "</strong></li>";
-        html += "</ul></div>";
-    }
-
-    html += "<div class='card'><h2>Systémové informace</h2><ul>";
-    html += "<li>Projekt: <strong>" + html_escape(project_name) + "</strong></li>";
-    html += "<li>Verze aplikace: <strong>" + std::string(app_desc->version) + "</strong></li>";
-    html += "<li>ESP-IDF: <strong>" + std::string(esp_get_idf_version()) + "</strong></li>";
-    html += "<li>Chip model: <strong>ESP32</strong></li>";
-    html += "<li>Jádra CPU: <strong>" + std::to_string(chip_info.cores) + "</strong></li>";
-    html += "<li>Revize čipu: <strong>" + std::to_string(chip_info.revision) + "</strong></li>";
-    html += "<li>Volná heap: <strong>" + std::to_string(static_cast<unsigned long>(esp_get_free_heap_size())) + " B</strong></li>";
-    html += "<li>Minimum heap: <strong>" + std::to_string(static_cast<unsigned long>(esp_get_minimum_free_heap_size())) + " B</strong></li>";
-    html += "<li>Uptime: <strong>" + std::to_string(uptime_seconds) + " s</strong></li>";
-    html += "</ul></div>";
-
-    html += "<p><a class='button' href='/config'>Otevřít konfiguraci</a></p>";
-    html += "</body></html>";
-    return html;
+        char time_buffer[32] = {0};
+        html.raw("<div class='card'><h2>Restarty</h2><ul>");
+        html.format("<li>Počet restartů: <strong>%lu</strong></li>", static_cast<unsigned long>(s_restart_info.boot_count));
+        html.raw("<li>Důvod posledního restartu: <strong>");
+        html.raw(reset_reason_to_str(static_cast<esp_reset_reason_t>(s_restart_info.last_reason)));
+        html.raw("</strong></li>");
+        html.raw("<li>Čas posledního restartu: <strong>");
+        html.raw(format_unix_time(s_restart_info.last_restart_unix, time_buffer, sizeof(time_buffer)));
+        html.raw("</strong></li>");
+        html.raw("</ul></div>");
+    }
+
+    // Karty renderuji do vlastniho bufferu (API karty); obsah je uz HTML.
+    char card_content[STATUS_CARD_BUFFER_LEN];
+    for (size_t i = 0; i < s_status_card_count; ++i) {
+        card_content[0] = '\0';
+        s_status_cards[i].render(card_content, sizeof(card_content));
+        card_content[sizeof(card_content) - 1] = '\0';
+        html.raw("<div class='card'><h2>");
+        html.escaped(s_status_cards[i].title);
+        html.raw("</h2>");
+        html.raw(card_content);
+        html.raw("</div>");
+    }
+
+    html.raw("<div class='card'><h2>Systémové informace</h2><ul>");
+    html.raw("<li>Projekt: <strong>");
+    html.escaped(project_name);
+    html.raw("</strong></li>");
+    html.raw("<li>Verze aplikace: <strong>");
+    html.raw(app_desc->version);
+    html.raw("</strong></li>");
+    html.raw("<li>ESP-IDF: <strong>");
+    html.raw(esp_get_idf_version());
+    html.raw("</strong></li>");
+    html.raw("<li>Chip model: <strong>ESP32</strong></li>");
+    html.format("<li>Jádra CPU: <strong>%u</strong></li>", static_cast<unsigned>(chip_info.cores));
+    html.format("<li>Revize čipu: <strong>%u</strong></li>", static_cast<unsigned>(chip_info.revision));
+    html.format("<li>Volná heap: <strong>%lu B</strong></li>", static_cast<unsigned long>(esp_get_free_heap_size()));
+    html.format("<li>Minimum heap: <strong>%lu B</strong></li>", static_cast<unsigned long>(esp_get_minimum_free_heap_size()));
+    html.format("<li>Uptime: <strong>%lu s</strong></li>", static_cast<unsigned long>(uptime_seconds));
+    html.raw("</ul></div>");
+
+    html.raw("<p><a class='button' href='/config'>Otevřít konfiguraci</a></p>");
+    html.raw("</body></html>");
 }
 
 static esp_err_t root_get_handler(httpd_req_t *req)
 {
-    std::string html = build_root_page_html();
     httpd_resp_set_type(req, "text/html; charset=utf-8");
-    return httpd_resp_send(req, html.c_str(), static_cast<ssize_t>(html.size()));
+    html_writer_t html(req);
+    render_root_page_html(html);
+    return html.finish();
 }
 
 static esp_err_t captive_redirect_handler(httpd_req_t *req)
@@ -410,14 +554,16 @@ static esp_err_t captive_windows_ncsi_handler(httpd_req_t *req)
 
 static esp_err_t config_get_handler(httpd_req_t *req)
 {
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
+    html_writer_t html(req);
+    render_config_page_html(html);
+    const esp_err_t result = html.finish();
+
     UBaseType_t stack_words = uxTaskGetStackHighWaterMark(nullptr);
     if (stack_words < 256) {
         ESP_LOGW(TAG, "Nizka rezerva stacku v GET handleru: %u words", static_cast<unsigned>(stack_words));
     }
-
-    std::string html = build_config_page_html();
-    httpd_resp_set_type(req, "text/html; charset=utf-8");
-    return httpd_resp_send(req, html.c_str(), static_cast<ssize_t>(html.size()));
+    return result;
 }
 
 static bool parse_bool_value(const std::string &value)
@@ -491,6 +637,19 @@ static esp_err_t save_form_to_nvs(const std::map<std::string, std::string> &para
     return ESP_OK;
 }
 
+// Restart po ulozeni konfigurace; kratka prodleva, aby se stihla odeslat odpoved.
+static void schedule_restart(void)
+{
+    auto restart_task = [](void *arg) {
+        vTaskDelay(pdMS_TO_TICKS(250));
+        ESP_LOGI(TAG, "Restartuji zarizeni po ulozeni konfigurace");
+        esp_restart();
+        vTaskDelete(nullptr);
+    };
+
+    xTaskCreate(restart_task, "cfg_restart", 2048, nullptr, 5, nullptr);
+}
+
 static esp_err_t config_save_handler(httpd_req_t *req)
 {
     UBaseType_t stack_words = uxTaskGetStackHighWaterMark(nullptr);
@@ -514,20 +673,42 @@ static esp_err_t config_save_handler(httpd_req_t *req)
 
     std::string body_string(body.data(), total_read);
     std::map<std::string, std::string> params = parse_form_encoded(body_string);
-    esp_err_t result = save_form_to_nvs(params);
+    // Cely formular jednim NVS commitem; nezmenene polozky config_store nezapisuje.
+    esp_err_t result = config_store_begin_batch();
+    if (result == ESP_OK) {
+        result = save_form_to_nvs(params);
+        const esp_err_t commit_result = config_store_commit_batch();
+        if (result == ESP_OK) {
+            result = commit_result;
+        }
+    }
     if (result != ESP_OK) {
         ESP_LOGE(TAG, "Ulozeni konfigurace selhalo: %s", esp_err_to_name(result));
         return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Ulozeni konfigurace selhalo");
     }
 
-    auto restart_task = [](void *arg) {
-        vTaskDelay(pdMS_TO_TICKS(250));
-        ESP_LOGI(TAG, "Restartuji zarizeni po ulozeni konfigurace");
-        esp_restart();
-        vTaskDelete(nullptr);
-    };
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
 
-    xTaskCreate(restart_task, "cfg_restart", 2048, nullptr, 5, nullptr);
+    // Polozky s odberatelem (kalibrace cidel) uz moduly prevzaly; restart jen kdyz se zmenilo
+    // neco, co se nacita jen pri startu.
+    if (!config_store_restart_required()) {
+        ESP_LOGI(TAG, "Konfigurace ulozena a pouzita bez restartu");
+        const char *html =
+            "<!doctype html><html><head>"
+            "<meta charset='utf-8'>"
+            "<meta name='viewport' content='width=device-width,initial-scale=1'>"
+            "<title>Uloženo</title>"
+            "<style>body{font-family:sans-serif;max-width:640px;margin:24px auto;padding:0 12px;}</style>"
+            "</head><body>"
+            "<h1>Konfigurace uložena</h1>"
+            "<p>Změny byly použity bez restartu zařízení.</p>"
+            "<p>Zpět na <a href='/config'>/config</a>.</p>"
+            "<script>setTimeout(function(){window.location.href='/config';},1200);</script>"
+            "</body></html>";
+        return httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
+    }
+
+    schedule_restart();
 
     const char *html =
         "<!doctype html><html><head>"
@@ -542,10 +723,363 @@ static esp_err_t config_save_handler(httpd_req_t *req)
         "<script>setTimeout(function(){window.location.href='/config';},1200);</script>"
         "</body></html>";
 
-    httpd_resp_set_type(req, "text/html; charset=utf-8");
     return httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
 }
 
+static esp_err_t send_json_chunk(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk(static_cast<httpd_req_t *>(ctx), data, static_cast<ssize_t>(len));
+}
+
+static const char *config_type_name(config_value_type_t type)
+{
+    switch (type) {
+        case CONFIG_VALUE_STRING: return "string";
+        case CONFIG_VALUE_INT32: return "int";
+        case CONFIG_VALUE_FLOAT: return "float";
+        case CONFIG_VALUE_BOOL: return "bool";
+        default: return "unknown";
+    }
+}
+
+static void render_config_item_json(JsonWriter &json, const config_item_t &item, const char *section_name)
+{
+    json.beginObject();
+    json.key("key");
+    json.string(item.key);
+    json.key("section");
+    json.string(section_name);
+    json.key("label");
+    json.string(item.label != nullptr ? item.label : item.key);
+    json.key("type");
+    json.string(config_type_name(item.type));
+    switch (item.type) {
+        case CONFIG_VALUE_STRING: {
+            char value[HTML_VALUE_LEN];
+            config_store_get_string_item(&item, value, sizeof(value));
+            json.key("value");
+            json.string(value);
+            json.key("default");
+            json.string(item.default_string);
+            json.key("max_len");
+            json.integer(static_cast<int64_t>(item.max_string_len));
+            break;
+        }
+        case CONFIG_VALUE_INT32:
+            json.key("value");
+            json.integer(config_store_get_i32_item(&item));
+            json.key("default");
+            json.integer(item.default_int);
+            json.key("min");
+            json.integer(item.min_int);
+            json.key("max");
+            json.integer(item.max_int);
+            break;
+        case CONFIG_VALUE_FLOAT:
+            json.key("value");
+            json.number(config_store_get_float_item(&item));
+            json.key("default");
+            json.number(item.default_float);
+            json.key("min");
+            json.number(item.min_float);
+            json.key("max");
+            json.number(item.max_float);
+            break;
+        case CONFIG_VALUE_BOOL:
+            json.key("value");
+            json.boolean(config_store_get_bool_item(&item));
+            json.key("default");
+            json.boolean(item.default_bool);
+            break;
+    }
+    json.endObject();
+}
+
+static esp_err_t api_config_get_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
+    char buffer[HTML_CHUNK_LEN];
+    JsonWriter json(buffer, sizeof(buffer), send_json_chunk, req);
+    json.beginObject();
+    json.key("restart_required");
+    json.boolean(config_store_restart_required());
+    json.key("items");
+    json.beginArray();
+    for (size_t index = 0; index < config_store_item_count(); ++index) {
+        const config_item_t *item = config_store_item_at(index);
+        if (item == nullptr) {
+            continue;
+        }
+        const char *section_name = config_store_section_for_item_at(index);
+        render_config_item_json(json, *item, (section_name != nullptr && section_name[0] != '\0') ? section_name : "Konfigurace");
+    }
+    json.endArray();
+    json.endObject();
+    const esp_err_t result = json.finish();
+    return result == ESP_OK ? httpd_resp_send_chunk(req, nullptr, 0) : result;
+}
+
+// Overena dvojice z tela PUT /api/config. Nastavi se az po precteni celeho tela.
+struct api_config_put_entry_t {
+    const config_item_t *item;
+    union {
+        int32_t i32;
+        float f;
+        bool b;
+    } value;
+    std::string string_value;
+};
+
+// httpd obsluhuje pozadavky v jednom tasku, tabulka tedy muze byt staticka. Kazda polozka
+// je v ni nejvyse jednou (opakovany klic prepise hodnotu), staci proto pocet polozek.
+static api_config_put_entry_t s_api_config_put_entries[CONFIG_STORE_MAX_ITEMS];
+
+typedef struct {
+    const char *error;
+    size_t count;
+} api_config_put_ctx_t;
+
+// Jedna dvojice z tela PUT /api/config. Typ JSON hodnoty musi odpovidat typu polozky,
+// rozsah a delka se upravi stejne jako pri ulozeni formulare. Hodnota se jen odlozi.
+static esp_err_t api_config_put_member(void *ctx, const char *key, json_value_kind_t kind, const char *value)
+{
+    api_config_put_ctx_t *put = static_cast<api_config_put_ctx_t *>(ctx);
+    const config_item_t *item = config_store_find_item(key);
+    if (item == nullptr) {
+        put->error = "neznamy klic";
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t index = 0;
+    while (index < put->count && s_api_config_put_entries[index].item != item) {
+        ++index;
+    }
+    if (index >= CONFIG_STORE_MAX_ITEMS) {
+        put->error = "prilis mnoho polozek";
+        return ESP_ERR_NO_MEM;
+    }
+    api_config_put_entry_t &entry = s_api_config_put_entries[index];
+
+    bool valid = false;
+    char *end_ptr = nullptr;
+    if (item->type == CONFIG_VALUE_STRING && kind == json_value_kind_t::STRING) {
+        const size_t max_len = item->max_string_len > 0 ? std::min(item->max_string_len, HTML_VALUE_LEN - 1) : HTML_VALUE_LEN - 1;
+        entry.string_value.assign(value, std::min(strlen(value), max_len));
+        valid = true;
+    } else if (item->type == CONFIG_VALUE_INT32 && kind == json_value_kind_t::NUMBER) {
+        const long parsed = strtol(value, &end_ptr, 10);
+        if (*end_ptr == '\0') {
+            entry.value.i32 = static_cast<int32_t>(std::max<long>(item->min_int, std::min<long>(item->max_int, parsed)));
+            valid = true;
+        }
+    } else if (item->type == CONFIG_VALUE_FLOAT && kind == json_value_kind_t::NUMBER) {
+        const float parsed = strtof(value, nullptr);
+        entry.value.f = std::max(item->min_float, std::min(item->max_float, parsed));
+        valid = true;
+    } else if (item->type == CONFIG_VALUE_BOOL && kind == json_value_kind_t::BOOLEAN) {
+        entry.value.b = strcmp(value, "true") == 0;
+        valid = true;
+    }
+
+    if (!valid) {
+        put->error = "neplatna hodnota";
+        return ESP_ERR_INVALID_ARG;
+    }
+    entry.item = item;
+    if (index == put->count) {
+        put->count += 1;
+    }
+    return ESP_OK;
+}
+
+// Odlozene hodnoty jednou davkou (jeden NVS commit, odberatele az po nem). Chybu zde
+// muze vratit jen zapis do NVS.
+static esp_err_t api_config_put_apply(const api_config_put_ctx_t &put)
+{
+    esp_err_t result = config_store_begin_batch();
+    if (result != ESP_OK) {
+        return result;
+    }
+    for (size_t index = 0; index < put.count && result == ESP_OK; ++index) {
+        const api_config_put_entry_t &entry = s_api_config_put_entries[index];
+        switch (entry.item->type) {
+            case CONFIG_VALUE_STRING:
+                result = config_store_set_string_item(entry.item, entry.string_value.c_str());
+                break;
+            case CONFIG_VALUE_INT32:
+                result = config_store_set_i32_item(entry.item, entry.value.i32);
+                break;
+            case CONFIG_VALUE_FLOAT:
+                result = config_store_set_float_item(entry.item, entry.value.f);
+                break;
+            case CONFIG_VALUE_BOOL:
+                result = config_store_set_bool_item(entry.item, entry.value.b);
+                break;
+        }
+    }
+    const esp_err_t commit_result = config_store_commit_batch();
+    return result != ESP_OK ? result : commit_result;
+}
+
+static esp_err_t send_json_error(httpd_req_t *req, const char *status, const char *error, const char *key)
+{
+    char buffer[192];
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter json(buffer, sizeof(buffer), send_json_chunk, req);
+    json.beginObject();
+    json.key("ok");
+    json.boolean(false);
+    json.key("error");
+    json.string(error);
+    if (key != nullptr && key[0] != '\0') {
+        json.key("key");
+        json.string(key);
+    }
+    json.endObject();
+    const esp_err_t result = json.finish();
+    return result == ESP_OK ? httpd_resp_send_chunk(req, nullptr, 0) : result;
+}
+
+// Telo se cte po castech primo do parseru, ktery dvojice jen overi a odlozi. Nastavi se
+// az po precteni celeho tela jednou davkou jako formular; pri chybe se nezmeni nic.
+static esp_err_t api_config_put_handler(httpd_req_t *req)
+{
+    if (req->content_len <= 0 || req->content_len > 8192) {
+        return send_json_error(req, "400 Bad Request", "neplatna delka tela", nullptr);
+    }
+
+    api_config_put_ctx_t put = {nullptr, 0};
+    JsonObjectReader<API_KEY_LEN, HTML_VALUE_LEN> reader(api_config_put_member, &put);
+    esp_err_t result = ESP_OK;
+
+    char chunk[256];
+    size_t remaining = req->content_len;
+    while (remaining > 0 && result == ESP_OK) {
+        const int bytes = httpd_req_recv(req, chunk, std::min(remaining, sizeof(chunk)));
+        if (bytes == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (bytes <= 0) {
+            return ESP_FAIL;
+        }
+        remaining -= static_cast<size_t>(bytes);
+        result = reader.feed(chunk, static_cast<size_t>(bytes));
+    }
+    if (result == ESP_OK) {
+        result = reader.finish();
+    }
+
+    if (result != ESP_OK) {
+        const char *error = put.error;
+        if (error == nullptr) {
+            switch (result) {
+                case ESP_ERR_INVALID_SIZE: error = "prilis dlouhy klic nebo hodnota"; break;
+                case ESP_ERR_NOT_SUPPORTED: error = "vnorene objekty a pole nejsou podporovany"; break;
+                case ESP_ERR_INVALID_ARG: error = "neplatny JSON"; break;
+                default: error = esp_err_to_name(result); break;
+            }
+        }
+        ESP_LOGW(TAG, "PUT /api/config: %s (%s)", error, reader.key());
+        return send_json_error(req, "400 Bad Request", error, reader.key());
+    }
+
+    result = api_config_put_apply(put);
+    if (result != ESP_OK) {
+        return send_json_error(req, "500 Internal Server Error", esp_err_to_name(result), nullptr);
+    }
+
+    const bool restart = config_store_restart_required();
+    char buffer[64];
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter json(buffer, sizeof(buffer), send_json_chunk, req);
+    json.beginObject();
+    json.key("ok");
+    json.boolean(true);
+    json.key("restart");
+    json.boolean(restart);
+    json.endObject();
+    result = json.finish();
+    if (result == ESP_OK) {
+        result = httpd_resp_send_chunk(req, nullptr, 0);
+    }
+    if (restart) {
+        schedule_restart();
+    }
+    return result;
+}
+
+static void render_json_sections(JsonWriter &json, config_webapp_api_t api)
+{
+    for (size_t i = 0; i < s_json_section_count; ++i) {
+        if (s_json_sections[i].api != api) {
+            continue;
+        }
+        json.key(s_json_sections[i].name);
+        s_json_sections[i].render(json);
+    }
+}
+
+static esp_err_t api_state_get_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
+    char buffer[HTML_CHUNK_LEN];
+    JsonWriter json(buffer, sizeof(buffer), send_json_chunk, req);
+    json.beginObject();
+    json.key("uptime_ms");
+    json.integer(esp_timer_get_time() / 1000LL);
+    render_json_sections(json, CONFIG_WEBAPP_API_STATE);
+    json.endObject();
+    const esp_err_t result = json.finish();
+    return result == ESP_OK ? httpd_resp_send_chunk(req, nullptr, 0) : result;
+}
+
+static esp_err_t api_diag_get_handler(httpd_req_t *req)
+{
+    const esp_app_desc_t *app_desc = esp_app_get_description();
+
+    httpd_resp_set_type(req, "application/json");
+    char buffer[HTML_CHUNK_LEN];
+    JsonWriter json(buffer, sizeof(buffer), send_json_chunk, req);
+    json.beginObject();
+    json.key("project");
+    json.string(project_name_for_html(app_desc));
+    json.key("version");
+    json.string(app_desc != nullptr ? app_desc->version : "");
+    json.key("idf");
+    json.string(esp_get_idf_version());
+    json.key("uptime_s");
+    json.integer(esp_timer_get_time() / 1000000LL);
+    json.key("heap_free_b");
+    json.integer(esp_get_free_heap_size());
+    json.key("heap_min_free_b");
+    json.integer(esp_get_minimum_free_heap_size());
+    if (s_has_restart_info) {
+        json.key("restart");
+        json.beginObject();
+        json.key("boot_count");
+        json.integer(s_restart_info.boot_count);
+        json.key("last_reason");
+        json.string(reset_reason_to_str(static_cast<esp_reset_reason_t>(s_restart_info.last_reason)));
+        json.key("last_restart_unix");
+        json.integer(s_restart_info.last_restart_unix);
+        json.endObject();
+    }
+    if (s_has_network_info) {
+        json.key("network");
+        json.beginObject();
+        json.key("mode");
+        json.string(s_network_info.is_ap_mode ? "ap" : "sta");
+        json.key("ssid");
+        json.string(s_network_ssid_storage.c_str());
+        json.endObject();
+    }
+    render_json_sections(json, CONFIG_WEBAPP_API_DIAG);
+    json.endObject();
+    const esp_err_t result = json.finish();
+    return result == ESP_OK ? httpd_resp_send_chunk(req, nullptr, 0) : result;
+}
+
 esp_err_t config_webapp_start(uint16_t http_port,
                               const config_webapp_restart_info_t *restart_info,
                               const config_webapp_network_info_t *network_info)
@@ -581,7 +1115,7 @@ esp_err_t config_webapp_start(uint16_t http_port,
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = http_port;
-    config.max_uri_handlers = 16;
+    config.max_uri_handlers = 20;
     config.stack_size = 10240;
     config.uri_match_fn = httpd_uri_match_wildcard;
 
@@ -612,6 +1146,34 @@ esp_err_t config_webapp_start(uint16_t http_port,
         .user_ctx = nullptr,
     };
 
+    httpd_uri_t api_config_get_uri = {
+        .uri = "/api/config",
+        .method = HTTP_GET,
+        .handler = api_config_get_handler,
+        .user_ctx = nullptr,
+    };
+
+    httpd_uri_t api_config_put_uri = {
+        .uri = "/api/config",
+        .method = HTTP_PUT,
+        .handler = api_config_put_handler,
+        .user_ctx = nullptr,
+    };
+
+    httpd_uri_t api_state_get_uri = {
+        .uri = "/api/state",
+        .method = HTTP_GET,
+        .handler = api_state_get_handler,
+        .user_ctx = nullptr,
+    };
+
+    httpd_uri_t api_diag_get_uri = {
+        .uri = "/api/diag",
+        .method = HTTP_GET,
+        .handler = api_diag_get_handler,
+        .user_ctx = nullptr,
+    };
+
     httpd_uri_t captive_android_uri = {
         .uri = "/generate_204",
         .method = HTTP_GET,
@@ -689,6 +1251,35 @@ esp_err_t config_webapp_start(uint16_t http_port,
         return result;
     }
 
+    // API pred captive fallbackem "/*", jinak by ho prebil.
+    result = httpd_register_uri_handler(s_ctx.server, &api_config_get_uri);
+    if (result != ESP_OK) {
+        httpd_stop(s_ctx.server);
+        s_ctx.server = nullptr;
+        return result;
+    }
+
+    result = httpd_register_uri_handler(s_ctx.server, &api_config_put_uri);
+    if (result != ESP_OK) {
+        httpd_stop(s_ctx.server);
+        s_ctx.server = nullptr;
+        return result;
+    }
+
+    result = httpd_register_uri_handler(s_ctx.server, &api_state_get_uri);
+    if (result != ESP_OK) {
+        httpd_stop(s_ctx.server);
+        s_ctx.server = nullptr;
+        return result;
+    }
+
+    result = httpd_register_uri_handler(s_ctx.server, &api_diag_get_uri);
+    if (result != ESP_OK) {
+        httpd_stop(s_ctx.server);
+        s_ctx.server = nullptr;
+        return result;
+    }
+
     result = httpd_register_uri_handler(s_ctx.server, &captive_android_uri);
     if (result != ESP_OK) {
         httpd_stop(s_ctx.server);
@@ -773,6 +1364,34 @@ esp_err_t config_webapp_prepare(const char *nvs_namespace)
     return ESP_OK;
 }
 
+esp_err_t config_webapp_add_status_card(const char *title, config_webapp_card_render_fn_t render)
+{
+    if (title == nullptr || render == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_status_card_count >= STATUS_CARD_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_status_cards[s_status_card_count] = {title, render};
+    ++s_status_card_count;
+    return ESP_OK;
+}
+
+esp_err_t config_webapp_add_json_section(config_webapp_api_t api, const char *name, config_webapp_json_render_fn_t render)
+{
+    if (name == nullptr || render == nullptr || (api != CONFIG_WEBAPP_API_STATE && api != CONFIG_WEBAPP_API_DIAG)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_json_section_count >= JSON_SECTION_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_json_sections[s_json_section_count] = {api, name, render};
+    ++s_json_section_count;
+    return ESP_OK;
+}
+
 esp_err_t config_webapp_get_i32(const char *key, int32_t *value)
 {
     if (key == nullptr || value == nullptr) {
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "esp_err.h"
+#include "json_writer.hpp"
 
 typedef struct {
     uint32_t boot_count;
@@ -16,7 +17,23 @@ typedef struct {
     const char *active_ssid;
 } config_webapp_network_info_t;
 
+// Dalsi karta na uvodni strance (napr. stav aplikace); render zapise HTML obsah karty bez nadpisu.
+typedef void (*config_webapp_card_render_fn_t)(char *buffer, size_t buffer_len);
+
 esp_err_t config_webapp_prepare(const char *nvs_namespace);
+esp_err_t config_webapp_add_status_card(const char *title, config_webapp_card_render_fn_t render);
+
+// JSON API: GET/PUT /api/config (polozky config_store), GET /api/state a GET /api/diag.
+// Moduly pridavaji do /api/state a /api/diag sekce; render zapise jednu JSON hodnotu
+// (objekt, pole, cislo, ...), ktera se v odpovedi objevi pod klicem name.
+typedef enum {
+    CONFIG_WEBAPP_API_STATE = 0,
+    CONFIG_WEBAPP_API_DIAG,
+} config_webapp_api_t;
+
+typedef void (*config_webapp_json_render_fn_t)(JsonWriter &json);
+
+esp_err_t config_webapp_add_json_section(config_webapp_api_t api, const char *name, config_webapp_json_render_fn_t render);
 
 esp_err_t config_webapp_start(uint16_t http_port,
                               const config_webapp_restart_info_t *restart_info,
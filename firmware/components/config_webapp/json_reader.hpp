@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "esp_err.h"
+
+enum class json_value_kind_t : uint8_t {
+    STRING = 0,
+    NUMBER,
+    BOOLEAN,
+    NULL_VALUE,
+};
+
+/**
+ * Prirustkove cteni plocheho JSON objektu {"klic": hodnota, ...} bez alokaci. Data se
+ * predavaji po castech, jak prichazi ze site (feed); klic a hodnota se skladaji v pevnych
+ * bufferech a kazda dvojice se hned preda callbacku. Hodnota je retezec (uz bez escapu),
+ * cislo nebo true/false/null v textove podobe; vnorene objekty a pole se odmitnou.
+ *
+ * Chyby: ESP_ERR_INVALID_ARG neplatny JSON, ESP_ERR_INVALID_SIZE prilis dlouhy klic nebo
+ * hodnota, ESP_ERR_NOT_SUPPORTED vnoreny objekt/pole, jinak chyba vracena callbackem.
+ * Po chybe reader dalsi data ignoruje; key() vraci klic, u ktereho chyba nastala.
+ *
+ * Priklad:
+ *   JsonObjectReader<16, 256> reader(on_member, &ctx);
+ *   while ((len = recv(buffer, sizeof(buffer))) > 0) {
+ *       if (reader.feed(buffer, len) != ESP_OK) break;
+ *   }
+ *   esp_err_t result = reader.finish();
+ */
+template <size_t KEY_LEN, size_t VALUE_LEN>
+class JsonObjectReader
+{
+public:
+    typedef esp_err_t (*member_fn_t)(void *ctx, const char *key, json_value_kind_t kind, const char *value);
+
+    JsonObjectReader(member_fn_t on_member, void *ctx)
+        : on_member_(on_member),
+          ctx_(ctx),
+          state_(state_t::START),
+          result_(ESP_OK),
+          key_len_(0),
+          value_len_(0),
+          escape_(0),
+          code_point_(0)
+    {
+        key_[0] = '\0';
+        value_[0] = '\0';
+    }
+
+    esp_err_t feed(const char *data, size_t len)
+    {
+        for (size_t index = 0; index < len && result_ == ESP_OK; ++index) {
+            step(data[index]);
+        }
+        return result_;
+    }
+
+    // Konec dat: ESP_OK jen pro uplny objekt (za nim smi byt jen bile znaky).
+    esp_err_t finish()
+    {
+        if (result_ == ESP_OK && state_ != state_t::DONE) {
+            result_ = ESP_ERR_INVALID_ARG;
+        }
+        return result_;
+    }
+
+    const char *key() const
+    {
+        return key_;
+    }
+
+private:
+    enum class state_t : uint8_t {
+        START,
+        FIRST_KEY_OR_END,
+        NEXT_KEY,
+        KEY,
+        COLON,
+        VALUE,
+        STRING_VALUE,
+        LITERAL,
+        AFTER_VALUE,
+        DONE,
+    };
+
+    static bool isSpace(char ch)
+    {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+    }
+
+    static bool isLiteralChar(char ch)
+    {
+        return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || ch == '-' || ch == '+' || ch == '.' || ch == 'E';
+    }
+
+    void fail(esp_err_t error)
+    {
+        result_ = error;
+    }
+
+    void step(char ch)
+    {
+        switch (state_) {
+            case state_t::START:
+                if (ch == '{') {
+                    state_ = state_t::FIRST_KEY_OR_END;
+                } else if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+            case state_t::FIRST_KEY_OR_END:
+            case state_t::NEXT_KEY:
+                if (ch == '"') {
+                    key_len_ = 0;
+                    key_[0] = '\0';
+                    state_ = state_t::KEY;
+                } else if (ch == '}' && state_ == state_t::FIRST_KEY_OR_END) {
+                    state_ = state_t::DONE;
+                } else if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+            case state_t::KEY:
+                if (stringChar(ch, key_, KEY_LEN, &key_len_)) {
+                    state_ = state_t::COLON;
+                }
+                break;
+            case state_t::COLON:
+                if (ch == ':') {
+                    state_ = state_t::VALUE;
+                } else if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+            case state_t::VALUE:
+                value_len_ = 0;
+                value_[0] = '\0';
+                if (ch == '"') {
+                    state_ = state_t::STRING_VALUE;
+                } else if (ch == '{' || ch == '[') {
+                    fail(ESP_ERR_NOT_SUPPORTED);
+                } else if (ch == '-' || (ch >= '0' && ch <= '9') || ch == 't' || ch == 'f' || ch == 'n') {
+                    append(ch, value_, VALUE_LEN, &value_len_);
+                    state_ = state_t::LITERAL;
+                } else if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+            case state_t::STRING_VALUE:
+                if (stringChar(ch, value_, VALUE_LEN, &value_len_)) {
+                    emit(json_value_kind_t::STRING);
+                }
+                break;
+            case state_t::LITERAL:
+                if (isLiteralChar(ch)) {
+                    append(ch, value_, VALUE_LEN, &value_len_);
+                    break;
+                }
+                emitLiteral();
+                if (result_ == ESP_OK) {
+                    step(ch);
+                }
+                break;
+            case state_t::AFTER_VALUE:
+                if (ch == ',') {
+                    state_ = state_t::NEXT_KEY;
+                } else if (ch == '}') {
+                    state_ = state_t::DONE;
+                } else if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+            case state_t::DONE:
+                if (!isSpace(ch)) {
+                    fail(ESP_ERR_INVALID_ARG);
+                }
+                break;
+        }
+    }
+
+    void append(char ch, char *buffer, size_t buffer_len, size_t *len)
+    {
+        if (*len + 1 >= buffer_len) {
+            fail(ESP_ERR_INVALID_SIZE);
+            return;
+        }
+        buffer[(*len)++] = ch;
+        buffer[*len] = '\0';
+    }
+
+    // Znak uvnitr retezce vcetne escapu (\uXXXX se ulozi jako UTF-8). Vraci true na konci retezce.
+    bool stringChar(char ch, char *buffer, size_t buffer_len, size_t *len)
+    {
+        if (escape_ == 1) {
+            escape_ = 0;
+            switch (ch) {
+                case '"': append('"', buffer, buffer_len, len); break;
+                case '\\': append('\\', buffer, buffer_len, len); break;
+                case '/': append('/', buffer, buffer_len, len); break;
+                case 'b': append('\b', buffer, buffer_len, len); break;
+                case 'f': append('\f', buffer, buffer_len, len); break;
+                case 'n': append('\n', buffer, buffer_len, len); break;
+                case 'r': append('\r', buffer, buffer_len, len); break;
+                case 't': append('\t', buffer, buffer_len, len); break;
+                case 'u': escape_ = 2; code_point_ = 0; break;
+                default: fail(ESP_ERR_INVALID_ARG); break;
+            }
+            return false;
+        }
+        if (escape_ >= 2) {
+            const int digit = hexDigit(ch);
+            if (digit < 0) {
+                fail(ESP_ERR_INVALID_ARG);
+                return false;
+            }
+            code_point_ = static_cast<uint16_t>((code_point_ << 4) | static_cast<uint16_t>(digit));
+            if (++escape_ == 6) {
+                escape_ = 0;
+                appendCodePoint(code_point_, buffer, buffer_len, len);
+            }
+            return false;
+        }
+        if (ch == '\\') {
+            escape_ = 1;
+            return false;
+        }
+        if (ch == '"') {
+            return true;
+        }
+        if (static_cast<unsigned char>(ch) < 0x20) {
+            fail(ESP_ERR_INVALID_ARG);
+            return false;
+        }
+        append(ch, buffer, buffer_len, len);
+        return false;
+    }
+
+    static int hexDigit(char ch)
+    {
+        if (ch >= '0' && ch <= '9') {
+            return ch - '0';
+        }
+        if (ch >= 'a' && ch <= 'f') {
+            return 10 + (ch - 'a');
+        }
+        if (ch >= 'A' && ch <= 'F') {
+            return 10 + (ch - 'A');
+        }
+        return -1;
+    }
+
+    // Jen znaky BMP; nulovy znak a samotne surrogate pary se odmitnou.
+    void appendCodePoint(uint16_t code_point, char *buffer, size_t buffer_len, size_t *len)
+    {
+        if (code_point == 0 || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            fail(ESP_ERR_INVALID_ARG);
+        } else if (code_point < 0x80) {
+            append(static_cast<char>(code_point), buffer, buffer_len, len);
+        } else if (code_point < 0x800) {
+            append(static_cast<char>(0xC0 | (code_point >> 6)), buffer, buffer_len, len);
+            append(static_cast<char>(0x80 | (code_point & 0x3F)), buffer, buffer_len, len);
+        } else {
+            append(static_cast<char>(0xE0 | (code_point >> 12)), buffer, buffer_len, len);
+            append(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)), buffer, buffer_len, len);
+            append(static_cast<char>(0x80 | (code_point & 0x3F)), buffer, buffer_len, len);
+        }
+    }
+
+    void emitLiteral()
+    {
+        if (strcmp(value_, "true") == 0 || strcmp(value_, "false") == 0) {
+            emit(json_value_kind_t::BOOLEAN);
+            return;
+        }
+        if (strcmp(value_, "null") == 0) {
+            emit(json_value_kind_t::NULL_VALUE);
+            return;
+        }
+        // Cislo: jen znaky cisla JSON a cele zpracovane strtod.
+        for (size_t index = 0; index < value_len_; ++index) {
+            const char ch = value_[index];
+            if (!((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E')) {
+                fail(ESP_ERR_INVALID_ARG);
+                return;
+            }
+        }
+        char *end = nullptr;
+        (void)strtod(value_, &end);
+        if (end == value_ || *end != '\0') {
+            fail(ESP_ERR_INVALID_ARG);
+            return;
+        }
+        emit(json_value_kind_t::NUMBER);
+    }
+
+    void emit(json_value_kind_t kind)
+    {
+        state_ = state_t::AFTER_VALUE;
+        const esp_err_t result = on_member_(ctx_, key_, kind, value_);
+        if (result != ESP_OK) {
+            fail(result);
+        }
+    }
+
+    member_fn_t on_member_;
+    void *ctx_;
+    state_t state_;
+    esp_err_t result_;
+    char key_[KEY_LEN];
+    char value_[VALUE_LEN];
+    size_t key_len_;
+    size_t value_len_;
+    uint8_t escape_;            // 0 nic, 1 po '\', 2-5 cislice \uXXXX
+    uint16_t code_point_;
+};
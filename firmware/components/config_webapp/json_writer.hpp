@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_err.h"
+
+/**
+ * Streamovany zapis JSON do pevneho bufferu. Plny buffer se preda funkci flush (napr.
+ * httpd_resp_send_chunk), takze velikost dokumentu neomezuje RAM a nic se nealokuje.
+ * Carky mezi prvky a escapovani retezcu resi zapisovac, volajici jen popisuje strukturu.
+ * Po prvni chybe flush se dalsi vystup zahodi a chybu vrati finish().
+ *
+ * Priklad:
+ *   char buffer[512];
+ *   JsonWriter json(buffer, sizeof(buffer), send_chunk, req);
+ *   json.beginObject();
+ *   json.key("uptime_s");
+ *   json.integer(uptime_s);
+ *   json.key("tlak");
+ *   json.beginArray();
+ *   json.number(1.25);
+ *   json.null();
+ *   json.endArray();
+ *   json.endObject();
+ *   esp_err_t result = json.finish();   // {"uptime_s":12,"tlak":[1.25,null]}
+ */
+class JsonWriter
+{
+public:
+    typedef esp_err_t (*flush_fn_t)(void *ctx, const char *data, size_t len);
+
+    JsonWriter(char *buffer, size_t buffer_len, flush_fn_t flush, void *flush_ctx)
+        : buffer_(buffer),
+          buffer_len_(buffer_len),
+          len_(0),
+          flush_(flush),
+          flush_ctx_(flush_ctx),
+          result_(ESP_OK),
+          depth_(0),
+          has_items_(0),
+          after_key_(false)
+    {
+    }
+
+    void beginObject()
+    {
+        open('{');
+    }
+
+    void endObject()
+    {
+        close('}');
+    }
+
+    void beginArray()
+    {
+        open('[');
+    }
+
+    void endArray()
+    {
+        close(']');
+    }
+
+    void key(const char *name)
+    {
+        valuePrefix();
+        writeString(name);
+        put(':');
+        after_key_ = true;
+    }
+
+    void string(const char *value)
+    {
+        valuePrefix();
+        writeString(value != nullptr ? value : "");
+    }
+
+    void integer(int64_t value)
+    {
+        valuePrefix();
+        format("%lld", static_cast<long long>(value));
+    }
+
+    // 7 platnych cislic (presnost float); NaN a nekonecno jako null.
+    void number(double value)
+    {
+        if (!std::isfinite(value)) {
+            null();
+            return;
+        }
+        valuePrefix();
+        format("%.7g", value);
+    }
+
+    void boolean(bool value)
+    {
+        valuePrefix();
+        write(value ? "true" : "false");
+    }
+
+    void null()
+    {
+        valuePrefix();
+        write("null");
+    }
+
+    // Hotova JSON hodnota (napr. payload, ktery modul uz formatuje jako JSON).
+    void raw(const char *json)
+    {
+        valuePrefix();
+        write(json);
+    }
+
+    esp_err_t finish()
+    {
+        flush();
+        return result_;
+    }
+
+    esp_err_t result() const
+    {
+        return result_;
+    }
+
+private:
+    static constexpr uint8_t MAX_DEPTH = 31;
+
+    void open(char bracket)
+    {
+        valuePrefix();
+        put(bracket);
+        if (depth_ < MAX_DEPTH) {
+            ++depth_;
+            has_items_ &= ~(1u << depth_);
+        }
+    }
+
+    void close(char bracket)
+    {
+        if (depth_ > 0) {
+            --depth_;
+        }
+        after_key_ = false;
+        put(bracket);
+    }
+
+    // Carka pred dalsim prvkem pole/objektu; hodnota hned za klicem carku nema.
+    void valuePrefix()
+    {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        const uint32_t bit = 1u << depth_;
+        if (depth_ > 0 && (has_items_ & bit) != 0) {
+            put(',');
+        }
+        has_items_ |= bit;
+    }
+
+    void writeString(const char *text)
+    {
+        put('"');
+        for (; *text != '\0'; ++text) {
+            const unsigned char ch = static_cast<unsigned char>(*text);
+            if (ch == '"' || ch == '\\') {
+                put('\\');
+                put(static_cast<char>(ch));
+            } else if (ch < 0x20) {
+                format("\\u%04x", static_cast<unsigned>(ch));
+            } else {
+                put(static_cast<char>(ch));
+            }
+        }
+        put('"');
+    }
+
+    void format(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char text[32];
+        va_list args;
+        va_start(args, fmt);
+        const int len = vsnprintf(text, sizeof(text), fmt, args);
+        va_end(args);
+        if (len > 0) {
+            write(text, static_cast<size_t>(len) < sizeof(text) ? static_cast<size_t>(len) : sizeof(text) - 1);
+        }
+    }
+
+    void write(const char *text)
+    {
+        write(text, strlen(text));
+    }
+
+    void write(const char *text, size_t len)
+    {
+        while (len > 0 && result_ == ESP_OK) {
+            if (len_ == buffer_len_) {
+                flush();
+                continue;
+            }
+            const size_t free_len = buffer_len_ - len_;
+            const size_t part = len < free_len ? len : free_len;
+            memcpy(buffer_ + len_, text, part);
+            len_ += part;
+            text += part;
+            len -= part;
+        }
+    }
+
+    void put(char ch)
+    {
+        write(&ch, 1);
+    }
+
+    void flush()
+    {
+        if (len_ > 0 && result_ == ESP_OK) {
+            result_ = flush_(flush_ctx_, buffer_, len_);
+        }
+        len_ = 0;
+    }
+
+    char *buffer_;
+    size_t buffer_len_;
+    size_t len_;
+    flush_fn_t flush_;
+    void *flush_ctx_;
+    esp_err_t result_;
+    uint8_t depth_;
+    uint32_t has_items_;    // bit i = uroven i uz ma prvek (pred dalsim carka)
+    bool after_key_;
+};
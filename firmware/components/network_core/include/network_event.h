@@ -22,6 +22,9 @@ typedef struct {
     uint32_t ip_addr;
     uint32_t reconnect_attempts;
     uint32_t reconnect_successes;
+    uint32_t last_connect_ms;       // posledni pripojeni: esp_wifi_connect -> IP (0 = zatim zadne)
+    uint32_t last_mqtt_ready_ms;    // posledni pripojeni: esp_wifi_connect -> MQTT pripojeno
+    bool last_connect_fast;         // posledni pripojeni pres ulozeny kanal/BSSID
 } network_event_t;
 
 system_network_level_t network_event_level(bool ap_mode, bool wifi_up, bool ip_ready, bool mqtt_ready);
@@ -23,6 +23,19 @@ typedef struct {
 
 esp_err_t network_register_event_callback(network_event_callback_t callback, void *ctx);
 
+// Volby STA, nastavuji se pred network_init_sta(). Adresy ve stejnem poradi bajtu jako
+// esp_ip4_addr_t.addr (a ip_addr v network_event_t).
+typedef struct {
+    bool static_ip;                     // pevna IP misto DHCP
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gateway;
+    uint32_t dns;                       // 0 = DNS nenastavovat
+    uint8_t fast_connect_max_failures;  // po tolika neuspesnych pokusech na ulozeny kanal/BSSID plny sken; 0 = vzdy plny sken
+} network_sta_options_t;
+
+esp_err_t network_set_sta_options(const network_sta_options_t *options);
+
 esp_err_t network_init_sta(const char *ssid, const char *password);
 esp_err_t network_init_ap(const char *ap_ssid, const char *ap_password);
 
@@ -32,6 +32,9 @@ network_event_t network_event_make(bool ap_mode,
         .ip_addr = ip_addr,
         .reconnect_attempts = reconnect_attempts,
         .reconnect_successes = reconnect_successes,
+        .last_connect_ms = 0,
+        .last_mqtt_ready_ms = 0,
+        .last_connect_fast = false,
     };
     return event;
 }
@@ -0,0 +1,97 @@
+#include "network_fast_connect.h"
+
+#include <cstring>
+
+#include "nvs.h"
+
+#define FAST_CONNECT_NVS_NAMESPACE "net_fast"
+#define FAST_CONNECT_NVS_KEY "ap"
+#define FAST_CONNECT_VERSION 1
+
+typedef struct {
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t ssid_hash;
+} fast_connect_record_t;
+
+static fast_connect_record_t s_record = {};
+static bool s_record_loaded = false;
+
+static uint32_t ssid_hash(const char *ssid)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *ch = ssid; *ch != '\0'; ++ch) {
+        hash ^= (uint8_t)*ch;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void load_record(void)
+{
+    if (s_record_loaded) {
+        return;
+    }
+    s_record_loaded = true;
+    memset(&s_record, 0, sizeof(s_record));
+
+    nvs_handle_t handle = 0;
+    if (nvs_open(FAST_CONNECT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(s_record);
+    if (nvs_get_blob(handle, FAST_CONNECT_NVS_KEY, &s_record, &len) != ESP_OK || len != sizeof(s_record)
+        || s_record.version != FAST_CONNECT_VERSION) {
+        memset(&s_record, 0, sizeof(s_record));
+    }
+    nvs_close(handle);
+}
+
+bool network_fast_connect_load(const char *ssid, network_fast_connect_ap_t *ap)
+{
+    if (ssid == NULL || ap == NULL) {
+        return false;
+    }
+
+    load_record();
+    if (s_record.version != FAST_CONNECT_VERSION || s_record.channel == 0 || s_record.ssid_hash != ssid_hash(ssid)) {
+        return false;
+    }
+
+    ap->channel = s_record.channel;
+    memcpy(ap->bssid, s_record.bssid, sizeof(ap->bssid));
+    return true;
+}
+
+esp_err_t network_fast_connect_store(const char *ssid, const network_fast_connect_ap_t *ap)
+{
+    if (ssid == NULL || ap == NULL || ap->channel == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    load_record();
+    fast_connect_record_t record = {};
+    record.version = FAST_CONNECT_VERSION;
+    record.channel = ap->channel;
+    memcpy(record.bssid, ap->bssid, sizeof(record.bssid));
+    record.ssid_hash = ssid_hash(ssid);
+    if (memcmp(&record, &s_record, sizeof(record)) == 0) {
+        return ESP_OK;
+    }
+
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(FAST_CONNECT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+    result = nvs_set_blob(handle, FAST_CONNECT_NVS_KEY, &record, sizeof(record));
+    if (result == ESP_OK) {
+        result = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    if (result == ESP_OK) {
+        s_record = record;
+    }
+    return result;
+}
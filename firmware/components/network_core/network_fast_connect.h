@@ -0,0 +1,21 @@
+#ifndef NETWORK_FAST_CONNECT_H
+#define NETWORK_FAST_CONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Posledni AP, ke kteremu se STA uspesne pripojila (kanal + BSSID). Ulozene v NVS a vazane
+// na SSID, takze po zmene site se nepouzije. Dalsi pripojeni pak skenuje jen jeden kanal.
+typedef struct {
+    uint8_t channel;
+    uint8_t bssid[6];
+} network_fast_connect_ap_t;
+
+// Nacte AP pro dane SSID; false, pokud zadne ulozene neni.
+bool network_fast_connect_load(const char *ssid, network_fast_connect_ap_t *ap);
+// Ulozi AP; do NVS se zapisuje jen pri zmene (roaming, zmena kanalu).
+esp_err_t network_fast_connect_store(const char *ssid, const network_fast_connect_ap_t *ap);
+
+#endif // NETWORK_FAST_CONNECT_H
@@ -12,12 +12,14 @@
 
 #include "network_ap_mode.h"
 #include "network_mqtt_config.h"
+#include "network_fast_connect.h"
 #include "network_event.h"
 #include "app_error_check.h"
 
 #define WIFI_RECONNECT_DELAY_MIN_MS 1000
 #define WIFI_RECONNECT_DELAY_MAX_MS 60000
 #define NETWORK_EVENT_IDLE_PUBLISH_MS 10000
+#define WIFI_FAST_CONNECT_DEFAULT_MAX_FAILURES 3
 
 #define MQTT_LWT_TOPIC_MAX_LEN 128
 #define MQTT_LWT_MESSAGE_MAX_LEN 64
@@ -39,6 +41,30 @@ static bool s_wifi_up = false;
 static bool s_ip_ready = false;
 static uint32_t s_ip_addr = 0;
 
+static network_sta_options_t s_sta_options = {
+    .static_ip = false,
+    .ip = 0,
+    .netmask = 0,
+    .gateway = 0,
+    .dns = 0,
+    .fast_connect_max_failures = WIFI_FAST_CONNECT_DEFAULT_MAX_FAILURES,
+};
+static char s_sta_ssid[33] = {0};
+static char s_sta_password[65] = {0};
+// Rychle pripojeni: ulozeny kanal/BSSID posledniho AP; po fast_connect_max_failures
+// neuspesnych pokusech se vraci plny sken, dokud se zarizeni znovu nepripoji.
+static network_fast_connect_ap_t s_fast_ap = {};
+static bool s_fast_ap_valid = false;
+static bool s_fast_config_applied = false;
+static uint32_t s_fast_connect_failures = 0;
+// Mereni doby pripojeni od volani esp_wifi_connect.
+static int64_t s_connect_started_us = 0;
+static bool s_connect_attempt_active = false;
+static bool s_mqtt_ready_pending = false;
+static uint32_t s_last_connect_ms = 0;
+static uint32_t s_last_mqtt_ready_ms = 0;
+static bool s_last_connect_fast = false;
+
 static esp_mqtt_client_handle_t s_mqtt_client = NULL;
 static bool s_mqtt_connected = false;
 static bool s_mqtt_start_requested = false;
@@ -148,6 +174,45 @@ static void log_network_level_transition(const network_event_t &event)
 
 static void schedule_wifi_reconnect(void);
 
+static bool fast_connect_enabled(void)
+{
+    return s_fast_ap_valid
+        && s_sta_options.fast_connect_max_failures > 0
+        && s_fast_connect_failures < s_sta_options.fast_connect_max_failures;
+}
+
+static esp_err_t apply_sta_config(void)
+{
+    wifi_config_t wifi_config = {};
+    strncpy((char *)wifi_config.sta.ssid, s_sta_ssid, sizeof(wifi_config.sta.ssid) - 1);
+    strncpy((char *)wifi_config.sta.password, s_sta_password, sizeof(wifi_config.sta.password) - 1);
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    wifi_config.sta.pmf_cfg.capable = true;
+    wifi_config.sta.pmf_cfg.required = false;
+
+    const bool fast = fast_connect_enabled();
+    if (fast) {
+        // Se zadanym kanalem driver skenuje jen ten kanal; BSSID preskoci vyber AP.
+        wifi_config.sta.channel = s_fast_ap.channel;
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, s_fast_ap.bssid, sizeof(wifi_config.sta.bssid));
+    }
+
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (ret == ESP_OK) {
+        s_fast_config_applied = fast;
+    }
+    return ret;
+}
+
+static void start_wifi_connect(void)
+{
+    s_connect_started_us = esp_timer_get_time();
+    s_connect_attempt_active = true;
+    s_mqtt_ready_pending = false;
+    esp_wifi_connect();
+}
+
 static void wifi_reconnect_cb(void *arg)
 {
     (void)arg;
@@ -156,8 +221,47 @@ static void wifi_reconnect_cb(void *arg)
     }
     s_wifi_reconnect_attempts++;
     s_wifi_reconnect_pending = true;
-    ESP_LOGW(TAG, "WiFi odpojeno, zkousim reconnect (backoff=%lu ms)", (unsigned long)s_wifi_reconnect_delay_ms);
-    esp_wifi_connect();
+    if (fast_connect_enabled() != s_fast_config_applied) {
+        esp_err_t ret = apply_sta_config();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Zmena WiFi STA konfigurace selhala: %s", esp_err_to_name(ret));
+        }
+    }
+    ESP_LOGW(TAG,
+             "WiFi odpojeno, zkousim reconnect (backoff=%lu ms, %s)",
+             (unsigned long)s_wifi_reconnect_delay_ms,
+             s_fast_config_applied ? "ulozeny kanal" : "plny sken");
+    start_wifi_connect();
+}
+
+// Po ziskani IP: doba pripojeni a ulozeni kanalu/BSSID pro dalsi rychle pripojeni.
+static void on_sta_connected_with_ip(const wifi_ap_record_t *ap_info)
+{
+    if (s_connect_attempt_active) {
+        s_last_connect_ms = (uint32_t)((esp_timer_get_time() - s_connect_started_us) / 1000);
+        s_last_connect_fast = s_fast_config_applied;
+        s_connect_attempt_active = false;
+        s_mqtt_ready_pending = true;
+        ESP_LOGI(TAG,
+                 "WiFi pripojeni trvalo %lu ms (%s%s)",
+                 (unsigned long)s_last_connect_ms,
+                 s_last_connect_fast ? "ulozeny kanal" : "plny sken",
+                 s_sta_options.static_ip ? ", pevna IP" : "");
+    }
+    s_fast_connect_failures = 0;
+
+    if (ap_info == nullptr || ap_info->primary == 0) {
+        return;
+    }
+    network_fast_connect_ap_t ap = {};
+    ap.channel = ap_info->primary;
+    memcpy(ap.bssid, ap_info->bssid, sizeof(ap.bssid));
+    esp_err_t ret = network_fast_connect_store(s_sta_ssid, &ap);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Ulozeni kanalu/BSSID AP selhalo: %s", esp_err_to_name(ret));
+    }
+    s_fast_ap = ap;
+    s_fast_ap_valid = true;
 }
 
 static void schedule_wifi_reconnect(void)
@@ -244,6 +348,9 @@ static void publish_network_event(void)
                                                s_ip_addr,
                                                s_wifi_reconnect_attempts,
                                                s_wifi_reconnect_successes);
+    event.last_connect_ms = s_last_connect_ms;
+    event.last_mqtt_ready_ms = s_last_mqtt_ready_ms;
+    event.last_connect_fast = s_last_connect_fast;
 
     log_network_level_transition(event);
 
@@ -381,8 +488,8 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         s_ip_ready = false;
         s_ip_addr = 0;
         s_last_rssi = INT8_MIN;
-        esp_wifi_connect();
-        ESP_LOGI(TAG, "WiFi spusteno, probiha pripojeni...");
+        start_wifi_connect();
+        ESP_LOGI(TAG, "WiFi spusteno, probiha pripojeni (%s)...", s_fast_config_applied ? "ulozeny kanal" : "plny sken");
         publish_network_event();
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
         ESP_LOGI(TAG, "WiFi pripojeno na AP, cekam na IP");
@@ -405,6 +512,15 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         s_ip_ready = false;
         s_ip_addr = 0;
         s_last_rssi = (disc != nullptr) ? disc->rssi : INT8_MIN;
+        if (s_connect_attempt_active && s_fast_config_applied) {
+            s_fast_connect_failures++;
+            if (!fast_connect_enabled()) {
+                ESP_LOGW(TAG,
+                         "Pripojeni na ulozeny kanal %u selhalo %lu x, dalsi pokus s plnym skenem",
+                         (unsigned)s_fast_ap.channel,
+                         (unsigned long)s_fast_connect_failures);
+            }
+        }
         schedule_wifi_reconnect();
         publish_network_event();
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
@@ -414,9 +530,11 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         s_ip_ready = true;
         s_ip_addr = event->ip_info.ip.addr;
         wifi_ap_record_t ap_info = {};
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        const bool ap_info_ok = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+        if (ap_info_ok) {
             s_last_rssi = ap_info.rssi;
         }
+        on_sta_connected_with_ip(ap_info_ok ? &ap_info : nullptr);
         if (s_wifi_reconnect_pending) {
             s_wifi_reconnect_successes++;
             s_wifi_reconnect_pending = false;
@@ -430,6 +548,10 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         if (mqtt_start_ret != ESP_OK) {
             ESP_LOGW(TAG, "Odlozeny start MQTT selhal: %s", esp_err_to_name(mqtt_start_ret));
         }
+        if (s_mqtt_client != NULL && !s_mqtt_connected) {
+            // Klient ceka na svuj reconnect timeout (az 10 s); s novou IP to neni potreba.
+            (void)esp_mqtt_client_reconnect(s_mqtt_client);
+        }
 
         publish_network_event();
         schedule_retry_publish();
@@ -447,7 +569,13 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
                 publish_network_event();
                 break;
             }
-            ESP_LOGI(TAG, "MQTT pripojeno");
+            if (s_mqtt_ready_pending) {
+                s_last_mqtt_ready_ms = (uint32_t)((esp_timer_get_time() - s_connect_started_us) / 1000);
+                s_mqtt_ready_pending = false;
+                ESP_LOGI(TAG, "MQTT pripojeno (%lu ms od startu WiFi pripojeni)", (unsigned long)s_last_mqtt_ready_ms);
+            } else {
+                ESP_LOGI(TAG, "MQTT pripojeno");
+            }
             s_mqtt_connected = true;
             publish_network_event();
             break;
@@ -485,6 +613,59 @@ esp_err_t network_register_event_callback(network_event_callback_t callback, voi
     return ESP_OK;
 }
 
+esp_err_t network_set_sta_options(const network_sta_options_t *options)
+{
+    if (options == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (options->static_ip && (options->ip == 0 || options->netmask == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_sta_options = *options;
+    return ESP_OK;
+}
+
+static void apply_static_ip(esp_netif_t *sta_netif)
+{
+    if (!s_sta_options.static_ip || sta_netif == NULL) {
+        return;
+    }
+
+    esp_err_t ret = esp_netif_dhcpc_stop(sta_netif);
+    if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        ESP_LOGW(TAG, "Nelze zastavit DHCP klienta, zustava DHCP: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    esp_netif_ip_info_t ip_info = {};
+    ip_info.ip.addr = s_sta_options.ip;
+    ip_info.netmask.addr = s_sta_options.netmask;
+    ip_info.gw.addr = s_sta_options.gateway;
+    ret = esp_netif_set_ip_info(sta_netif, &ip_info);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Nastaveni pevne IP selhalo, zustava DHCP: %s", esp_err_to_name(ret));
+        (void)esp_netif_dhcpc_start(sta_netif);
+        return;
+    }
+
+    if (s_sta_options.dns != 0) {
+        esp_netif_dns_info_t dns_info = {};
+        dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+        dns_info.ip.u_addr.ip4.addr = s_sta_options.dns;
+        ret = esp_netif_set_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns_info);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Nastaveni DNS selhalo: %s", esp_err_to_name(ret));
+        }
+    }
+
+    ESP_LOGI(TAG,
+             "WiFi STA pevna IP: " IPSTR " maska " IPSTR " brana " IPSTR,
+             IP2STR(&ip_info.ip),
+             IP2STR(&ip_info.netmask),
+             IP2STR(&ip_info.gw));
+}
+
 esp_err_t network_init_sta(const char *ssid, const char *password)
 {
     if (ssid == NULL || password == NULL || strlen(ssid) == 0) {
@@ -493,7 +674,8 @@ esp_err_t network_init_sta(const char *ssid, const char *password)
 
     network_platform_init();
 
-    esp_netif_create_default_wifi_sta();
+    esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta();
+    apply_static_ip(sta_netif);
 
     if (!s_sta_handlers_registered) {
         esp_event_handler_instance_t instance_any_id;
@@ -511,21 +693,20 @@ esp_err_t network_init_sta(const char *ssid, const char *password)
         s_sta_handlers_registered = true;
     }
 
-    wifi_config_t wifi_config = {};
-    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
-    strncpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-    wifi_config.sta.pmf_cfg.capable = true;
-    wifi_config.sta.pmf_cfg.required = false;
+    strncpy(s_sta_ssid, ssid, sizeof(s_sta_ssid) - 1);
+    s_sta_ssid[sizeof(s_sta_ssid) - 1] = '\0';
+    strncpy(s_sta_password, password, sizeof(s_sta_password) - 1);
+    s_sta_password[sizeof(s_sta_password) - 1] = '\0';
+    s_fast_ap_valid = network_fast_connect_load(s_sta_ssid, &s_fast_ap);
+    s_fast_connect_failures = 0;
 
     ESP_LOGI(TAG,
-             "WiFi STA cfg: ssid='%s' auth>=WPA2 pmf_capable=%d pmf_required=%d",
+             "WiFi STA cfg: ssid='%s' auth>=WPA2 pmf_capable=1 pmf_required=0 ulozeny_kanal=%u",
              ssid,
-             wifi_config.sta.pmf_cfg.capable ? 1 : 0,
-             wifi_config.sta.pmf_cfg.required ? 1 : 0);
+             s_fast_ap_valid ? (unsigned)s_fast_ap.channel : 0U);
 
     APP_ERROR_CHECK("E211", esp_wifi_set_mode(WIFI_MODE_STA));
-    APP_ERROR_CHECK("E212", esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    APP_ERROR_CHECK("E212", apply_sta_config());
     APP_ERROR_CHECK("E213", esp_wifi_start());
 
     s_ap_mode_active = false;
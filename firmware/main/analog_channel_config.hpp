@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "analog_fault_detector.hpp"
+
+// Mez RAW, detekce poruch a heartbeat eventu analogovych kanalu (tlak.cpp, zasoba.cpp).
+// Bez zavislosti na ESP-IDF, stejne hodnoty pouziva prehrani zaznamu v tools/trace_common.hpp.
+
+// Bez zmeny zaokrouhlenych tlaku se event posila jen jako heartbeat.
+static constexpr int64_t PRESSURE_EVENT_HEARTBEAT_US = 30LL * 1000LL * 1000LL;
+static constexpr int32_t PRESSURE_RAW_SANITY_MIN = 0;
+static constexpr int32_t PRESSURE_RAW_SANITY_MAX = 4095;
+static constexpr int32_t PRESSURE_RAW_SANITY_MIN_MARGIN = 80;
+
+// Detekce poruch smycky (vzorek po 100 ms): skok > ~1.2 bar za vzorek je u vodovodu nefyzikalni,
+// zamrzly RAW 60 s, sum > 40 LSB smerodatne odchylky, mekke poruchy potvrzene 5 s.
+static constexpr AnalogFaultDetector::Config PRESSURE_FAULT_DETECTOR_CONFIG = {
+    .open_below = PRESSURE_RAW_SANITY_MIN + PRESSURE_RAW_SANITY_MIN_MARGIN,
+    .short_above = PRESSURE_RAW_SANITY_MAX - PRESSURE_RAW_SANITY_MIN_MARGIN,
+    .max_step = 400,
+    .noise_stddev_max = 40.0f,
+    .variance_alpha = 0.05f,
+    .stuck_samples = 600,
+    .confirm_samples = 50,
+};
+
+// Bez zmeny objemu/hladiny se event posila jen jako heartbeat (vzorkuje se dal plnou rychlosti).
+static constexpr int64_t LEVEL_EVENT_HEARTBEAT_US = 30LL * 1000LL * 1000LL;
+static constexpr uint32_t LEVEL_RAW_SANITY_MIN = 0;
+static constexpr uint32_t LEVEL_RAW_SANITY_MAX = 4095;
+static constexpr uint32_t LEVEL_RAW_SANITY_MIN_MARGIN = 80;
+
+// Detekce poruch smycky (vzorek po 20 ms): hladina se meni pomalu, skok > 150 LSB (~9 cm)
+// za vzorek je porucha, zamrzly RAW 60 s, sum > 40 LSB smerodatne odchylky, potvrzeni 5 s.
+static constexpr AnalogFaultDetector::Config LEVEL_FAULT_DETECTOR_CONFIG = {
+    .open_below = LEVEL_RAW_SANITY_MIN + LEVEL_RAW_SANITY_MIN_MARGIN,
+    .short_above = LEVEL_RAW_SANITY_MAX - LEVEL_RAW_SANITY_MIN_MARGIN,
+    .max_step = 150,
+    .noise_stddev_max = 40.0f,
+    .variance_alpha = 0.02f,
+    .stuck_samples = 3000,
+    .confirm_samples = 250,
+};
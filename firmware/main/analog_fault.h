@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Diagnosticky stav analogoveho 4-20 mA kanalu (tlak pred/za, hladina).
+// Poradi je zaroven priorita: pri vice soucasnych poruchach se hlasi ta s nizsim cislem.
+typedef enum {
+    ANALOG_FAULT_NONE = 0,
+    ANALOG_FAULT_OPEN_LOOP,   // proud pod 4 mA - prerusena smycka / odpojene cidlo
+    ANALOG_FAULT_SHORT_LOOP,  // proud nad 20 mA - zkrat smycky
+    ANALOG_FAULT_STUCK,       // RAW se dlouho nezmenil ani o 1 LSB - zamrzly prevodnik/cidlo
+    ANALOG_FAULT_RATE,        // opakovane skoky nad fyzikalne mozny gradient
+    ANALOG_FAULT_NOISY,       // klouzavy rozptyl nad limitem
+    ANALOG_FAULT_COUNT,
+} analog_fault_t;
+
+static inline const char *analog_fault_to_string(analog_fault_t fault)
+{
+    switch (fault) {
+        case ANALOG_FAULT_NONE: return "ok";
+        case ANALOG_FAULT_OPEN_LOOP: return "open";
+        case ANALOG_FAULT_SHORT_LOOP: return "short";
+        case ANALOG_FAULT_STUCK: return "stuck";
+        case ANALOG_FAULT_RATE: return "rate";
+        case ANALOG_FAULT_NOISY: return "noisy";
+        default: return "unknown";
+    }
+}
+
+// Porucha, pri ktere nelze hodnote verit (publikuje se NaN).
+static inline bool analog_fault_is_hard(analog_fault_t fault)
+{
+    return fault == ANALOG_FAULT_OPEN_LOOP || fault == ANALOG_FAULT_SHORT_LOOP || fault == ANALOG_FAULT_STUCK;
+}
+
+#ifdef __cplusplus
+}
+#endif
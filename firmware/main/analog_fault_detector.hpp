@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+
+#include "analog_fault.h"
+
+/**
+ * Prubezna detekce poruch analogoveho 4-20 mA kanalu nad surovymi ADC vzorky.
+ * Bezi ve stejnem pruchodu jako TrimmedMean, pamet i cas na vzorek jsou konstantni:
+ * - otevrena/zkratovana smycka: RAW mimo [open_below, short_above], hlasi se okamzite,
+ * - zamrzla hodnota: RAW beze zmeny stuck_samples vzorku za sebou (zivy prevodnik sumi o par LSB),
+ * - gradient: skok |RAW - predchozi| > max_step se pocita do derave nadoby (+SPIKE_WEIGHT, -1 za klidny vzorek),
+ * - sum: exponencialne vazeny rozptyl RAW nad noise_stddev_max^2.
+ * Mekke poruchy (gradient, sum) musi trvat confirm_samples vzorku, nez se nahlasi, a stejne dlouho
+ * musi byt pryc, nez se zrusi; prechodovy dej po zapnuti cerpadla tak poruchu nevyvola.
+ *
+ * Priklad:
+ *   AnalogFaultDetector detector(config);
+ *   const analog_fault_t fault = detector.process(raw_value);
+ */
+class AnalogFaultDetector {
+public:
+    struct Config {
+        uint32_t open_below;
+        uint32_t short_above;
+        uint32_t max_step;
+        float noise_stddev_max;
+        float variance_alpha;
+        uint16_t stuck_samples;
+        uint16_t confirm_samples;
+    };
+
+    explicit AnalogFaultDetector(const Config &config)
+        : config_(config),
+          noise_variance_max_(config.noise_stddev_max * config.noise_stddev_max),
+          mean_(0.0f),
+          variance_(0.0f),
+          previous_raw_(0),
+          same_count_(0),
+          spike_score_(0),
+          soft_candidate_(ANALOG_FAULT_NONE),
+          soft_count_(0),
+          soft_fault_(ANALOG_FAULT_NONE),
+          fault_(ANALOG_FAULT_NONE),
+          initialized_(false)
+    {
+    }
+
+    analog_fault_t process(uint32_t raw)
+    {
+        if (!initialized_) {
+            mean_ = (float)raw;
+            previous_raw_ = raw;
+            initialized_ = true;
+        }
+
+        const uint32_t step = raw > previous_raw_ ? raw - previous_raw_ : previous_raw_ - raw;
+        previous_raw_ = raw;
+
+        // zamrzla hodnota
+        if (step == 0) {
+            if (same_count_ < UINT16_MAX) {
+                same_count_ += 1;
+            }
+        } else {
+            same_count_ = 0;
+        }
+
+        // gradient: derava nadoba
+        if (step > config_.max_step) {
+            spike_score_ = (spike_score_ > SPIKE_SCORE_MAX - SPIKE_WEIGHT) ? SPIKE_SCORE_MAX : spike_score_ + SPIKE_WEIGHT;
+        } else if (spike_score_ > 0) {
+            spike_score_ -= 1;
+        }
+
+        // exponencialne vazeny prumer a rozptyl (West 1979)
+        const float diff = (float)raw - mean_;
+        const float increment = config_.variance_alpha * diff;
+        mean_ += increment;
+        variance_ = (1.0f - config_.variance_alpha) * (variance_ + diff * increment);
+
+        update_soft_fault();
+
+        if (raw < config_.open_below) {
+            fault_ = ANALOG_FAULT_OPEN_LOOP;
+        } else if (raw > config_.short_above) {
+            fault_ = ANALOG_FAULT_SHORT_LOOP;
+        } else if (config_.stuck_samples > 0 && same_count_ >= config_.stuck_samples) {
+            fault_ = ANALOG_FAULT_STUCK;
+        } else {
+            fault_ = soft_fault_;
+        }
+        return fault_;
+    }
+
+    analog_fault_t fault() const
+    {
+        return fault_;
+    }
+
+    float variance() const
+    {
+        return variance_;
+    }
+
+    uint8_t spike_score() const
+    {
+        return spike_score_;
+    }
+
+    uint16_t same_count() const
+    {
+        return same_count_;
+    }
+
+private:
+    static constexpr uint8_t SPIKE_WEIGHT = 8;
+    static constexpr uint8_t SPIKE_SCORE_MAX = 255;
+    static constexpr uint8_t SPIKE_SCORE_ON = 64;   // ~8 skoku v kratke dobe
+    static constexpr uint8_t SPIKE_SCORE_OFF = 16;
+
+    void update_soft_fault()
+    {
+        analog_fault_t candidate = ANALOG_FAULT_NONE;
+        const bool rate_active = (soft_fault_ == ANALOG_FAULT_RATE) ? spike_score_ >= SPIKE_SCORE_OFF
+                                                                    : spike_score_ >= SPIKE_SCORE_ON;
+        const bool noise_active = (soft_fault_ == ANALOG_FAULT_NOISY) ? variance_ > noise_variance_max_ * 0.25f
+                                                                      : variance_ > noise_variance_max_;
+        if (rate_active) {
+            candidate = ANALOG_FAULT_RATE;
+        } else if (noise_variance_max_ > 0.0f && noise_active) {
+            candidate = ANALOG_FAULT_NOISY;
+        }
+
+        if (candidate == soft_fault_) {
+            soft_candidate_ = candidate;
+            soft_count_ = 0;
+            return;
+        }
+
+        if (candidate != soft_candidate_) {
+            soft_candidate_ = candidate;
+            soft_count_ = 0;
+        }
+        if (++soft_count_ >= config_.confirm_samples) {
+            soft_fault_ = candidate;
+            soft_count_ = 0;
+        }
+    }
+
+    Config config_;
+    float noise_variance_max_;
+    float mean_;
+    float variance_;
+    uint32_t previous_raw_;
+    uint16_t same_count_;
+    uint8_t spike_score_;
+    analog_fault_t soft_candidate_;
+    uint16_t soft_count_;
+    analog_fault_t soft_fault_;
+    analog_fault_t fault_;
+    bool initialized_;
+};
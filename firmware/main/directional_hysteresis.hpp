@@ -1,13 +1,17 @@
 #pragma once
 
-class DirectionalHysteresis {
+#include <cstdint>
+
+// Hystereze se smerovou pameti; T je float nebo int32_t pro Q16.16 (viz fixed_point.hpp).
+template<typename T>
+class BasicDirectionalHysteresis {
 public:
-    explicit DirectionalHysteresis(float hysteresis)
-        : hysteresis_(hysteresis), value_(0.0f), direction_(0), initialized_(false)
+    explicit BasicDirectionalHysteresis(T hysteresis)
+        : hysteresis_(hysteresis), value_(T(0)), direction_(0), initialized_(false)
     {
     }
 
-    float process(float input)
+    T process(T input)
     {
         if (!initialized_) {
             value_ = input;
@@ -15,18 +19,18 @@ public:
             return value_;
         }
 
-        if (hysteresis_ <= 0.0f) {
+        if (hysteresis_ <= T(0)) {
             value_ = input;
             direction_ = 0;
             return value_;
         }
 
-        const float delta = input - value_;
-        if (delta == 0.0f) {
+        const T delta = input - value_;
+        if (delta == T(0)) {
             return value_;
         }
 
-        if (delta > 0.0f) {
+        if (delta > T(0)) {
             if (direction_ < 0 && delta < hysteresis_) {
                 return value_;
             }
@@ -48,9 +52,18 @@ public:
         return direction_;
     }
 
+    // Nove pasmo; drzena hodnota a smer zustanou (zmena konfigurace za behu).
+    void setHysteresis(T hysteresis)
+    {
+        hysteresis_ = hysteresis;
+    }
+
 private:
-    float hysteresis_;
-    float value_;
+    T hysteresis_;
+    T value_;
     int direction_; // -1 = klesani, 0 = nezavazne, 1 = stoupani
     bool initialized_;
 };
+
+typedef BasicDirectionalHysteresis<float> DirectionalHysteresis;
+typedef BasicDirectionalHysteresis<int32_t> DirectionalHysteresisQ16;
@@ -22,6 +22,7 @@ extern "C" {
 #include "config_store.h"
 #include "app_error_check.h"
 #include "pins.h"
+#include "sensor_events.h"
 
 #define TAG "elektromer"
 
@@ -126,6 +127,10 @@ static constexpr bool KWS_ENERGY_HIGH_WORD_FIRST = false;
 
 static constexpr float PUMP_RUNNING_POWER_THRESHOLD_W = 5.0f;
 
+// Odecty jdou do state_manageru pri zmene stavu cerpadla, jinak nejvyse jednou za periodu.
+static constexpr int64_t METER_EVENT_RUNNING_PERIOD_US = 2LL * 1000LL * 1000LL;
+static constexpr int64_t METER_EVENT_IDLE_PERIOD_US = 10LL * 1000LL * 1000LL;
+
 enum class pump_state_t : uint8_t {
     STOPPED = 0,     // elektroměr odpověděl, výkon je nulový
     RUNNING = 1,     // elektroměr odpověděl, výkon je nenulový
@@ -322,8 +327,9 @@ static meter_values_t read_meter_values_with_retry(int32_t slave_addr, const met
     return values;
 }
 
-static pump_state_t check_pump_state(int32_t slave_addr, const meter_register_map_t &map)
+static pump_state_t check_pump_state(int32_t slave_addr, const meter_register_map_t &map, float *power_out)
 {
+    *power_out = float_nan();
     if (!binding_enabled(map.power)) {
         return pump_state_t::METER_ERROR;
     }
@@ -339,6 +345,7 @@ static pump_state_t check_pump_state(int32_t slave_addr, const meter_register_ma
     if (!ok || std::isnan(power_w)) {
         return pump_state_t::METER_ERROR;
     }
+    *power_out = power_w;
     return (power_w >= PUMP_RUNNING_POWER_THRESHOLD_W) ? pump_state_t::RUNNING : pump_state_t::STOPPED;
 }
 
@@ -925,31 +932,96 @@ static esp_err_t init_uart(void)
     return ESP_OK;
 }
 
+static void publish_power_event(pump_state_t pump, const meter_values_t &values)
+{
+    sensor_pump_state_t state = SENSOR_PUMP_METER_ERROR;
+    if (pump == pump_state_t::RUNNING) {
+        state = SENSOR_PUMP_RUNNING;
+    } else if (pump == pump_state_t::STOPPED) {
+        state = SENSOR_PUMP_STOPPED;
+    }
+
+    app_event_t event = {
+        .event_type = EVT_SENSOR,
+        .timestamp_us = esp_timer_get_time(),
+        .data = {
+            .sensor = {
+                .sensor_type = SENSOR_EVENT_POWER,
+                .data = {
+                    .power = {
+                        .stav = state,
+                        .vykon_w = values.power_w,
+                        .jalovy_vykon_var = values.reactive_power_var,
+                        .cosfi = values.power_factor,
+                        .proud_a = values.current_a,
+                        .napeti_v = values.voltage_v,
+                        .energie_wh = values.energy_total_wh,
+                        .energie_jalova_varh = values.energy_aux_wh,
+                    },
+                },
+            },
+        },
+    };
+    (void)sensor_events_publish(&event, pdMS_TO_TICKS(20));
+}
+
 static void kws_task(void *pvParameters)
 {
     (void)pvParameters;
 
     TickType_t last_full_read_ticks = 0;
+    pump_state_t last_published_pump = pump_state_t::METER_ERROR;
+    int64_t last_published_us = 0;
 
     while (true) {
         const TickType_t loop_start = xTaskGetTickCount();
 
 
-        const pump_state_t pump = check_pump_state(KWS_HARDCODED_SLAVE_ADDR, KWS_METER_MAP);
-        ESP_LOGI(TAG, "Pump state: %s", (pump == pump_state_t::RUNNING) ? "RUNNING" : ((pump == pump_state_t::STOPPED) ? "STOPPED" : "METER_ERROR"));
+        float power_w = float_nan();
+        const pump_state_t pump = check_pump_state(KWS_HARDCODED_SLAVE_ADDR, KWS_METER_MAP, &power_w);
+        ESP_LOGD(TAG, "Pump state: %s", (pump == pump_state_t::RUNNING) ? "RUNNING" : ((pump == pump_state_t::STOPPED) ? "STOPPED" : "METER_ERROR"));
         vTaskDelay(pdMS_TO_TICKS(100));
 
+        const int64_t now_us = esp_timer_get_time();
+        const int64_t event_period_us = (pump == pump_state_t::RUNNING) ? METER_EVENT_RUNNING_PERIOD_US
+                                                                        : METER_EVENT_IDLE_PERIOD_US;
+        const bool publish_due = (pump != last_published_pump) || (now_us - last_published_us) >= event_period_us;
+
         if (pump == pump_state_t::RUNNING) {
             {
                 meter_values_t values = read_meter_values_with_retry(KWS_HARDCODED_SLAVE_ADDR, KWS_METER_MAP);
                 log_meter_values_fixed(KWS_HARDCODED_SLAVE_ADDR, KWS_METER_MAP, values);
+                if (std::isnan(values.power_w)) {
+                    values.power_w = power_w;
+                }
+                if (publish_due) {
+                    publish_power_event(pump, values);
+                }
             }
             // {
             //     meter_values_t values = read_meter_values_with_retry(TAC_HARDCODED_SLAVE_ADDR, TAC_METER_MAP);
             //     log_meter_values_fixed(TAC_HARDCODED_SLAVE_ADDR, TAC_METER_MAP, values);
             // }
+        } else if (publish_due) {
+            meter_values_t values = {
+                .voltage_v = float_nan(),
+                .current_a = float_nan(),
+                .power_w = power_w,
+                .reactive_power_var = float_nan(),
+                .apparent_power_va = float_nan(),
+                .frequency_hz = float_nan(),
+                .power_factor = float_nan(),
+                .phase_angle_deg = float_nan(),
+                .energy_total_wh = float_nan(),
+                .energy_aux_wh = float_nan(),
+            };
+            publish_power_event(pump, values);
         }
 
+        if (publish_due) {
+            last_published_pump = pump;
+            last_published_us = now_us;
+        }
     }
 }
 
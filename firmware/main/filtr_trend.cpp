@@ -0,0 +1,301 @@
+#include "filtr_trend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include "nvs.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <atomic>
+#include <cmath>
+
+#include "config_store.h"
+#include "debug_mqtt.h"
+#include "app_error_check.h"
+
+#define TAG "filtr_trend"
+
+namespace {
+
+static constexpr float TREND_DEFAULT_Q_REF_L_MIN = 20.0f;
+static constexpr float TREND_DEFAULT_Q_MIN_L_MIN = 2.0f;
+static constexpr float TREND_DEFAULT_HALF_LIFE_DAYS = 30.0f;
+
+// Nabeh tlaku po zapnuti cerpadla se do prumeru relace nepocita.
+static constexpr int64_t TREND_SESSION_SETTLE_US = 15LL * 1000LL * 1000LL;
+static constexpr int64_t TREND_SESSION_MIN_US = 30LL * 1000LL * 1000LL;
+static constexpr uint32_t TREND_MIN_SESSIONS = 3;
+static constexpr double TREND_MIN_T_STDDEV_DAYS = 0.25;
+static constexpr double TREND_MIN_SLOPE_BAR_PER_DAY = 1e-6;
+static constexpr double US_PER_DAY = 86400.0 * 1e6;
+
+static const char *TREND_NVS_NAMESPACE = "filtr_trend";
+static const char *TREND_NVS_KEY = "state";
+static constexpr uint32_t TREND_STATE_VERSION = 1;
+
+static const config_item_t TREND_Q_REF_ITEM = {
+    .key = "flt_q_ref", .label = "Prutok pro tlk_dp_100 [l/min]", .description = "Prutok, pri kterem tlk_dp_100 znamena 100% zaneseni; na nej se prepocitava dP pro trend.",
+    .type = CONFIG_VALUE_FLOAT, .default_string = nullptr, .default_int = 0, .default_float = TREND_DEFAULT_Q_REF_L_MIN, .default_bool = false,
+    .max_string_len = 0, .min_int = 0, .max_int = 0, .min_float = 1.0f, .max_float = 200.0f,
+};
+static const config_item_t TREND_Q_MIN_ITEM = {
+    .key = "flt_q_min", .label = "Min. prutok pro trend [l/min]", .description = "Nad timto prutokem se bere cerpadlo jako bezici a dP se zapocitava do trendu.",
+    .type = CONFIG_VALUE_FLOAT, .default_string = nullptr, .default_int = 0, .default_float = TREND_DEFAULT_Q_MIN_L_MIN, .default_bool = false,
+    .max_string_len = 0, .min_int = 0, .max_int = 0, .min_float = 0.1f, .max_float = 100.0f,
+};
+static const config_item_t TREND_HALF_LIFE_ITEM = {
+    .key = "flt_half_d", .label = "Trend polocas zapominani [dny]", .description = "Po kolika dnech ma stara relace v regresi polovicni vahu.",
+    .type = CONFIG_VALUE_FLOAT, .default_string = nullptr, .default_int = 0, .default_float = TREND_DEFAULT_HALF_LIFE_DAYS, .default_bool = false,
+    .max_string_len = 0, .min_int = 0, .max_int = 0, .min_float = 1.0f, .max_float = 365.0f,
+};
+
+// Vazene sumy pro y = a + b*t s exponencialnim zapominanim (t ve dnech).
+typedef struct {
+    uint32_t version;
+    uint32_t sessions;
+    double last_t_days;
+    double s0;
+    double st;
+    double sy;
+    double stt;
+    double sty;
+} trend_state_t;
+
+typedef struct {
+    float q_ref_l_min;
+    float q_min_l_min;
+    float half_life_days;
+} trend_config_t;
+
+static trend_config_t s_config = {
+    .q_ref_l_min = TREND_DEFAULT_Q_REF_L_MIN,
+    .q_min_l_min = TREND_DEFAULT_Q_MIN_L_MIN,
+    .half_life_days = TREND_DEFAULT_HALF_LIFE_DAYS,
+};
+
+// tlk_dp_100 patri tlaku a meni se za behu: zapisuje callback config_store (task, ktery
+// ulozil konfiguraci), cte state_manager v filtr_trend_get_estimate().
+static std::atomic<float> s_dp_100_bar(1.0f);
+// Po zmene tlk_dp_100 se odhad publikuje znovu pri dalsi udalosti prutoku.
+static std::atomic<bool> s_dp_100_changed(false);
+
+static trend_state_t s_state = {};
+
+// Cas trendu pokracuje pres restart od posledni relace (vypadek napajeni se nepocita).
+static double s_time_offset_days = 0.0;
+
+// Probihajici relace cerpani
+static bool s_running = false;
+static int64_t s_session_start_us = 0;
+static int64_t s_last_update_us = 0;
+static float s_flow_l_min = 0.0f;
+static float s_dp_bar = NAN;
+static double s_dp_norm_integral = 0.0;
+static double s_dp_norm_time_us = 0.0;
+
+static double now_days(int64_t timestamp_us)
+{
+    return s_time_offset_days + (double)timestamp_us / US_PER_DAY;
+}
+
+static void load_state(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(TREND_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+
+    trend_state_t loaded = {};
+    size_t length = sizeof(loaded);
+    const esp_err_t result = nvs_get_blob(handle, TREND_NVS_KEY, &loaded, &length);
+    nvs_close(handle);
+
+    if (result != ESP_OK || length != sizeof(loaded) || loaded.version != TREND_STATE_VERSION) {
+        ESP_LOGW(TAG, "Ulozeny trend chybi nebo ma jinou verzi, zacinam znovu");
+        return;
+    }
+
+    s_state = loaded;
+    s_time_offset_days = loaded.last_t_days;
+    ESP_LOGI(TAG, "Trend nacten: relaci=%lu t=%.2f d", (unsigned long)loaded.sessions, loaded.last_t_days);
+}
+
+static void save_state(void)
+{
+    nvs_handle_t handle;
+    esp_err_t result = nvs_open(TREND_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result == ESP_OK) {
+        result = nvs_set_blob(handle, TREND_NVS_KEY, &s_state, sizeof(s_state));
+        if (result == ESP_OK) {
+            result = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Ulozeni trendu selhalo: %s", esp_err_to_name(result));
+    }
+}
+
+static void add_point(double t_days, double dp_norm_bar)
+{
+    if (s_state.sessions > 0) {
+        const double dt = t_days - s_state.last_t_days;
+        const double decay = std::exp2(-(dt > 0.0 ? dt : 0.0) / (double)s_config.half_life_days);
+        s_state.s0 *= decay;
+        s_state.st *= decay;
+        s_state.sy *= decay;
+        s_state.stt *= decay;
+        s_state.sty *= decay;
+    }
+
+    s_state.version = TREND_STATE_VERSION;
+    s_state.sessions += 1;
+    s_state.last_t_days = t_days;
+    s_state.s0 += 1.0;
+    s_state.st += t_days;
+    s_state.sy += dp_norm_bar;
+    s_state.stt += t_days * t_days;
+    s_state.sty += t_days * dp_norm_bar;
+}
+
+static void reload_dp_100(void)
+{
+    float dp_100_bar = config_store_get_float("tlk_dp_100");
+    if (!(dp_100_bar > 0.0f)) {
+        dp_100_bar = 1.0f;
+    }
+    s_dp_100_bar.store(dp_100_bar, std::memory_order_relaxed);
+}
+
+static void on_dp_100_changed(void *ctx)
+{
+    (void)ctx;
+    reload_dp_100();
+    s_dp_100_changed.store(true, std::memory_order_release);
+    ESP_LOGI(TAG, "Nove dp100=%.3f bar prevzato za behu", (double)s_dp_100_bar.load(std::memory_order_relaxed));
+}
+
+static void accumulate(int64_t timestamp_us)
+{
+    if (s_running && timestamp_us > s_last_update_us && std::isfinite(s_dp_bar) && s_flow_l_min > 0.0f) {
+        const int64_t settled_from_us = s_session_start_us + TREND_SESSION_SETTLE_US;
+        const int64_t from_us = s_last_update_us > settled_from_us ? s_last_update_us : settled_from_us;
+        if (timestamp_us > from_us) {
+            const double dp_norm = (double)s_dp_bar * (double)s_config.q_ref_l_min / (double)s_flow_l_min;
+            const double dt_us = (double)(timestamp_us - from_us);
+            s_dp_norm_integral += dp_norm * dt_us;
+            s_dp_norm_time_us += dt_us;
+        }
+    }
+    s_last_update_us = timestamp_us;
+}
+
+} // namespace
+
+void filtr_trend_register_config_items(void)
+{
+    APP_ERROR_CHECK("E741", config_store_register_item(&TREND_Q_REF_ITEM));
+    APP_ERROR_CHECK("E742", config_store_register_item(&TREND_Q_MIN_ITEM));
+    APP_ERROR_CHECK("E743", config_store_register_item(&TREND_HALF_LIFE_ITEM));
+}
+
+void filtr_trend_init(void)
+{
+    s_config.q_ref_l_min = config_store_get_float_item(&TREND_Q_REF_ITEM);
+    s_config.q_min_l_min = config_store_get_float_item(&TREND_Q_MIN_ITEM);
+    s_config.half_life_days = config_store_get_float_item(&TREND_HALF_LIFE_ITEM);
+    reload_dp_100();
+    APP_ERROR_CHECK("E779",
+                    config_store_subscribe_item(config_store_find_item("tlk_dp_100"), on_dp_100_changed, nullptr));
+
+    load_state();
+    ESP_LOGI(TAG,
+             "Trend zanaseni: q_ref=%.1f l/min q_min=%.1f l/min polocas=%.0f d dp100=%.3f bar",
+             (double)s_config.q_ref_l_min,
+             (double)s_config.q_min_l_min,
+             (double)s_config.half_life_days,
+             (double)s_dp_100_bar.load(std::memory_order_relaxed));
+}
+
+bool filtr_trend_on_flow(float prutok_l_min, int64_t timestamp_us)
+{
+    accumulate(timestamp_us);
+    s_flow_l_min = std::isfinite(prutok_l_min) ? prutok_l_min : 0.0f;
+    const bool config_changed = s_dp_100_changed.exchange(false, std::memory_order_acq_rel);
+
+    const bool running = s_flow_l_min >= s_config.q_min_l_min;
+    if (running == s_running) {
+        return config_changed;
+    }
+
+    s_running = running;
+    if (running) {
+        s_session_start_us = timestamp_us;
+        s_dp_norm_integral = 0.0;
+        s_dp_norm_time_us = 0.0;
+        return config_changed;
+    }
+
+    const int64_t session_us = timestamp_us - s_session_start_us;
+    if (session_us < TREND_SESSION_MIN_US || s_dp_norm_time_us <= 0.0) {
+        DEBUG_PUBLISH("filtr_trend", "relace zahozena delka=%lld us", (long long)session_us);
+        return config_changed;
+    }
+
+    const double dp_norm = s_dp_norm_integral / s_dp_norm_time_us;
+    add_point(now_days(timestamp_us), dp_norm);
+    save_state();
+
+    DEBUG_PUBLISH("filtr_trend",
+                  "relace delka=%lld s dp_norm=%.4f bar n=%lu",
+                  (long long)(session_us / 1000000LL),
+                  dp_norm,
+                  (unsigned long)s_state.sessions);
+    return true;
+}
+
+void filtr_trend_on_pressure(float rozdil_bar, int64_t timestamp_us)
+{
+    accumulate(timestamp_us);
+    s_dp_bar = rozdil_bar;
+}
+
+bool filtr_trend_get_estimate(filtr_trend_estimate_t *out)
+{
+    if (out == nullptr) {
+        return false;
+    }
+
+    out->sessions = s_state.sessions;
+    out->dp_norm_bar = NAN;
+    out->slope_bar_per_day = NAN;
+    out->days_to_full = NAN;
+
+    if (s_state.sessions < TREND_MIN_SESSIONS || s_state.s0 <= 0.0) {
+        return false;
+    }
+
+    const double den = s_state.s0 * s_state.stt - s_state.st * s_state.st;
+    const double t_variance = den / (s_state.s0 * s_state.s0);
+    if (t_variance < TREND_MIN_T_STDDEV_DAYS * TREND_MIN_T_STDDEV_DAYS) {
+        return false;
+    }
+
+    const double slope = (s_state.s0 * s_state.sty - s_state.st * s_state.sy) / den;
+    const double intercept = (s_state.sy - slope * s_state.st) / s_state.s0;
+    const double dp_now = intercept + slope * now_days(esp_timer_get_time());
+
+    out->dp_norm_bar = (float)dp_now;
+    out->slope_bar_per_day = (float)slope;
+    if (slope > TREND_MIN_SLOPE_BAR_PER_DAY) {
+        const double days = ((double)s_dp_100_bar.load(std::memory_order_relaxed) - dp_now) / slope;
+        out->days_to_full = (float)(days > 0.0 ? days : 0.0);
+    }
+    return true;
+}
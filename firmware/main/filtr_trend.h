@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Trend zanaseni filtru: dP prepocteny na referencni prutok se behem cerpani
+// prumeruje za kazdou relaci a relace se pridavaji do inkrementalni vazene
+// linearni regrese (O(1) pamet, historie se nikdy neprochazi).
+
+typedef struct {
+    uint32_t sessions;          // pocet relaci zapoctenych do regrese od resetu
+    float dp_norm_bar;          // odhad dP na referencnim prutoku v aktualnim case
+    float slope_bar_per_day;    // NaN dokud neni dost dat
+    float days_to_full;         // NaN = bez odhadu nebo se filtr nezanasi
+} filtr_trend_estimate_t;
+
+void filtr_trend_register_config_items(void);
+void filtr_trend_init(void);
+
+// Vola state_manager pri kazde udalosti prutoku / tlaku. Vraci true, kdyz skoncila
+// relace cerpani a odhad trendu se zmenil, nebo se za behu zmenil tlk_dp_100.
+bool filtr_trend_on_flow(float prutok_l_min, int64_t timestamp_us);
+void filtr_trend_on_pressure(float rozdil_bar, int64_t timestamp_us);
+
+bool filtr_trend_get_estimate(filtr_trend_estimate_t *out);
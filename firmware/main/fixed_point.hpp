@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Aritmetika v pevne radove carce Q16.16 pro retezec zpracovani analogovych cidel
+ * (kalibrace -> EMA -> hystereze -> zaokrouhleni).
+ *
+ * Volba cesty je v dobe prekladu: SENSOR_MATH_FIXED_POINT=1 prepne tlak.cpp
+ * a zasoba.cpp na celociselnou cestu, 0 (vychozi) ponecha float cestu. Firmware ji
+ * nastavuje pres option() v main/CMakeLists.txt (idf.py build -DSENSOR_MATH_FIXED_POINT=ON),
+ * hostove nastroje pres -DSENSOR_MATH_FIXED_POINT=1.
+ *
+ * Rozsah: -32768 .. +32767.99998, rozliseni 1 LSB = 1/65536 ~ 1.53e-5.
+ *
+ * Odchylky vuci float ceste (pri vychozich kalibracich, v jednotkach LSB):
+ * - kalibrace RAW -> jednotka: <= 1 LSB (smernice ma 32 zlomkovych bitu),
+ * - EMA: ustaleny stav se muze zastavit az 0.5/alpha LSB od vstupu
+ *   (alpha 0.25 -> 2 LSB ~ 3e-5 m, alpha 0.01 -> 50 LSB ~ 7.6e-4); pri zmene
+ *   vstupu navic zpozdeni z kvantovani alpha, max. 0.5 LSB * |vstup - EMA| / alpha,
+ * - hystereze: prah je kvantovan na +-0.5 LSB, porovnani jsou presna; vstup
+ *   odlisny o par LSB muze u prahu prepnout jen v jedne ceste, druha pak drzi
+ *   predchozi hodnotu (rozdil max. sirka hystereze), dokud vstup pasmo neopusti,
+ * - zaokrouhleni: shodne s roundf(), jen hodnoty do 1 LSB od hranice x.5
+ *   se mohou lisit o jednu posledni publikovanou cislici.
+ * Meze kontroluje tools/fixed_point_equiv.cpp nad zaznamem z cmd/trace.
+ */
+#ifndef SENSOR_MATH_FIXED_POINT
+#define SENSOR_MATH_FIXED_POINT 0
+#endif
+
+namespace q16 {
+
+typedef int32_t value_t;
+
+static constexpr int32_t FRAC_BITS = 16;
+static constexpr value_t ONE = (value_t)1 << FRAC_BITS;
+static constexpr value_t HALF = ONE >> 1;
+
+inline value_t from_float(float value)
+{
+    const float scaled = value * (float)ONE;
+    return (value_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+inline float to_float(value_t value)
+{
+    return (float)value / (float)ONE;
+}
+
+inline value_t from_int(int32_t value)
+{
+    return (value_t)(value * ONE);
+}
+
+inline value_t mul(value_t a, value_t b)
+{
+    return (value_t)((((int64_t)a * (int64_t)b) + HALF) >> FRAC_BITS);
+}
+
+inline value_t clamp(value_t value, value_t min_value, value_t max_value)
+{
+    if (value < min_value) {
+        return min_value;
+    }
+    if (value > max_value) {
+        return max_value;
+    }
+    return value;
+}
+
+/**
+ * Linearni prevod RAW -> jednotka mezi dvema kalibracnimi body.
+ * Smernice je predpocitana s 32 zlomkovymi bity, za behu tedy zbyva
+ * jedno 32x32->64 nasobeni a posun.
+ */
+class LinearMap
+{
+public:
+    LinearMap() : raw_min_(0), out_min_(0), slope_q32_(0) {}
+
+    LinearMap(int32_t raw_min, int32_t raw_max, float out_min, float out_max)
+        : raw_min_(raw_min), out_min_(from_float(out_min)), slope_q32_(0)
+    {
+        const int32_t raw_span = raw_max - raw_min;
+        if (raw_span != 0) {
+            const int64_t out_span = (int64_t)from_float(out_max) - (int64_t)out_min_;
+            const int64_t numerator = out_span * (int64_t)ONE;
+            const int64_t half_span = (raw_span > 0 ? raw_span : -raw_span) / 2;
+            slope_q32_ = (numerator >= 0 ? numerator + half_span : numerator - half_span) / raw_span;
+        }
+    }
+
+    value_t map(int32_t raw) const
+    {
+        const int64_t delta = (int64_t)(raw - raw_min_) * slope_q32_;
+        return out_min_ + (value_t)((delta + HALF) >> FRAC_BITS);
+    }
+
+private:
+    int32_t raw_min_;
+    value_t out_min_;
+    int64_t slope_q32_;
+};
+
+/**
+ * EMA ve tvaru y += alpha * (x - y); prvni vzorek filtr jen nastavi.
+ */
+class Ema
+{
+public:
+    explicit Ema(float alpha = 1.0f) : alpha_(from_float(alpha)), value_(0), initialized_(false) {}
+
+    value_t process(value_t input)
+    {
+        if (!initialized_) {
+            value_ = input;
+            initialized_ = true;
+        } else {
+            value_ += mul(alpha_, input - value_);
+        }
+        return value_;
+    }
+
+    value_t value() const
+    {
+        return value_;
+    }
+
+    // Nova alpha bez resetu stavu (zmena konfigurace za behu).
+    void setAlpha(float alpha)
+    {
+        alpha_ = from_float(alpha);
+    }
+
+private:
+    value_t alpha_;
+    value_t value_;
+    bool initialized_;
+};
+
+inline int32_t pow10_for_decimals(int32_t decimals)
+{
+    if (decimals <= 1) {
+        return 10;
+    }
+    if (decimals >= 3) {
+        return 1000;
+    }
+    return 100;
+}
+
+/**
+ * Zaokrouhli na 1-3 desetinna mista (polovina od nuly jako roundf) a vrati
+ * float pro publikaci. Jedine deleni ve float je na hranici vystupu.
+ */
+inline float round_to_decimals(value_t value, int32_t decimals)
+{
+    const int32_t scale = pow10_for_decimals(decimals);
+    const int64_t scaled = (int64_t)value * scale;
+    const int64_t magnitude = ((scaled >= 0 ? scaled : -scaled) + HALF) >> FRAC_BITS;
+    const int64_t units = scaled >= 0 ? magnitude : -magnitude;
+    return (float)units / (float)scale;
+}
+
+} // namespace q16
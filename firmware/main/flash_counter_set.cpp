@@ -0,0 +1,387 @@
+#include "flash_counter_set.h"
+
+extern "C" {
+#include "nvs.h"
+#include "esp_log.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+constexpr const char *NVS_NAMESPACE = "flash_ctr";
+constexpr const char *TAG = "counter_set";
+constexpr uint32_t BOOKKEEPING_MAGIC = 0x46435331; // "FCS1"
+
+uint32_t fnv1a32(const char *text)
+{
+    uint32_t hash = 2166136261u;
+    while (*text != '\0') {
+        hash ^= static_cast<uint8_t>(*text);
+        hash *= 16777619u;
+        ++text;
+    }
+    return hash;
+}
+}
+
+FlashCounterSet::FlashCounterSet()
+    : counters_{},
+      banks_{},
+      count_(0),
+      nvs_key_{},
+      bookkeeping_{},
+      initialized_(false)
+{
+}
+
+esp_err_t FlashCounterSet::init(const char *set_name, const Region *regions, size_t count)
+{
+    if (set_name == nullptr || set_name[0] == '\0' || regions == nullptr || count == 0 || count > MAX_COUNTERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        const Region &region = regions[index];
+        if (region.partition_label == nullptr) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        const esp_partition_t *partition = esp_partition_find_first(
+            ESP_PARTITION_TYPE_DATA,
+            ESP_PARTITION_SUBTYPE_ANY,
+            region.partition_label);
+        if (partition == nullptr) {
+            return ESP_ERR_NOT_FOUND;
+        }
+
+        const uint32_t size = region.size != 0 ? region.size : partition->size - std::min(region.offset, partition->size);
+        if (size == 0
+            || region.offset % partition->erase_size != 0
+            || size % partition->erase_size != 0
+            || region.offset > partition->size
+            || size > partition->size - region.offset) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        // Oblasti v jednom oddilu se nesmi prekryvat.
+        for (size_t other = 0; other < index; ++other) {
+            const Counter &previous = counters_[other];
+            if (previous.partition == partition
+                && region.offset < previous.offset + previous.size
+                && previous.offset < region.offset + size) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+
+        counters_[index] = Counter{
+            .name = region.name != nullptr ? region.name : region.partition_label,
+            .partition = partition,
+            .offset = region.offset,
+            .size = size,
+            .total_bits = size * 8,
+            .used_bits = 0,
+            .pending_steps = 0,
+            .dual_bank = region.dual_bank,
+        };
+        if (region.dual_bank) {
+            esp_err_t result = banks_[index].init_dual_bank(region.partition_label, region.offset, size);
+            if (result != ESP_OK) {
+                return result;
+            }
+        }
+    }
+    count_ = count;
+
+    const int written = std::snprintf(nvs_key_.data(), nvs_key_.size(), "s_%08lx",
+                                      static_cast<unsigned long>(fnv1a32(set_name)));
+    if (written <= 0 || static_cast<size_t>(written) >= nvs_key_.size()) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    bool found = false;
+    esp_err_t result = load_bookkeeping_(&found);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    bool dirty = !found || bookkeeping_.magic != BOOKKEEPING_MAGIC || bookkeeping_.count != count_
+        || bookkeeping_.rollover_mask != 0;
+    if (!found || bookkeeping_.magic != BOOKKEEPING_MAGIC) {
+        bookkeeping_ = Bookkeeping{};
+        bookkeeping_.magic = BOOKKEEPING_MAGIC;
+    } else if (bookkeeping_.count != count_) {
+        // Pridany citac zacina od nuly, zaklady puvodnich zustanou.
+        ESP_LOGW(TAG, "Sada %s: pocet citacu %u -> %u", set_name, (unsigned)bookkeeping_.count, (unsigned)count_);
+        for (size_t index = std::min<size_t>(bookkeeping_.count, MAX_COUNTERS); index < MAX_COUNTERS; ++index) {
+            bookkeeping_.base[index] = 0;
+        }
+        bookkeeping_.rollover_mask &= static_cast<uint8_t>((1U << count_) - 1U);
+    }
+    bookkeeping_.count = static_cast<uint8_t>(count_);
+
+    // Zaklad citace s rozpracovanym mazanim uz obsahuje celou oblast; mazani se dokonci.
+    for (size_t index = 0; index < count_; ++index) {
+        Counter &counter = counters_[index];
+        if (counter.dual_bank) {
+            // Zaklad je v hlavicce banky, evidence sady ho nedrzi.
+            bookkeeping_.base[index] = 0;
+            continue;
+        }
+        if ((bookkeeping_.rollover_mask & (1U << index)) != 0) {
+            ESP_LOGW(TAG, "Dokoncuji preteceni citace %s", counter.name);
+            result = esp_partition_erase_range(counter.partition, counter.offset, counter.size);
+            counter.used_bits = 0;
+        } else {
+            result = FlashMonotonicCounter::count_cleared_bits(counter.partition, counter.offset, counter.size, &counter.used_bits);
+        }
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+
+    bookkeeping_.rollover_mask = 0;
+    if (dirty) {
+        result = save_bookkeeping_(bookkeeping_);
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+
+    initialized_ = true;
+    return ESP_OK;
+}
+
+esp_err_t FlashCounterSet::add(size_t index, uint32_t steps)
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (index >= count_) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Counter &counter = counters_[index];
+    if (steps > UINT32_MAX - counter.pending_steps) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    counter.pending_steps += steps;
+    return ESP_OK;
+}
+
+esp_err_t FlashCounterSet::flush()
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Nejdriv vse, co se vejde do aktualnich oblasti; jeden zapis na citac.
+    uint8_t overflow_mask = 0;
+    for (size_t index = 0; index < count_; ++index) {
+        Counter &counter = counters_[index];
+        if (counter.dual_bank) {
+            esp_err_t result = write_dual_bank_steps_(index);
+            if (result != ESP_OK) {
+                return result;
+            }
+            continue;
+        }
+        const uint32_t steps = std::min(counter.pending_steps, counter.total_bits - counter.used_bits);
+        esp_err_t result = write_steps_(counter, steps);
+        if (result != ESP_OK) {
+            return result;
+        }
+        if (counter.pending_steps > 0) {
+            overflow_mask = static_cast<uint8_t>(overflow_mask | (1U << index));
+        }
+    }
+
+    // Plne oblasti se pretoci spolecne (jedna evidence pro vsechny) a zbytek se dopise.
+    while (overflow_mask != 0) {
+        esp_err_t result = rollover_(overflow_mask);
+        if (result != ESP_OK) {
+            return result;
+        }
+
+        const uint8_t rolled_mask = overflow_mask;
+        overflow_mask = 0;
+        for (size_t index = 0; index < count_; ++index) {
+            if ((rolled_mask & (1U << index)) == 0) {
+                continue;
+            }
+            Counter &counter = counters_[index];
+            result = write_steps_(counter, std::min(counter.pending_steps, counter.total_bits));
+            if (result != ESP_OK) {
+                return result;
+            }
+            if (counter.pending_steps > 0) {
+                overflow_mask = static_cast<uint8_t>(overflow_mask | (1U << index));
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+uint64_t FlashCounterSet::value(size_t index) const
+{
+    if (index >= count_) {
+        return 0;
+    }
+    const Counter &counter = counters_[index];
+    if (counter.dual_bank) {
+        return banks_[index].value() + counter.pending_steps;
+    }
+    const int64_t current = bookkeeping_.base[index] + static_cast<int64_t>(counter.used_bits) + counter.pending_steps;
+    return current <= 0 ? 0 : static_cast<uint64_t>(current);
+}
+
+uint32_t FlashCounterSet::pending(size_t index) const
+{
+    return index < count_ ? counters_[index].pending_steps : 0;
+}
+
+size_t FlashCounterSet::count() const
+{
+    return count_;
+}
+
+const char *FlashCounterSet::name(size_t index) const
+{
+    return index < count_ ? counters_[index].name : "";
+}
+
+bool FlashCounterSet::erase_pending() const
+{
+    for (size_t index = 0; index < count_; ++index) {
+        if (counters_[index].dual_bank && banks_[index].erase_pending()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t FlashCounterSet::erase_step()
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (size_t index = 0; index < count_; ++index) {
+        if (counters_[index].dual_bank && banks_[index].erase_pending()) {
+            return banks_[index].erase_step();
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t FlashCounterSet::load_bookkeeping_(bool *found)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    size_t length = sizeof(bookkeeping_);
+    result = nvs_get_blob(handle, nvs_key_.data(), &bookkeeping_, &length);
+    *found = (result == ESP_OK && length == sizeof(bookkeeping_));
+    if (result == ESP_ERR_NVS_NOT_FOUND || result == ESP_ERR_NVS_INVALID_LENGTH || (result == ESP_OK && !*found)) {
+        result = ESP_OK;
+    }
+
+    nvs_close(handle);
+    return result;
+}
+
+esp_err_t FlashCounterSet::save_bookkeeping_(const Bookkeeping &bookkeeping) const
+{
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    result = nvs_set_blob(handle, nvs_key_.data(), &bookkeeping, sizeof(bookkeeping));
+    if (result == ESP_OK) {
+        result = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return result;
+}
+
+esp_err_t FlashCounterSet::write_steps_(Counter &counter, uint32_t steps)
+{
+    if (steps == 0) {
+        return ESP_OK;
+    }
+
+    esp_err_t result = FlashMonotonicCounter::clear_bits(counter.partition, counter.offset, counter.used_bits, steps);
+    if (result != ESP_OK) {
+        // Cast bloku uz mohla byt zapsana; used_bits musi odpovidat flash.
+        const uint32_t before = counter.used_bits;
+        if (FlashMonotonicCounter::count_cleared_bits(counter.partition, counter.offset, counter.size, &counter.used_bits) == ESP_OK
+            && counter.used_bits > before) {
+            counter.pending_steps -= std::min(counter.used_bits - before, counter.pending_steps);
+        }
+        return result;
+    }
+
+    counter.used_bits += steps;
+    counter.pending_steps -= steps;
+    return ESP_OK;
+}
+
+// Preteceni si citac A/B resi sam (hlavicka do pripravene banky, bez NVS a bez mazani).
+esp_err_t FlashCounterSet::write_dual_bank_steps_(size_t index)
+{
+    Counter &counter = counters_[index];
+    if (counter.pending_steps == 0) {
+        return ESP_OK;
+    }
+
+    FlashMonotonicCounter &bank = banks_[index];
+    const uint64_t before = bank.value();
+    const esp_err_t result = bank.increment(counter.pending_steps);
+    // Pri chybe mohla byt cast prirustku zapsana; zbytek zustava pripraveny.
+    counter.pending_steps -= static_cast<uint32_t>(std::min<uint64_t>(bank.value() - before, counter.pending_steps));
+    return result;
+}
+
+esp_err_t FlashCounterSet::rollover_(uint8_t mask)
+{
+    Bookkeeping next = bookkeeping_;
+    for (size_t index = 0; index < count_; ++index) {
+        if ((mask & (1U << index)) != 0) {
+            ESP_LOGI(TAG, "Preteceni citace %s: base=%lld used_bits=%lu",
+                     counters_[index].name,
+                     (long long)next.base[index],
+                     (unsigned long)counters_[index].used_bits);
+            next.base[index] += counters_[index].used_bits;
+        }
+    }
+
+    // Nove zaklady a priznak mazani jednim commitem; po vypadku init() mazani dokonci.
+    next.rollover_mask = mask;
+    esp_err_t result = save_bookkeeping_(next);
+    if (result != ESP_OK) {
+        return result;
+    }
+    bookkeeping_ = next;
+
+    for (size_t index = 0; index < count_; ++index) {
+        if ((mask & (1U << index)) == 0) {
+            continue;
+        }
+        Counter &counter = counters_[index];
+        result = esp_partition_erase_range(counter.partition, counter.offset, counter.size);
+        if (result != ESP_OK) {
+            return result;
+        }
+        counter.used_bits = 0;
+    }
+
+    bookkeeping_.rollover_mask = 0;
+    return save_bookkeeping_(bookkeeping_);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "flash_monotonic_counter.h"
+
+/**
+ * Sada pojmenovanych monotonnich citacu v bitmapach flash se spolecnou evidenci v NVS.
+ *
+ * Kazdy citac ma vlastni oblast (cely oddil nebo jeho vyrez zarovnany na erase sektor),
+ * bitmapa se nuluje po poradi jako ve FlashMonotonicCounter a sdili s nim bitove operace.
+ * Zaklady po preteceni vsech citacu a priznaky rozpracovaneho mazani jsou v jednom NVS
+ * zaznamu sady, takze preteceni vice citacu v jedne davce stoji dva NVS commity celkem.
+ *
+ * Oblast s dual_bank (sudy pocet sektoru, aspon 2) pouzije format A/B z FlashMonotonicCounter
+ * (init_dual_bank): zaklad je v hlavicce banky, NVS se pro ni nepouziva a flush() pri preteceni
+ * jen zapise hlavicku do pripravene banky. Starou banku maze vlastnik pres erase_step() v klidu.
+ *
+ * Prirustky se nejdriv pripravi v RAM (add) a flush() je zapise: jeden zapis na kazdy
+ * zmeneny citac bez ohledu na pocet add(). Citace zmenene spolecne (napr. konec relace
+ * cerpani) se tak zapisi jednou davkou.
+ *
+ * Priklad:
+ *   static const FlashCounterSet::Region REGIONS[] = {
+ *       {"starty", "user_data3", 0x0000, 0x1000},
+ *       {"restarty", "user_data3", 0x1000, 0x1000},
+ *   };
+ *   FlashCounterSet counters;
+ *   counters.init("provoz", REGIONS, 2);
+ *   counters.add(0, 1);
+ *   counters.add(1, 1);
+ *   counters.flush();
+ *   const uint64_t starty = counters.value(0);
+ */
+class FlashCounterSet {
+public:
+    static constexpr size_t MAX_COUNTERS = 8;
+
+    struct Region {
+        const char *name;
+        const char *partition_label;
+        uint32_t offset;            // zarovnane na erase sektor
+        uint32_t size;              // 0 = do konce oddilu
+        bool dual_bank;             // format A/B bez NVS (FlashMonotonicCounter::init_dual_bank)
+    };
+
+    FlashCounterSet();
+
+    esp_err_t init(const char *set_name, const Region *regions, size_t count);
+
+    // Pripravi prirustek v RAM; do flash ho zapise az flush().
+    esp_err_t add(size_t index, uint32_t steps);
+    esp_err_t flush();
+
+    // Zapsana hodnota plus pripraveny prirustek.
+    uint64_t value(size_t index) const;
+    uint32_t pending(size_t index) const;
+    size_t count() const;
+    const char *name(size_t index) const;
+
+    // Mazani stare banky citacu A/B po preteceni, jeden sektor na volani (vola vlastnik v klidu).
+    bool erase_pending() const;
+    esp_err_t erase_step();
+
+private:
+    struct Counter {
+        const char *name;
+        const esp_partition_t *partition;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t total_bits;
+        uint32_t used_bits;
+        uint32_t pending_steps;
+        bool dual_bank;
+    };
+
+    // Spolecny NVS zaznam sady (blob).
+    struct Bookkeeping {
+        uint32_t magic;
+        uint8_t count;
+        uint8_t rollover_mask;      // bit i = oblast citace i se prave maze (jen bez dual_bank)
+        uint8_t reserved[2];
+        int64_t base[MAX_COUNTERS];
+    };
+
+    esp_err_t load_bookkeeping_(bool *found);
+    esp_err_t save_bookkeeping_(const Bookkeeping &bookkeeping) const;
+    esp_err_t write_steps_(Counter &counter, uint32_t steps);
+    esp_err_t write_dual_bank_steps_(size_t index);
+    esp_err_t rollover_(uint8_t mask);
+
+    std::array<Counter, MAX_COUNTERS> counters_;
+    std::array<FlashMonotonicCounter, MAX_COUNTERS> banks_;     // jen citace s dual_bank
+    size_t count_;
+    std::array<char, 16> nvs_key_;
+    Bookkeeping bookkeeping_;
+    bool initialized_;
+};
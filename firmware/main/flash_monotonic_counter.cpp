@@ -7,12 +7,33 @@ extern "C" {
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 
 namespace {
 constexpr size_t SCAN_CHUNK_SIZE = 256;
 constexpr size_t WRITE_CHUNK_SIZE = 256;
+// Kolik bajtu pred a za nalezenou hranici se pri rychle obnove kontroluje.
+constexpr uint32_t RECOVERY_CHECK_BYTES = 16;
+
+constexpr uint32_t BANK_HEADER_MAGIC = 0x464d4332; // "FMC2"
+constexpr uint32_t BANK_READY_MAGIC = 0x52454459;  // "REDY"
+
+// Hlavicka banky formatu A/B; bitmapa zacina hned za ni. Zapisuje se jen magic..crc,
+// ready se zapise az po smazani cele banky (banka je pripravena na dalsi preteceni).
+struct bank_header_t {
+    uint32_t magic;
+    uint32_t seq;
+    int64_t base;
+    uint32_t crc;
+    uint32_t reserved[2];
+    uint32_t ready;
+};
+
+constexpr uint32_t BANK_HEADER_SIZE = sizeof(bank_header_t);
+constexpr uint32_t BANK_HEADER_WRITE_SIZE = offsetof(bank_header_t, reserved);
+static_assert(BANK_HEADER_SIZE == 32, "bank_header_t musi mit 32 B");
 constexpr const char *NVS_NAMESPACE = "flash_ctr";
 constexpr const char *TAG = "monotonic";
 
@@ -26,24 +47,79 @@ uint32_t fnv1a32(const char *text)
     }
     return hash;
 }
+
+uint32_t crc32(const void *data, size_t length)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t bank_header_crc(const bank_header_t &header)
+{
+    return crc32(&header, offsetof(bank_header_t, crc));
 }
 
+bool bank_header_valid(const bank_header_t &header)
+{
+    return header.magic == BANK_HEADER_MAGIC && header.crc == bank_header_crc(header);
+}
+
+// Smazana a pripravena banka: hlavicka cela 0xFF a zapsany priznak ready.
+bool bank_header_ready(const bank_header_t &header)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&header);
+    for (uint32_t i = 0; i < offsetof(bank_header_t, ready); ++i) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return header.ready == BANK_READY_MAGIC;
+}
+}
+
+// 1 = po kazdem zapisu zpetne cteni a porovnani se zapsanym obsahem (jen pro ladeni;
+// bezny prirustek je jeden zapis bez jakehokoli cteni z flash).
 #ifndef FLASH_MONOTONIC_COUNTER_VERIFY_WRITES
 #define FLASH_MONOTONIC_COUNTER_VERIFY_WRITES 0
 #endif
 
+// 1 = po rychle obnove jeste plny sken oblasti; pri neshode plati plny sken.
+#ifndef FLASH_MONOTONIC_COUNTER_VERIFY_RECOVERY
+#define FLASH_MONOTONIC_COUNTER_VERIFY_RECOVERY 0
+#endif
+
 FlashMonotonicCounter::FlashMonotonicCounter()
     : partition_(nullptr),
+      region_offset_(0),
+      region_size_(0),
       nvs_base_key_{},
       nvs_pending_key_{},
       base_value_(0),
       used_bits_(0),
       total_bits_(0),
-      initialized_(false)
+      initialized_(false),
+      dual_bank_(false),
+      bank_size_(0),
+      active_bank_(0),
+      bank_seq_(0),
+      erase_pending_(false),
+      erase_sector_(0)
 {
 }
 
 esp_err_t FlashMonotonicCounter::init(const char *partition_label)
+{
+    return init(partition_label, 0, 0);
+}
+
+esp_err_t FlashMonotonicCounter::find_partition_(const char *partition_label, uint32_t *region_offset, uint32_t *region_size)
 {
     if (partition_label == nullptr || partition_label[0] == '\0') {
         return ESP_ERR_INVALID_ARG;
@@ -57,12 +133,46 @@ esp_err_t FlashMonotonicCounter::init(const char *partition_label)
         return ESP_ERR_NOT_FOUND;
     }
 
-    esp_err_t result = derive_nvs_keys_from_partition_label_(partition_label);
+    // size 0 = cely oddil.
+    if (*region_size == 0) {
+        *region_offset = 0;
+        *region_size = partition_->size;
+    }
+    if (*region_offset % partition_->erase_size != 0
+        || *region_size % partition_->erase_size != 0
+        || *region_offset > partition_->size
+        || *region_size > partition_->size - *region_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    region_offset_ = *region_offset;
+    region_size_ = *region_size;
+    return ESP_OK;
+}
+
+esp_err_t FlashMonotonicCounter::init(const char *partition_label, uint32_t region_offset, uint32_t region_size)
+{
+    // Cely oddil = puvodni format, NVS klice podle labelu.
+    esp_err_t found = find_partition_(partition_label, &region_offset, &region_size);
+    if (found != ESP_OK) {
+        return found;
+    }
+    dual_bank_ = false;
+
+    // Vyrez oddilu ma vlastni NVS klice, aby se nepletl s citacem pres cely oddil.
+    std::array<char, 40> key_source = {};
+    if (region_offset_ == 0 && region_size_ == partition_->size) {
+        std::snprintf(key_source.data(), key_source.size(), "%s", partition_label);
+    } else {
+        std::snprintf(key_source.data(), key_source.size(), "%s@%lx",
+                      partition_label, static_cast<unsigned long>(region_offset_));
+    }
+
+    esp_err_t result = derive_nvs_keys_from_partition_label_(key_source.data());
     if (result != ESP_OK) {
         return result;
     }
 
-    total_bits_ = partition_->size * 8;
+    total_bits_ = region_size_ * 8;
 
     result = load_base_from_nvs_();
     if (result != ESP_OK) {
@@ -76,7 +186,7 @@ esp_err_t FlashMonotonicCounter::init(const char *partition_label)
     }
 
     if (rollover_pending) {
-        result = esp_partition_erase_range(partition_, 0, partition_->size);
+        result = esp_partition_erase_range(partition_, region_offset_, region_size_);
         if (result != ESP_OK) {
             return result;
         }
@@ -97,6 +207,181 @@ esp_err_t FlashMonotonicCounter::init(const char *partition_label)
     return ESP_OK;
 }
 
+esp_err_t FlashMonotonicCounter::init_dual_bank(const char *partition_label, uint32_t region_offset, uint32_t region_size)
+{
+    esp_err_t result = find_partition_(partition_label, &region_offset, &region_size);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    const uint32_t sectors = region_size_ / partition_->erase_size;
+    if (sectors < 2 || sectors % 2 != 0 || partition_->erase_size <= BANK_HEADER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    dual_bank_ = true;
+    bank_size_ = region_size_ / 2;
+    total_bits_ = (bank_size_ - BANK_HEADER_SIZE) * 8;
+    erase_pending_ = false;
+    erase_sector_ = 0;
+
+    bank_header_t headers[2] = {};
+    for (uint8_t bank = 0; bank < 2; ++bank) {
+        result = esp_partition_read(partition_, bank_offset_(bank), &headers[bank], sizeof(headers[bank]));
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+
+    const bool valid[2] = {bank_header_valid(headers[0]), bank_header_valid(headers[1])};
+    if (!valid[0] && !valid[1]) {
+        ESP_LOGW(TAG, "Oblast 0x%lx bez platne hlavicky banky, zakladam citac od nuly",
+                 static_cast<unsigned long>(region_offset_));
+        result = create_dual_bank_();
+        initialized_ = (result == ESP_OK);
+        return result;
+    }
+
+    if (valid[0] && valid[1]) {
+        active_bank_ = static_cast<int32_t>(headers[1].seq - headers[0].seq) > 0 ? 1 : 0;
+    } else {
+        active_bank_ = valid[1] ? 1 : 0;
+    }
+    base_value_ = headers[active_bank_].base;
+    bank_seq_ = headers[active_bank_].seq;
+
+    result = count_cleared_bits(partition_, bitmap_offset_(), bank_size_ - BANK_HEADER_SIZE, &used_bits_);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    // Stara banka (nebo prerusene mazani ci zapis hlavicky) se smaze postupne.
+    erase_pending_ = !bank_header_ready(headers[1 - active_bank_]);
+
+    initialized_ = true;
+    return ESP_OK;
+}
+
+uint32_t FlashMonotonicCounter::bank_offset_(uint8_t bank) const
+{
+    return region_offset_ + bank * bank_size_;
+}
+
+uint32_t FlashMonotonicCounter::bitmap_offset_() const
+{
+    return dual_bank_ ? bank_offset_(active_bank_) + BANK_HEADER_SIZE : region_offset_;
+}
+
+esp_err_t FlashMonotonicCounter::write_bank_header_(uint8_t bank, uint32_t seq, int64_t base)
+{
+    bank_header_t header = {};
+    header.magic = BANK_HEADER_MAGIC;
+    header.seq = seq;
+    header.base = base;
+    header.crc = bank_header_crc(header);
+    return esp_partition_write(partition_, bank_offset_(bank), &header, BANK_HEADER_WRITE_SIZE);
+}
+
+// Nova oblast: obe banky smazat, banka 0 aktivni od nuly, banka 1 pripravena.
+esp_err_t FlashMonotonicCounter::create_dual_bank_()
+{
+    esp_err_t result = esp_partition_erase_range(partition_, region_offset_, region_size_);
+    if (result == ESP_OK) {
+        result = write_bank_header_(0, 1, 0);
+    }
+    if (result == ESP_OK) {
+        result = esp_partition_write(partition_, bank_offset_(1) + offsetof(bank_header_t, ready),
+                                     &BANK_READY_MAGIC, sizeof(BANK_READY_MAGIC));
+    }
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    active_bank_ = 0;
+    bank_seq_ = 1;
+    base_value_ = 0;
+    used_bits_ = 0;
+    erase_pending_ = false;
+    erase_sector_ = 0;
+    return ESP_OK;
+}
+
+bool FlashMonotonicCounter::erase_pending() const
+{
+    return initialized_ && dual_bank_ && erase_pending_;
+}
+
+esp_err_t FlashMonotonicCounter::erase_step()
+{
+    if (!erase_pending()) {
+        return ESP_OK;
+    }
+
+    const uint8_t stale_bank = static_cast<uint8_t>(1 - active_bank_);
+    const uint32_t sector_offset = bank_offset_(stale_bank) + erase_sector_ * partition_->erase_size;
+    esp_err_t result = ESP_OK;
+    if (erase_sector_ == 0) {
+        // Priznak ready se nejdriv znehodnoti, aby prerusene mazani nevypadalo jako hotove.
+        const uint32_t not_ready = 0;
+        result = esp_partition_write(partition_, bank_offset_(stale_bank) + offsetof(bank_header_t, ready),
+                                     &not_ready, sizeof(not_ready));
+    }
+    if (result == ESP_OK) {
+        result = esp_partition_erase_range(partition_, sector_offset, partition_->erase_size);
+    }
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    ++erase_sector_;
+    if (erase_sector_ * partition_->erase_size < bank_size_) {
+        return ESP_OK;
+    }
+
+    result = esp_partition_write(partition_, bank_offset_(stale_bank) + offsetof(bank_header_t, ready),
+                                 &BANK_READY_MAGIC, sizeof(BANK_READY_MAGIC));
+    if (result != ESP_OK) {
+        erase_sector_ = 0;
+        return result;
+    }
+    erase_pending_ = false;
+    erase_sector_ = 0;
+    return ESP_OK;
+}
+
+esp_err_t FlashMonotonicCounter::rollover_dual_bank_()
+{
+    while (erase_pending_) {
+        ESP_LOGW(TAG, "Preteceni pred dokoncenim mazani banky, domazavam");
+        esp_err_t result = erase_step();
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+
+    // Nova hlavicka do pripravene banky; od jejiho zapisu plati nova banka.
+    const uint8_t next_bank = static_cast<uint8_t>(1 - active_bank_);
+    const int64_t new_base = signed_value_();
+    ESP_LOGI(TAG, "Rollover do banky %u: base=%lld seq=%lu",
+             (unsigned)next_bank,
+             (long long)new_base,
+             (unsigned long)(bank_seq_ + 1));
+    esp_err_t result = write_bank_header_(next_bank, bank_seq_ + 1, new_base);
+    if (result != ESP_OK) {
+        // Neuplna hlavicka neplati; banka se pred dalsim pokusem znovu smaze.
+        erase_pending_ = true;
+        erase_sector_ = 0;
+        return result;
+    }
+
+    active_bank_ = next_bank;
+    bank_seq_ += 1;
+    base_value_ = new_base;
+    used_bits_ = 0;
+    erase_pending_ = true;
+    erase_sector_ = 0;
+    return ESP_OK;
+}
+
 esp_err_t FlashMonotonicCounter::derive_nvs_keys_from_partition_label_(const char *partition_label)
 {
     const uint32_t hash = fnv1a32(partition_label);
@@ -158,7 +443,11 @@ esp_err_t FlashMonotonicCounter::reset()
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t result = esp_partition_erase_range(partition_, 0, partition_->size);
+    if (dual_bank_) {
+        return create_dual_bank_();
+    }
+
+    esp_err_t result = esp_partition_erase_range(partition_, region_offset_, region_size_);
     if (result != ESP_OK) {
         return result;
     }
@@ -254,77 +543,199 @@ esp_err_t FlashMonotonicCounter::save_rollover_state_to_nvs_(int64_t base_value,
 }
 
 esp_err_t FlashMonotonicCounter::count_zero_bits_in_partition_()
+{
+    return count_cleared_bits(partition_, region_offset_, region_size_, &used_bits_);
+}
+
+esp_err_t FlashMonotonicCounter::clear_bits_range_(uint32_t start_bit, uint32_t bit_count)
+{
+    if (bit_count == 0) {
+        return ESP_OK;
+    }
+
+    if (start_bit >= total_bits_ || bit_count > (total_bits_ - start_bit)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return clear_bits(partition_, bitmap_offset_(), start_bit, bit_count);
+}
+
+esp_err_t FlashMonotonicCounter::count_cleared_bits(const esp_partition_t *partition,
+                                                    uint32_t region_offset,
+                                                    uint32_t region_size,
+                                                    uint32_t *used_bits)
+{
+    if (partition == nullptr || used_bits == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t fast_bits = 0;
+    bool consistent = false;
+    esp_err_t result = find_cleared_boundary_(partition, region_offset, region_size, &fast_bits, &consistent);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    if (!consistent) {
+        ESP_LOGW(TAG, "Nekonzistentni bitmapa u hranice %lu (oblast 0x%lx), plny sken",
+                 static_cast<unsigned long>(fast_bits),
+                 static_cast<unsigned long>(region_offset));
+        return scan_cleared_bits_(partition, region_offset, region_size, used_bits);
+    }
+
+#if FLASH_MONOTONIC_COUNTER_VERIFY_RECOVERY
+    uint32_t scanned_bits = 0;
+    result = scan_cleared_bits_(partition, region_offset, region_size, &scanned_bits);
+    if (result != ESP_OK) {
+        return result;
+    }
+    if (scanned_bits != fast_bits) {
+        ESP_LOGE(TAG, "Verify obnovy: puleni=%lu plny sken=%lu (oblast 0x%lx)",
+                 static_cast<unsigned long>(fast_bits),
+                 static_cast<unsigned long>(scanned_bits),
+                 static_cast<unsigned long>(region_offset));
+        fast_bits = scanned_bits;
+    }
+#endif
+
+    *used_bits = fast_bits;
+    return ESP_OK;
+}
+
+// Bity se nuluji striktne po poradi, takze oblast je: bajty 0x00, nanejvys jeden rozpracovany
+// bajt (vynulovane dolni bity) a zbytek 0xFF. Prvni bajt ruzny od 0x00 se najde pulenim
+// intervalu; okoli hranice se pak precte a zkontroluje, zda tomuto tvaru odpovida.
+esp_err_t FlashMonotonicCounter::find_cleared_boundary_(const esp_partition_t *partition,
+                                                        uint32_t region_offset,
+                                                        uint32_t region_size,
+                                                        uint32_t *used_bits,
+                                                        bool *consistent)
+{
+    uint32_t low = 0;
+    uint32_t high = region_size;
+    while (low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+        uint8_t value = 0xFF;
+        esp_err_t result = esp_partition_read(partition, region_offset + middle, &value, sizeof(value));
+        if (result != ESP_OK) {
+            return result;
+        }
+
+        if (value == 0x00) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    const uint32_t boundary = low;
+    const uint32_t window_start = boundary > RECOVERY_CHECK_BYTES ? boundary - RECOVERY_CHECK_BYTES : 0;
+    const uint32_t window_end = std::min<uint32_t>(region_size, boundary + RECOVERY_CHECK_BYTES);
+    std::array<uint8_t, 2 * RECOVERY_CHECK_BYTES> window = {};
+    if (window_end > window_start) {
+        esp_err_t result = esp_partition_read(partition, region_offset + window_start, window.data(), window_end - window_start);
+        if (result != ESP_OK) {
+            return result;
+        }
+    }
+
+    bool ok = true;
+    uint32_t partial_bits = 0;
+    for (uint32_t index = window_start; index < window_end; ++index) {
+        const uint8_t value = window[index - window_start];
+        if (index < boundary) {
+            ok = ok && value == 0x00;
+        } else if (index == boundary) {
+            // Vynulovane bity musi tvorit souvisly blok od bitu 0.
+            const uint32_t cleared = static_cast<uint32_t>(~value & 0xFF);
+            ok = ok && (cleared & (cleared + 1)) == 0;
+            partial_bits = static_cast<uint32_t>(__builtin_popcount(cleared));
+        } else {
+            ok = ok && value == 0xFF;
+        }
+    }
+
+    *used_bits = boundary * 8 + partial_bits;
+    *consistent = ok;
+    return ESP_OK;
+}
+
+esp_err_t FlashMonotonicCounter::scan_cleared_bits_(const esp_partition_t *partition,
+                                                    uint32_t region_offset,
+                                                    uint32_t region_size,
+                                                    uint32_t *used_bits)
 {
     std::array<uint8_t, SCAN_CHUNK_SIZE> buffer = {};
-    used_bits_ = 0;
+    uint32_t cleared = 0;
 
     size_t offset = 0;
-    while (offset < partition_->size) {
-        const size_t bytes_to_read = std::min<size_t>(buffer.size(), static_cast<size_t>(partition_->size) - offset);
-        esp_err_t result = esp_partition_read(partition_, offset, buffer.data(), bytes_to_read);
+    while (offset < region_size) {
+        const size_t bytes_to_read = std::min<size_t>(buffer.size(), static_cast<size_t>(region_size) - offset);
+        esp_err_t result = esp_partition_read(partition, region_offset + offset, buffer.data(), bytes_to_read);
         if (result != ESP_OK) {
             return result;
         }
 
         for (size_t i = 0; i < bytes_to_read; ++i) {
-            used_bits_ += __builtin_popcount(static_cast<unsigned int>(~buffer[i] & 0xFF));
+            cleared += __builtin_popcount(static_cast<unsigned int>(~buffer[i] & 0xFF));
         }
 
         offset += bytes_to_read;
     }
 
+    *used_bits = cleared;
     return ESP_OK;
 }
 
-esp_err_t FlashMonotonicCounter::clear_bits_range_(uint32_t start_bit, uint32_t bit_count)
+esp_err_t FlashMonotonicCounter::clear_bits(const esp_partition_t *partition,
+                                            uint32_t region_offset,
+                                            uint32_t start_bit,
+                                            uint32_t bit_count)
 {
-    if (bit_count == 0) {
-        return ESP_OK;
-    }
-
-    if (start_bit >= total_bits_ || bit_count > (total_bits_ - start_bit)) {
+    if (partition == nullptr) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    const uint32_t start_byte = start_bit / 8;
-    const uint32_t end_bit = start_bit + bit_count;
-    const uint32_t end_byte = (end_bit + 7) / 8;
-    const uint32_t bytes_to_write = end_byte - start_byte;
-
     std::array<uint8_t, WRITE_CHUNK_SIZE> buffer = {};
-    if (bytes_to_write > buffer.size()) {
-        return ESP_ERR_INVALID_SIZE;
-    }
 
-    esp_err_t read_result = esp_partition_read(partition_, start_byte, buffer.data(), bytes_to_write);
-    if (read_result != ESP_OK) {
-        return read_result;
-    }
+    // Bity pred start_bit uz jsou vynulovane (bitmapa se plni po poradi), takze obsah
+    // zasazenych bajtu je dany jen koncem bloku a z flash se necte: plne bajty 0x00,
+    // posledni rozpracovany bajt ma vynulovane dolni bity. Zapisuji se jen tyto bajty,
+    // po blocich nejvyse WRITE_CHUNK_SIZE bajtu; pro bezny prirustek je to jeden bajt.
+    while (bit_count > 0) {
+        const uint32_t start_byte = start_bit / 8;
+        const uint32_t chunk_end_bit = std::min<uint32_t>(start_bit + bit_count, (start_byte + WRITE_CHUNK_SIZE) * 8);
+        const uint32_t end_byte = (chunk_end_bit + 7) / 8;
+        const uint32_t bytes_to_write = end_byte - start_byte;
+
+        std::memset(buffer.data(), 0x00, bytes_to_write);
+        if (chunk_end_bit % 8 != 0) {
+            buffer[bytes_to_write - 1] = static_cast<uint8_t>(0xFFu << (chunk_end_bit % 8));
+        }
 
-    for (uint32_t byte_offset = 0; byte_offset < bytes_to_write; ++byte_offset) {
-        const uint32_t abs_byte = start_byte + byte_offset;
-        const uint32_t byte_first_bit = abs_byte * 8;
-        const uint32_t clear_from = std::max(start_bit, byte_first_bit);
-        const uint32_t clear_to = std::min(end_bit, byte_first_bit + 8);
+        esp_err_t write_result = esp_partition_write(partition, region_offset + start_byte, buffer.data(), bytes_to_write);
+        if (write_result != ESP_OK) {
+            return write_result;
+        }
 
-        for (uint32_t bit = clear_from; bit < clear_to; ++bit) {
-            buffer[byte_offset] = static_cast<uint8_t>(buffer[byte_offset] & ~(1U << (bit - byte_first_bit)));
+#if FLASH_MONOTONIC_COUNTER_VERIFY_WRITES
+        esp_err_t verify_result = verify_written_bytes_(partition, region_offset + start_byte, buffer.data(), bytes_to_write);
+        if (verify_result != ESP_OK) {
+            return verify_result;
         }
-    }
+#endif
 
-    esp_err_t write_result = esp_partition_write(partition_, start_byte, buffer.data(), bytes_to_write);
-    if (write_result != ESP_OK) {
-        return write_result;
+        bit_count -= chunk_end_bit - start_bit;
+        start_bit = chunk_end_bit;
     }
 
-#if FLASH_MONOTONIC_COUNTER_VERIFY_WRITES
-    return verify_written_bytes_(start_byte, buffer.data(), bytes_to_write);
-#else
     return ESP_OK;
-#endif
 }
 
-esp_err_t FlashMonotonicCounter::verify_written_bytes_(uint32_t start_byte, const uint8_t *expected, uint32_t bytes_to_check)
+esp_err_t FlashMonotonicCounter::verify_written_bytes_(const esp_partition_t *partition,
+                                                       uint32_t start_byte,
+                                                       const uint8_t *expected,
+                                                       uint32_t bytes_to_check)
 {
     if (expected == nullptr || bytes_to_check == 0) {
         return ESP_ERR_INVALID_ARG;
@@ -335,7 +746,7 @@ esp_err_t FlashMonotonicCounter::verify_written_bytes_(uint32_t start_byte, cons
         return ESP_ERR_INVALID_SIZE;
     }
 
-    esp_err_t read_result = esp_partition_read(partition_, start_byte, verify_buffer.data(), bytes_to_check);
+    esp_err_t read_result = esp_partition_read(partition, start_byte, verify_buffer.data(), bytes_to_check);
     if (read_result != ESP_OK) {
         return read_result;
     }
@@ -364,6 +775,10 @@ esp_err_t FlashMonotonicCounter::verify_written_bytes_(uint32_t start_byte, cons
 
 esp_err_t FlashMonotonicCounter::rollover_()
 {
+    if (dual_bank_) {
+        return rollover_dual_bank_();
+    }
+
     const int64_t new_base = signed_value_();
 
     ESP_LOGI(TAG, "Rollover: base=%lld used_bits=%lu total_bits=%lu new_base=%lld",
@@ -377,7 +792,7 @@ esp_err_t FlashMonotonicCounter::rollover_()
         return result;
     }
 
-    result = esp_partition_erase_range(partition_, 0, partition_->size);
+    result = esp_partition_erase_range(partition_, region_offset_, region_size_);
     if (result != ESP_OK) {
         return result;
     }
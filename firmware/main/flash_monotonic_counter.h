@@ -11,11 +11,35 @@ public:
     FlashMonotonicCounter();
 
     esp_err_t init(const char *partition_label);
+    // Citac jen v casti oddilu; offset a size musi byt zarovnane na erase sektor.
+    esp_err_t init(const char *partition_label, uint32_t region_offset, uint32_t region_size);
+    // Format A/B bez NVS: oblast (sudy pocet sektoru, aspon 2) se deli na dve banky, kazda
+    // s hlavickou {magic, sekvence, zaklad, CRC} a bitmapou. Plati platna hlavicka s vyssi
+    // sekvenci. Preteceni zapise novou hlavicku do druhe (smazane) banky a teprve pak
+    // se stara banka maze, po sektorech pres erase_step().
+    esp_err_t init_dual_bank(const char *partition_label, uint32_t region_offset, uint32_t region_size);
     esp_err_t increment(uint32_t steps = 1);
     esp_err_t reset();
 
     uint64_t value() const;
 
+    // Mazani stare banky po preteceni (jen format A/B). Vlastnik vola erase_step() v klidu,
+    // jeden sektor na volani; kdyz banka neni smazana pri dalsim preteceni, domaze se hned.
+    bool erase_pending() const;
+    esp_err_t erase_step();
+
+    // Bitmapove operace nad oblasti oddilu (bity se nuluji postupne od zacatku oblasti),
+    // sdilene s FlashTieredCounter. count_cleared_bits hleda hranici pulenim intervalu
+    // (O(log n) cteni) a pri nekonzistenci okoli hranice prejde na plny sken oblasti.
+    static esp_err_t count_cleared_bits(const esp_partition_t *partition,
+                                        uint32_t region_offset,
+                                        uint32_t region_size,
+                                        uint32_t *used_bits);
+    static esp_err_t clear_bits(const esp_partition_t *partition,
+                                uint32_t region_offset,
+                                uint32_t start_bit,
+                                uint32_t bit_count);
+
 private:
     esp_err_t derive_nvs_keys_from_partition_label_(const char *partition_label);
     esp_err_t load_base_from_nvs_();
@@ -23,11 +47,31 @@ private:
     esp_err_t save_rollover_state_to_nvs_(int64_t base_value, bool pending) const;
     int64_t signed_value_() const;
     esp_err_t count_zero_bits_in_partition_();
+    static esp_err_t find_cleared_boundary_(const esp_partition_t *partition,
+                                            uint32_t region_offset,
+                                            uint32_t region_size,
+                                            uint32_t *used_bits,
+                                            bool *consistent);
+    static esp_err_t scan_cleared_bits_(const esp_partition_t *partition,
+                                        uint32_t region_offset,
+                                        uint32_t region_size,
+                                        uint32_t *used_bits);
     esp_err_t clear_bits_range_(uint32_t start_bit, uint32_t bit_count);
-    esp_err_t verify_written_bytes_(uint32_t start_byte, const uint8_t *expected, uint32_t bytes_to_check);
+    static esp_err_t verify_written_bytes_(const esp_partition_t *partition,
+                                           uint32_t start_byte,
+                                           const uint8_t *expected,
+                                           uint32_t bytes_to_check);
     esp_err_t rollover_();
+    esp_err_t find_partition_(const char *partition_label, uint32_t *region_offset, uint32_t *region_size);
+    uint32_t bitmap_offset_() const;
+    uint32_t bank_offset_(uint8_t bank) const;
+    esp_err_t write_bank_header_(uint8_t bank, uint32_t seq, int64_t base);
+    esp_err_t create_dual_bank_();
+    esp_err_t rollover_dual_bank_();
 
     const esp_partition_t *partition_;
+    uint32_t region_offset_;
+    uint32_t region_size_;
     std::array<char, 16> nvs_base_key_;
     std::array<char, 16> nvs_pending_key_;
 
@@ -35,4 +79,11 @@ private:
     uint32_t used_bits_;
     uint32_t total_bits_;
     bool initialized_;
+
+    bool dual_bank_;
+    uint32_t bank_size_;
+    uint8_t active_bank_;
+    uint32_t bank_seq_;
+    bool erase_pending_;
+    uint32_t erase_sector_;
 };
@@ -0,0 +1,376 @@
+#include "flash_tiered_counter.h"
+
+extern "C" {
+#include "nvs.h"
+#include "esp_log.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+constexpr const char *NVS_NAMESPACE = "flash_ctr";
+constexpr const char *TAG = "tiered";
+constexpr uint8_t TIERED_FORMAT_VERSION = 1;        // hruba uroven s NVS (FlashMonotonicCounter::init)
+constexpr uint8_t TIERED_FORMAT_DUAL_BANK = 2;      // hruba uroven A/B bez NVS (init_dual_bank)
+constexpr uint32_t FINE_HEADER_MAGIC = 0x46544331; // "FTC1"
+
+// Hlavicka jemneho sektoru; bitmapa zacina hned za ni.
+struct fine_header_t {
+    uint32_t magic;
+    uint32_t epoch;
+    uint32_t epoch_check;
+    uint32_t reserved;
+};
+
+constexpr uint32_t FINE_HEADER_SIZE = sizeof(fine_header_t);
+
+uint32_t fnv1a32(const char *text)
+{
+    uint32_t hash = 2166136261u;
+    while (*text != '\0') {
+        hash ^= static_cast<uint8_t>(*text);
+        hash *= 16777619u;
+        ++text;
+    }
+    return hash;
+}
+}
+
+FlashTieredCounter::FlashTieredCounter()
+    : partition_(nullptr),
+      coarse_(),
+      nvs_format_key_{},
+      nvs_migration_key_{},
+      sector_size_(0),
+      fine_capacity_bits_(0),
+      fine_used_bits_(0),
+      format_(0),
+      initialized_(false)
+{
+}
+
+esp_err_t FlashTieredCounter::init(const char *partition_label, uint32_t legacy_scale)
+{
+    if (partition_label == nullptr || partition_label[0] == '\0' || legacy_scale == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    partition_ = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA,
+        ESP_PARTITION_SUBTYPE_ANY,
+        partition_label);
+    if (partition_ == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sector_size_ = partition_->erase_size;
+    if (sector_size_ <= FINE_HEADER_SIZE || partition_->size < 2 * sector_size_) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    fine_capacity_bits_ = (sector_size_ - FINE_HEADER_SIZE) * 8;
+
+    esp_err_t result = derive_nvs_keys_(partition_label);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    uint8_t format = 0;
+    bool migration_found = false;
+    uint64_t migration_value = 0;
+    result = load_format_(&format, &migration_found, &migration_value);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    if (format != TIERED_FORMAT_VERSION && format != TIERED_FORMAT_DUAL_BANK) {
+        // Format A/B potrebuje vedle jemneho sektoru aspon dve banky po sektoru.
+        format_ = partition_->size / sector_size_ >= 3 ? TIERED_FORMAT_DUAL_BANK : TIERED_FORMAT_VERSION;
+        if (!migration_found) {
+            // Puvodni citac pres cely oddil; jeho hodnota se nejdriv ulozi do NVS,
+            // teprve pak se oddil smaze.
+            FlashMonotonicCounter legacy;
+            result = legacy.init(partition_label);
+            if (result != ESP_OK) {
+                return result;
+            }
+            migration_value = legacy.value() * legacy_scale;
+            result = save_migration_value_(migration_value);
+            if (result != ESP_OK) {
+                return result;
+            }
+        }
+        result = migrate_legacy_(partition_label, migration_value);
+    } else {
+        format_ = format;
+        result = init_coarse_(partition_label);
+        if (result == ESP_OK) {
+            result = recover_fine_();
+        }
+    }
+
+    initialized_ = (result == ESP_OK);
+    return result;
+}
+
+esp_err_t FlashTieredCounter::increment(uint32_t steps)
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t remaining_steps = steps;
+    while (remaining_steps > 0) {
+        if (fine_used_bits_ >= fine_capacity_bits_) {
+            esp_err_t roll_result = roll_up_();
+            if (roll_result != ESP_OK) {
+                return roll_result;
+            }
+        }
+
+        const uint32_t block_bits = std::min<uint32_t>(remaining_steps, fine_capacity_bits_ - fine_used_bits_);
+        esp_err_t clear_result = FlashMonotonicCounter::clear_bits(partition_, FINE_HEADER_SIZE, fine_used_bits_, block_bits);
+        if (clear_result != ESP_OK) {
+            // Cast bloku uz mohla byt zapsana; value() musi odpovidat flash.
+            FlashMonotonicCounter::count_cleared_bits(partition_, FINE_HEADER_SIZE, sector_size_ - FINE_HEADER_SIZE, &fine_used_bits_);
+            return clear_result;
+        }
+
+        fine_used_bits_ += block_bits;
+        remaining_steps -= block_bits;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t FlashTieredCounter::reset()
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t result = coarse_.reset();
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    return start_fine_epoch_();
+}
+
+uint64_t FlashTieredCounter::value() const
+{
+    return coarse_.value() * fine_capacity_bits_ + fine_used_bits_;
+}
+
+uint32_t FlashTieredCounter::fineCapacity() const
+{
+    return fine_capacity_bits_;
+}
+
+bool FlashTieredCounter::erasePending() const
+{
+    return initialized_ && coarse_.erase_pending();
+}
+
+esp_err_t FlashTieredCounter::eraseStep()
+{
+    return initialized_ ? coarse_.erase_step() : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t FlashTieredCounter::init_coarse_(const char *partition_label)
+{
+    if (format_ == TIERED_FORMAT_DUAL_BANK) {
+        const uint32_t bank_sectors = (partition_->size / sector_size_ - 1) / 2;
+        return coarse_.init_dual_bank(partition_label, sector_size_, 2 * bank_sectors * sector_size_);
+    }
+    return coarse_.init(partition_label, sector_size_, partition_->size - sector_size_);
+}
+
+esp_err_t FlashTieredCounter::derive_nvs_keys_(const char *partition_label)
+{
+    const uint32_t hash = fnv1a32(partition_label);
+
+    const int format_written = std::snprintf(
+        nvs_format_key_.data(),
+        nvs_format_key_.size(),
+        "f_%08lx",
+        static_cast<unsigned long>(hash));
+    const int migration_written = std::snprintf(
+        nvs_migration_key_.data(),
+        nvs_migration_key_.size(),
+        "m_%08lx",
+        static_cast<unsigned long>(hash));
+
+    if (format_written <= 0 || static_cast<size_t>(format_written) >= nvs_format_key_.size()) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (migration_written <= 0 || static_cast<size_t>(migration_written) >= nvs_migration_key_.size()) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t FlashTieredCounter::load_format_(uint8_t *format, bool *migration_found, uint64_t *migration_value) const
+{
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    result = nvs_get_u8(handle, nvs_format_key_.data(), format);
+    if (result == ESP_ERR_NVS_NOT_FOUND) {
+        *format = 0;
+        result = ESP_OK;
+    }
+
+    if (result == ESP_OK) {
+        result = nvs_get_u64(handle, nvs_migration_key_.data(), migration_value);
+        *migration_found = (result == ESP_OK);
+        if (result == ESP_ERR_NVS_NOT_FOUND) {
+            result = ESP_OK;
+        }
+    }
+
+    nvs_close(handle);
+    return result;
+}
+
+esp_err_t FlashTieredCounter::save_migration_value_(uint64_t migration_value) const
+{
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    result = nvs_set_u64(handle, nvs_migration_key_.data(), migration_value);
+    if (result == ESP_OK) {
+        result = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return result;
+}
+
+esp_err_t FlashTieredCounter::finish_migration_() const
+{
+    nvs_handle_t handle = 0;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    result = nvs_set_u8(handle, nvs_format_key_.data(), format_);
+    if (result == ESP_OK) {
+        result = nvs_erase_key(handle, nvs_migration_key_.data());
+        if (result == ESP_ERR_NVS_NOT_FOUND) {
+            result = ESP_OK;
+        }
+    }
+    if (result == ESP_OK) {
+        result = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return result;
+}
+
+// Sestavi novy format s hodnotou migration_value. Po vypadku se cela migrace zopakuje
+// z hodnoty v NVS, proto smi oddil vzdy smazat.
+esp_err_t FlashTieredCounter::migrate_legacy_(const char *partition_label, uint64_t migration_value)
+{
+    ESP_LOGW(TAG, "Prevod %s na dvouurovnovy format: hodnota=%llu",
+             partition_label,
+             (unsigned long long)migration_value);
+
+    // reset() smaze hrubou cast, start_fine_epoch_() jemny sektor.
+    esp_err_t result = init_coarse_(partition_label);
+    if (result == ESP_OK) {
+        result = coarse_.reset();
+    }
+
+    const uint64_t coarse_steps = migration_value / fine_capacity_bits_;
+    for (uint64_t done = 0; result == ESP_OK && done < coarse_steps;) {
+        const uint32_t block = static_cast<uint32_t>(std::min<uint64_t>(coarse_steps - done, UINT32_MAX));
+        result = coarse_.increment(block);
+        done += block;
+    }
+
+    if (result == ESP_OK) {
+        result = start_fine_epoch_();
+    }
+
+    const uint32_t fine_steps = static_cast<uint32_t>(migration_value % fine_capacity_bits_);
+    if (result == ESP_OK && fine_steps > 0) {
+        result = FlashMonotonicCounter::clear_bits(partition_, FINE_HEADER_SIZE, 0, fine_steps);
+        fine_used_bits_ = fine_steps;
+    }
+
+    if (result == ESP_OK) {
+        result = finish_migration_();
+    }
+
+    return result;
+}
+
+esp_err_t FlashTieredCounter::recover_fine_()
+{
+    fine_header_t header = {};
+    esp_err_t result = esp_partition_read(partition_, 0, &header, sizeof(header));
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    const uint32_t coarse_epoch = static_cast<uint32_t>(coarse_.value());
+    const bool header_valid = header.magic == FINE_HEADER_MAGIC && header.epoch_check == ~header.epoch;
+
+    if (header_valid && header.epoch == coarse_epoch) {
+        return FlashMonotonicCounter::count_cleared_bits(partition_,
+                                                         FINE_HEADER_SIZE,
+                                                         sector_size_ - FINE_HEADER_SIZE,
+                                                         &fine_used_bits_);
+    }
+
+    // Hruba uroven uz sektor zapocitala (nebo se sektor po smazani nestihl zalozit).
+    if (header_valid && header.epoch + 1U == coarse_epoch) {
+        ESP_LOGW(TAG, "Dokoncuji prerusene preneseni jemneho sektoru, epocha=%lu", (unsigned long)coarse_epoch);
+    } else {
+        ESP_LOGW(TAG, "Neplatna hlavicka jemneho sektoru (magic=0x%08lx epoch=%lu, hruba=%lu), zakladam znovu",
+                 (unsigned long)header.magic,
+                 (unsigned long)header.epoch,
+                 (unsigned long)coarse_epoch);
+    }
+    return start_fine_epoch_();
+}
+
+esp_err_t FlashTieredCounter::start_fine_epoch_()
+{
+    esp_err_t result = esp_partition_erase_range(partition_, 0, sector_size_);
+    if (result != ESP_OK) {
+        return result;
+    }
+    fine_used_bits_ = 0;
+
+    const uint32_t epoch = static_cast<uint32_t>(coarse_.value());
+    const fine_header_t header = {
+        .magic = FINE_HEADER_MAGIC,
+        .epoch = epoch,
+        .epoch_check = ~epoch,
+        .reserved = 0xFFFFFFFFu,
+    };
+    return esp_partition_write(partition_, 0, &header, sizeof(header));
+}
+
+esp_err_t FlashTieredCounter::roll_up_()
+{
+    ESP_LOGI(TAG, "Preneseni jemneho sektoru: hruba=%llu", (unsigned long long)coarse_.value());
+
+    esp_err_t result = coarse_.increment(1);
+    if (result != ESP_OK) {
+        return result;
+    }
+
+    return start_fine_epoch_();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "flash_monotonic_counter.h"
+
+/**
+ * Dvouurovnovy monotonni citac v jednom oddilu.
+ *
+ * Prvni sektor je jemna uroven: hlavicka s epochou a bitmapa, kazdy vynulovany bit je jeden
+ * krok (napr. 0.1 l). Zbytek oddilu je hruba uroven (FlashMonotonicCounter ve vyrezu oddilu),
+ * kazdy jeji bit je jeden cely jemny sektor. Hodnota = hruba * kapacita_sektoru + jemne bity.
+ *
+ * Preneseni plneho jemneho sektoru: nejdriv +1 v hrube urovni, pak smazani jemneho sektoru
+ * a zapis hlavicky s epochou = nova hruba hodnota. Po vypadku uprostred se podle epochy pozna,
+ * ze jemny sektor je uz zapocitany, a jen se zalozi znovu.
+ *
+ * Pri prvnim startu se hodnota puvodniho FlashMonotonicCounter pres cely oddil prevede
+ * (krat legacy_scale) do noveho formatu; postup je v NVS, takze preziji i vypadek.
+ * Oddil s aspon 3 sektory dostane pri zalozeni hrubou uroven ve formatu A/B bez NVS
+ * (FlashMonotonicCounter::init_dual_bank); jeji starou banku maze eraseStep().
+ *
+ * Priklad:
+ *   FlashTieredCounter counter;
+ *   counter.init("flow_data0", 10);   // puvodni citac pocital litry, novy decilitry
+ *   counter.increment(37);
+ *   const uint64_t decilitry = counter.value();
+ */
+class FlashTieredCounter {
+public:
+    FlashTieredCounter();
+
+    esp_err_t init(const char *partition_label, uint32_t legacy_scale);
+    esp_err_t increment(uint32_t steps = 1);
+    esp_err_t reset();
+
+    uint64_t value() const;
+    uint32_t fineCapacity() const;
+
+    // Mazani po preteceni hrube urovne (jen format A/B), jeden sektor na volani.
+    bool erasePending() const;
+    esp_err_t eraseStep();
+
+private:
+    esp_err_t derive_nvs_keys_(const char *partition_label);
+    esp_err_t load_format_(uint8_t *format, bool *migration_found, uint64_t *migration_value) const;
+    esp_err_t save_migration_value_(uint64_t migration_value) const;
+    esp_err_t finish_migration_() const;
+    esp_err_t init_coarse_(const char *partition_label);
+    esp_err_t migrate_legacy_(const char *partition_label, uint64_t migration_value);
+    esp_err_t recover_fine_();
+    esp_err_t start_fine_epoch_();
+    esp_err_t roll_up_();
+
+    const esp_partition_t *partition_;
+    FlashMonotonicCounter coarse_;
+    std::array<char, 16> nvs_format_key_;
+    std::array<char, 16> nvs_migration_key_;
+
+    uint32_t sector_size_;
+    uint32_t fine_capacity_bits_;
+    uint32_t fine_used_bits_;
+    uint8_t format_;
+    bool initialized_;
+};
@@ -0,0 +1,180 @@
+#include "flow_pulse_source.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/gpio.h"
+#if FLOW_PULSE_BACKEND_PCNT
+#include "driver/pulse_cnt.h"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "pins.h"
+#include "app_error_check.h"
+#include "sensor_trace.h"
+#include "pulse_ring.hpp"
+
+#define TAG "flow_pulse"
+
+static_assert(FLOW_PCNT_DECIMATION >= 1 && FLOW_PCNT_DECIMATION <= 32767, "FLOW_PCNT_DECIMATION mimo rozsah PCNT");
+
+// Casy zachycenych impulsu (ISR -> task). U GPIO backendu je sekvence zaroven pocet impulsu,
+// u PCNT backendu pocet dosazenych watch pointu.
+static PulseTimestampRing<FLOW_PULSE_SOURCE_MAX_TIMESTAMPS> s_pulse_ring;
+
+#if !FLOW_PULSE_BACKEND_PCNT
+
+static void IRAM_ATTR flow_isr_handler(void *arg)
+{
+    (void)arg;
+    const uint32_t timestamp = (uint32_t)esp_timer_get_time();
+
+    s_pulse_ring.push(timestamp);
+
+    sensor_trace_record_isr(SENSOR_TRACE_CH_FLOW_PULSE, timestamp);
+}
+
+void flow_pulse_source_init(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << FLOW_SENSOR_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE
+    };
+    APP_ERROR_CHECK("E711", gpio_config(&io_conf));
+
+    APP_ERROR_CHECK("E712", gpio_install_isr_service(0));
+    APP_ERROR_CHECK("E713", gpio_isr_handler_add(FLOW_SENSOR_GPIO, flow_isr_handler, NULL));
+
+    ESP_LOGI(TAG,
+             "GPIO flow nastaven: pullup=1 pulldown=0 intr=posedge pin=%d",
+             (int)FLOW_SENSOR_GPIO);
+}
+
+const char *flow_pulse_source_name(void)
+{
+    return "gpio_isr";
+}
+
+uint32_t flow_pulse_source_total(void)
+{
+    return s_pulse_ring.sequence();
+}
+
+uint32_t flow_pulse_source_pulses_per_timestamp(void)
+{
+    return 1;
+}
+
+#else // FLOW_PULSE_BACKEND_PCNT
+
+static pcnt_unit_handle_t s_pcnt_unit = nullptr;
+static pcnt_channel_handle_t s_pcnt_channel = nullptr;
+static uint32_t s_last_total = 0;
+
+// Citac PCNT se pri dosazeni high_limit sam vynuluje a zaroven vyvola watch point.
+static bool IRAM_ATTR flow_pcnt_on_reach(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t *edata, void *user_ctx)
+{
+    (void)unit;
+    (void)edata;
+    (void)user_ctx;
+
+    s_pulse_ring.push((uint32_t)esp_timer_get_time());
+    return false;
+}
+
+void flow_pulse_source_init(void)
+{
+    const gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << FLOW_SENSOR_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    APP_ERROR_CHECK("E711", gpio_config(&io_conf));
+
+    pcnt_unit_config_t unit_config = {};
+    unit_config.low_limit = -1;
+    unit_config.high_limit = FLOW_PCNT_DECIMATION;
+    APP_ERROR_CHECK("E744", pcnt_new_unit(&unit_config, &s_pcnt_unit));
+
+    const pcnt_glitch_filter_config_t filter_config = {
+        .max_glitch_ns = FLOW_PCNT_GLITCH_NS,
+    };
+    APP_ERROR_CHECK("E745", pcnt_unit_set_glitch_filter(s_pcnt_unit, &filter_config));
+
+    pcnt_chan_config_t channel_config = {};
+    channel_config.edge_gpio_num = FLOW_SENSOR_GPIO;
+    channel_config.level_gpio_num = -1;
+    APP_ERROR_CHECK("E746", pcnt_new_channel(s_pcnt_unit, &channel_config, &s_pcnt_channel));
+    APP_ERROR_CHECK("E747",
+                    pcnt_channel_set_edge_action(s_pcnt_channel,
+                                                 PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                                 PCNT_CHANNEL_EDGE_ACTION_HOLD));
+
+    APP_ERROR_CHECK("E748", pcnt_unit_add_watch_point(s_pcnt_unit, FLOW_PCNT_DECIMATION));
+    const pcnt_event_callbacks_t callbacks = {
+        .on_reach = flow_pcnt_on_reach,
+    };
+    APP_ERROR_CHECK("E749", pcnt_unit_register_event_callbacks(s_pcnt_unit, &callbacks, nullptr));
+
+    APP_ERROR_CHECK("E750", pcnt_unit_enable(s_pcnt_unit));
+    APP_ERROR_CHECK("E751", pcnt_unit_clear_count(s_pcnt_unit));
+    APP_ERROR_CHECK("E752", pcnt_unit_start(s_pcnt_unit));
+
+    ESP_LOGI(TAG,
+             "PCNT flow nastaven: pin=%d glitch_ns=%d decimace=%d",
+             (int)FLOW_SENSOR_GPIO,
+             (int)FLOW_PCNT_GLITCH_NS,
+             (int)FLOW_PCNT_DECIMATION);
+}
+
+const char *flow_pulse_source_name(void)
+{
+    return "pcnt";
+}
+
+uint32_t flow_pulse_source_total(void)
+{
+    uint32_t blocks = 0;
+    int count = 0;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        blocks = s_pulse_ring.sequence();
+        if (pcnt_unit_get_count(s_pcnt_unit, &count) != ESP_OK) {
+            return s_last_total;
+        }
+        if (s_pulse_ring.sequence() == blocks) {
+            break;
+        }
+    }
+
+    // Mezi vynulovanim citace a obsluhou watch pointu muze soucet na okamzik klesnout
+    // o jeden blok; takovy odecet se ignoruje, aby celkovy pocet nikdy necouval.
+    const uint32_t total = blocks * (uint32_t)FLOW_PCNT_DECIMATION + (uint32_t)(count > 0 ? count : 0);
+    if ((int32_t)(total - s_last_total) > 0) {
+        s_last_total = total;
+    }
+    return s_last_total;
+}
+
+uint32_t flow_pulse_source_pulses_per_timestamp(void)
+{
+    return FLOW_PCNT_DECIMATION;
+}
+
+#endif // FLOW_PULSE_BACKEND_PCNT
+
+uint32_t flow_pulse_source_snapshot(uint32_t *out, uint32_t max_count, uint32_t *sequence)
+{
+    return s_pulse_ring.snapshot(out, max_count, sequence);
+}
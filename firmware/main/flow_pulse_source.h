@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+// Zdroj impulsu prutokomeru, backend se voli v dobe prekladu:
+// - FLOW_PULSE_BACKEND_PCNT=0 (vychozi): GPIO preruseni na kazdou nabeznou hranu,
+//   cas kazdeho impulsu jde do lock-free bufferu.
+// - FLOW_PULSE_BACKEND_PCNT=1: hrany pocita periferie PCNT s glitch filtrem, preruseni
+//   prijde jen pri dosazeni watch pointu (kazdy FLOW_PCNT_DECIMATION-ty impuls) a do
+//   bufferu jde cas jen tohoto impulsu. Celkovy pocet je presny, preruseni je N-krat mene.
+// Firmware ho nastavuje pres option() v main/CMakeLists.txt (idf.py build -DFLOW_PULSE_BACKEND_PCNT=ON),
+// vychozi hodnota nize plati pro hostove nastroje.
+#ifndef FLOW_PULSE_BACKEND_PCNT
+#define FLOW_PULSE_BACKEND_PCNT 0
+#endif
+
+// Kazdy kolikaty impuls vyvola preruseni a zapise cas (jen PCNT backend).
+#ifndef FLOW_PCNT_DECIMATION
+#define FLOW_PCNT_DECIMATION 4
+#endif
+
+// Impulsy kratsi nez tato doba PCNT ignoruje (ESP32: max ~12.7 us pri APB 80 MHz).
+#ifndef FLOW_PCNT_GLITCH_NS
+#define FLOW_PCNT_GLITCH_NS 10000
+#endif
+
+static constexpr uint32_t FLOW_PULSE_SOURCE_MAX_TIMESTAMPS = 128;
+
+// Nastavi GPIO / PCNT a spusti pocitani. Pri chybe zastavi start (APP_ERROR_CHECK).
+void flow_pulse_source_init(void);
+
+const char *flow_pulse_source_name(void);
+
+// Volne bezici pocet vsech impulsu (modulo 2^32), neklesa. Jen pro merici task.
+uint32_t flow_pulse_source_total(void);
+
+// Kolik impulsu odpovida jednomu intervalu mezi sousednimi casy ze snapshotu (1 nebo decimace).
+uint32_t flow_pulse_source_pulses_per_timestamp(void);
+
+// Zkopiruje posledni casy zachycenych impulsu (dolnich 32 bitu esp_timer_get_time(),
+// out[0] nejstarsi) a vrati jejich pocet. *sequence = pocet vsech zachycenych casu.
+uint32_t flow_pulse_source_snapshot(uint32_t *out, uint32_t max_count, uint32_t *sequence);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Odhad prutoku z casu impulsu s promennym oknem a nejistotou.
+ *
+ * Okno se bere od nejnovejsiho impulsu zpet, dokud nema target_pulses impulsu (vysoky prutok,
+ * kratke okno a rychla odezva) nebo dokud nepokryje max_window_us (nizky prutok, okno
+ * omezene casem). Dokud je posledni impuls mladsi nez ocekavany interval T (plus 2 sigma
+ * jitteru), plati rychlost z okna. Pak je rychlost shora omezena 1/stari, protoze dalsi
+ * impuls zatim neprisel.
+ * Odhad tak plynule klesa k nule a po zero_intervals * T (v mezich zero_min_us..zero_max_us)
+ * spadne na 0.
+ *
+ * Nejistota (1 sigma, v impulsech/s) se pocita z variacniho koeficientu intervalu v okne
+ * deleneho sqrt(poctu intervalu). Pri poklesu se k ni pricte rozdil proti rychlosti z okna.
+ *
+ * Casy jsou dolnich 32 bitu mikrosekund a rozdily se pocitaji modulo 2^32.
+ *
+ * Priklad:
+ *   FlowRateEstimator estimator(FlowRateEstimator::Config{16, 4000000, 1000000, 3000000, 4.0f, 0.05f});
+ *   const FlowRateEstimator::Estimate e = estimator.estimate(ts, count, 1, (uint32_t)now_us);
+ *   const float l_min = e.pulses_per_s * 60.0f / pulses_per_liter;
+ */
+class FlowRateEstimator
+{
+public:
+    struct Config {
+        uint32_t target_pulses;     // kolik impulsu staci do okna pri vysokem prutoku
+        uint32_t max_window_us;     // nejdelsi okno pri nizkem prutoku
+        uint32_t zero_min_us;       // nejkratsi doba bez impulsu pro nulu
+        uint32_t zero_max_us;       // nejdelsi doba bez impulsu pro nulu
+        float zero_intervals;       // nula po tolika ocekavanych intervalech bez impulsu
+        float min_cv;               // spodni mez variacniho koeficientu (nesymetrie cidla)
+    };
+
+    struct Estimate {
+        float pulses_per_s;         // 0 = stoji
+        float uncertainty_per_s;    // 1 sigma
+        float confidence;           // 0..1, 1 - relativni nejistota
+        uint32_t window_pulses;     // impulsu pouzitych v okne
+        uint32_t window_us;
+        bool decaying;              // dalsi impuls je po case, odhad je omezeny starim
+    };
+
+    explicit FlowRateEstimator(const Config &config) : config_(config)
+    {
+    }
+
+    // timestamps: nejstarsi prvni, kazdy cas odpovida pulses_per_timestamp impulsum (decimace).
+    Estimate estimate(const uint32_t *timestamps, uint32_t count, uint32_t pulses_per_timestamp, uint32_t now_us) const
+    {
+        Estimate result = {0.0f, 0.0f, 0.0f, 0, 0, false};
+        if (count < 2 || pulses_per_timestamp == 0) {
+            return result;
+        }
+
+        // U decimovanych casu muze byt posledni cas az o N impulsu starsi; skutecne zastaveni
+        // pak hlida volajici podle celkoveho poctu impulsu.
+        const uint32_t zero_max_us = config_.zero_max_us * pulses_per_timestamp;
+        const uint32_t last = timestamps[count - 1U];
+        const uint32_t age_us = now_us - last;
+        if (age_us > zero_max_us) {
+            return zero(age_us, pulses_per_timestamp, result);
+        }
+
+        // Okno: pocet impulsu nebo cas, co nastane driv; aspon jeden interval.
+        uint32_t intervals = 0;
+        uint32_t span_us = 0;
+        for (uint32_t step = 1; step < count; ++step) {
+            const uint32_t candidate_span = last - timestamps[count - 1U - step];
+            if (intervals > 0 && candidate_span > config_.max_window_us) {
+                break;
+            }
+            intervals = step;
+            span_us = candidate_span;
+            if (intervals * pulses_per_timestamp >= config_.target_pulses) {
+                break;
+            }
+        }
+        if (span_us == 0) {
+            return result;
+        }
+
+        const float mean_interval_us = (float)span_us / (float)intervals;
+
+        float zero_after_us = config_.zero_intervals * mean_interval_us;
+        zero_after_us = zero_after_us < (float)config_.zero_min_us ? (float)config_.zero_min_us : zero_after_us;
+        zero_after_us = zero_after_us > (float)zero_max_us ? (float)zero_max_us : zero_after_us;
+        if ((float)age_us > zero_after_us) {
+            return zero(age_us, pulses_per_timestamp, result);
+        }
+
+        float variance = 0.0f;
+        for (uint32_t step = 0; step < intervals; ++step) {
+            const float interval = (float)(timestamps[count - 1U - step] - timestamps[count - 2U - step]);
+            const float diff = interval - mean_interval_us;
+            variance += diff * diff;
+        }
+        float cv = intervals >= 2 ? sqrtf(variance / (float)(intervals - 1U)) / mean_interval_us : 1.0f;
+        cv = cv < config_.min_cv ? config_.min_cv : cv;
+
+        const float scale = 1e6f * (float)pulses_per_timestamp;
+        const float window_rate = scale / mean_interval_us;
+        float rate = window_rate;
+        float uncertainty = window_rate * cv / sqrtf((float)intervals);
+
+        // Jitter hran nesmi spustit pokles: ten zacne az po 2 sigma (max jeden interval)
+        // a navaze spojite na rychlost z okna.
+        const float slack_us = (cv < 0.5f ? 2.0f * cv : 1.0f) * mean_interval_us;
+        if ((float)age_us > mean_interval_us + slack_us) {
+            rate = scale / ((float)age_us - slack_us);
+            uncertainty += window_rate - rate;
+            result.decaying = true;
+        }
+
+        result.pulses_per_s = rate;
+        result.uncertainty_per_s = uncertainty;
+        result.confidence = confidence(rate, uncertainty);
+        result.window_pulses = intervals * pulses_per_timestamp;
+        result.window_us = span_us;
+        return result;
+    }
+
+private:
+    // Po nule muze byt skutecny prutok nanejvys takovy, ze by impuls jeste neprisel;
+    // ta mez je nejistota, samotna nula se povazuje za jistou.
+    static Estimate zero(uint32_t age_us, uint32_t pulses_per_timestamp, Estimate result)
+    {
+        result.uncertainty_per_s = age_us > 0 ? 1e6f * (float)pulses_per_timestamp / (float)age_us : 0.0f;
+        result.confidence = 1.0f;
+        return result;
+    }
+
+    static float confidence(float rate, float uncertainty)
+    {
+        if (!(rate > 0.0f)) {
+            return 0.0f;
+        }
+        const float value = 1.0f - uncertainty / rate;
+        return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    }
+
+    Config config_;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Profil simulatoru prutoku. Sdili ho firmware simulator v prutokomer.cpp (generuje impulsy
+ * na FLOW_SIMULATOR_GPIO) i hostovy simulator tools/flow_sim.cpp (virtualni cas).
+ *
+ * Kazdy krok se prehraje po FLOW_SIMULATOR_PROFILE_UPDATE_MS. V kazdem updatu je nastaveny
+ * prutok linearne mezi start a end, posledni update kroku ma presne end_l_min.
+ *
+ * Priklad:
+ *   const flow_simulator_profile_step_t &step = FLOW_SIMULATOR_PROFILE[i];
+ *   for (uint32_t u = 0; u < flow_simulator_step_updates(step); ++u) {
+ *       nastav(flow_simulator_step_setpoint(step, u));
+ *   }
+ */
+typedef struct {
+    const char *name;
+    float start_l_min;
+    float end_l_min;
+    uint32_t duration_ms;
+} flow_simulator_profile_step_t;
+
+static constexpr uint32_t FLOW_SIMULATOR_PROFILE_UPDATE_MS = 200;
+
+static const flow_simulator_profile_step_t FLOW_SIMULATOR_PROFILE[] = {
+    {.name = "stopped",        .start_l_min = 0.0f,  .end_l_min = 0.0f,  .duration_ms = 3000},
+    {.name = "slow_rise",      .start_l_min = 0.0f,  .end_l_min = 8.0f,  .duration_ms = 12000},
+    {.name = "fast_rise",      .start_l_min = 8.0f,  .end_l_min = 55.0f, .duration_ms = 5000},
+    {.name = "hold_high",      .start_l_min = 55.0f, .end_l_min = 55.0f, .duration_ms = 5000},
+    {.name = "slow_fall",      .start_l_min = 55.0f, .end_l_min = 18.0f, .duration_ms = 10000},
+    {.name = "fast_stop",      .start_l_min = 18.0f, .end_l_min = 0.0f,  .duration_ms = 4000},
+    {.name = "stopped_again",  .start_l_min = 0.0f,  .end_l_min = 0.0f,  .duration_ms = 4000},
+    {.name = "quick_restart",  .start_l_min = 0.0f,  .end_l_min = 42.0f, .duration_ms = 3000},
+    {.name = "hold_medium",    .start_l_min = 42.0f, .end_l_min = 42.0f, .duration_ms = 5000},
+    {.name = "slow_taper",     .start_l_min = 42.0f, .end_l_min = 6.0f,  .duration_ms = 8000},
+    {.name = "hold_low",       .start_l_min = 6.0f,  .end_l_min = 6.0f,  .duration_ms = 5000},
+};
+
+static constexpr size_t FLOW_SIMULATOR_PROFILE_STEPS = sizeof(FLOW_SIMULATOR_PROFILE) / sizeof(FLOW_SIMULATOR_PROFILE[0]);
+
+inline uint32_t flow_simulator_step_updates(const flow_simulator_profile_step_t &step)
+{
+    const uint32_t duration_ms = step.duration_ms > 0 ? step.duration_ms : FLOW_SIMULATOR_PROFILE_UPDATE_MS;
+    return (duration_ms + FLOW_SIMULATOR_PROFILE_UPDATE_MS - 1U) / FLOW_SIMULATOR_PROFILE_UPDATE_MS;
+}
+
+inline float flow_simulator_step_setpoint(const flow_simulator_profile_step_t &step, uint32_t update_index)
+{
+    const uint32_t updates = flow_simulator_step_updates(step);
+    const float progress = (updates <= 1) ? 1.0f : (float)update_index / (float)(updates - 1U);
+    return step.start_l_min + ((step.end_l_min - step.start_l_min) * progress);
+}
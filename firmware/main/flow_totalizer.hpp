@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Celkove cerpane mnozstvi: impulsy se scitaji v RAM a do perzistentniho citace se zapisuji
+ * po davkach. Trida sama flash nevola; kdo drzi citac (ve firmware persistencni task
+ * v prutokomer.cpp, na hostu tools/flow_sim.cpp), se zepta batchDue(), zapise
+ * increment(pendingSteps()) a uspesny zapis potvrdi commitSteps().
+ *
+ * Krok citace je 1/steps_per_liter litru. Aby se pri kalibraci, ktera neni nasobkem
+ * steps_per_liter, neztracely zbytky, drzi se nezapsany objem v tickach = impuls/steps_per_liter
+ * (jeden krok je pak presne pulses_per_liter ticku).
+ *
+ * Davka je splatna, kdyz je v RAM aspon batch_steps kroku, nebo aspon jeden krok a bud
+ * od posledniho zapisu uplynulo batch_period_us, nebo uz idle_us neprisel zadny impuls
+ * (dotekla davka, zbytek po restartu je mensi nez jeden krok). Mezi pendingSteps()
+ * a commitSteps() muze dal pribyvat addPulses(), commit odecte jen zapsane kroky.
+ *
+ * Priklad:
+ *   FlowTotalizer totalizer(10, 100, 60LL * 1000 * 1000, 5LL * 1000 * 1000);
+ *   totalizer.start(counter.value(), 38, now_us);
+ *   totalizer.addPulses(pulsy, now_us);
+ *   if (totalizer.batchDue(now_us)) {
+ *       const uint32_t steps = totalizer.pendingSteps();
+ *       if (counter.increment(steps) == ESP_OK) totalizer.commitSteps(steps, now_us);
+ *   }
+ */
+class FlowTotalizer
+{
+public:
+    FlowTotalizer(uint32_t steps_per_liter, uint32_t batch_steps, int64_t batch_period_us, int64_t idle_us)
+        : steps_per_liter_(steps_per_liter > 0 ? steps_per_liter : 1),
+          batch_steps_(batch_steps > 0 ? batch_steps : 1),
+          batch_period_us_(batch_period_us),
+          idle_us_(idle_us),
+          pulses_per_liter_(1),
+          persisted_steps_(0),
+          unpersisted_ticks_(0),
+          last_commit_us_(0),
+          last_pulse_us_(0)
+    {
+    }
+
+    void start(uint64_t persisted_steps, uint32_t pulses_per_liter, int64_t now_us)
+    {
+        persisted_steps_ = persisted_steps;
+        unpersisted_ticks_ = 0;
+        pulses_per_liter_ = pulses_per_liter > 0 ? pulses_per_liter : 1;
+        last_commit_us_ = now_us;
+        last_pulse_us_ = now_us;
+    }
+
+    void addPulses(uint32_t pulses, int64_t now_us)
+    {
+        if (pulses > 0) {
+            unpersisted_ticks_ += (uint64_t)pulses * steps_per_liter_;
+            last_pulse_us_ = now_us;
+        }
+    }
+
+    // Obnova nezapsaneho zbytku (journal po restartu).
+    void addTicks(uint64_t ticks)
+    {
+        unpersisted_ticks_ += ticks;
+    }
+
+    uint32_t pendingSteps() const
+    {
+        const uint64_t steps = unpersisted_ticks_ / pulses_per_liter_;
+        return steps > UINT32_MAX ? UINT32_MAX : (uint32_t)steps;
+    }
+
+    bool batchDue(int64_t now_us) const
+    {
+        const uint32_t steps = pendingSteps();
+        if (steps >= batch_steps_) {
+            return true;
+        }
+        return steps > 0
+            && ((now_us - last_commit_us_) >= batch_period_us_ || (now_us - last_pulse_us_) >= idle_us_);
+    }
+
+    // Potvrdi zapis steps kroku do citace.
+    void commitSteps(uint32_t steps, int64_t now_us)
+    {
+        const uint64_t ticks = (uint64_t)steps * pulses_per_liter_;
+        persisted_steps_ += steps;
+        unpersisted_ticks_ = unpersisted_ticks_ > ticks ? unpersisted_ticks_ - ticks : 0;
+        last_commit_us_ = now_us;
+    }
+
+    float totalLiters() const
+    {
+        return (float)((double)persisted_steps_ / (double)steps_per_liter_)
+             + (float)((double)unpersisted_ticks_ / ((double)pulses_per_liter_ * (double)steps_per_liter_));
+    }
+
+    uint64_t persistedSteps() const
+    {
+        return persisted_steps_;
+    }
+
+    // Nezapsany objem v tickach (1/steps_per_liter impulsu).
+    uint64_t unpersistedTicks() const
+    {
+        return unpersisted_ticks_;
+    }
+
+    uint32_t stepsPerLiter() const
+    {
+        return steps_per_liter_;
+    }
+
+private:
+    uint32_t steps_per_liter_;
+    uint32_t batch_steps_;
+    int64_t batch_period_us_;
+    int64_t idle_us_;
+    uint32_t pulses_per_liter_;
+    uint64_t persisted_steps_;
+    uint64_t unpersisted_ticks_;
+    int64_t last_commit_us_;
+    int64_t last_pulse_us_;
+};
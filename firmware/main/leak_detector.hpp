@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Detekce uniku a necekaneho prutoku nad proudem impulsu prutokomeru, v konstantni pameti.
+ *
+ * Detektor dostava prirustky impulsu (z volne beziciho citace) a stav cerpadla. Impulsy
+ * behem relace cerpani a v dobehu runoff_us po jejim konci jsou normalni a ignoruji se.
+ * Ostatni impulsy se skladaji do tri epizod. Epizoda je jen zacatek, posledni impuls
+ * a pocet, a konci, kdyz mezi impulsy uplyne vic nez jeji mezera:
+ *  - TRICKLE: pomaly unik, impulsy v klidu s mezerou nejvys trickle_gap_us trvaji aspon
+ *    trickle_min_us a je jich aspon trickle_min_pulses (napr. jeden impuls za 10 min
+ *    celou noc). Relace cerpani epizodu nepreruseji.
+ *  - UNPOWERED: aspon unpowered_pulses impulsu, kdyz elektromer hlasi stojici cerpadlo.
+ *    Bez platnych dat elektromeru se nepocita.
+ *  - AFTER_END: aspon after_end_pulses impulsu v after_end_us po dobehu relace.
+ *    Alarm drzi do zacatku dalsi relace.
+ *
+ * Priklad:
+ *   LeakDetector detector(LeakDetector::Config{...});
+ *   detector.onPump(pump_session_is_active(), now_us);
+ *   detector.onMeter(meter_ok, now_us);
+ *   const uint8_t alarms = detector.onPulseTotal(impulsy_celkem, now_us);
+ *   if (alarms & LeakDetector::ALARM_TRICKLE) { ... }
+ */
+class LeakDetector
+{
+public:
+    static constexpr uint8_t ALARM_TRICKLE = 1U << 0;
+    static constexpr uint8_t ALARM_UNPOWERED = 1U << 1;
+    static constexpr uint8_t ALARM_AFTER_END = 1U << 2;
+
+    struct Config {
+        int64_t runoff_us;              // dobeh po konci relace, impulsy se ignoruji
+        int64_t trickle_gap_us;         // nejdelsi mezera mezi impulsy pomaleho uniku
+        int64_t trickle_min_us;         // jak dlouho musi pomaly unik trvat
+        uint32_t trickle_min_pulses;
+        int64_t unpowered_gap_us;       // mezera, po ktere epizoda bez napajeni konci
+        uint32_t unpowered_pulses;
+        int64_t after_end_us;           // jak dlouho po dobehu se hlida prutok
+        uint32_t after_end_pulses;
+        int64_t meter_stale_us;         // starsi odecet elektromeru neplati
+    };
+
+    explicit LeakDetector(const Config &config) : config_(config)
+    {
+    }
+
+    // active = probiha relace cerpani (vcetne cekani na jeji konec).
+    void onPump(bool active, int64_t now_us)
+    {
+        if (active && !pump_active_) {
+            // Novy rozbeh: prutok po minule relaci uz se neposuzuje.
+            after_end_ = Episode{};
+            alarms_ &= (uint8_t)~ALARM_AFTER_END;
+        }
+        if (!active && pump_active_) {
+            stop_us_ = now_us;
+            stopped_once_ = true;
+        }
+        pump_active_ = active;
+    }
+
+    // meter_ok = elektromer odpovedel a cerpadlo podle nej stoji nebo bezi.
+    void onMeter(bool meter_ok, int64_t now_us)
+    {
+        meter_ok_ = meter_ok;
+        meter_us_ = now_us;
+    }
+
+    // Volne bezici pocet impulsu (modulo 2^32). Vraci aktualni masku alarmu.
+    uint8_t onPulseTotal(uint32_t pulse_total, int64_t now_us)
+    {
+        if (!have_total_) {
+            last_total_ = pulse_total;
+            have_total_ = true;
+        }
+        const uint32_t pulses = pulse_total - last_total_;
+        last_total_ = pulse_total;
+        return onPulses(pulses, now_us);
+    }
+
+    uint8_t onPulses(uint32_t pulses, int64_t now_us)
+    {
+        expire(now_us);
+
+        if (pulses > 0) {
+            if (pump_active_) {
+                // Relace cerpani pomaly unik nepreruseji.
+                if (trickle_.pulses > 0) {
+                    trickle_.last_us = now_us;
+                }
+            } else if (!stopped_once_ || now_us - stop_us_ >= config_.runoff_us) {
+                trickle_.add(pulses, now_us);
+                if (meterFresh(now_us)) {
+                    unpowered_.add(pulses, now_us);
+                }
+                if (stopped_once_ && now_us - stop_us_ < config_.runoff_us + config_.after_end_us) {
+                    after_end_.add(pulses, now_us);
+                }
+            }
+        }
+
+        if (trickle_.pulses >= config_.trickle_min_pulses && trickle_.last_us - trickle_.start_us >= config_.trickle_min_us) {
+            alarms_ |= ALARM_TRICKLE;
+        }
+        if (unpowered_.pulses >= config_.unpowered_pulses) {
+            alarms_ |= ALARM_UNPOWERED;
+        }
+        if (after_end_.pulses >= config_.after_end_pulses) {
+            alarms_ |= ALARM_AFTER_END;
+        }
+        return alarms_;
+    }
+
+    uint8_t alarms() const
+    {
+        return alarms_;
+    }
+
+    // Pocet impulsu a delka probihajici epizody pomaleho uniku (pro diagnostiku).
+    uint32_t tricklePulses() const
+    {
+        return trickle_.pulses;
+    }
+
+    int64_t trickleDurationUs() const
+    {
+        return trickle_.pulses > 0 ? trickle_.last_us - trickle_.start_us : 0;
+    }
+
+private:
+    struct Episode {
+        int64_t start_us = 0;
+        int64_t last_us = 0;
+        uint32_t pulses = 0;
+
+        void add(uint32_t count, int64_t now_us)
+        {
+            if (pulses == 0) {
+                start_us = now_us;
+            }
+            last_us = now_us;
+            pulses += count;
+        }
+
+        bool expired(int64_t now_us, int64_t gap_us) const
+        {
+            return pulses > 0 && now_us - last_us > gap_us;
+        }
+    };
+
+    bool meterFresh(int64_t now_us) const
+    {
+        return meter_ok_ && now_us - meter_us_ <= config_.meter_stale_us;
+    }
+
+    void expire(int64_t now_us)
+    {
+        if (trickle_.expired(now_us, config_.trickle_gap_us)) {
+            trickle_ = Episode{};
+            alarms_ &= (uint8_t)~ALARM_TRICKLE;
+        }
+        if (unpowered_.expired(now_us, config_.unpowered_gap_us)) {
+            unpowered_ = Episode{};
+            alarms_ &= (uint8_t)~ALARM_UNPOWERED;
+        }
+    }
+
+    Config config_;
+
+    bool pump_active_ = false;
+    bool stopped_once_ = false;
+    int64_t stop_us_ = 0;
+    bool meter_ok_ = false;
+    int64_t meter_us_ = 0;
+    bool have_total_ = false;
+    uint32_t last_total_ = 0;
+    uint8_t alarms_ = 0;
+
+    Episode trickle_;
+    Episode unpowered_;
+    Episode after_end_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Parametry modulu menitelne za behu: jeden zapisovatel (callback config_store) a jeden
+ * ctenar (merici task), bez zamku v hlavni smycce.
+ *
+ * Dve kopie a citac sequence_: zapisovatel pise vzdy do neaktivni kopie (liche sequence_
+ * = zapis probiha) a dokoncenim ji zverejni. Ctenar v kazdem vzorku jen porovna citac
+ * s posledni prevzatou verzi; pri zmene zkopiruje aktivni kopii a overi, ze se do ni mezitim
+ * nezacalo psat (to by chtelo dva zapisy behem jedne kopie, pak se kopie zopakuje).
+ *
+ * Priklad:
+ *   static LiveParams<level_config_t> s_live(defaults);
+ *   // callback config_store:
+ *   s_live.publish(read_config());
+ *   // merici task, na zacatku kazdeho vzorku:
+ *   if (s_live.fetch(&seen, &config)) { apply(config); }
+ */
+template <typename T>
+class LiveParams
+{
+    static_assert(std::is_trivially_copyable<T>::value, "LiveParams potrebuje trivialne kopirovatelny typ");
+
+public:
+    explicit LiveParams(const T &initial) : sequence_(0)
+    {
+        slots_[0] = initial;
+        slots_[1] = initial;
+    }
+
+    // Jen jeden zapisovatel naraz (config_store vola odberatele postupne).
+    void publish(const T &value)
+    {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        const uint32_t target = ((sequence >> 1) + 1U) & 1U;
+        sequence_.store(sequence + 1U, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slots_[target] = value;
+        sequence_.store(sequence + 2U, std::memory_order_release);
+    }
+
+    // Verze posledni zverejnene hodnoty (pocet publish).
+    uint32_t version() const
+    {
+        return sequence_.load(std::memory_order_acquire) >> 1;
+    }
+
+    // Zkopiruje parametry, pokud se od *seen_version zmenily; jinak jen jedno atomicke cteni.
+    bool fetch(uint32_t *seen_version, T *out) const
+    {
+        uint32_t before = sequence_.load(std::memory_order_acquire);
+        if ((before >> 1) == *seen_version) {
+            return false;
+        }
+
+        for (;;) {
+            *out = slots_[(before >> 1) & 1U];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t after = sequence_.load(std::memory_order_relaxed);
+            // Do prectene kopie se zacne psat az druhym dalsim zapisem.
+            if (after - before < 2U) {
+                break;
+            }
+            before = after;
+        }
+        *seen_version = before >> 1;
+        return true;
+    }
+
+private:
+    std::atomic<uint32_t> sequence_;
+    T slots_[2];
+};
@@ -22,6 +22,7 @@ extern "C" {
 #include "network_init.h"
 #include "ota_manager.h"
 #include "status_display.h"
+#include "sensor_trace.h"
 #include "teplota.h"
 #include "webapp_startup.h"
 #include "debug_mqtt.h"
@@ -330,6 +331,39 @@ static void command_set_log_level(const char *payload)
     ESP_LOGW(TAG, "Log level nastaven: tag='%s' level=%s", tag, log_level_name(level));
 }
 
+static void command_trace(const char *payload)
+{
+    char buffer[MQTT_PUBLISH_TEXT_MAX_LEN] = {0};
+    strncpy(buffer, (payload != nullptr) ? payload : "", sizeof(buffer) - 1);
+
+    char *saveptr = nullptr;
+    const char *action = strtok_r(buffer, " \t", &saveptr);
+    if (action == nullptr) {
+        ESP_LOGW(TAG, "cmd/trace: prazdny payload, ocekavam 'start [mask] [zaznamu]', 'stop' nebo 'dump'");
+        return;
+    }
+
+    esp_err_t result = ESP_OK;
+    if (strcasecmp(action, "start") == 0) {
+        const char *mask_text = strtok_r(nullptr, " \t", &saveptr);
+        const char *records_text = strtok_r(nullptr, " \t", &saveptr);
+        const uint32_t mask = (mask_text != nullptr) ? (uint32_t)strtoul(mask_text, nullptr, 0) : SENSOR_TRACE_MASK_ALL;
+        const uint32_t records = (records_text != nullptr) ? (uint32_t)strtoul(records_text, nullptr, 0) : 0;
+        result = sensor_trace_start(mask, records);
+    } else if (strcasecmp(action, "stop") == 0) {
+        sensor_trace_stop();
+    } else if (strcasecmp(action, "dump") == 0) {
+        result = sensor_trace_dump_mqtt();
+    } else {
+        ESP_LOGW(TAG, "cmd/trace: neznama akce '%s'", action);
+        return;
+    }
+
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "cmd/trace %s selhal: %s", action, esp_err_to_name(result));
+    }
+}
+
 static void handle_command(mqtt_topic_id_t command_id, const char *payload)
 {
     ESP_LOGI(TAG,
@@ -409,6 +443,10 @@ static void handle_command(mqtt_topic_id_t command_id, const char *payload)
             break;
         }
 
+        case mqtt_topic_id_t::TOPIC_CMD_TRACE:
+            command_trace(payload);
+            break;
+
         default:
             ESP_LOGW(TAG, "Neznamy command topic id: %u", (unsigned)command_id);
             break;
@@ -61,6 +61,13 @@ static ha_topic_name_cfg_t s_ha_topic_name_cfg[(size_t)mqtt_topic_id_t::COUNT] =
     {mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_NAPETI_V, "Cerpani napeti", {0}, false},
     {mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_ENERGIE_CINNA_KWH, "Cerpani energie cinna", {0}, false},
     {mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_ENERGIE_JALOVA_KVARH, "Cerpani energie jalova", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_CERPANI_RELACE, "Posledni relace cerpani", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_FILTR_DP_NORM, "Filtr dP na ref. prutoku", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_FILTR_TREND, "Filtr trend zanaseni", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_FILTR_DNY_DO_ZANESENI, "Filtr dny do zaneseni", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_ALARM_POMALY_UNIK, "Alarm pomaly unik", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_ALARM_IMPULSY_BEZ_CERPADLA, "Alarm impulsy bez cerpadla", {0}, false},
+    {mqtt_topic_id_t::TOPIC_STAV_ALARM_PRUTOK_PO_RELACI, "Alarm prutok po relaci", {0}, false},
     {mqtt_topic_id_t::TOPIC_SYSTEM_STATUS, "Stav zarizeni", {0}, false},
     {mqtt_topic_id_t::TOPIC_SYSTEM_BOOT_MODE, "Boot mode", {0}, false},
     {mqtt_topic_id_t::TOPIC_SYSTEM_OTA_EVENT, "OTA event", {0}, false},
@@ -75,6 +82,8 @@ static ha_topic_name_cfg_t s_ha_topic_name_cfg[(size_t)mqtt_topic_id_t::COUNT] =
     {mqtt_topic_id_t::TOPIC_DIAG_WIFI_RSSI_DBM, "WiFi RSSI", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_WIFI_RECONNECT_TRY, "WiFi reconnect pokusy", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_WIFI_RECONNECT_SUCCESS, "WiFi reconnect uspechy", {0}, false},
+    {mqtt_topic_id_t::TOPIC_DIAG_WIFI_CONNECT_MS, "WiFi doba pripojeni", {0}, false},
+    {mqtt_topic_id_t::TOPIC_DIAG_MQTT_READY_MS, "MQTT doba pripojeni", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_MQTT_RECONNECTS, "MQTT reconnecty", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_LAST_MQTT_RC, "Posledni MQTT RC", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_HEAP_FREE_B, "Heap free", {0}, false},
@@ -82,6 +91,9 @@ static ha_topic_name_cfg_t s_ha_topic_name_cfg[(size_t)mqtt_topic_id_t::COUNT] =
     {mqtt_topic_id_t::TOPIC_DIAG_ESP_VCC_MV, "ESP VCC", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_NVS_ERRORS, "NVS chyby", {0}, false},
     {mqtt_topic_id_t::TOPIC_DIAG_TEPLOTA_SCAN, "DS18B20 scan", {0}, false},
+    {mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_HLADINA, "Porucha cidla hladiny", {0}, false},
+    {mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_TLAK_PRED, "Porucha cidla tlaku pred", {0}, false},
+    {mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_TLAK_ZA, "Porucha cidla tlaku za", {0}, false},
     {mqtt_topic_id_t::TOPIC_CMD_REBOOT, "CMD reboot", {0}, false},
     {mqtt_topic_id_t::TOPIC_CMD_WEBAPP, "CMD webapp", {0}, false},
     {mqtt_topic_id_t::TOPIC_CMD_DEBUG, "CMD debug", {0}, false},
@@ -89,6 +101,7 @@ static ha_topic_name_cfg_t s_ha_topic_name_cfg[(size_t)mqtt_topic_id_t::COUNT] =
     {mqtt_topic_id_t::TOPIC_CMD_OTA_START, "CMD OTA start", {0}, false},
     {mqtt_topic_id_t::TOPIC_CMD_OTA_CONFIRM, "CMD OTA confirm", {0}, false},
     {mqtt_topic_id_t::TOPIC_CMD_TEPLOTA_SCAN, "CMD teplota scan", {0}, false},
+    {mqtt_topic_id_t::TOPIC_CMD_TRACE, "CMD trace", {0}, false},
 };
 
 static_assert((sizeof(s_ha_topic_name_cfg) / sizeof(s_ha_topic_name_cfg[0])) == (size_t)mqtt_topic_id_t::COUNT,
@@ -256,6 +269,11 @@ static ha_entity_meta_t infer_meta(const mqtt_topic_descriptor_t &topic)
         meta.payload_off = "0";
         if (topic.id == mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_BEZI) {
             meta.device_class = "running";
+        } else if (topic.id == mqtt_topic_id_t::TOPIC_STAV_ALARM_POMALY_UNIK) {
+            meta.device_class = "moisture";
+        } else if (topic.id == mqtt_topic_id_t::TOPIC_STAV_ALARM_IMPULSY_BEZ_CERPADLA ||
+                   topic.id == mqtt_topic_id_t::TOPIC_STAV_ALARM_PRUTOK_PO_RELACI) {
+            meta.device_class = "problem";
         }
         return meta;
     }
@@ -271,6 +289,11 @@ static ha_entity_meta_t infer_meta(const mqtt_topic_descriptor_t &topic)
             meta.value_template = "{{ value_json.found | count }}";
             meta.unit = "count";
             meta.json_attributes_topic = topic.full_topic;
+        } else if (topic.id == mqtt_topic_id_t::TOPIC_STAV_CERPANI_RELACE) {
+            meta.icon = "mdi:pump";
+            meta.value_template = "{{ value_json.l }}";
+            meta.unit = "L";
+            meta.json_attributes_topic = topic.full_topic;
         }
     }
 
@@ -302,6 +325,13 @@ static ha_entity_meta_t infer_meta(const mqtt_topic_descriptor_t &topic)
         meta.device_class = "pressure";
         meta.unit = "bar";
         meta.state_class = "measurement";
+    } else if (topic_ends_with(full, "_bar_den")) {
+        meta.unit = "bar/d";
+        meta.state_class = "measurement";
+    } else if (topic_ends_with(full, "/dny_do_zaneseni")) {
+        meta.device_class = "duration";
+        meta.unit = "d";
+        meta.state_class = "measurement";
     } else if (topic_ends_with(full, "_percent") || topic_ends_with(full, "/progress")) {
         meta.unit = "%";
         meta.state_class = "measurement";
@@ -327,6 +357,10 @@ static ha_entity_meta_t infer_meta(const mqtt_topic_descriptor_t &topic)
     } else if (topic_ends_with(full, "_kvarh")) {
         meta.unit = "kvarh";
         meta.state_class = "total_increasing";
+    } else if (topic_ends_with(full, "_ms")) {
+        meta.device_class = "duration";
+        meta.unit = "ms";
+        meta.state_class = "measurement";
     } else if (topic_ends_with(full, "_s")) {
         meta.device_class = "duration";
         meta.unit = "s";
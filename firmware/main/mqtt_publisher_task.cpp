@@ -7,6 +7,7 @@
 #include "esp_task_wdt.h"
 #include "mqtt_publish.h"
 #include "status_display.h"
+#include "config_webapp.h"
 #include "app_error_check.h"
 
 static const char *TAG = "mqtt_publisher_task";
@@ -36,6 +37,8 @@ struct topic_last_state_t {
 };
 
 static topic_last_state_t s_last_state[(size_t)mqtt_topic_id_t::COUNT] = {};
+// Chrani valid/event v s_last_state pro cteni z webapp (/api/state, /api/diag).
+static portMUX_TYPE s_last_state_mux = portMUX_INITIALIZER_UNLOCKED;
 
 static bool value_type_matches_topic(mqtt_payload_kind_t payload_kind, mqtt_publish_value_type_t value_type);
 static esp_err_t build_payload_string(const mqtt_publish_event_t &event, char *payload, size_t payload_len);
@@ -225,8 +228,84 @@ static void save_last_state(const mqtt_publish_event_t &event)
     }
 
     topic_last_state_t &last = s_last_state[topic_index];
+    taskENTER_CRITICAL(&s_last_state_mux);
     last.valid = true;
     last.event = event;
+    taskEXIT_CRITICAL(&s_last_state_mux);
+}
+
+// Kopie posledni hodnoty topicu; false, pokud zatim zadna neprisla.
+static bool snapshot_last_event(size_t topic_index, mqtt_publish_event_t *event)
+{
+    taskENTER_CRITICAL(&s_last_state_mux);
+    const bool valid = s_last_state[topic_index].valid;
+    if (valid) {
+        *event = s_last_state[topic_index].event;
+    }
+    taskEXIT_CRITICAL(&s_last_state_mux);
+    return valid;
+}
+
+// Posledni hodnoty topicu, jejichz cesta (bez MQTT_TOPIC_ROOT) zacina jednim z prefixu;
+// klicem je tato cesta, napr. "stav/zasoba/objem".
+static void render_cached_topics_json(JsonWriter &json, const char *const *prefixes, size_t prefix_count)
+{
+    const size_t root_len = strlen(MQTT_TOPIC_ROOT) + 1;
+    json.beginObject();
+    for (size_t index = 0; index < (size_t)mqtt_topic_id_t::COUNT; ++index) {
+        const mqtt_topic_descriptor_t &topic = MQTT_TOPIC_TABLE[index];
+        if (topic.direction != mqtt_topic_direction_t::PUBLISH_ONLY || strlen(topic.full_topic) <= root_len) {
+            continue;
+        }
+        const char *path = topic.full_topic + root_len;
+        bool matches = false;
+        for (size_t prefix = 0; prefix < prefix_count && !matches; ++prefix) {
+            matches = strncmp(path, prefixes[prefix], strlen(prefixes[prefix])) == 0;
+        }
+
+        mqtt_publish_event_t event;
+        if (!matches || !snapshot_last_event(index, &event)) {
+            continue;
+        }
+
+        json.key(path);
+        switch (event.value_type) {
+            case mqtt_publish_value_type_t::BOOL:
+                json.boolean(event.value.as_bool);
+                break;
+            case mqtt_publish_value_type_t::INT64:
+                json.integer(event.value.as_int64);
+                break;
+            case mqtt_publish_value_type_t::DOUBLE:
+                json.number(event.value.as_double);
+                break;
+            case mqtt_publish_value_type_t::TEXT:
+                event.value.as_text[MQTT_PUBLISH_TEXT_MAX_LEN - 1] = '\0';
+                if (topic.payload_kind == mqtt_payload_kind_t::JSON) {
+                    json.raw(event.value.as_text);
+                } else {
+                    json.string(event.value.as_text);
+                }
+                break;
+            case mqtt_publish_value_type_t::EMPTY:
+            default:
+                json.null();
+                break;
+        }
+    }
+    json.endObject();
+}
+
+static void render_state_json(JsonWriter &json)
+{
+    static const char *const PREFIXES[] = {"stav/"};
+    render_cached_topics_json(json, PREFIXES, sizeof(PREFIXES) / sizeof(PREFIXES[0]));
+}
+
+static void render_diag_json(JsonWriter &json)
+{
+    static const char *const PREFIXES[] = {"system/", "diag/"};
+    render_cached_topics_json(json, PREFIXES, sizeof(PREFIXES) / sizeof(PREFIXES[0]));
 }
 
 static esp_err_t publish_if_changed(const mqtt_publish_event_t &event)
@@ -318,7 +397,9 @@ esp_err_t mqtt_publisher_task_start(uint32_t queue_length,
         return ESP_OK;
     }
 
+    taskENTER_CRITICAL(&s_last_state_mux);
     memset(s_last_state, 0, sizeof(s_last_state));
+    taskEXIT_CRITICAL(&s_last_state_mux);
 
     s_publish_queue = xQueueCreate((UBaseType_t)queue_length, sizeof(mqtt_publish_queue_item_t));
     if (s_publish_queue == nullptr) {
@@ -338,6 +419,8 @@ esp_err_t mqtt_publisher_task_start(uint32_t queue_length,
         return ESP_ERR_NO_MEM;
     }
 
+    APP_ERROR_CHECK("E509", config_webapp_add_json_section(CONFIG_WEBAPP_API_STATE, "mqtt", render_state_json));
+    APP_ERROR_CHECK("E510", config_webapp_add_json_section(CONFIG_WEBAPP_API_DIAG, "mqtt", render_diag_json));
     return ESP_OK;
 }
 
@@ -29,6 +29,13 @@ const mqtt_topic_descriptor_t MQTT_TOPIC_TABLE[(size_t)mqtt_topic_id_t::COUNT] =
     TOPIC_ENTRY(TOPIC_STAV_CERPANI_PUMPA_NAPETI_V,       "stav/cerpani/pumpa/napeti_v",      PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_STAV_CERPANI_PUMPA_ENERGIE_CINNA_KWH, "stav/cerpani/pumpa/energie_cinna_kwh", PUBLISH_ONLY, NUMBER, 1, true),
     TOPIC_ENTRY(TOPIC_STAV_CERPANI_PUMPA_ENERGIE_JALOVA_KVARH, "stav/cerpani/pumpa/energie_jalova_kvarh", PUBLISH_ONLY, NUMBER, 1, true),
+    TOPIC_ENTRY(TOPIC_STAV_CERPANI_RELACE,               "stav/cerpani/relace",              PUBLISH_ONLY,   JSON,    1, true),
+    TOPIC_ENTRY(TOPIC_STAV_FILTR_DP_NORM,                "stav/filtr/dp_norm_bar",           PUBLISH_ONLY,   NUMBER,  1, true),
+    TOPIC_ENTRY(TOPIC_STAV_FILTR_TREND,                  "stav/filtr/trend_bar_den",         PUBLISH_ONLY,   NUMBER,  1, true),
+    TOPIC_ENTRY(TOPIC_STAV_FILTR_DNY_DO_ZANESENI,        "stav/filtr/dny_do_zaneseni",       PUBLISH_ONLY,   NUMBER,  1, true),
+    TOPIC_ENTRY(TOPIC_STAV_ALARM_POMALY_UNIK,            "stav/alarm/pomaly_unik",           PUBLISH_ONLY,   BOOLEAN, 1, true),
+    TOPIC_ENTRY(TOPIC_STAV_ALARM_IMPULSY_BEZ_CERPADLA,   "stav/alarm/impulsy_bez_cerpadla",  PUBLISH_ONLY,   BOOLEAN, 1, true),
+    TOPIC_ENTRY(TOPIC_STAV_ALARM_PRUTOK_PO_RELACI,       "stav/alarm/prutok_po_relaci",      PUBLISH_ONLY,   BOOLEAN, 1, true),
 
     TOPIC_ENTRY(TOPIC_SYSTEM_STATUS,                     "system/status",                    PUBLISH_ONLY,   TEXT,    1, true),
     TOPIC_ENTRY(TOPIC_SYSTEM_BOOT_MODE,                  "system/boot_mode",                 PUBLISH_ONLY,   TEXT,    1, true),
@@ -45,6 +52,8 @@ const mqtt_topic_descriptor_t MQTT_TOPIC_TABLE[(size_t)mqtt_topic_id_t::COUNT] =
     TOPIC_ENTRY(TOPIC_DIAG_WIFI_RSSI_DBM,                "diag/wifi_rssi_dbm",               PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_WIFI_RECONNECT_TRY,           "diag/wifi_reconnect_try",          PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_WIFI_RECONNECT_SUCCESS,       "diag/wifi_reconnect_success",      PUBLISH_ONLY,   NUMBER,  1, true),
+    TOPIC_ENTRY(TOPIC_DIAG_WIFI_CONNECT_MS,              "diag/wifi_connect_ms",             PUBLISH_ONLY,   NUMBER,  1, true),
+    TOPIC_ENTRY(TOPIC_DIAG_MQTT_READY_MS,                "diag/mqtt_ready_ms",               PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_MQTT_RECONNECTS,              "diag/mqtt_reconnects",             PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_LAST_MQTT_RC,                 "diag/last_mqtt_rc",                PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_HEAP_FREE_B,                  "diag/heap_free_b",                 PUBLISH_ONLY,   NUMBER,  1, true),
@@ -52,6 +61,9 @@ const mqtt_topic_descriptor_t MQTT_TOPIC_TABLE[(size_t)mqtt_topic_id_t::COUNT] =
     TOPIC_ENTRY(TOPIC_DIAG_ESP_VCC_MV,                   "diag/esp_vcc_mv",                  PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_NVS_ERRORS,                   "diag/nvs_errors",                  PUBLISH_ONLY,   NUMBER,  1, true),
     TOPIC_ENTRY(TOPIC_DIAG_TEPLOTA_SCAN,                 "diag/teplota_scan",                PUBLISH_ONLY,   JSON,    1, false),
+    TOPIC_ENTRY(TOPIC_DIAG_PORUCHA_HLADINA,              "diag/porucha/hladina",             PUBLISH_ONLY,   TEXT,    1, true),
+    TOPIC_ENTRY(TOPIC_DIAG_PORUCHA_TLAK_PRED,            "diag/porucha/tlak_pred",           PUBLISH_ONLY,   TEXT,    1, true),
+    TOPIC_ENTRY(TOPIC_DIAG_PORUCHA_TLAK_ZA,              "diag/porucha/tlak_za",             PUBLISH_ONLY,   TEXT,    1, true),
 
     TOPIC_ENTRY(TOPIC_CMD_REBOOT,                        "cmd/reboot",                       SUBSCRIBE_ONLY, TEXT,    1, false),
     TOPIC_ENTRY(TOPIC_CMD_WEBAPP,                        "cmd/webapp",                       SUBSCRIBE_ONLY, TEXT,    1, false),
@@ -60,6 +72,7 @@ const mqtt_topic_descriptor_t MQTT_TOPIC_TABLE[(size_t)mqtt_topic_id_t::COUNT] =
     TOPIC_ENTRY(TOPIC_CMD_OTA_START,                     "cmd/ota/start",                    SUBSCRIBE_ONLY, TEXT,    1, false),
     TOPIC_ENTRY(TOPIC_CMD_OTA_CONFIRM,                   "cmd/ota/confirm",                  SUBSCRIBE_ONLY, TEXT,    1, false),
     TOPIC_ENTRY(TOPIC_CMD_TEPLOTA_SCAN,                  "cmd/teplota/scan",                 SUBSCRIBE_ONLY, TEXT,    1, false),
+    TOPIC_ENTRY(TOPIC_CMD_TRACE,                         "cmd/trace",                        SUBSCRIBE_ONLY, TEXT,    1, false),
 };
 
 #undef TOPIC_ENTRY
@@ -24,6 +24,13 @@ enum class mqtt_topic_id_t : uint16_t {
     TOPIC_STAV_CERPANI_PUMPA_NAPETI_V,
     TOPIC_STAV_CERPANI_PUMPA_ENERGIE_CINNA_KWH,
     TOPIC_STAV_CERPANI_PUMPA_ENERGIE_JALOVA_KVARH,
+    TOPIC_STAV_CERPANI_RELACE,
+    TOPIC_STAV_FILTR_DP_NORM,
+    TOPIC_STAV_FILTR_TREND,
+    TOPIC_STAV_FILTR_DNY_DO_ZANESENI,
+    TOPIC_STAV_ALARM_POMALY_UNIK,
+    TOPIC_STAV_ALARM_IMPULSY_BEZ_CERPADLA,
+    TOPIC_STAV_ALARM_PRUTOK_PO_RELACI,
 
     TOPIC_SYSTEM_STATUS,
     TOPIC_SYSTEM_BOOT_MODE,
@@ -40,6 +47,8 @@ enum class mqtt_topic_id_t : uint16_t {
     TOPIC_DIAG_WIFI_RSSI_DBM,
     TOPIC_DIAG_WIFI_RECONNECT_TRY,
     TOPIC_DIAG_WIFI_RECONNECT_SUCCESS,
+    TOPIC_DIAG_WIFI_CONNECT_MS,
+    TOPIC_DIAG_MQTT_READY_MS,
     TOPIC_DIAG_MQTT_RECONNECTS,
     TOPIC_DIAG_LAST_MQTT_RC,
     TOPIC_DIAG_HEAP_FREE_B,
@@ -47,6 +56,9 @@ enum class mqtt_topic_id_t : uint16_t {
     TOPIC_DIAG_ESP_VCC_MV,
     TOPIC_DIAG_NVS_ERRORS,
     TOPIC_DIAG_TEPLOTA_SCAN,
+    TOPIC_DIAG_PORUCHA_HLADINA,
+    TOPIC_DIAG_PORUCHA_TLAK_PRED,
+    TOPIC_DIAG_PORUCHA_TLAK_ZA,
 
     TOPIC_CMD_REBOOT,
     TOPIC_CMD_WEBAPP,
@@ -55,6 +67,7 @@ enum class mqtt_topic_id_t : uint16_t {
     TOPIC_CMD_OTA_START,
     TOPIC_CMD_OTA_CONFIRM,
     TOPIC_CMD_TEPLOTA_SCAN,
+    TOPIC_CMD_TRACE,
 
     COUNT,
 };
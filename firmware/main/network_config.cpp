@@ -2,6 +2,7 @@
 
 #include "config_store.h"
 #include "app_error_check.h"
+#include "esp_netif.h"
 
 static const config_item_t WIFI_SSID_ITEM = {
     .key = "wifi_ssid", .label = "WiFi SSID", .description = "SSID site, ke ktere se ma zarizeni pripojit.",
@@ -28,6 +29,50 @@ static const config_item_t MQTT_PASS_ITEM = {
     .type = CONFIG_VALUE_STRING, .default_string = "prsi.cely-rok", .default_int = 0, .default_float = 0.0f, .default_bool = false,
     .max_string_len = 127, .min_int = 0, .max_int = 0, .min_float = 0.0f, .max_float = 0.0f,
 };
+static const config_item_t NET_IP_ITEM = {
+    .key = "net_ip", .label = "Pevna IP", .description = "IPv4 adresa zarizeni bez DHCP, napr. 192.168.1.50. Prazdne = DHCP.",
+    .type = CONFIG_VALUE_STRING, .default_string = "", .default_int = 0, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 15, .min_int = 0, .max_int = 0, .min_float = 0.0f, .max_float = 0.0f,
+};
+static const config_item_t NET_MASK_ITEM = {
+    .key = "net_mask", .label = "Maska site", .description = "Maska site pro pevnou IP.",
+    .type = CONFIG_VALUE_STRING, .default_string = "255.255.255.0", .default_int = 0, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 15, .min_int = 0, .max_int = 0, .min_float = 0.0f, .max_float = 0.0f,
+};
+static const config_item_t NET_GW_ITEM = {
+    .key = "net_gw", .label = "Brana", .description = "Vychozi brana pro pevnou IP.",
+    .type = CONFIG_VALUE_STRING, .default_string = "", .default_int = 0, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 15, .min_int = 0, .max_int = 0, .min_float = 0.0f, .max_float = 0.0f,
+};
+static const config_item_t NET_DNS_ITEM = {
+    .key = "net_dns", .label = "DNS server", .description = "DNS server pro pevnou IP. Prazdne = pouzije se brana.",
+    .type = CONFIG_VALUE_STRING, .default_string = "", .default_int = 0, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 15, .min_int = 0, .max_int = 0, .min_float = 0.0f, .max_float = 0.0f,
+};
+static const config_item_t WIFI_FAST_FAIL_ITEM = {
+    .key = "wifi_fast_fail", .label = "Rychle pripojeni - pokusu", .description = "Pocet neuspesnych pokusu na ulozeny kanal a BSSID, po kterem se skenuji vsechny kanaly. 0 = vzdy plny sken.",
+    .type = CONFIG_VALUE_INT32, .default_string = nullptr, .default_int = 3, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 0, .min_int = 0, .max_int = 20, .min_float = 0.0f, .max_float = 0.0f,
+};
+
+// Prazdny retezec = adresa 0; neplatny zapis = chyba.
+static esp_err_t parse_ip4(const config_item_t *item, uint32_t *addr)
+{
+    char text[16] = {0};
+    config_store_get_string_item(item, text, sizeof(text));
+    *addr = 0;
+    if (text[0] == '\0') {
+        return ESP_OK;
+    }
+
+    esp_ip4_addr_t ip = {};
+    esp_err_t result = esp_netif_str_to_ip4(text, &ip);
+    if (result != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *addr = ip.addr;
+    return ESP_OK;
+}
 
 void network_config_register_config_items(void)
 {
@@ -36,6 +81,11 @@ void network_config_register_config_items(void)
     APP_ERROR_CHECK("E803", config_store_register_item(&MQTT_URI_ITEM));
     APP_ERROR_CHECK("E804", config_store_register_item(&MQTT_USER_ITEM));
     APP_ERROR_CHECK("E805", config_store_register_item(&MQTT_PASS_ITEM));
+    APP_ERROR_CHECK("E808", config_store_register_item(&NET_IP_ITEM));
+    APP_ERROR_CHECK("E809", config_store_register_item(&NET_MASK_ITEM));
+    APP_ERROR_CHECK("E810", config_store_register_item(&NET_GW_ITEM));
+    APP_ERROR_CHECK("E811", config_store_register_item(&NET_DNS_ITEM));
+    APP_ERROR_CHECK("E812", config_store_register_item(&WIFI_FAST_FAIL_ITEM));
 }
 
 esp_err_t network_config_load_wifi_credentials(char *ssid, size_t ssid_len, char *password, size_t password_len)
@@ -69,3 +119,35 @@ esp_err_t network_config_load_mqtt_credentials(char *username, size_t username_l
     config_store_get_string_item(&MQTT_PASS_ITEM, password, password_len);
     return ESP_OK;
 }
+
+esp_err_t network_config_load_sta_options(network_sta_options_t *options)
+{
+    if (options == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *options = {};
+    options->fast_connect_max_failures = (uint8_t)config_store_get_i32_item(&WIFI_FAST_FAIL_ITEM);
+
+    uint32_t ip = 0;
+    uint32_t netmask = 0;
+    uint32_t gateway = 0;
+    uint32_t dns = 0;
+    if (parse_ip4(&NET_IP_ITEM, &ip) != ESP_OK || parse_ip4(&NET_MASK_ITEM, &netmask) != ESP_OK
+        || parse_ip4(&NET_GW_ITEM, &gateway) != ESP_OK || parse_ip4(&NET_DNS_ITEM, &dns) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ip == 0) {
+        return ESP_OK;
+    }
+    if (netmask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    options->static_ip = true;
+    options->ip = ip;
+    options->netmask = netmask;
+    options->gateway = gateway;
+    options->dns = (dns != 0) ? dns : gateway;
+    return ESP_OK;
+}
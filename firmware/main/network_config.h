@@ -2,8 +2,11 @@
 
 #include <stddef.h>
 #include "esp_err.h"
+#include "network_init.h"
 
 void network_config_register_config_items(void);
 esp_err_t network_config_load_wifi_credentials(char *ssid, size_t ssid_len, char *password, size_t password_len);
 esp_err_t network_config_load_mqtt_uri(char *uri, size_t uri_len);
 esp_err_t network_config_load_mqtt_credentials(char *username, size_t username_len, char *password, size_t password_len);
+// Pevna IP a rychle pripojeni z config_store; neplatna adresa vraci ESP_ERR_INVALID_ARG (pak DHCP).
+esp_err_t network_config_load_sta_options(network_sta_options_t *options);
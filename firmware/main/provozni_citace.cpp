@@ -0,0 +1,159 @@
+#include "provozni_citace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <cmath>
+#include <cstdio>
+
+#include "config_webapp.h"
+#include "app_error_check.h"
+#include "flash_counter_set.h"
+
+#define TAG "provoz"
+
+namespace {
+
+static const char *PROVOZ_SET_NAME = "provoz";
+
+// Chod a energie pribyvaji nejrychleji (tisice kroku za den), maji proto cely oddil ve formatu
+// A/B (sektor na banku, bez NVS, starou banku maze provozni_citace_idle()). Starty a restarty
+// si deli user_data3 po sektoru, pretecou jednou za desitky tisic startu a zustavaji na evidenci v NVS.
+static const FlashCounterSet::Region PROVOZ_REGIONS[PROVOZNI_CITAC_COUNT] = {
+    {"starty", "user_data3", 0x0000, 0x1000, false},
+    {"chod_s", "user_data1", 0x0000, 0, true},
+    {"energie_wh", "user_data2", 0x0000, 0, true},
+    {"restarty", "user_data3", 0x1000, 0x1000, false},
+};
+
+static FlashCounterSet s_counters;
+static bool s_ready = false;
+// Zlomek Wh z predchozich relaci (energie relace je v kWh).
+static float s_energy_remainder_wh = 0.0f;
+
+// Kopie hodnot pro cteni z jinych tasku (webapp).
+static portMUX_TYPE s_values_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t s_values[PROVOZNI_CITAC_COUNT] = {};
+
+static void publish_values(void)
+{
+    uint64_t values[PROVOZNI_CITAC_COUNT];
+    for (size_t i = 0; i < PROVOZNI_CITAC_COUNT; ++i) {
+        values[i] = s_counters.value(i);
+    }
+    taskENTER_CRITICAL(&s_values_mux);
+    for (size_t i = 0; i < PROVOZNI_CITAC_COUNT; ++i) {
+        s_values[i] = values[i];
+    }
+    taskEXIT_CRITICAL(&s_values_mux);
+}
+
+static void flush_counters(void)
+{
+    esp_err_t result = s_counters.flush();
+    if (result != ESP_OK) {
+        // Nezapsane prirustky zustavaji v RAM a zapisi se s dalsi davkou.
+        ESP_LOGW(TAG, "Zapis provoznich citacu selhal: %s", esp_err_to_name(result));
+    }
+    publish_values();
+}
+
+static void render_webapp_card(char *buffer, size_t buffer_len)
+{
+    const uint64_t chod_s = provozni_citace_get(PROVOZNI_CITAC_CHOD_S);
+    snprintf(buffer,
+             buffer_len,
+             "<table>"
+             "<tr><td>Startů čerpadla</td><td>%llu</td></tr>"
+             "<tr><td>Doba chodu</td><td>%llu h %02u min</td></tr>"
+             "<tr><td>Energie</td><td>%.3f kWh</td></tr>"
+             "<tr><td>Restartů</td><td>%llu</td></tr>"
+             "</table>",
+             (unsigned long long)provozni_citace_get(PROVOZNI_CITAC_STARTY),
+             (unsigned long long)(chod_s / 3600U),
+             (unsigned)((chod_s / 60U) % 60U),
+             (double)provozni_citace_get(PROVOZNI_CITAC_ENERGIE_WH) / 1000.0,
+             (unsigned long long)provozni_citace_get(PROVOZNI_CITAC_RESTARTY));
+}
+
+static void render_webapp_json(JsonWriter &json)
+{
+    json.beginObject();
+    for (size_t i = 0; i < PROVOZNI_CITAC_COUNT; ++i) {
+        json.key(PROVOZ_REGIONS[i].name);
+        json.integer((int64_t)provozni_citace_get((provozni_citac_t)i));
+    }
+    json.endObject();
+}
+
+} // namespace
+
+void provozni_citace_init(void)
+{
+    esp_err_t result = s_counters.init(PROVOZ_SET_NAME, PROVOZ_REGIONS, PROVOZNI_CITAC_COUNT);
+    if (result != ESP_OK) {
+        ESP_LOGE(TAG, "Provozni citace nejsou k dispozici: %s", esp_err_to_name(result));
+        return;
+    }
+    s_ready = true;
+
+    (void)s_counters.add(PROVOZNI_CITAC_RESTARTY, 1);
+    flush_counters();
+
+    APP_ERROR_CHECK("E774", config_webapp_add_status_card("Provozní čítače", render_webapp_card));
+    APP_ERROR_CHECK("E778", config_webapp_add_json_section(CONFIG_WEBAPP_API_DIAG, "provozni_citace", render_webapp_json));
+    ESP_LOGI(TAG,
+             "Provozni citace: starty=%llu chod=%llu s energie=%llu Wh restarty=%llu",
+             (unsigned long long)s_counters.value(PROVOZNI_CITAC_STARTY),
+             (unsigned long long)s_counters.value(PROVOZNI_CITAC_CHOD_S),
+             (unsigned long long)s_counters.value(PROVOZNI_CITAC_ENERGIE_WH),
+             (unsigned long long)s_counters.value(PROVOZNI_CITAC_RESTARTY));
+}
+
+void provozni_citace_on_session(const pump_session_record_t *record)
+{
+    if (!s_ready || record == nullptr) {
+        return;
+    }
+
+    (void)s_counters.add(PROVOZNI_CITAC_STARTY, 1);
+    (void)s_counters.add(PROVOZNI_CITAC_CHOD_S, record->duration_s);
+    if (std::isfinite(record->energy_kwh) && record->energy_kwh > 0.0f) {
+        const float energy_wh = record->energy_kwh * 1000.0f + s_energy_remainder_wh;
+        const uint32_t whole_wh = (uint32_t)energy_wh;
+        s_energy_remainder_wh = energy_wh - (float)whole_wh;
+        (void)s_counters.add(PROVOZNI_CITAC_ENERGIE_WH, whole_wh);
+    }
+    flush_counters();
+}
+
+void provozni_citace_idle(void)
+{
+    // Behem relace ne: mazani sektoru by zdrzelo zpracovani udalosti cerpadla.
+    if (!s_ready || pump_session_is_active() || !s_counters.erase_pending()) {
+        return;
+    }
+    const esp_err_t result = s_counters.erase_step();
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Mazani banky provoznich citacu selhalo: %s", esp_err_to_name(result));
+    }
+}
+
+uint64_t provozni_citace_get(provozni_citac_t citac)
+{
+    if ((size_t)citac >= PROVOZNI_CITAC_COUNT) {
+        return 0;
+    }
+    taskENTER_CRITICAL(&s_values_mux);
+    const uint64_t value = s_values[citac];
+    taskEXIT_CRITICAL(&s_values_mux);
+    return value;
+}
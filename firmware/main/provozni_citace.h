@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pump_session.h"
+
+// Provozni citace cerpadla ve flash (FlashCounterSet nad user_data1..3): pocet startu,
+// doba chodu, energie a pocet restartu. Prirustky jedne relace se zapisuji jednou davkou.
+
+typedef enum {
+    PROVOZNI_CITAC_STARTY = 0,
+    PROVOZNI_CITAC_CHOD_S,
+    PROVOZNI_CITAC_ENERGIE_WH,
+    PROVOZNI_CITAC_RESTARTY,
+    PROVOZNI_CITAC_COUNT,
+} provozni_citac_t;
+
+// Nacte citace z flash a zapocita tento start.
+void provozni_citace_init(void);
+
+// Vola state_manager po uzavreni relace cerpani.
+void provozni_citace_on_session(const pump_session_record_t *record);
+
+// Vola state_manager v klidu (timeout fronty, udalost prutoku). Mimo relaci cerpani smaze
+// po preteceni citace A/B jeden sektor stare banky, jinak nic.
+void provozni_citace_idle(void);
+
+uint64_t provozni_citace_get(provozni_citac_t citac);
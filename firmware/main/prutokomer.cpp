@@ -5,8 +5,11 @@ extern "C" {
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_timer.h"
 #include "esp_task_wdt.h"
+#include "esp_system.h"
+#include "esp_attr.h"
 #include "driver/gpio.h"
 
 #ifdef __cplusplus
@@ -15,10 +18,14 @@ extern "C" {
 
 #include "pins.h"
 #include "sensor_events.h"
-#include "flash_monotonic_counter.h"
+#include "flash_tiered_counter.h"
 #include "config_store.h"
 #include "app_error_check.h"
 #include "debug_mqtt.h"
+#include "flow_pulse_source.h"
+#include "flow_rate_estimator.hpp"
+#include "flow_simulator_profile.hpp"
+#include "flow_totalizer.hpp"
 #include <math.h>
 
 #define TAG "prutokomer"
@@ -26,20 +33,30 @@ extern "C" {
 static constexpr int32_t FLOW_DEFAULT_PULSES_PER_LITER = 38; // F = 4.5 * Q, Q v l/min
 static constexpr int32_t FLOW_MIN_PULSES_PER_LITER = 1;
 static constexpr int32_t FLOW_MAX_PULSES_PER_LITER = 200;
-static constexpr uint32_t COUNTER_INCREMENT_LITERS = 1; // Kolik litrů odpovídá jednomu kroku v monotonic counteru
+static constexpr uint32_t FLOW_COUNTER_STEPS_PER_LITER = 10; // krok citace = 0.1 l
+static constexpr uint32_t FLOW_LEGACY_STEPS_PER_LITER = 1;   // puvodni citac pres cely oddil pocital litry
 static constexpr TickType_t FLOW_SAMPLE_PERIOD = pdMS_TO_TICKS(200);
 static constexpr UBaseType_t FLOW_TASK_STACK_SIZE = 4096;
+static constexpr UBaseType_t FLOW_PERSIST_TASK_STACK_SIZE = 4096;
+static constexpr uint32_t FLOW_PERSIST_BATCH_LITERS = 10;               // zápis po 10 l ...
+static constexpr int64_t FLOW_PERSIST_PERIOD_US = 60LL * 1000LL * 1000LL; // ... nebo po minutě
+static constexpr int64_t FLOW_PERSIST_IDLE_US = 5LL * 1000LL * 1000LL;    // ... nebo 5 s po poslednim impulsu
+static constexpr TickType_t FLOW_PERSIST_POLL_PERIOD = pdMS_TO_TICKS(1000);
+static constexpr TickType_t FLOW_PERSIST_SHUTDOWN_WAIT = pdMS_TO_TICKS(500);
+static constexpr uint32_t FLOW_JOURNAL_MAGIC = 0x464C4A32; // "FLJ2", nezapsany zbytek v tickach
 static constexpr uint8_t FLOW_LOG_EVERY_N_SAMPLES = 5;
-static constexpr uint32_t FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE = 128;
-static constexpr int64_t FLOW_TARGET_WINDOW_US = 1500000; // cílové okno historie pro odhad průtoku
-static constexpr uint32_t FLOW_MIN_INTERVALS_FOR_ESTIMATE = 4;
+static constexpr uint32_t FLOW_TARGET_WINDOW_PULSES = 16; // při vysokém průtoku okno podle počtu impulsů
+static constexpr uint32_t FLOW_MAX_WINDOW_US = 4000000;  // při nízkém průtoku okno omezené časem
+static constexpr uint32_t FLOW_ZERO_MIN_US = 1000000;    // nejdřív po této době bez impulsu může být průtok 0
 static constexpr uint32_t FLOW_ZERO_TIMEOUT_US = 3000000; // pokud bez impulsu, průtok = 0
+static constexpr float FLOW_ZERO_INTERVALS = 4.0f;        // nula po 4 očekávaných intervalech bez impulsu
+static constexpr float FLOW_MIN_INTERVAL_CV = 0.05f;
 
 static constexpr bool FLOW_SIMULATOR_ENABLED = false;
 static constexpr uint32_t FLOW_SIMULATED_PULSE_WIDTH_US = 1000;
 static constexpr const char *FLOW_SIMULATOR_PERIODIC_TIMER_NAME = "flow_sim_period";
 static constexpr const char *FLOW_SIMULATOR_PULSE_OFF_TIMER_NAME = "flow_sim_off";
-static constexpr TickType_t FLOW_SIMULATOR_PROFILE_UPDATE_PERIOD = pdMS_TO_TICKS(200);
+static constexpr TickType_t FLOW_SIMULATOR_PROFILE_UPDATE_PERIOD = pdMS_TO_TICKS(FLOW_SIMULATOR_PROFILE_UPDATE_MS);
 static constexpr UBaseType_t FLOW_SIMULATOR_TASK_STACK_SIZE = 3072;
 
 static const config_item_t FLOW_PULSES_PER_LITER_ITEM = {
@@ -50,19 +67,41 @@ static const config_item_t FLOW_PULSES_PER_LITER_ITEM = {
 
 static const char *FLOW_COUNTER_PARTITION_LABEL = "flow_data0";
 
-// Kruhový buffer posledních N časů impulsů pro výpočet průtoku
-static int64_t s_pulse_timestamps[FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE];
-static volatile uint32_t s_pulse_write_idx = 0;
-
-// sdílený counter z ISR
-static volatile uint32_t pulse_count = 0;
-static portMUX_TYPE s_pulse_count_mux = portMUX_INITIALIZER_UNLOCKED;
-static FlashMonotonicCounter s_flow_counter;
-static uint64_t s_persisted_counter_steps = 0;
-static uint64_t s_unpersisted_pulses = 0;
+static const FlowRateEstimator s_flow_estimator(FlowRateEstimator::Config{
+    FLOW_TARGET_WINDOW_PULSES,
+    FLOW_MAX_WINDOW_US,
+    FLOW_ZERO_MIN_US,
+    FLOW_ZERO_TIMEOUT_US,
+    FLOW_ZERO_INTERVALS,
+    FLOW_MIN_INTERVAL_CV,
+});
+static uint32_t s_counted_total = 0;
+static uint32_t s_estimate_total = 0;
+static int64_t s_estimate_total_changed_us = 0;
+static FlashTieredCounter s_flow_counter;
+// Stav totalizeru sdili merici task (impulsy) a persistencni task (zapis do flash).
+static FlowTotalizer s_flow_totalizer(FLOW_COUNTER_STEPS_PER_LITER,
+                                      FLOW_PERSIST_BATCH_LITERS * FLOW_COUNTER_STEPS_PER_LITER,
+                                      FLOW_PERSIST_PERIOD_US,
+                                      FLOW_PERSIST_IDLE_US);
+static portMUX_TYPE s_flow_totalizer_mux = portMUX_INITIALIZER_UNLOCKED;
+// Zapisy citace (persistencni task vs. shutdown handler).
+static StaticSemaphore_t s_flow_persist_mutex_buffer;
+static SemaphoreHandle_t s_flow_persist_mutex = nullptr;
+static TaskHandle_t s_flow_persist_task = nullptr;
+
+// Nezapsany zbytek v RTC pameti: prezije SW restart, panic a watchdog (a brown-out,
+// pokud RTC pamet udrzi napeti), takze se po restartu ztrati nanejvys jedna davka.
+typedef struct {
+    uint32_t magic;
+    uint32_t pulses_per_liter;
+    uint64_t persisted_steps;
+    uint64_t unpersisted_ticks;
+    uint32_t check;
+} flow_power_fail_journal_t;
+
+static RTC_NOINIT_ATTR flow_power_fail_journal_t s_flow_journal;
 static uint32_t s_flow_pulses_per_liter = static_cast<uint32_t>(FLOW_DEFAULT_PULSES_PER_LITER);
-static uint32_t s_pulses_per_counter_increment =
-    static_cast<uint32_t>(FLOW_DEFAULT_PULSES_PER_LITER) * COUNTER_INCREMENT_LITERS;
 static esp_timer_handle_t s_flow_simulator_periodic_timer = nullptr;
 static esp_timer_handle_t s_flow_simulator_pulse_off_timer = nullptr;
 static uint32_t s_flow_simulator_pulse_width_us = FLOW_SIMULATED_PULSE_WIDTH_US;
@@ -70,27 +109,6 @@ static float s_flow_simulator_current_l_min = 0.0f;
 static bool s_prutok_zaokrouhleny_valid = false;
 static float s_prutok_zaokrouhleny = 0.0f;
 
-typedef struct {
-    const char *name;
-    float start_l_min;
-    float end_l_min;
-    TickType_t duration_ticks;
-} flow_simulator_profile_step_t;
-
-static const flow_simulator_profile_step_t FLOW_SIMULATOR_PROFILE[] = {
-    {.name = "stopped",        .start_l_min = 0.0f,  .end_l_min = 0.0f,  .duration_ticks = pdMS_TO_TICKS(3000)},
-    {.name = "slow_rise",      .start_l_min = 0.0f,  .end_l_min = 8.0f,  .duration_ticks = pdMS_TO_TICKS(12000)},
-    {.name = "fast_rise",      .start_l_min = 8.0f,  .end_l_min = 55.0f, .duration_ticks = pdMS_TO_TICKS(5000)},
-    {.name = "hold_high",      .start_l_min = 55.0f, .end_l_min = 55.0f, .duration_ticks = pdMS_TO_TICKS(5000)},
-    {.name = "slow_fall",      .start_l_min = 55.0f, .end_l_min = 18.0f, .duration_ticks = pdMS_TO_TICKS(10000)},
-    {.name = "fast_stop",      .start_l_min = 18.0f, .end_l_min = 0.0f,  .duration_ticks = pdMS_TO_TICKS(4000)},
-    {.name = "stopped_again",  .start_l_min = 0.0f,  .end_l_min = 0.0f,  .duration_ticks = pdMS_TO_TICKS(4000)},
-    {.name = "quick_restart",  .start_l_min = 0.0f,  .end_l_min = 42.0f, .duration_ticks = pdMS_TO_TICKS(3000)},
-    {.name = "hold_medium",    .start_l_min = 42.0f, .end_l_min = 42.0f, .duration_ticks = pdMS_TO_TICKS(5000)},
-    {.name = "slow_taper",     .start_l_min = 42.0f, .end_l_min = 6.0f,  .duration_ticks = pdMS_TO_TICKS(8000)},
-    {.name = "hold_low",       .start_l_min = 6.0f,  .end_l_min = 6.0f,  .duration_ticks = pdMS_TO_TICKS(5000)},
-};
-
 void prutokomer_register_config_items(void)
 {
     APP_ERROR_CHECK("E706", config_store_register_item(&FLOW_PULSES_PER_LITER_ITEM));
@@ -107,30 +125,13 @@ static void load_flow_config(void)
                    : configured);
 
     s_flow_pulses_per_liter = static_cast<uint32_t>(clamped);
-    s_pulses_per_counter_increment = s_flow_pulses_per_liter * COUNTER_INCREMENT_LITERS;
-}
-
-// ISR handler - počítá pulsy a ukládá časy do bufferu
-static void IRAM_ATTR flow_isr_handler(void *arg) {
-    (void)arg;
-    int64_t timestamp = esp_timer_get_time();
-    
-    // Počítat pulsy pro celkový objem
-    portENTER_CRITICAL_ISR(&s_pulse_count_mux);
-    pulse_count += 1;
-    portEXIT_CRITICAL_ISR(&s_pulse_count_mux);
-
-    s_pulse_timestamps[s_pulse_write_idx] = timestamp;
-    s_pulse_write_idx = (s_pulse_write_idx + 1) % FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE;
 }
 
 static uint32_t get_and_clear_pulse_count(void)
 {
-    uint32_t count = 0;
-    portENTER_CRITICAL(&s_pulse_count_mux);
-    count = pulse_count;
-    pulse_count = 0;
-    portEXIT_CRITICAL(&s_pulse_count_mux);
+    const uint32_t total = flow_pulse_source_total();
+    const uint32_t count = total - s_counted_total;
+    s_counted_total = total;
     return count;
 }
 
@@ -235,18 +236,14 @@ static void flow_pulse_simulator_task(void *pvParameters)
     (void)pvParameters;
 
     while (1) {
-        for (size_t step_index = 0; step_index < (sizeof(FLOW_SIMULATOR_PROFILE) / sizeof(FLOW_SIMULATOR_PROFILE[0])); ++step_index) {
+        for (size_t step_index = 0; step_index < FLOW_SIMULATOR_PROFILE_STEPS; ++step_index) {
             const flow_simulator_profile_step_t &step = FLOW_SIMULATOR_PROFILE[step_index];
             const TickType_t update_ticks =
                 (FLOW_SIMULATOR_PROFILE_UPDATE_PERIOD > 0) ? FLOW_SIMULATOR_PROFILE_UPDATE_PERIOD : 1;
-            const TickType_t duration_ticks = (step.duration_ticks > 0) ? step.duration_ticks : update_ticks;
-            const uint32_t updates = (uint32_t)((duration_ticks + update_ticks - 1) / update_ticks);
+            const uint32_t updates = flow_simulator_step_updates(step);
 
             for (uint32_t update_index = 0; update_index < updates; ++update_index) {
-                const float progress =
-                    (updates <= 1) ? 1.0f : (float)update_index / (float)(updates - 1U);
-                const float flow_l_min =
-                    step.start_l_min + ((step.end_l_min - step.start_l_min) * progress);
+                const float flow_l_min = flow_simulator_step_setpoint(step, update_index);
 
                 APP_ERROR_CHECK("E721", nastav_flow_simulator_prutok(flow_l_min));
                 ESP_LOGI(TAG,
@@ -259,53 +256,25 @@ static void flow_pulse_simulator_task(void *pvParameters)
     }
 }
 
-static float vypocitej_surovy_prutok(int64_t now_us)
+static FlowRateEstimator::Estimate vypocitej_surovy_prutok(int64_t now_us)
 {
-    const uint32_t write_idx = s_pulse_write_idx;
-    int64_t last_pulse_time = 0;
-    int64_t first_pulse_time = 0;
-    uint32_t intervals = 0;
-
-    const uint32_t last_idx =
-        (write_idx + FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE - 1U) % FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE;
-    last_pulse_time = s_pulse_timestamps[last_idx];
-
-    if (last_pulse_time <= 0) {
-        return 0.0f;
-    }
-
-    const int64_t time_since_last_pulse = now_us - last_pulse_time;
-    if (time_since_last_pulse > FLOW_ZERO_TIMEOUT_US) {
-        return 0.0f;
-    }
-
-    first_pulse_time = last_pulse_time;
-
-    for (uint32_t step = 1; step < FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE; ++step) {
-        const uint32_t idx =
-            (last_idx + FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE - step) % FLOW_PULSE_TIMESTAMPS_BUFFER_SIZE;
-        const int64_t candidate_time = s_pulse_timestamps[idx];
-
-        if (candidate_time <= 0 || candidate_time > first_pulse_time) {
-            break;
-        }
-
-        first_pulse_time = candidate_time;
-        intervals = step;
-
-        const int64_t time_span_us = last_pulse_time - first_pulse_time;
-        if (time_span_us >= FLOW_TARGET_WINDOW_US && intervals >= FLOW_MIN_INTERVALS_FOR_ESTIMATE) {
-            break;
-        }
+    uint32_t timestamps[FLOW_PULSE_SOURCE_MAX_TIMESTAMPS];
+    uint32_t sequence = 0;
+    const uint32_t count = flow_pulse_source_snapshot(timestamps, FLOW_PULSE_SOURCE_MAX_TIMESTAMPS, &sequence);
+
+    // Zero timeout se hlida podle celkoveho poctu impulsu, ktery roste s kazdym impulsem
+    // i u PCNT backendu, kde se cas zachyti jen u kazdeho N-teho. Zaroven chrani pred
+    // pretecenim 32bitovych casu (~71 min) u davno starych zaznamu.
+    const uint32_t total = flow_pulse_source_total();
+    if (total != s_estimate_total) {
+        s_estimate_total = total;
+        s_estimate_total_changed_us = now_us;
     }
-
-    const int64_t time_span_us = last_pulse_time - first_pulse_time;
-    if (time_span_us <= 0 || intervals == 0) {
-        return 0.0f;
+    if (count == 0 || (now_us - s_estimate_total_changed_us) > FLOW_ZERO_TIMEOUT_US) {
+        return FlowRateEstimator::Estimate{0.0f, 0.0f, 1.0f, 0, 0, false};
     }
 
-    return (static_cast<float>(intervals) * 60000000.0f)
-         / (static_cast<float>(time_span_us) * static_cast<float>(s_flow_pulses_per_liter));
+    return s_flow_estimator.estimate(timestamps, count, flow_pulse_source_pulses_per_timestamp(), (uint32_t)now_us);
 }
 
 static float zaokrouhli_prutok_s_hysterezi(float prutok)
@@ -345,29 +314,124 @@ static float zaokrouhli_prutok_s_hysterezi(float prutok)
     return s_prutok_zaokrouhleny;
 }
 
-static float zpracuj_cerpano_celkem(uint32_t sampled_pulses)
+static uint32_t flow_journal_check(const flow_power_fail_journal_t &journal)
 {
-    if (sampled_pulses > 0) {
-        s_unpersisted_pulses += static_cast<uint64_t>(sampled_pulses);
+    return ~(journal.magic
+             ^ journal.pulses_per_liter
+             ^ (uint32_t)journal.persisted_steps
+             ^ (uint32_t)(journal.persisted_steps >> 32)
+             ^ (uint32_t)journal.unpersisted_ticks
+             ^ (uint32_t)(journal.unpersisted_ticks >> 32));
+}
 
-        while (s_unpersisted_pulses >= static_cast<uint64_t>(s_pulses_per_counter_increment)) {
-            ESP_LOGD(TAG,
-                     "Persistuji krok flow counteru: %llu -> %llu (batch_pulses=%llu)",
-                     (unsigned long long)s_persisted_counter_steps,
-                     (unsigned long long)(s_persisted_counter_steps + 1),
-                     (unsigned long long)s_unpersisted_pulses);
-            const esp_err_t increment_result = s_flow_counter.increment(1);
-            if (increment_result != ESP_OK) {
-                ESP_LOGE(TAG, "Nelze zapsat flow counter: %s", esp_err_to_name(increment_result));
-                break;
+// Volat v kriticke sekci s_flow_totalizer_mux.
+static void flow_journal_update_locked(void)
+{
+    s_flow_journal.magic = FLOW_JOURNAL_MAGIC;
+    s_flow_journal.pulses_per_liter = s_flow_pulses_per_liter;
+    s_flow_journal.persisted_steps = s_flow_totalizer.persistedSteps();
+    s_flow_journal.unpersisted_ticks = s_flow_totalizer.unpersistedTicks();
+    s_flow_journal.check = flow_journal_check(s_flow_journal);
+}
+
+// Kolik nezapsanych ticku vratit z journalu po restartu. Kdyz citac mezitim zapsal
+// davku, ktera se do journalu uz nepropsala, odecte se (jeden krok = pulses_per_liter ticku).
+static uint64_t flow_journal_recover(uint64_t persisted_steps)
+{
+    const flow_power_fail_journal_t journal = s_flow_journal;
+    if (journal.magic != FLOW_JOURNAL_MAGIC
+        || journal.check != flow_journal_check(journal)
+        || journal.pulses_per_liter != s_flow_pulses_per_liter
+        || journal.persisted_steps > persisted_steps) {
+        return 0;
+    }
+
+    const uint64_t already_persisted = (persisted_steps - journal.persisted_steps) * (uint64_t)s_flow_pulses_per_liter;
+    return journal.unpersisted_ticks > already_persisted ? journal.unpersisted_ticks - already_persisted : 0;
+}
+
+// Zapise vsechny cele kroky z RAM jednim increment(n). Bezi mimo merici task.
+static esp_err_t persist_flow_batch(TickType_t wait)
+{
+    if (s_flow_persist_mutex == nullptr || xSemaphoreTake(s_flow_persist_mutex, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    taskENTER_CRITICAL(&s_flow_totalizer_mux);
+    const uint32_t steps = s_flow_totalizer.pendingSteps();
+    taskEXIT_CRITICAL(&s_flow_totalizer_mux);
+
+    esp_err_t result = ESP_OK;
+    if (steps > 0) {
+        // Pri chybe uprostred davky se potvrdi jen kroky, ktere citac opravdu zapsal.
+        const uint64_t value_before = s_flow_counter.value();
+        result = s_flow_counter.increment(steps);
+        const uint32_t written = (uint32_t)(s_flow_counter.value() - value_before);
+        if (written > 0) {
+            taskENTER_CRITICAL(&s_flow_totalizer_mux);
+            s_flow_totalizer.commitSteps(written, esp_timer_get_time());
+            flow_journal_update_locked();
+            taskEXIT_CRITICAL(&s_flow_totalizer_mux);
+            ESP_LOGD(TAG, "Flow counter +%lu kroku", (unsigned long)written);
+        }
+    }
+
+    xSemaphoreGive(s_flow_persist_mutex);
+    return result;
+}
+
+static void flow_persist_task(void *pvParameters)
+{
+    (void)pvParameters;
+    APP_ERROR_CHECK("E754", esp_task_wdt_add(nullptr));
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, FLOW_PERSIST_POLL_PERIOD);
+
+        taskENTER_CRITICAL(&s_flow_totalizer_mux);
+        const bool due = s_flow_totalizer.batchDue(esp_timer_get_time());
+        taskEXIT_CRITICAL(&s_flow_totalizer_mux);
+
+        if (due) {
+            const esp_err_t result = persist_flow_batch(portMAX_DELAY);
+            if (result != ESP_OK) {
+                ESP_LOGE(TAG, "Nelze zapsat flow counter: %s", esp_err_to_name(result));
+            }
+        } else if (s_flow_counter.erasePending() && xSemaphoreTake(s_flow_persist_mutex, 0) == pdTRUE) {
+            // Stara banka hrube urovne po preteceni, po sektorech mimo zapis davky.
+            const esp_err_t result = s_flow_counter.eraseStep();
+            xSemaphoreGive(s_flow_persist_mutex);
+            if (result != ESP_OK) {
+                ESP_LOGW(TAG, "Mazani banky flow counteru selhalo: %s", esp_err_to_name(result));
             }
-            s_persisted_counter_steps += 1;
-            s_unpersisted_pulses -= static_cast<uint64_t>(s_pulses_per_counter_increment);
         }
+
+        APP_ERROR_CHECK("E755", esp_task_wdt_reset());
+    }
+}
+
+// Posledni zapis pred rizenym restartem (OTA, cmd/restart, esp_restart()).
+static void flow_persist_shutdown_handler(void)
+{
+    const esp_err_t result = persist_flow_batch(FLOW_PERSIST_SHUTDOWN_WAIT);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Flow counter pred restartem nezapsan: %s", esp_err_to_name(result));
     }
+}
 
-    return static_cast<float>(s_persisted_counter_steps * COUNTER_INCREMENT_LITERS)
-         + (static_cast<float>(s_unpersisted_pulses) / static_cast<float>(s_flow_pulses_per_liter));
+static float zpracuj_cerpano_celkem(uint32_t sampled_pulses, int64_t now_us)
+{
+    taskENTER_CRITICAL(&s_flow_totalizer_mux);
+    s_flow_totalizer.addPulses(sampled_pulses, now_us);
+    flow_journal_update_locked();
+    const bool due = s_flow_totalizer.batchDue(now_us);
+    const float total = s_flow_totalizer.totalLiters();
+    taskEXIT_CRITICAL(&s_flow_totalizer_mux);
+
+    if (due && s_flow_persist_task != nullptr) {
+        xTaskNotifyGive(s_flow_persist_task);
+    }
+    return total;
 }
 
 static void pocitani_pulsu(void *pvParameters)
@@ -382,19 +446,23 @@ static void pocitani_pulsu(void *pvParameters)
 
         const int64_t now_us = esp_timer_get_time();
 
-        const float surovy_prutok = vypocitej_surovy_prutok(now_us);
+        const FlowRateEstimator::Estimate odhad = vypocitej_surovy_prutok(now_us);
+        const float prevod_na_l_min = 60.0f / static_cast<float>(s_flow_pulses_per_liter);
+        const float surovy_prutok = odhad.pulses_per_s * prevod_na_l_min;
+        const float nejistota_prutoku = odhad.uncertainty_per_s * prevod_na_l_min;
         const float publikovany_prutok = zaokrouhli_prutok_s_hysterezi(surovy_prutok);
 
         // Počet pulsů od poslední vzorky
         const uint32_t sampled_pulses = get_and_clear_pulse_count();
-        const float cerpano_celkem = zpracuj_cerpano_celkem(sampled_pulses);
+        const float cerpano_celkem = zpracuj_cerpano_celkem(sampled_pulses, now_us);
 
         sample_counter += 1;
         if (sample_counter >= FLOW_LOG_EVERY_N_SAMPLES) {
             sample_counter = 0;
             ESP_LOGD(TAG,
-                     "Prutok raw=%.3f rounded=%.3f l/min, celkem=%.2f l",
+                     "Prutok raw=%.3f +-%.3f rounded=%.3f l/min, celkem=%.2f l",
                      surovy_prutok,
+                     nejistota_prutoku,
                      publikovany_prutok,
                      cerpano_celkem);
         }
@@ -409,6 +477,9 @@ static void pocitani_pulsu(void *pvParameters)
                         .flow = {
                             .prutok = publikovany_prutok,
                             .cerpano_celkem = cerpano_celkem,
+                            .prutok_nejistota = nejistota_prutoku,
+                            .prutok_duvera = odhad.confidence,
+                            .impulsy_celkem = flow_pulse_source_total(),
                         },
                     },
                 },
@@ -417,15 +488,26 @@ static void pocitani_pulsu(void *pvParameters)
 
         bool queued = sensor_events_publish(&event, pdMS_TO_TICKS(20));
 
+        taskENTER_CRITICAL(&s_flow_totalizer_mux);
+        const uint64_t persisted_steps = s_flow_totalizer.persistedSteps();
+        const uint64_t unpersisted_ticks = s_flow_totalizer.unpersistedTicks();
+        taskEXIT_CRITICAL(&s_flow_totalizer_mux);
+
         DEBUG_PUBLISH("prutok",
-                      "queued=%d ts=%lld sampled_pulses=%lu raw_l_min=%.4f rounded_l_min=%.4f total_l=%.4f persisted_steps=%llu",
+                      "queued=%d ts=%lld sampled_pulses=%lu raw_l_min=%.4f sigma_l_min=%.4f conf=%.2f window=%lu/%lums decay=%d rounded_l_min=%.4f total_l=%.4f persisted_steps=%llu unpersisted_pulses=%.1f",
                       queued ? 1 : 0,
                       (long long)now_us,
                       (unsigned long)sampled_pulses,
                       (double)surovy_prutok,
+                      (double)nejistota_prutoku,
+                      (double)odhad.confidence,
+                      (unsigned long)odhad.window_pulses,
+                      (unsigned long)(odhad.window_us / 1000U),
+                      odhad.decaying ? 1 : 0,
                       (double)publikovany_prutok,
                       (double)cerpano_celkem,
-                      (unsigned long long)s_persisted_counter_steps);
+                      (unsigned long long)persisted_steps,
+                      (double)unpersisted_ticks / (double)FLOW_COUNTER_STEPS_PER_LITER);
 
         APP_ERROR_CHECK("E708", esp_task_wdt_reset());
     }
@@ -436,41 +518,43 @@ void prutokomer_init(void)
     load_flow_config();
 
     ESP_LOGI(TAG,
-             "Init flow: gpio=%d pulses_per_l=%lu sample_period_ms=%lu target_window_ms=%lld",
+             "Init flow: gpio=%d backend=%s pulses_per_l=%lu sample_period_ms=%lu window=%lu pulsu/%lu ms",
              (int)FLOW_SENSOR_GPIO,
+             flow_pulse_source_name(),
              (unsigned long)s_flow_pulses_per_liter,
              (unsigned long)pdTICKS_TO_MS(FLOW_SAMPLE_PERIOD),
-             (long long)(FLOW_TARGET_WINDOW_US / 1000));
+             (unsigned long)FLOW_TARGET_WINDOW_PULSES,
+             (unsigned long)(FLOW_MAX_WINDOW_US / 1000U));
 
-    APP_ERROR_CHECK("E709", s_flow_counter.init(FLOW_COUNTER_PARTITION_LABEL));
+    APP_ERROR_CHECK("E709", s_flow_counter.init(FLOW_COUNTER_PARTITION_LABEL,
+                                                FLOW_COUNTER_STEPS_PER_LITER / FLOW_LEGACY_STEPS_PER_LITER));
     // APP_ERROR_CHECK("E710", s_flow_counter.reset());
 
-    s_persisted_counter_steps = s_flow_counter.value();
-    s_unpersisted_pulses = 0;
+    const uint64_t persisted_steps = s_flow_counter.value();
+    const uint64_t recovered_ticks = flow_journal_recover(persisted_steps);
+    s_flow_totalizer.start(persisted_steps, s_flow_pulses_per_liter, esp_timer_get_time());
+    s_flow_totalizer.addTicks(recovered_ticks);
+    flow_journal_update_locked();
     
     ESP_LOGI(TAG,
-             "Flow counter inicializovan, kroky=%llu, objem=%llu l, pulses_per_l=%lu",
-             (unsigned long long)s_persisted_counter_steps,
-             (unsigned long long)(s_persisted_counter_steps * COUNTER_INCREMENT_LITERS),
+             "Flow counter inicializovan, kroky=%llu, objem=%.1f l, z journalu=%.1f pulsu, pulses_per_l=%lu",
+             (unsigned long long)s_flow_totalizer.persistedSteps(),
+             (double)s_flow_totalizer.persistedSteps() / (double)FLOW_COUNTER_STEPS_PER_LITER,
+             (double)recovered_ticks / (double)FLOW_COUNTER_STEPS_PER_LITER,
              (unsigned long)s_flow_pulses_per_liter);
-    //TODO Někam to nastavit ..
-
-    // --- Nastavení GPIO pro flow senzor ---
-    gpio_config_t io_conf = {
-        .pin_bit_mask = 1ULL << FLOW_SENSOR_GPIO,
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_POSEDGE
-    };
-    APP_ERROR_CHECK("E711", gpio_config(&io_conf));
 
-    APP_ERROR_CHECK("E712", gpio_install_isr_service(0));
-    APP_ERROR_CHECK("E713", gpio_isr_handler_add(FLOW_SENSOR_GPIO, flow_isr_handler, NULL));
+    s_flow_persist_mutex = xSemaphoreCreateMutexStatic(&s_flow_persist_mutex_buffer);
+    APP_ERROR_CHECK("E753",
+                    xTaskCreate(flow_persist_task, "flow_persist", FLOW_PERSIST_TASK_STACK_SIZE, NULL, 1, &s_flow_persist_task) == pdPASS
+                        ? ESP_OK
+                        : ESP_FAIL);
+    APP_ERROR_CHECK("E769", esp_register_shutdown_handler(flow_persist_shutdown_handler));
+    //TODO Někam to nastavit ..
 
-    ESP_LOGI(TAG,
-             "GPIO flow nastaven: pullup=1 pulldown=0 intr=posedge pin=%d",
-             (int)FLOW_SENSOR_GPIO);
+    // --- Zdroj impulsu flow senzoru (GPIO ISR nebo PCNT) ---
+    flow_pulse_source_init();
+    s_counted_total = flow_pulse_source_total();
+    s_estimate_total = s_counted_total;
 
     if (FLOW_SIMULATOR_ENABLED) {
         gpio_config_t sim_io_conf = {
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Lock-free kruhovy buffer casu impulsu pro jednoho producenta (ISR) a jednoho konzumenta (task).
+ * Uklada dolnich 32 bitu esp_timer_get_time(); rozdily se pocitaji modulo 2^32, takze jsou spravne
+ * pro intervaly kratsi nez ~71 min (starsi data musi konzument odfiltrovat sam).
+ *
+ * sequence() je volne bezici pocet vsech zapsanych impulsu a nahrazuje samostatny citac
+ * chraneny spinlockem. snapshot() zkopiruje posledni zaznamy a podle sekvence pred a po
+ * kopirovani zahodi ty, ktere mohl producent mezitim prepsat, takze vysledek je vzdy konzistentni.
+ *
+ * Priklad:
+ *   static PulseTimestampRing<128> s_ring;
+ *   s_ring.push((uint32_t)esp_timer_get_time());     // ISR
+ *   uint32_t ts[128]; uint32_t seq;
+ *   const uint32_t n = s_ring.snapshot(ts, 128, &seq); // task, ts[0] nejstarsi
+ */
+template<uint32_t Capacity>
+class PulseTimestampRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1U)) == 0, "Capacity musi byt mocnina 2");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "uint32_t atomiky musi byt lock-free");
+
+public:
+    static constexpr uint32_t CAPACITY = Capacity;
+
+    PulseTimestampRing() : head_(0)
+    {
+        for (uint32_t index = 0; index < Capacity; ++index) {
+            slots_[index].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Jen producent (ISR). Nejdriv zapise cas, az potom zverejni novou sekvenci.
+    inline __attribute__((always_inline)) void push(uint32_t timestamp_us)
+    {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        // Konzument, ktery uvidi novy cas ve slotu, musi po svem acquire uvidet i predchozi sekvenci.
+        std::atomic_thread_fence(std::memory_order_release);
+        slots_[head & MASK].store(timestamp_us, std::memory_order_relaxed);
+        head_.store(head + 1U, std::memory_order_release);
+    }
+
+    uint32_t sequence() const
+    {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Zkopiruje az max_count poslednich casu do out (od nejstarsiho po nejnovejsi).
+     * @param sequence_out sekvence odpovidajici poslednimu vracenemu zaznamu (+1)
+     * @return pocet platnych zaznamu
+     */
+    uint32_t snapshot(uint32_t *out, uint32_t max_count, uint32_t *sequence_out) const
+    {
+        const uint32_t head_before = head_.load(std::memory_order_acquire);
+        uint32_t count = head_before < Capacity ? head_before : Capacity;
+        if (count > max_count) {
+            count = max_count;
+        }
+
+        const uint32_t first = head_before - count;
+        for (uint32_t index = 0; index < count; ++index) {
+            out[index] = slots_[(first + index) & MASK].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint32_t head_after = head_.load(std::memory_order_relaxed);
+
+        // Producent mohl behem kopirovani prepsat sloty sekvenci < head_after + 1 - Capacity
+        // (zapis pro head_after muze prave probihat).
+        const uint32_t overwritten = head_after - head_before;
+        uint32_t skip = 0;
+        if (overwritten + 1U + count > Capacity) {
+            skip = overwritten + 1U + count - Capacity;
+            if (skip > count) {
+                skip = count;
+            }
+        }
+        if (skip > 0) {
+            for (uint32_t index = skip; index < count; ++index) {
+                out[index - skip] = out[index];
+            }
+            count -= skip;
+        }
+
+        if (sequence_out != nullptr) {
+            *sequence_out = head_before;
+        }
+        return count;
+    }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1U;
+
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> slots_[Capacity];
+};
@@ -0,0 +1,258 @@
+#include "pump_session.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <cmath>
+#include <cstdio>
+
+#include "config_store.h"
+#include "config_webapp.h"
+#include "debug_mqtt.h"
+#include "app_error_check.h"
+#include "pump_session_tracker.hpp"
+
+#define TAG "pump_session"
+
+namespace {
+
+// Kratke vypnuti (tlakovy spinac, vypadek odectu) relaci nerozdeli.
+static constexpr int64_t SESSION_END_HOLD_US = 10LL * 1000LL * 1000LL;
+static constexpr int64_t SESSION_MIN_US = 10LL * 1000LL * 1000LL;
+// Elektromer posila odecet aspon kazdych 10 s; starsi odecet uz neplati.
+static constexpr int64_t SESSION_POWER_STALE_US = 30LL * 1000LL * 1000LL;
+static constexpr float SESSION_DEFAULT_Q_MIN_L_MIN = 2.0f;
+
+static PumpSessionTracker s_tracker(SESSION_DEFAULT_Q_MIN_L_MIN,
+                                    SESSION_END_HOLD_US,
+                                    SESSION_MIN_US,
+                                    SESSION_POWER_STALE_US);
+
+// Kruhovy buffer dokoncenych relaci; cte ho i HTTP task webapp.
+static portMUX_TYPE s_recent_mux = portMUX_INITIALIZER_UNLOCKED;
+static pump_session_record_t s_recent[PUMP_SESSION_RECENT_COUNT] = {};
+static size_t s_recent_head = 0;
+static size_t s_recent_count = 0;
+
+static void store_record(const pump_session_record_t &record)
+{
+    taskENTER_CRITICAL(&s_recent_mux);
+    s_recent[s_recent_head] = record;
+    s_recent_head = (s_recent_head + 1U) % PUMP_SESSION_RECENT_COUNT;
+    if (s_recent_count < PUMP_SESSION_RECENT_COUNT) {
+        ++s_recent_count;
+    }
+    taskEXIT_CRITICAL(&s_recent_mux);
+}
+
+static bool finish_if_done(int64_t timestamp_us)
+{
+    PumpSessionTracker::Stats stats = {};
+    if (!s_tracker.update(timestamp_us, &stats)) {
+        return false;
+    }
+
+    const pump_session_record_t record = {
+        .start_uptime_s = (uint32_t)(stats.start_us / 1000000LL),
+        .duration_s = (uint32_t)(stats.duration_us / 1000000LL),
+        .volume_l = stats.volume_l,
+        .flow_mean_l_min = stats.flow_mean_l_min,
+        .flow_peak_l_min = stats.flow_peak_l_min,
+        .dp_mean_bar = stats.dp_mean_bar,
+        .energy_kwh = stats.energy_kwh,
+        .liters_per_kwh = stats.liters_per_kwh,
+    };
+    store_record(record);
+
+    ESP_LOGI(TAG,
+             "Relace: %lu s, %.1f l, q=%.1f/%.1f l/min, dp=%.3f bar, %.3f kWh, %.0f l/kWh",
+             (unsigned long)record.duration_s,
+             (double)record.volume_l,
+             (double)record.flow_mean_l_min,
+             (double)record.flow_peak_l_min,
+             (double)record.dp_mean_bar,
+             (double)record.energy_kwh,
+             (double)record.liters_per_kwh);
+    return true;
+}
+
+static int append_number_or_null(char *buffer, size_t buffer_len, const char *key, float value, const char *fmt)
+{
+    if (!std::isfinite(value)) {
+        return snprintf(buffer, buffer_len, ",\"%s\":null", key);
+    }
+    char number[24];
+    snprintf(number, sizeof(number), fmt, (double)value);
+    return snprintf(buffer, buffer_len, ",\"%s\":%s", key, number);
+}
+
+static void format_cell(char *buffer, size_t buffer_len, float value, const char *fmt)
+{
+    if (std::isfinite(value)) {
+        snprintf(buffer, buffer_len, fmt, (double)value);
+    } else {
+        snprintf(buffer, buffer_len, "-");
+    }
+}
+
+static void render_webapp_card(char *buffer, size_t buffer_len)
+{
+    pump_session_record_t records[PUMP_SESSION_RECENT_COUNT];
+    const size_t count = pump_session_get_recent(records, PUMP_SESSION_RECENT_COUNT);
+    if (count == 0) {
+        snprintf(buffer, buffer_len, "<p>Zatim zadna relace.</p>");
+        return;
+    }
+
+    size_t offset = 0;
+    int written = snprintf(buffer,
+                           buffer_len,
+                           "<table><tr><th>start [s]</th><th>doba [s]</th><th>objem [l]</th><th>Q prum/max [l/min]</th>"
+                           "<th>dP [bar]</th><th>energie [kWh]</th><th>l/kWh</th></tr>");
+    for (size_t i = 0; i < count && written > 0 && (size_t)written < buffer_len - offset; ++i) {
+        offset += (size_t)written;
+        const pump_session_record_t &r = records[i];
+        char dp[16];
+        char kwh[16];
+        char l_kwh[16];
+        format_cell(dp, sizeof(dp), r.dp_mean_bar, "%.3f");
+        format_cell(kwh, sizeof(kwh), r.energy_kwh, "%.3f");
+        format_cell(l_kwh, sizeof(l_kwh), r.liters_per_kwh, "%.0f");
+        written = snprintf(buffer + offset,
+                           buffer_len - offset,
+                           "<tr><td>%lu</td><td>%lu</td><td>%.1f</td><td>%.1f / %.1f</td><td>%s</td><td>%s</td><td>%s</td></tr>",
+                           (unsigned long)r.start_uptime_s,
+                           (unsigned long)r.duration_s,
+                           (double)r.volume_l,
+                           (double)r.flow_mean_l_min,
+                           (double)r.flow_peak_l_min,
+                           dp,
+                           kwh,
+                           l_kwh);
+    }
+    if (written > 0 && (size_t)written < buffer_len - offset) {
+        offset += (size_t)written;
+        snprintf(buffer + offset, buffer_len - offset, "</table>");
+    }
+}
+
+// /api/diag: posledni relace (nejnovejsi prvni) ve stejnem tvaru jako MQTT stav/cerpani/relace.
+static void render_webapp_json(JsonWriter &json)
+{
+    pump_session_record_t records[PUMP_SESSION_RECENT_COUNT];
+    const size_t count = pump_session_get_recent(records, PUMP_SESSION_RECENT_COUNT);
+    json.beginArray();
+    for (size_t i = 0; i < count; ++i) {
+        char record_json[160];
+        if (pump_session_format_json(&records[i], record_json, sizeof(record_json)) > 0) {
+            json.raw(record_json);
+        }
+    }
+    json.endArray();
+}
+
+} // namespace
+
+void pump_session_init(void)
+{
+    const float q_min = config_store_get_float("flt_q_min");
+    if (q_min > 0.0f) {
+        s_tracker.setMinFlow(q_min);
+    }
+
+    APP_ERROR_CHECK("E770", config_webapp_add_status_card("Relace čerpání", render_webapp_card));
+    APP_ERROR_CHECK("E777", config_webapp_add_json_section(CONFIG_WEBAPP_API_DIAG, "relace_cerpani", render_webapp_json));
+    ESP_LOGI(TAG,
+             "Relace cerpani: q_min=%.1f l/min konec po %lld s klidu",
+             (double)(q_min > 0.0f ? q_min : SESSION_DEFAULT_Q_MIN_L_MIN),
+             (long long)(SESSION_END_HOLD_US / 1000000LL));
+}
+
+bool pump_session_on_flow(float prutok_l_min, float cerpano_celkem_l, int64_t timestamp_us)
+{
+    s_tracker.onFlow(prutok_l_min, cerpano_celkem_l, timestamp_us);
+    return finish_if_done(timestamp_us);
+}
+
+void pump_session_on_pressure(float rozdil_bar, int64_t timestamp_us)
+{
+    s_tracker.onPressure(rozdil_bar, timestamp_us);
+}
+
+bool pump_session_on_power(bool meter_ok, bool running, float vykon_w, int64_t timestamp_us)
+{
+    s_tracker.onPower(meter_ok, running, vykon_w, timestamp_us);
+    const bool was_active = s_tracker.active();
+    const bool finished = finish_if_done(timestamp_us);
+    if (!was_active && s_tracker.active()) {
+        DEBUG_PUBLISH("relace", "start p=%.1f W", (double)vykon_w);
+    }
+    return finished;
+}
+
+bool pump_session_is_active(void)
+{
+    return s_tracker.active();
+}
+
+size_t pump_session_get_recent(pump_session_record_t *out, size_t max_count)
+{
+    if (out == nullptr) {
+        return 0;
+    }
+
+    taskENTER_CRITICAL(&s_recent_mux);
+    const size_t count = s_recent_count < max_count ? s_recent_count : max_count;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = (s_recent_head + PUMP_SESSION_RECENT_COUNT - 1U - i) % PUMP_SESSION_RECENT_COUNT;
+        out[i] = s_recent[index];
+    }
+    taskEXIT_CRITICAL(&s_recent_mux);
+    return count;
+}
+
+int pump_session_format_json(const pump_session_record_t *record, char *buffer, size_t buffer_len)
+{
+    if (record == nullptr || buffer == nullptr || buffer_len == 0) {
+        return -1;
+    }
+
+    int offset = snprintf(buffer,
+                          buffer_len,
+                          "{\"up\":%lu,\"s\":%lu",
+                          (unsigned long)record->start_uptime_s,
+                          (unsigned long)record->duration_s);
+    const struct {
+        const char *key;
+        float value;
+        const char *fmt;
+    } fields[] = {
+        {"l", record->volume_l, "%.1f"},
+        {"q", record->flow_mean_l_min, "%.1f"},
+        {"q_max", record->flow_peak_l_min, "%.1f"},
+        {"dp", record->dp_mean_bar, "%.3f"},
+        {"kwh", record->energy_kwh, "%.3f"},
+        {"l_kwh", record->liters_per_kwh, "%.0f"},
+    };
+    for (const auto &field : fields) {
+        if (offset < 0 || (size_t)offset >= buffer_len) {
+            return -1;
+        }
+        offset += append_number_or_null(buffer + offset, buffer_len - (size_t)offset, field.key, field.value, field.fmt);
+    }
+    if (offset < 0 || (size_t)offset + 1U >= buffer_len) {
+        return -1;
+    }
+    buffer[offset++] = '}';
+    buffer[offset] = '\0';
+    return offset;
+}
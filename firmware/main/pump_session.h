@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Relace cerpani: chod cerpadla podle elektromeru (bez nej podle prutoku) a statistiky
+// kazde relace z prubeznych integralu (PumpSessionTracker). Dokoncene relace se drzi
+// v malem kruhovem bufferu pro webapp a publikuji se jako JSON.
+
+#define PUMP_SESSION_RECENT_COUNT 8
+
+typedef struct {
+    uint32_t start_uptime_s;
+    uint32_t duration_s;
+    float volume_l;
+    float flow_mean_l_min;
+    float flow_peak_l_min;
+    float dp_mean_bar;          // NaN = bez mereni tlaku
+    float energy_kwh;           // NaN = bez elektromeru
+    float liters_per_kwh;       // NaN = bez energie
+} pump_session_record_t;
+
+void pump_session_init(void);
+
+// Vola state_manager pri kazde udalosti prutoku / tlaku / elektromeru. Vraci true,
+// kdyz se prave uzavrela relace (je v pump_session_get_recent na indexu 0).
+bool pump_session_on_flow(float prutok_l_min, float cerpano_celkem_l, int64_t timestamp_us);
+void pump_session_on_pressure(float rozdil_bar, int64_t timestamp_us);
+bool pump_session_on_power(bool meter_ok, bool running, float vykon_w, int64_t timestamp_us);
+
+// Probiha relace (cerpadlo bezi nebo se ceka na jeji konec).
+bool pump_session_is_active(void);
+
+// Posledni relace, nejnovejsi prvni. Vraci pocet zapsanych zaznamu.
+size_t pump_session_get_recent(pump_session_record_t *out, size_t max_count);
+
+// Kompaktni JSON zaznam relace (vejde se do MQTT_PUBLISH_TEXT_MAX_LEN).
+int pump_session_format_json(const pump_session_record_t *record, char *buffer, size_t buffer_len);
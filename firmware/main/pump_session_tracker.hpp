@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Relace cerpani (zapnuti az vypnuti cerpadla) a jejich statistiky z prubeznych vstupu.
+ *
+ * Cerpadlo bezi podle elektromeru (onPower), dokud prichazi platna data. Kdyz elektromer
+ * neodpovida nebo je posledni odecet starsi nez power_stale_us, rozhoduje prutok >= q_min.
+ * Relace konci az po end_hold_us bez chodu, kratke vypadky uvnitr relace ji tedy nerozdeli.
+ * Doba relace je doba chodu (do prvniho vypnuti), objem zahrnuje i dobeh v end_hold_us.
+ *
+ * Vsechny prumery jsou casove vazene integraly s drzenim posledni hodnoty (jako ve filtr_trend),
+ * relace drzi jen nekolik sum a nic neprochazi zpetne:
+ *  - objem z rozdilu cerpano_celkem (nebo z integralu prutoku, kdyz celkovy objem neni),
+ *  - prumerny a spickovy prutok za dobu chodu,
+ *  - prumerny rozdil tlaku na filtru za dobu chodu, kdy prutok >= q_min,
+ *  - energie z integralu cinneho vykonu; jen kdyz elektromer pokryl aspon 90 % relace.
+ *
+ * Priklad:
+ *   PumpSessionTracker tracker(2.0f, 10000000, 10000000, 30000000);
+ *   tracker.onPower(true, true, 750.0f, now_us);
+ *   tracker.onFlow(28.0f, 1234.5f, now_us);
+ *   PumpSessionTracker::Stats stats;
+ *   if (tracker.update(now_us, &stats)) { ... relace skoncila ... }
+ */
+class PumpSessionTracker
+{
+public:
+    struct Stats {
+        int64_t start_us;
+        int64_t duration_us;        // doba chodu, bez dobehu
+        float volume_l;
+        float flow_mean_l_min;
+        float flow_peak_l_min;
+        float dp_mean_bar;          // NaN = bez mereni tlaku
+        float energy_kwh;           // NaN = bez elektromeru
+        float liters_per_kwh;       // NaN = bez energie
+    };
+
+    PumpSessionTracker(float q_min_l_min, int64_t end_hold_us, int64_t min_duration_us, int64_t power_stale_us)
+        : q_min_l_min_(q_min_l_min),
+          end_hold_us_(end_hold_us),
+          min_duration_us_(min_duration_us),
+          power_stale_us_(power_stale_us)
+    {
+    }
+
+    void setMinFlow(float q_min_l_min)
+    {
+        q_min_l_min_ = q_min_l_min;
+    }
+
+    void onFlow(float prutok_l_min, float cerpano_celkem_l, int64_t now_us)
+    {
+        accumulate(now_us);
+        flow_l_min_ = std::isfinite(prutok_l_min) && prutok_l_min > 0.0f ? prutok_l_min : 0.0f;
+        if (std::isfinite(cerpano_celkem_l)) {
+            total_l_ = cerpano_celkem_l;
+        }
+        if (open_ && flow_l_min_ > flow_peak_l_min_) {
+            flow_peak_l_min_ = flow_l_min_;
+        }
+    }
+
+    void onPressure(float rozdil_bar, int64_t now_us)
+    {
+        accumulate(now_us);
+        dp_bar_ = rozdil_bar;
+    }
+
+    // meter_ok = false: elektromer neodpovedel, rozhoduje prutok.
+    void onPower(bool meter_ok, bool running, float power_w, int64_t now_us)
+    {
+        accumulate(now_us);
+        meter_ok_ = meter_ok && std::isfinite(power_w);
+        power_running_ = running;
+        power_w_ = meter_ok_ ? power_w : 0.0f;
+        last_power_us_ = now_us;
+    }
+
+    // Vyhodnoti chod k casu now_us. Vraci true, kdyz se prave uzavrela relace delsi nez
+    // min_duration_us; jeji statistiky jsou v *out.
+    bool update(int64_t now_us, Stats *out)
+    {
+        accumulate(now_us);
+        const bool running = isRunning(now_us);
+
+        if (!open_) {
+            if (running) {
+                open(now_us);
+            }
+            return false;
+        }
+
+        if (running) {
+            stop_us_ = 0;
+            return false;
+        }
+
+        if (stop_us_ == 0) {
+            stop_us_ = now_us;
+        }
+        if (now_us - stop_us_ < end_hold_us_) {
+            return false;
+        }
+
+        open_ = false;
+        const int64_t duration_us = stop_us_ - start_us_;
+        if (duration_us < min_duration_us_ || out == nullptr) {
+            return false;
+        }
+        finish(now_us, duration_us, out);
+        return true;
+    }
+
+    bool active() const
+    {
+        return open_;
+    }
+
+    bool isRunning(int64_t now_us) const
+    {
+        if (meter_ok_ && now_us - last_power_us_ <= power_stale_us_) {
+            return power_running_;
+        }
+        return flow_l_min_ >= q_min_l_min_;
+    }
+
+private:
+    static constexpr double US_PER_MIN = 60.0e6;
+    static constexpr double US_PER_HOUR = 3600.0e6;
+
+    void open(int64_t now_us)
+    {
+        open_ = true;
+        start_us_ = now_us;
+        stop_us_ = 0;
+        start_total_l_ = total_l_;
+        flow_peak_l_min_ = flow_l_min_;
+        flow_integral_ = 0.0;
+        tail_flow_integral_ = 0.0;
+        run_time_us_ = 0.0;
+        dp_integral_ = 0.0;
+        dp_time_us_ = 0.0;
+        energy_integral_ = 0.0;
+        energy_time_us_ = 0.0;
+    }
+
+    void accumulate(int64_t now_us)
+    {
+        if (open_ && now_us > last_update_us_) {
+            const int64_t from_us = last_update_us_ > start_us_ ? last_update_us_ : start_us_;
+            const double dt_us = (double)(now_us - from_us);
+            if (dt_us > 0.0) {
+                // Doba chodu konci prvnim vypnutim; dobeh se pocita jen do objemu a energie.
+                if (stop_us_ == 0) {
+                    flow_integral_ += (double)flow_l_min_ * dt_us;
+                    run_time_us_ += dt_us;
+                    if (std::isfinite(dp_bar_) && flow_l_min_ >= q_min_l_min_) {
+                        dp_integral_ += (double)dp_bar_ * dt_us;
+                        dp_time_us_ += dt_us;
+                    }
+                } else {
+                    tail_flow_integral_ += (double)flow_l_min_ * dt_us;
+                }
+                if (meter_ok_ && from_us - last_power_us_ <= power_stale_us_) {
+                    energy_integral_ += (double)power_w_ * dt_us;
+                    energy_time_us_ += dt_us;
+                }
+            }
+        }
+        if (now_us > last_update_us_) {
+            last_update_us_ = now_us;
+        }
+    }
+
+    void finish(int64_t now_us, int64_t duration_us, Stats *out)
+    {
+        const double flow_volume_l = (flow_integral_ + tail_flow_integral_) / US_PER_MIN;
+        const float volume_l = (std::isfinite(start_total_l_) && std::isfinite(total_l_) && total_l_ >= start_total_l_)
+                             ? total_l_ - start_total_l_
+                             : (float)flow_volume_l;
+
+        out->start_us = start_us_;
+        out->duration_us = duration_us;
+        out->volume_l = volume_l;
+        out->flow_mean_l_min = run_time_us_ > 0.0 ? (float)(flow_integral_ / run_time_us_) : 0.0f;
+        out->flow_peak_l_min = flow_peak_l_min_;
+        out->dp_mean_bar = dp_time_us_ > 0.0 ? (float)(dp_integral_ / dp_time_us_) : NAN;
+
+        const double session_us = (double)(now_us - start_us_);
+        if (energy_time_us_ >= 0.9 * session_us && energy_integral_ > 0.0) {
+            const double energy_kwh = energy_integral_ / US_PER_HOUR / 1000.0;
+            out->energy_kwh = (float)energy_kwh;
+            out->liters_per_kwh = (float)((double)volume_l / energy_kwh);
+        } else {
+            out->energy_kwh = NAN;
+            out->liters_per_kwh = NAN;
+        }
+    }
+
+    float q_min_l_min_;
+    int64_t end_hold_us_;
+    int64_t min_duration_us_;
+    int64_t power_stale_us_;
+
+    // Posledni vstupy (drzi se do dalsi udalosti)
+    float flow_l_min_ = 0.0f;
+    float total_l_ = NAN;
+    float dp_bar_ = NAN;
+    bool meter_ok_ = false;
+    bool power_running_ = false;
+    float power_w_ = 0.0f;
+    int64_t last_power_us_ = 0;
+    int64_t last_update_us_ = 0;
+
+    // Probihajici relace
+    bool open_ = false;
+    int64_t start_us_ = 0;
+    int64_t stop_us_ = 0;           // 0 = cerpadlo bezi
+    float start_total_l_ = NAN;
+    float flow_peak_l_min_ = 0.0f;
+    double flow_integral_ = 0.0;    // l/min * us
+    double tail_flow_integral_ = 0.0;
+    double run_time_us_ = 0.0;
+    double dp_integral_ = 0.0;      // bar * us
+    double dp_time_us_ = 0.0;
+    double energy_integral_ = 0.0;  // W * us
+    double energy_time_us_ = 0.0;
+};
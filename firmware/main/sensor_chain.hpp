@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "directional_hysteresis.hpp"
+#include "fixed_point.hpp"
+
+/**
+ * Zpracovani analogoveho kanalu za trimmed mean: kalibrace RAW -> jednotka, EMA,
+ * hystereze, prepocet na vystupni jednotku a zaokrouhleni pro publikaci.
+ * Hlavicka nezavisi na ESP-IDF. Pouziva ji tlak.cpp, zasoba.cpp i host nastroje v tools/,
+ * takze offline prehrani pocita presne totez co zarizeni.
+ * SensorChainFloat a SensorChainQ16 se lisi jen v mezich popsanych v README (Celociselna cesta vypoctu).
+ * SensorChain je varianta zvolena pres SENSOR_MATH_FIXED_POINT.
+ *
+ * Priklad:
+ *   SensorChain chain;
+ *   chain.configure(config);   // i za behu, stav EMA a hystereze zustava
+ *   sensor_chain_sample_t sample;
+ *   chain.process(raw_trimmed, &sample);
+ */
+typedef struct {
+    int32_t raw_min;
+    int32_t raw_max;
+    float out_min;
+    float out_max;
+    float ema_alpha;
+    float hysteresis;
+    int32_t round_decimals;
+    float output_scale;   // objem = vyska * plocha nadrze, u tlaku 1
+    bool clamp_negative;  // zaporna hodnota po hysterezi -> nulovy vystup (objem)
+} sensor_chain_config_t;
+
+typedef struct {
+    float value_raw;       // po kalibraci
+    float value_ema;
+    float value_hyst;
+    float output;          // value_hyst * output_scale
+    float output_rounded;  // publikovana hodnota
+} sensor_chain_sample_t;
+
+inline float sensor_chain_round(float value, int32_t decimals)
+{
+    if (decimals <= 1) {
+        return std::roundf(value * 10.0f) / 10.0f;
+    }
+    if (decimals >= 3) {
+        return std::roundf(value * 1000.0f) / 1000.0f;
+    }
+    return std::roundf(value * 100.0f) / 100.0f;
+}
+
+class SensorChainFloat
+{
+public:
+    SensorChainFloat() : config_(), ema_(0.0f), ema_initialized_(false), hysteresis_(0.0f) {}
+
+    void configure(const sensor_chain_config_t &config)
+    {
+        config_ = config;
+        hysteresis_.setHysteresis(config.hysteresis);
+    }
+
+    float calibrate(uint32_t raw) const
+    {
+        // Linearni interpolace mezi kalibracnimi body.
+        const int32_t raw_span = config_.raw_max - config_.raw_min;
+        if (raw_span == 0) {
+            return config_.out_min;
+        }
+        return config_.out_min +
+               ((float)((int32_t)raw - config_.raw_min) * (config_.out_max - config_.out_min) / (float)raw_span);
+    }
+
+    void process(uint32_t raw_filtered, sensor_chain_sample_t *sample)
+    {
+        sample->value_raw = calibrate(raw_filtered);
+        if (!ema_initialized_) {
+            ema_ = sample->value_raw;
+            ema_initialized_ = true;
+        } else {
+            ema_ = config_.ema_alpha * sample->value_raw + (1.0f - config_.ema_alpha) * ema_;
+        }
+        sample->value_ema = ema_;
+        sample->value_hyst = hysteresis_.process(ema_);
+
+        const float clamped = (config_.clamp_negative && sample->value_hyst < 0.0f) ? 0.0f : sample->value_hyst;
+        sample->output = clamped * config_.output_scale;
+        sample->output_rounded = sensor_chain_round(sample->output, config_.round_decimals);
+    }
+
+private:
+    sensor_chain_config_t config_;
+    float ema_;
+    bool ema_initialized_;
+    DirectionalHysteresis hysteresis_;
+};
+
+class SensorChainQ16
+{
+public:
+    SensorChainQ16() : config_(), map_(), ema_(), hysteresis_(0), scale_(q16::ONE) {}
+
+    // Smernice, alpha, prah a meritko se predpocitaji zde, za behu zbyvaji celociselne operace.
+    void configure(const sensor_chain_config_t &config)
+    {
+        config_ = config;
+        map_ = q16::LinearMap(config.raw_min, config.raw_max, config.out_min, config.out_max);
+        ema_.setAlpha(config.ema_alpha);
+        hysteresis_.setHysteresis(q16::from_float(config.hysteresis));
+        scale_ = q16::from_float(config.output_scale);
+    }
+
+    void process(uint32_t raw_filtered, sensor_chain_sample_t *sample)
+    {
+        const q16::value_t value = map_.map((int32_t)raw_filtered);
+        const q16::value_t value_ema = ema_.process(value);
+        const q16::value_t value_hyst = hysteresis_.process(value_ema);
+        const q16::value_t clamped = (config_.clamp_negative && value_hyst < 0) ? 0 : value_hyst;
+        // mul() s q16::ONE vrati hodnotu beze zmeny, tlak tedy meritkem nic neztraci.
+        const q16::value_t output = q16::mul(clamped, scale_);
+
+        sample->value_raw = q16::to_float(value);
+        sample->value_ema = q16::to_float(value_ema);
+        sample->value_hyst = q16::to_float(value_hyst);
+        sample->output = q16::to_float(output);
+        sample->output_rounded = q16::round_to_decimals(output, config_.round_decimals);
+    }
+
+private:
+    sensor_chain_config_t config_;
+    q16::LinearMap map_;
+    q16::Ema ema_;
+    DirectionalHysteresisQ16 hysteresis_;
+    q16::value_t scale_;
+};
+
+#if SENSOR_MATH_FIXED_POINT
+typedef SensorChainQ16 SensorChain;
+#else
+typedef SensorChainFloat SensorChain;
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Rozhoduje, zda ma merici task poslat sensor event do fronty.
+ * Task vzorkuje plnou rychlosti, event ale posila jen kdyz se zmeni nektera
+ * z publikovanych hodnot (po hysterezi/zaokrouhleni), zmeni se platnost
+ * (NaN <-> cislo) nebo uplyne heartbeat perioda.
+ *
+ * Priklad:
+ *   SensorEventGate<2> gate(30LL * 1000LL * 1000LL);
+ *   const float values[2] = {objem, hladina};
+ *   if (gate.shouldEmit(values, now_us) && sensor_events_publish(...)) {
+ *       gate.markEmitted(values, now_us);
+ *   }
+ */
+template<size_t ValueCount>
+class SensorEventGate
+{
+public:
+    explicit SensorEventGate(int64_t heartbeat_us)
+        : heartbeat_us_(heartbeat_us), last_emit_us_(0), emitted_(false)
+    {
+        for (size_t i = 0; i < ValueCount; ++i) {
+            last_values_[i] = NAN;
+        }
+    }
+
+    bool shouldEmit(const float (&values)[ValueCount], int64_t now_us) const
+    {
+        if (!emitted_ || (now_us - last_emit_us_) >= heartbeat_us_) {
+            return true;
+        }
+
+        for (size_t i = 0; i < ValueCount; ++i) {
+            if (!sameValue(values[i], last_values_[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void markEmitted(const float (&values)[ValueCount], int64_t now_us)
+    {
+        for (size_t i = 0; i < ValueCount; ++i) {
+            last_values_[i] = values[i];
+        }
+        last_emit_us_ = now_us;
+        emitted_ = true;
+    }
+
+private:
+    static bool sameValue(float a, float b)
+    {
+        const bool a_valid = std::isfinite(a);
+        const bool b_valid = std::isfinite(b);
+        if (a_valid != b_valid) {
+            return false;
+        }
+        return !a_valid || a == b;
+    }
+
+    int64_t heartbeat_us_;
+    int64_t last_emit_us_;
+    float last_values_[ValueCount];
+    bool emitted_;
+};
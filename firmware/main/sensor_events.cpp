@@ -28,6 +28,20 @@ static const char *event_type_to_string(event_type_t event_type)
     }
 }
 
+static const char *pump_state_to_string(sensor_pump_state_t state)
+{
+    switch (state) {
+        case SENSOR_PUMP_STOPPED:
+            return "stopped";
+        case SENSOR_PUMP_RUNNING:
+            return "running";
+        case SENSOR_PUMP_METER_ERROR:
+            return "meter_error";
+        default:
+            return "unknown";
+    }
+}
+
 static const char *temperature_probe_to_string(sensor_temperature_probe_t probe)
 {
     switch (probe) {
@@ -127,33 +141,50 @@ void sensor_event_to_string(const app_event_t *event, char *buffer, size_t buffe
                 case SENSOR_EVENT_ZASOBA:
                     snprintf(buffer,
                              buffer_len,
-                             "event=%s type=zasoba ts=%lld objem=%.3fm3 hladina=%.3fm",
+                             "event=%s type=zasoba ts=%lld objem=%.3fm3 hladina=%.3fm fault=%s",
                              event_type_to_string(event->event_type),
                              (long long)event->timestamp_us,
                              event->data.sensor.data.zasoba.objem,
-                             event->data.sensor.data.zasoba.hladina);
+                             event->data.sensor.data.zasoba.hladina,
+                             analog_fault_to_string(event->data.sensor.data.zasoba.fault));
                     break;
 
                 case SENSOR_EVENT_FLOW:
                     snprintf(buffer,
                              buffer_len,
-                             "event=%s type=flow ts=%lld flow=%.2f l/min total=%.2f l",
+                             "event=%s type=flow ts=%lld flow=%.2f l/min sigma=%.2f conf=%.2f total=%.2f l",
                              event_type_to_string(event->event_type),
                              (long long)event->timestamp_us,
                              event->data.sensor.data.flow.prutok,
+                             event->data.sensor.data.flow.prutok_nejistota,
+                             event->data.sensor.data.flow.prutok_duvera,
                              event->data.sensor.data.flow.cerpano_celkem);
                     break;
 
                 case SENSOR_EVENT_PRESSURE:
                     snprintf(buffer,
                              buffer_len,
-                             "event=%s type=pressure ts=%lld p_before=%.3fbar p_after=%.3fbar dp=%.3fbar clog=%.1f%%",
+                             "event=%s type=pressure ts=%lld p_before=%.3fbar p_after=%.3fbar dp=%.3fbar clog=%.1f%% fault=%s/%s",
                              event_type_to_string(event->event_type),
                              (long long)event->timestamp_us,
                              event->data.sensor.data.pressure.pred_filtrem,
                              event->data.sensor.data.pressure.za_filtrem,
                              event->data.sensor.data.pressure.rozdil_filtru,
-                             event->data.sensor.data.pressure.zanesenost_filtru);
+                             event->data.sensor.data.pressure.zanesenost_filtru,
+                             analog_fault_to_string(event->data.sensor.data.pressure.fault_pred),
+                             analog_fault_to_string(event->data.sensor.data.pressure.fault_za));
+                    break;
+
+                case SENSOR_EVENT_POWER:
+                    snprintf(buffer,
+                             buffer_len,
+                             "event=%s type=power ts=%lld pump=%s p=%.1fW i=%.3fA e=%.0fWh",
+                             event_type_to_string(event->event_type),
+                             (long long)event->timestamp_us,
+                             pump_state_to_string(event->data.sensor.data.power.stav),
+                             event->data.sensor.data.power.vykon_w,
+                             event->data.sensor.data.power.proud_a,
+                             event->data.sensor.data.power.energie_wh);
                     break;
 
                 default:
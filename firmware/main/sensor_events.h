@@ -9,6 +9,7 @@ extern "C" {
 #include <stddef.h>
 #include <freertos/FreeRTOS.h>
 #include "network_event.h"
+#include "analog_fault.h"
 
 typedef enum {
     EVT_SENSOR,
@@ -22,6 +23,7 @@ typedef enum {
     SENSOR_EVENT_ZASOBA,
     SENSOR_EVENT_FLOW,
     SENSOR_EVENT_PRESSURE,
+    SENSOR_EVENT_POWER,
 } sensor_event_type_t;
 
 typedef enum {
@@ -37,11 +39,15 @@ typedef struct {
 typedef struct {
     float objem;
     float hladina;
+    analog_fault_t fault;
 } sensor_zasoba_data_t;
 
 typedef struct {
     float prutok;
     float cerpano_celkem;
+    float prutok_nejistota;   // 1 sigma suroveho odhadu prutoku, l/min
+    float prutok_duvera;      // 0..1
+    uint32_t impulsy_celkem;  // volne bezici pocet impulsu (modulo 2^32) pro detekci uniku
 } sensor_flow_data_t;
 
 typedef struct {
@@ -49,8 +55,28 @@ typedef struct {
     float za_filtrem;
     float rozdil_filtru;
     float zanesenost_filtru;
+    analog_fault_t fault_pred;
+    analog_fault_t fault_za;
 } sensor_pressure_data_t;
 
+typedef enum {
+    SENSOR_PUMP_STOPPED = 0,
+    SENSOR_PUMP_RUNNING,
+    SENSOR_PUMP_METER_ERROR,    // elektromer neodpovedel, hodnoty jsou NaN
+} sensor_pump_state_t;
+
+// Odecet elektromeru cerpadla; kdyz cerpadlo stoji, je vyplneny jen vykon.
+typedef struct {
+    sensor_pump_state_t stav;
+    float vykon_w;
+    float jalovy_vykon_var;
+    float cosfi;
+    float proud_a;
+    float napeti_v;
+    float energie_wh;
+    float energie_jalova_varh;
+} sensor_power_data_t;
+
 typedef struct {
     sensor_event_type_t sensor_type;
     union {
@@ -58,6 +84,7 @@ typedef struct {
         sensor_zasoba_data_t zasoba;
         sensor_flow_data_t flow;
         sensor_pressure_data_t pressure;
+        sensor_power_data_t power;
     } data;
 } sensor_event_t;
 
@@ -0,0 +1,276 @@
+#include "sensor_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/base64.h"
+#include "mqtt_client.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "debug_mqtt.h"
+#include "network_init.h"
+
+static const char *TAG = "sensor_trace";
+
+static constexpr const char *SENSOR_TRACE_TOPIC = DEBUG_TOPIC("trace");
+static constexpr size_t SENSOR_TRACE_CHUNK_BYTES = 384;
+static constexpr TickType_t SENSOR_TRACE_CHUNK_DELAY = pdMS_TO_TICKS(20);
+static constexpr UBaseType_t SENSOR_TRACE_DUMP_TASK_STACK_SIZE = 4096;
+
+static portMUX_TYPE s_trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static sensor_trace_record_t *s_records = nullptr;
+static uint32_t s_capacity = 0;
+static uint32_t s_count = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_channel_mask = 0;
+static uint32_t s_start_time_us = 0;
+static volatile bool s_active = false;
+static volatile bool s_dump_in_progress = false;
+
+static inline void IRAM_ATTR append_record_locked(sensor_trace_channel_t channel,
+                                                  uint32_t timestamp_us,
+                                                  uint16_t value,
+                                                  uint8_t flags)
+{
+    if (s_count >= s_capacity) {
+        s_dropped += 1;
+        return;
+    }
+
+    sensor_trace_record_t *record = &s_records[s_count++];
+    record->timestamp_us = timestamp_us;
+    record->value = value;
+    record->channel = (uint8_t)channel;
+    record->flags = flags;
+}
+
+esp_err_t sensor_trace_start(uint32_t channel_mask, uint32_t max_records)
+{
+    if (s_dump_in_progress) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (channel_mask == 0) {
+        channel_mask = SENSOR_TRACE_MASK_ALL;
+    }
+    if (max_records == 0) {
+        max_records = SENSOR_TRACE_DEFAULT_RECORDS;
+    }
+    if (max_records > SENSOR_TRACE_MAX_RECORDS) {
+        max_records = SENSOR_TRACE_MAX_RECORDS;
+    }
+
+    sensor_trace_stop();
+
+    sensor_trace_record_t *buffer = s_records;
+    if (buffer == nullptr || s_capacity != max_records) {
+        heap_caps_free(buffer);
+        buffer = (sensor_trace_record_t *)heap_caps_malloc(max_records * sizeof(sensor_trace_record_t),
+                                                           MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (buffer == nullptr) {
+            taskENTER_CRITICAL(&s_trace_mux);
+            s_records = nullptr;
+            s_capacity = 0;
+            s_count = 0;
+            taskEXIT_CRITICAL(&s_trace_mux);
+            ESP_LOGE(TAG, "Nelze alokovat trace buffer (%lu zaznamu)", (unsigned long)max_records);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    taskENTER_CRITICAL(&s_trace_mux);
+    s_records = buffer;
+    s_capacity = max_records;
+    s_count = 0;
+    s_dropped = 0;
+    s_channel_mask = channel_mask & SENSOR_TRACE_MASK_ALL;
+    s_start_time_us = (uint32_t)esp_timer_get_time();
+    s_active = true;
+    taskEXIT_CRITICAL(&s_trace_mux);
+
+    ESP_LOGW(TAG,
+             "Trace spusten: mask=0x%02lx kapacita=%lu zaznamu (%lu B)",
+             (unsigned long)s_channel_mask,
+             (unsigned long)s_capacity,
+             (unsigned long)(s_capacity * sizeof(sensor_trace_record_t)));
+    return ESP_OK;
+}
+
+void sensor_trace_stop(void)
+{
+    if (!s_active) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_trace_mux);
+    s_active = false;
+    taskEXIT_CRITICAL(&s_trace_mux);
+
+    ESP_LOGW(TAG,
+             "Trace zastaven: zaznamu=%lu zahozeno=%lu",
+             (unsigned long)s_count,
+             (unsigned long)s_dropped);
+}
+
+bool sensor_trace_is_active(void)
+{
+    return s_active;
+}
+
+uint32_t sensor_trace_record_count(void)
+{
+    return s_count;
+}
+
+void sensor_trace_record(sensor_trace_channel_t channel, uint16_t value, uint8_t flags)
+{
+    if (!s_active || (s_channel_mask & (1u << channel)) == 0) {
+        return;
+    }
+
+    const uint32_t timestamp_us = (uint32_t)esp_timer_get_time();
+    taskENTER_CRITICAL(&s_trace_mux);
+    if (s_active) {
+        append_record_locked(channel, timestamp_us, value, flags);
+    }
+    taskEXIT_CRITICAL(&s_trace_mux);
+}
+
+void IRAM_ATTR sensor_trace_record_isr(sensor_trace_channel_t channel, uint32_t timestamp_us)
+{
+    if (!s_active || (s_channel_mask & (1u << channel)) == 0) {
+        return;
+    }
+
+    portENTER_CRITICAL_ISR(&s_trace_mux);
+    if (s_active) {
+        append_record_locked(channel, timestamp_us, 0, 0);
+    }
+    portEXIT_CRITICAL_ISR(&s_trace_mux);
+}
+
+static bool publish_trace_chunk(esp_mqtt_client_handle_t client,
+                                size_t offset,
+                                size_t total,
+                                const uint8_t *data,
+                                size_t length)
+{
+    // "offset/celkem " + base64 (4/3 delky) + NUL
+    char payload[32 + ((SENSOR_TRACE_CHUNK_BYTES + 2) / 3) * 4 + 1];
+    const int prefix_len = snprintf(payload, sizeof(payload), "%u/%u ", (unsigned)offset, (unsigned)total);
+    if (prefix_len <= 0) {
+        return false;
+    }
+
+    size_t encoded_len = 0;
+    const int encode_result = mbedtls_base64_encode((unsigned char *)payload + prefix_len,
+                                                    sizeof(payload) - (size_t)prefix_len,
+                                                    &encoded_len,
+                                                    data,
+                                                    length);
+    if (encode_result != 0) {
+        ESP_LOGE(TAG, "Base64 kodovani trace selhalo: %d", encode_result);
+        return false;
+    }
+
+    const int msg_id = esp_mqtt_client_publish(client,
+                                               SENSOR_TRACE_TOPIC,
+                                               payload,
+                                               prefix_len + (int)encoded_len,
+                                               1,
+                                               0);
+    return msg_id >= 0;
+}
+
+static void sensor_trace_dump_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    sensor_trace_header_t header = {
+        .magic = SENSOR_TRACE_MAGIC,
+        .version = SENSOR_TRACE_VERSION,
+        .record_size = (uint8_t)sizeof(sensor_trace_record_t),
+        .channel_mask = (uint16_t)s_channel_mask,
+        .record_count = s_count,
+        .dropped_count = s_dropped,
+        .start_time_us = s_start_time_us,
+    };
+
+    const size_t records_bytes = (size_t)header.record_count * sizeof(sensor_trace_record_t);
+    const size_t total = sizeof(header) + records_bytes;
+    uint8_t chunk[SENSOR_TRACE_CHUNK_BYTES];
+    size_t offset = 0;
+    bool ok = true;
+
+    ESP_LOGI(TAG, "Odesilam trace: %lu zaznamu, %u B", (unsigned long)header.record_count, (unsigned)total);
+
+    while (offset < total) {
+        esp_mqtt_client_handle_t client = network_mqtt_client();
+        if (client == nullptr || !network_mqtt_is_connected()) {
+            ESP_LOGW(TAG, "Odeslani trace preruseno: MQTT neni pripojeno (offset=%u)", (unsigned)offset);
+            ok = false;
+            break;
+        }
+
+        const size_t length = (total - offset) < sizeof(chunk) ? (total - offset) : sizeof(chunk);
+        for (size_t index = 0; index < length; ++index) {
+            const size_t position = offset + index;
+            chunk[index] = (position < sizeof(header))
+                               ? ((const uint8_t *)&header)[position]
+                               : ((const uint8_t *)s_records)[position - sizeof(header)];
+        }
+
+        if (!publish_trace_chunk(client, offset, total, chunk, length)) {
+            ESP_LOGW(TAG, "Publikace bloku trace selhala (offset=%u)", (unsigned)offset);
+            ok = false;
+            break;
+        }
+
+        offset += length;
+        vTaskDelay(SENSOR_TRACE_CHUNK_DELAY);
+    }
+
+    if (ok) {
+        ESP_LOGI(TAG, "Trace odeslan (%u B)", (unsigned)total);
+    }
+
+    s_dump_in_progress = false;
+    vTaskDelete(nullptr);
+}
+
+esp_err_t sensor_trace_dump_mqtt(void)
+{
+    if (s_dump_in_progress) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_records == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sensor_trace_stop();
+    s_dump_in_progress = true;
+
+    if (xTaskCreate(sensor_trace_dump_task,
+                    "trace_dump",
+                    SENSOR_TRACE_DUMP_TASK_STACK_SIZE,
+                    nullptr,
+                    2,
+                    nullptr) != pdPASS) {
+        s_dump_in_progress = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
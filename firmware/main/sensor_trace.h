@@ -0,0 +1,64 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+
+// Zaznam surovych vzorku cidel do RAM pro offline prehrani (tools/trace_replay.cpp).
+// Format dumpu: sensor_trace_header_t + N x sensor_trace_record_t, little-endian.
+
+#define SENSOR_TRACE_MAGIC 0x52545356u // "VSTR"
+#define SENSOR_TRACE_VERSION 1u
+#define SENSOR_TRACE_DEFAULT_RECORDS 4096u
+#define SENSOR_TRACE_MAX_RECORDS 16384u
+
+typedef enum {
+    SENSOR_TRACE_CH_TLAK_PRED = 0,  // ADC RAW tlak pred filtrem
+    SENSOR_TRACE_CH_TLAK_ZA,        // ADC RAW tlak za filtrem
+    SENSOR_TRACE_CH_ZASOBA,         // ADC RAW hladina
+    SENSOR_TRACE_CH_FLOW_PULSE,     // hrana impulsu prutokomeru (value = 0)
+    SENSOR_TRACE_CH_COUNT,
+} sensor_trace_channel_t;
+
+#define SENSOR_TRACE_MASK_ALL ((1u << SENSOR_TRACE_CH_COUNT) - 1u)
+
+// Priznaky zaznamu
+#define SENSOR_TRACE_FLAG_ADC_FAIL 0x01u
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t record_size;
+    uint16_t channel_mask;
+    uint32_t record_count;
+    uint32_t dropped_count;
+    uint32_t start_time_us;  // dolnich 32 bitu esp_timer_get_time() pri startu
+} sensor_trace_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;   // dolnich 32 bitu esp_timer_get_time(), pretece po ~71 min
+    uint16_t value;
+    uint8_t channel;
+    uint8_t flags;
+} sensor_trace_record_t;
+
+esp_err_t sensor_trace_start(uint32_t channel_mask, uint32_t max_records);
+void sensor_trace_stop(void);
+bool sensor_trace_is_active(void);
+uint32_t sensor_trace_record_count(void);
+
+void sensor_trace_record(sensor_trace_channel_t channel, uint16_t value, uint8_t flags);
+void IRAM_ATTR sensor_trace_record_isr(sensor_trace_channel_t channel, uint32_t timestamp_us);
+
+// Asynchronne odesle zaznam po blocich do debug/trace (base64, "offset/celkem data").
+esp_err_t sensor_trace_dump_mqtt(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,10 @@ extern "C" {
 #include "status_display.h"
 #include "restart_info.h"
 #include "app_error_check.h"
+#include "filtr_trend.h"
+#include "pump_session.h"
+#include "provozni_citace.h"
+#include "unik.h"
 #include <tm1637.h>
 
 static const char *TAG = "state_manager";
@@ -67,6 +71,43 @@ static constexpr SensorFaultDisplay SENSOR_FAULT_PRESSURE_AFTER {
 };
 
 
+// Druh poruchy analogoveho kanalu (AnalogFaultDetector) na volnych segmentech pozice 3;
+// ktery kanal je v poruse, ukazuje jeho segment vyse (D hladina, F tlak pred, B tlak za).
+static constexpr SensorFaultDisplay SENSOR_FAULT_KIND_LOOP {
+    3,
+    static_cast<uint8_t>(TM1637_SEG_A)
+};
+
+static constexpr SensorFaultDisplay SENSOR_FAULT_KIND_STUCK {
+    3,
+    static_cast<uint8_t>(TM1637_SEG_G)
+};
+
+static constexpr SensorFaultDisplay SENSOR_FAULT_KIND_RATE {
+    3,
+    static_cast<uint8_t>(TM1637_SEG_E)
+};
+
+static constexpr SensorFaultDisplay SENSOR_FAULT_KIND_NOISY {
+    3,
+    static_cast<uint8_t>(TM1637_SEG_C)
+};
+
+typedef enum {
+    ANALOG_CHANNEL_LEVEL = 0,
+    ANALOG_CHANNEL_PRESSURE_BEFORE,
+    ANALOG_CHANNEL_PRESSURE_AFTER,
+    ANALOG_CHANNEL_COUNT,
+} analog_channel_t;
+
+static analog_fault_t s_analog_faults[ANALOG_CHANNEL_COUNT] = {};
+
+static constexpr mqtt_topic_id_t ANALOG_FAULT_TOPICS[ANALOG_CHANNEL_COUNT] = {
+    mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_HLADINA,
+    mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_TLAK_PRED,
+    mqtt_topic_id_t::TOPIC_DIAG_PORUCHA_TLAK_ZA,
+};
+
 // Toto prakticky asi nenastane, ale pro jistotu indikovat chybu senzoru i v případě, že naměřená hodnota není číslo (NaN) nebo nekonečno.
 static constexpr SensorFaultDisplay SENSOR_FAULT_FLOW{
     2,
@@ -87,6 +128,14 @@ static void publish_runtime_diagnostics(const network_event_t *network_snapshot)
                                            (int64_t)network_snapshot->reconnect_attempts);
         (void)mqtt_publisher_enqueue_int64(mqtt_topic_id_t::TOPIC_DIAG_WIFI_RECONNECT_SUCCESS,
                                            (int64_t)network_snapshot->reconnect_successes);
+        if (network_snapshot->last_connect_ms != 0) {
+            (void)mqtt_publisher_enqueue_int64(mqtt_topic_id_t::TOPIC_DIAG_WIFI_CONNECT_MS,
+                                               (int64_t)network_snapshot->last_connect_ms);
+        }
+        if (network_snapshot->last_mqtt_ready_ms != 0) {
+            (void)mqtt_publisher_enqueue_int64(mqtt_topic_id_t::TOPIC_DIAG_MQTT_READY_MS,
+                                               (int64_t)network_snapshot->last_mqtt_ready_ms);
+        }
     }
 
     (void)mqtt_publisher_enqueue_int64(mqtt_topic_id_t::TOPIC_DIAG_MQTT_RECONNECTS,
@@ -111,6 +160,91 @@ static void set_sensor_fault_indicator(SensorFaultDisplay fault_type, bool is_fa
 
 }
 
+static void set_analog_fault(analog_channel_t channel, analog_fault_t fault)
+{
+    if (s_analog_faults[channel] != fault) {
+        ESP_LOGW(TAG,
+                 "Analogovy kanal %d: %s -> %s",
+                 (int)channel,
+                 analog_fault_to_string(s_analog_faults[channel]),
+                 analog_fault_to_string(fault));
+        s_analog_faults[channel] = fault;
+    }
+
+    bool loop = false;
+    bool stuck = false;
+    bool rate = false;
+    bool noisy = false;
+    for (const analog_fault_t channel_fault : s_analog_faults) {
+        loop |= channel_fault == ANALOG_FAULT_OPEN_LOOP || channel_fault == ANALOG_FAULT_SHORT_LOOP;
+        stuck |= channel_fault == ANALOG_FAULT_STUCK;
+        rate |= channel_fault == ANALOG_FAULT_RATE;
+        noisy |= channel_fault == ANALOG_FAULT_NOISY;
+    }
+    set_sensor_fault_indicator(SENSOR_FAULT_KIND_LOOP, loop);
+    set_sensor_fault_indicator(SENSOR_FAULT_KIND_STUCK, stuck);
+    set_sensor_fault_indicator(SENSOR_FAULT_KIND_RATE, rate);
+    set_sensor_fault_indicator(SENSOR_FAULT_KIND_NOISY, noisy);
+
+    (void)mqtt_publisher_enqueue_text(ANALOG_FAULT_TOPICS[channel], analog_fault_to_string(fault));
+}
+
+static void publish_filtr_trend(void)
+{
+    filtr_trend_estimate_t estimate = {};
+    if (!filtr_trend_get_estimate(&estimate)) {
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_FILTR_DP_NORM);
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_FILTR_TREND);
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_FILTR_DNY_DO_ZANESENI);
+        return;
+    }
+
+    (void)mqtt_publisher_enqueue_double(mqtt_topic_id_t::TOPIC_STAV_FILTR_DP_NORM, (double)estimate.dp_norm_bar);
+    (void)mqtt_publisher_enqueue_double(mqtt_topic_id_t::TOPIC_STAV_FILTR_TREND, (double)estimate.slope_bar_per_day);
+    if (std::isfinite(estimate.days_to_full)) {
+        (void)mqtt_publisher_enqueue_double(mqtt_topic_id_t::TOPIC_STAV_FILTR_DNY_DO_ZANESENI,
+                                            (double)estimate.days_to_full);
+    } else {
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_FILTR_DNY_DO_ZANESENI);
+    }
+
+    ESP_LOGI(TAG,
+             "Trend filtru: relaci=%lu dp_norm=%.3f bar trend=%.5f bar/den do zaneseni=%.1f dni",
+             (unsigned long)estimate.sessions,
+             (double)estimate.dp_norm_bar,
+             (double)estimate.slope_bar_per_day,
+             (double)estimate.days_to_full);
+}
+
+static void on_pump_session_closed(void)
+{
+    pump_session_record_t record = {};
+    if (pump_session_get_recent(&record, 1) == 0) {
+        return;
+    }
+
+    provozni_citace_on_session(&record);
+
+    char json[MQTT_PUBLISH_TEXT_MAX_LEN];
+    if (pump_session_format_json(&record, json, sizeof(json)) < 0) {
+        ESP_LOGW(TAG, "JSON relace cerpani se nevesel do zpravy");
+        return;
+    }
+
+    esp_err_t result = mqtt_publisher_enqueue_text(mqtt_topic_id_t::TOPIC_STAV_CERPANI_RELACE, json);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Enqueue relace cerpani selhalo: %s", esp_err_to_name(result));
+    }
+}
+
+static void publish_unik_alarmy(void)
+{
+    const unik_alarmy_t alarmy = unik_get_alarmy();
+    (void)mqtt_publisher_enqueue_bool(mqtt_topic_id_t::TOPIC_STAV_ALARM_POMALY_UNIK, alarmy.pomaly_unik);
+    (void)mqtt_publisher_enqueue_bool(mqtt_topic_id_t::TOPIC_STAV_ALARM_IMPULSY_BEZ_CERPADLA, alarmy.bez_cerpadla);
+    (void)mqtt_publisher_enqueue_bool(mqtt_topic_id_t::TOPIC_STAV_ALARM_PRUTOK_PO_RELACI, alarmy.po_relaci);
+}
+
 static void publish_boot_diagnostics_once(void)
 {
     const esp_partition_t *running = esp_ota_get_running_partition();
@@ -166,6 +300,9 @@ static void publish_boot_diagnostics_once(void)
         (void)mqtt_publisher_enqueue_int64(mqtt_topic_id_t::TOPIC_SYSTEM_REBOOT_COUNTER,
                                            (int64_t)restart_info.boot_count);
     }
+
+    publish_filtr_trend();
+    publish_unik_alarmy();
 }
 
 
@@ -221,7 +358,8 @@ static void publish_zasoba_to_outputs(const sensor_event_t &event)
     char text[16];
     esp_err_t enqueue_result;
     const bool sensor_fault = !std::isfinite(event.data.zasoba.objem) || !std::isfinite(event.data.zasoba.hladina);
-    set_sensor_fault_indicator(SENSOR_FAULT_LEVEL, sensor_fault);
+    set_sensor_fault_indicator(SENSOR_FAULT_LEVEL, sensor_fault || event.data.zasoba.fault != ANALOG_FAULT_NONE);
+    set_analog_fault(ANALOG_CHANNEL_LEVEL, event.data.zasoba.fault);
 
     if (sensor_fault) {
         snprintf(text, sizeof(text), "----");
@@ -286,6 +424,39 @@ static void publish_flow_to_outputs(const sensor_event_t &event)
 
 }
 
+static void publish_optional_double(mqtt_topic_id_t topic_id, float value, double scale)
+{
+    if (std::isfinite(value)) {
+        (void)mqtt_publisher_enqueue_double(topic_id, (double)value * scale);
+    }
+}
+
+static void publish_power_to_outputs(const sensor_event_t &event)
+{
+    const sensor_power_data_t &power = event.data.power;
+
+    if (power.stav == SENSOR_PUMP_METER_ERROR) {
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_BEZI);
+        (void)mqtt_publisher_enqueue_empty(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_VYKON_CINNY_W);
+        return;
+    }
+
+    esp_err_t result = mqtt_publisher_enqueue_bool(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_BEZI,
+                                                   power.stav == SENSOR_PUMP_RUNNING);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Enqueue stavu pumpy selhalo: %s", esp_err_to_name(result));
+    }
+
+    // Kdyz cerpadlo stoji, elektromer posila jen vykon; ostatni hodnoty zustanou posledni.
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_VYKON_CINNY_W, power.vykon_w, 1.0);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_JALOVY_VYKON_VAR, power.jalovy_vykon_var, 1.0);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_COSFI, power.cosfi, 1.0);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_PROUD_A, power.proud_a, 1.0);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_NAPETI_V, power.napeti_v, 1.0);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_ENERGIE_CINNA_KWH, power.energie_wh, 0.001);
+    publish_optional_double(mqtt_topic_id_t::TOPIC_STAV_CERPANI_PUMPA_ENERGIE_JALOVA_KVARH, power.energie_jalova_varh, 0.001);
+}
+
 static void publish_pressure_to_outputs(const sensor_event_t &event)
 {
     const float pred_filtrem = event.data.pressure.pred_filtrem;
@@ -296,8 +467,12 @@ static void publish_pressure_to_outputs(const sensor_event_t &event)
     const bool sensor_fault_pred_filtrem = !std::isfinite(pred_filtrem);
     const bool sensor_fault_za_filtrem = !std::isfinite(za_filtrem);
         
-    set_sensor_fault_indicator(SENSOR_FAULT_PRESSURE_BEFORE, sensor_fault_pred_filtrem);
-    set_sensor_fault_indicator(SENSOR_FAULT_PRESSURE_AFTER, sensor_fault_za_filtrem);
+    set_sensor_fault_indicator(SENSOR_FAULT_PRESSURE_BEFORE,
+                               sensor_fault_pred_filtrem || event.data.pressure.fault_pred != ANALOG_FAULT_NONE);
+    set_sensor_fault_indicator(SENSOR_FAULT_PRESSURE_AFTER,
+                               sensor_fault_za_filtrem || event.data.pressure.fault_za != ANALOG_FAULT_NONE);
+    set_analog_fault(ANALOG_CHANNEL_PRESSURE_BEFORE, event.data.pressure.fault_pred);
+    set_analog_fault(ANALOG_CHANNEL_PRESSURE_AFTER, event.data.pressure.fault_za);
 
     if (sensor_fault_pred_filtrem) {
         lcd_print(LCD_PRESSURE_X, 0, "-++-", false, 0);
@@ -380,6 +555,7 @@ static void state_manager_task(void *pvParameters)
 
     while (true) {
         if (!sensor_events_receive(&event, STATE_MANAGER_EVENT_WAIT_TICKS)) {
+            provozni_citace_idle();
             APP_ERROR_CHECK("E602", esp_task_wdt_reset());
             continue;
         }
@@ -402,13 +578,42 @@ static void state_manager_task(void *pvParameters)
                         break;
                     case SENSOR_EVENT_FLOW: {
                         publish_flow_to_outputs(event.data.sensor);
+                        if (filtr_trend_on_flow(event.data.sensor.data.flow.prutok, event.timestamp_us)) {
+                            publish_filtr_trend();
+                        }
+                        if (pump_session_on_flow(event.data.sensor.data.flow.prutok,
+                                                 event.data.sensor.data.flow.cerpano_celkem,
+                                                 event.timestamp_us)) {
+                            on_pump_session_closed();
+                        }
+                        unik_on_pump(pump_session_is_active(), event.timestamp_us);
+                        if (unik_on_flow(event.data.sensor.data.flow.impulsy_celkem, event.timestamp_us)) {
+                            publish_unik_alarmy();
+                        }
+                        provozni_citace_idle();
                         APP_ERROR_CHECK("E604", esp_task_wdt_reset());
                         break;
                     }
                     case SENSOR_EVENT_PRESSURE:
                         publish_pressure_to_outputs(event.data.sensor);
+                        filtr_trend_on_pressure(event.data.sensor.data.pressure.rozdil_filtru, event.timestamp_us);
+                        pump_session_on_pressure(event.data.sensor.data.pressure.rozdil_filtru, event.timestamp_us);
                         APP_ERROR_CHECK("E604", esp_task_wdt_reset());
                         break;
+                    case SENSOR_EVENT_POWER: {
+                        const sensor_power_data_t &power = event.data.sensor.data.power;
+                        publish_power_to_outputs(event.data.sensor);
+                        if (pump_session_on_power(power.stav != SENSOR_PUMP_METER_ERROR,
+                                                  power.stav == SENSOR_PUMP_RUNNING,
+                                                  power.vykon_w,
+                                                  event.timestamp_us)) {
+                            on_pump_session_closed();
+                        }
+                        unik_on_power(power.stav != SENSOR_PUMP_METER_ERROR, event.timestamp_us);
+                        unik_on_pump(pump_session_is_active(), event.timestamp_us);
+                        APP_ERROR_CHECK("E604", esp_task_wdt_reset());
+                        break;
+                    }
                     default:
                         ESP_LOGW(TAG, "Neznamy sensor event: %d", (int)event.data.sensor.sensor_type);
                         break;
@@ -21,7 +21,12 @@ extern "C" {
 #include "config_store.h"
 #include "debug_mqtt.h"
 #include "app_error_check.h"
-#include "directional_hysteresis.hpp"
+#include "sensor_chain.hpp"
+#include "sensor_trace.h"
+#include "sensor_event_gate.hpp"
+#include "analog_fault_detector.hpp"
+#include "analog_channel_config.hpp"
+#include "live_params.hpp"
 
 #define TAG "tlak"
 
@@ -44,9 +49,6 @@ static constexpr int32_t PRESSURE_MAX_SAMPLE_MS = 1000;
 static constexpr int32_t PRESSURE_MIN_ROUND_DECIMALS = 1;
 static constexpr int32_t PRESSURE_MAX_ROUND_DECIMALS = 3;
 static constexpr int64_t PRESSURE_CFG_DEBUG_PERIOD_US = 10LL * 1000LL * 1000LL;
-static constexpr int32_t PRESSURE_RAW_SANITY_MIN = 0;
-static constexpr int32_t PRESSURE_RAW_SANITY_MAX = 4095;
-static constexpr int32_t PRESSURE_RAW_SANITY_MIN_MARGIN = 80;
 
 static const config_item_t PRESSURE_BEFORE_RAW_4MA_ITEM = {
     .key = "tlk_b_raw_4ma", .label = "Tlak pred filtrem RAW pro 4 mA", .description = "ADC RAW hodnota (pred filtrem) odpovidajici vstupu 4 mA.",
@@ -137,21 +139,50 @@ static pressure_runtime_config_t g_pressure_config = {
     .dp_100_percent_bar = PRESSURE_DEFAULT_DP100_BAR,
 };
 
+// Vse, co jde zmenit z webapp za behu; tlak_task ho prevezme mezi vzorky.
+typedef struct {
+    pressure_sensor_calibration_t before;
+    pressure_sensor_calibration_t after;
+    pressure_runtime_config_t runtime;
+} pressure_live_config_t;
+
+static LiveParams<pressure_live_config_t> s_live_config({
+    .before = {PRESSURE_DEFAULT_RAW_4MA, PRESSURE_DEFAULT_RAW_20MA, PRESSURE_DEFAULT_MIN_BAR, PRESSURE_DEFAULT_MAX_BAR},
+    .after = {PRESSURE_DEFAULT_RAW_4MA, PRESSURE_DEFAULT_RAW_20MA, PRESSURE_DEFAULT_MIN_BAR, PRESSURE_DEFAULT_MAX_BAR},
+    .runtime = g_pressure_config,
+});
+
+static const config_item_t *const PRESSURE_LIVE_ITEMS[] = {
+    &PRESSURE_BEFORE_RAW_4MA_ITEM,
+    &PRESSURE_BEFORE_RAW_20MA_ITEM,
+    &PRESSURE_BEFORE_MIN_ITEM,
+    &PRESSURE_BEFORE_MAX_ITEM,
+    &PRESSURE_AFTER_RAW_4MA_ITEM,
+    &PRESSURE_AFTER_RAW_20MA_ITEM,
+    &PRESSURE_AFTER_MIN_ITEM,
+    &PRESSURE_AFTER_MAX_ITEM,
+    &PRESSURE_EMA_ALPHA_ITEM,
+    &PRESSURE_HYST_BAR_ITEM,
+    &PRESSURE_SAMPLE_MS_ITEM,
+    &PRESSURE_ROUND_DECIMALS_ITEM,
+    &PRESSURE_DP100_ITEM,
+};
+
 static TrimmedMean<31, 5> pressure_before_filter;
 static TrimmedMean<31, 5> pressure_after_filter;
-static DirectionalHysteresis s_pressure_hysteresis_before(PRESSURE_DEFAULT_HYST_BAR);
-static DirectionalHysteresis s_pressure_hysteresis_after(PRESSURE_DEFAULT_HYST_BAR);
+static AnalogFaultDetector s_pressure_fault_before(PRESSURE_FAULT_DETECTOR_CONFIG);
+static AnalogFaultDetector s_pressure_fault_after(PRESSURE_FAULT_DETECTOR_CONFIG);
 
 static int64_t s_last_cfg_debug_publish_us = 0;
 
 typedef struct {
     const char *name;
     adc_channel_t channel;
+    sensor_trace_channel_t trace_channel;
     TrimmedMean<31, 5> *filter;
+    AnalogFaultDetector *fault_detector;
     pressure_sensor_calibration_t calibration;
-    float ema_value;
-    bool ema_initialized;
-    DirectionalHysteresis *hysteresis;
+    SensorChain chain;
 } pressure_sensor_static_t;
 
 typedef struct {
@@ -161,36 +192,37 @@ typedef struct {
     float pressure_ema;
     float pressure_hyst;
     float pressure_rounded;
+    analog_fault_t fault;
 } pressure_sensor_sample_t;
 
 static pressure_sensor_static_t s_pressure_sensor_before = {
     .name = "pred",
     .channel = PRESSURE_SENSOR_BEFORE_ADC_CHANNEL,
+    .trace_channel = SENSOR_TRACE_CH_TLAK_PRED,
     .filter = &pressure_before_filter,
+    .fault_detector = &s_pressure_fault_before,
     .calibration = {
         .raw_at_4ma = PRESSURE_DEFAULT_RAW_4MA,
         .raw_at_20ma = PRESSURE_DEFAULT_RAW_20MA,
         .pressure_min_bar = PRESSURE_DEFAULT_MIN_BAR,
         .pressure_max_bar = PRESSURE_DEFAULT_MAX_BAR,
     },
-    .ema_value = 0.0f,
-    .ema_initialized = false,
-    .hysteresis = &s_pressure_hysteresis_before,
+    .chain = SensorChain(),
 };
 
 static pressure_sensor_static_t s_pressure_sensor_after = {
     .name = "za",
     .channel = PRESSURE_SENSOR_AFTER_ADC_CHANNEL,
+    .trace_channel = SENSOR_TRACE_CH_TLAK_ZA,
     .filter = &pressure_after_filter,
+    .fault_detector = &s_pressure_fault_after,
     .calibration = {
         .raw_at_4ma = PRESSURE_DEFAULT_RAW_4MA,
         .raw_at_20ma = PRESSURE_DEFAULT_RAW_20MA,
         .pressure_min_bar = PRESSURE_DEFAULT_MIN_BAR,
         .pressure_max_bar = PRESSURE_DEFAULT_MAX_BAR,
     },
-    .ema_value = 0.0f,
-    .ema_initialized = false,
-    .hysteresis = &s_pressure_hysteresis_after,
+    .chain = SensorChain(),
 };
 
 static float clamp01(float value)
@@ -252,67 +284,70 @@ static void sanitize_sensor_calibration(pressure_sensor_calibration_t *calibrati
     }
 }
 
-static void load_pressure_calibration_config(void)
+static pressure_live_config_t read_pressure_config(void)
 {
-    s_pressure_sensor_before.calibration.raw_at_4ma = config_store_get_i32_item(&PRESSURE_BEFORE_RAW_4MA_ITEM);
-    s_pressure_sensor_before.calibration.raw_at_20ma = config_store_get_i32_item(&PRESSURE_BEFORE_RAW_20MA_ITEM);
-    s_pressure_sensor_before.calibration.pressure_min_bar = config_store_get_float_item(&PRESSURE_BEFORE_MIN_ITEM);
-    s_pressure_sensor_before.calibration.pressure_max_bar = config_store_get_float_item(&PRESSURE_BEFORE_MAX_ITEM);
-
-    s_pressure_sensor_after.calibration.raw_at_4ma = config_store_get_i32_item(&PRESSURE_AFTER_RAW_4MA_ITEM);
-    s_pressure_sensor_after.calibration.raw_at_20ma = config_store_get_i32_item(&PRESSURE_AFTER_RAW_20MA_ITEM);
-    s_pressure_sensor_after.calibration.pressure_min_bar = config_store_get_float_item(&PRESSURE_AFTER_MIN_ITEM);
-    s_pressure_sensor_after.calibration.pressure_max_bar = config_store_get_float_item(&PRESSURE_AFTER_MAX_ITEM);
-
-    g_pressure_config.ema_alpha = config_store_get_float_item(&PRESSURE_EMA_ALPHA_ITEM);
-    g_pressure_config.hyst_bar = config_store_get_float_item(&PRESSURE_HYST_BAR_ITEM);
-    g_pressure_config.sample_ms = config_store_get_i32_item(&PRESSURE_SAMPLE_MS_ITEM);
-    g_pressure_config.round_decimals = config_store_get_i32_item(&PRESSURE_ROUND_DECIMALS_ITEM);
-    g_pressure_config.dp_100_percent_bar = config_store_get_float_item(&PRESSURE_DP100_ITEM);
-
-    sanitize_sensor_calibration(&s_pressure_sensor_before.calibration, s_pressure_sensor_before.name);
-    sanitize_sensor_calibration(&s_pressure_sensor_after.calibration, s_pressure_sensor_after.name);
-
-    if (g_pressure_config.ema_alpha <= 0.0f || g_pressure_config.ema_alpha > 1.0f) {
-        g_pressure_config.ema_alpha = PRESSURE_DEFAULT_EMA_ALPHA;
-        ESP_LOGW(TAG, "Neplatna tlk_ema_alpha, pouzivam default %.3f", (double)g_pressure_config.ema_alpha);
+    pressure_live_config_t config = {};
+    pressure_runtime_config_t &runtime = config.runtime;
+    config.before.raw_at_4ma = config_store_get_i32_item(&PRESSURE_BEFORE_RAW_4MA_ITEM);
+    config.before.raw_at_20ma = config_store_get_i32_item(&PRESSURE_BEFORE_RAW_20MA_ITEM);
+    config.before.pressure_min_bar = config_store_get_float_item(&PRESSURE_BEFORE_MIN_ITEM);
+    config.before.pressure_max_bar = config_store_get_float_item(&PRESSURE_BEFORE_MAX_ITEM);
+
+    config.after.raw_at_4ma = config_store_get_i32_item(&PRESSURE_AFTER_RAW_4MA_ITEM);
+    config.after.raw_at_20ma = config_store_get_i32_item(&PRESSURE_AFTER_RAW_20MA_ITEM);
+    config.after.pressure_min_bar = config_store_get_float_item(&PRESSURE_AFTER_MIN_ITEM);
+    config.after.pressure_max_bar = config_store_get_float_item(&PRESSURE_AFTER_MAX_ITEM);
+
+    runtime.ema_alpha = config_store_get_float_item(&PRESSURE_EMA_ALPHA_ITEM);
+    runtime.hyst_bar = config_store_get_float_item(&PRESSURE_HYST_BAR_ITEM);
+    runtime.sample_ms = config_store_get_i32_item(&PRESSURE_SAMPLE_MS_ITEM);
+    runtime.round_decimals = config_store_get_i32_item(&PRESSURE_ROUND_DECIMALS_ITEM);
+    runtime.dp_100_percent_bar = config_store_get_float_item(&PRESSURE_DP100_ITEM);
+
+    sanitize_sensor_calibration(&config.before, s_pressure_sensor_before.name);
+    sanitize_sensor_calibration(&config.after, s_pressure_sensor_after.name);
+
+    if (runtime.ema_alpha <= 0.0f || runtime.ema_alpha > 1.0f) {
+        runtime.ema_alpha = PRESSURE_DEFAULT_EMA_ALPHA;
+        ESP_LOGW(TAG, "Neplatna tlk_ema_alpha, pouzivam default %.3f", (double)runtime.ema_alpha);
     }
 
-    if (g_pressure_config.hyst_bar < 0.0f) {
-        g_pressure_config.hyst_bar = PRESSURE_DEFAULT_HYST_BAR;
-        ESP_LOGW(TAG, "Neplatna tlk_hyst_bar, pouzivam default %.4f bar", (double)g_pressure_config.hyst_bar);
+    if (runtime.hyst_bar < 0.0f) {
+        runtime.hyst_bar = PRESSURE_DEFAULT_HYST_BAR;
+        ESP_LOGW(TAG, "Neplatna tlk_hyst_bar, pouzivam default %.4f bar", (double)runtime.hyst_bar);
     }
 
-    if (g_pressure_config.sample_ms < PRESSURE_MIN_SAMPLE_MS || g_pressure_config.sample_ms > PRESSURE_MAX_SAMPLE_MS) {
-        g_pressure_config.sample_ms = PRESSURE_DEFAULT_SAMPLE_MS;
-        ESP_LOGW(TAG, "Neplatna tlk_sample_ms, pouzivam default %ld ms", (long)g_pressure_config.sample_ms);
+    if (runtime.sample_ms < PRESSURE_MIN_SAMPLE_MS || runtime.sample_ms > PRESSURE_MAX_SAMPLE_MS) {
+        runtime.sample_ms = PRESSURE_DEFAULT_SAMPLE_MS;
+        ESP_LOGW(TAG, "Neplatna tlk_sample_ms, pouzivam default %ld ms", (long)runtime.sample_ms);
     }
 
-    if (g_pressure_config.round_decimals < PRESSURE_MIN_ROUND_DECIMALS || g_pressure_config.round_decimals > PRESSURE_MAX_ROUND_DECIMALS) {
-        g_pressure_config.round_decimals = PRESSURE_DEFAULT_ROUND_DECIMALS;
-        ESP_LOGW(TAG, "Neplatna tlk_round_dec, pouzivam default %ld", (long)g_pressure_config.round_decimals);
+    if (runtime.round_decimals < PRESSURE_MIN_ROUND_DECIMALS || runtime.round_decimals > PRESSURE_MAX_ROUND_DECIMALS) {
+        runtime.round_decimals = PRESSURE_DEFAULT_ROUND_DECIMALS;
+        ESP_LOGW(TAG, "Neplatna tlk_round_dec, pouzivam default %ld", (long)runtime.round_decimals);
     }
 
-    if (g_pressure_config.dp_100_percent_bar <= 0.0f) {
-        g_pressure_config.dp_100_percent_bar = PRESSURE_DEFAULT_DP100_BAR;
-        ESP_LOGW(TAG, "Neplatne tlk_dp_100, pouzivam %.3f bar", (double)g_pressure_config.dp_100_percent_bar);
+    if (runtime.dp_100_percent_bar <= 0.0f) {
+        runtime.dp_100_percent_bar = PRESSURE_DEFAULT_DP100_BAR;
+        ESP_LOGW(TAG, "Neplatne tlk_dp_100, pouzivam %.3f bar", (double)runtime.dp_100_percent_bar);
     }
 
     ESP_LOGI(TAG,
              "Kalibrace tlaku: pred(raw4=%ld raw20=%ld p_min=%.3f p_max=%.3f) za(raw4=%ld raw20=%ld p_min=%.3f p_max=%.3f) ema=%.3f hyst=%.4f sm=%ld rd=%ld dp100=%.3f",
-             (long)s_pressure_sensor_before.calibration.raw_at_4ma,
-             (long)s_pressure_sensor_before.calibration.raw_at_20ma,
-             (double)s_pressure_sensor_before.calibration.pressure_min_bar,
-             (double)s_pressure_sensor_before.calibration.pressure_max_bar,
-             (long)s_pressure_sensor_after.calibration.raw_at_4ma,
-             (long)s_pressure_sensor_after.calibration.raw_at_20ma,
-             (double)s_pressure_sensor_after.calibration.pressure_min_bar,
-             (double)s_pressure_sensor_after.calibration.pressure_max_bar,
-             (double)g_pressure_config.ema_alpha,
-             (double)g_pressure_config.hyst_bar,
-             (long)g_pressure_config.sample_ms,
-             (long)g_pressure_config.round_decimals,
-             (double)g_pressure_config.dp_100_percent_bar);
+             (long)config.before.raw_at_4ma,
+             (long)config.before.raw_at_20ma,
+             (double)config.before.pressure_min_bar,
+             (double)config.before.pressure_max_bar,
+             (long)config.after.raw_at_4ma,
+             (long)config.after.raw_at_20ma,
+             (double)config.after.pressure_min_bar,
+             (double)config.after.pressure_max_bar,
+             (double)runtime.ema_alpha,
+             (double)runtime.hyst_bar,
+             (long)runtime.sample_ms,
+             (long)runtime.round_decimals,
+             (double)runtime.dp_100_percent_bar);
+    return config;
 }
 
 static esp_err_t adc_init(void)
@@ -330,12 +365,6 @@ static esp_err_t adc_init(void)
     return ESP_OK;
 }
 
-static bool pressure_raw_is_plausible(uint32_t raw_value)
-{
-    return (raw_value <= PRESSURE_RAW_SANITY_MAX - PRESSURE_RAW_SANITY_MIN_MARGIN
-         && raw_value >= PRESSURE_RAW_SANITY_MIN + PRESSURE_RAW_SANITY_MIN_MARGIN);
-}
-
 static bool adc_read_raw(adc_channel_t channel, uint32_t *raw_value)
 {
     if (raw_value == nullptr) {
@@ -359,54 +388,32 @@ static uint32_t adc_filter_trimmed_mean(TrimmedMean<31, 5> &filter, uint32_t raw
     return filter.getValue();
 }
 
-static float adc_raw_to_pressure_bar(const pressure_sensor_calibration_t &calibration, uint32_t raw_value)
-{
-    const int32_t raw_span = calibration.raw_at_20ma - calibration.raw_at_4ma;
-    if (raw_span == 0) {
-        return calibration.pressure_min_bar;
-    }
-
-    return calibration.pressure_min_bar +
-           ((float)((int32_t)raw_value - calibration.raw_at_4ma) *
-            (calibration.pressure_max_bar - calibration.pressure_min_bar) /
-            (float)raw_span);
-}
-
-static float pressure_filter_ema(pressure_sensor_static_t *sensor, float pressure_raw_bar)
-{
-    if (sensor == nullptr) {
-        return NAN;
-    }
-
-    if (!sensor->ema_initialized) {
-        sensor->ema_value = pressure_raw_bar;
-        sensor->ema_initialized = true;
-    } else {
-        const float alpha = g_pressure_config.ema_alpha;
-        sensor->ema_value = alpha * pressure_raw_bar + (1.0f - alpha) * sensor->ema_value;
-    }
-
-    return sensor->ema_value;
-}
-
-static float pressure_apply_hysteresis(pressure_sensor_static_t *sensor, float pressure_bar)
+// Kalibrace, EMA, hystereze a zaokrouhleni jsou v sensor_chain.hpp (float nebo Q16.16).
+static void process_pressure_chain(pressure_sensor_static_t *sensor, pressure_sensor_sample_t *sample)
 {
-    if (sensor == nullptr || sensor->hysteresis == nullptr) {
-        return NAN;
-    }
+    sensor_chain_sample_t chain_sample = {};
+    sensor->chain.process(sample->raw_filtered, &chain_sample);
 
-    return sensor->hysteresis->process(pressure_bar);
+    sample->pressure_raw = chain_sample.value_raw;
+    sample->pressure_ema = chain_sample.value_ema;
+    sample->pressure_hyst = chain_sample.value_hyst;
+    sample->pressure_rounded = chain_sample.output_rounded;
 }
 
-static float round_to_decimals(float value, int32_t decimals)
+static void configure_pressure_chain(pressure_sensor_static_t *sensor)
 {
-    if (decimals <= 1) {
-        return std::roundf(value * 10.0f) / 10.0f;
-    }
-    if (decimals >= 3) {
-        return std::roundf(value * 1000.0f) / 1000.0f;
-    }
-    return std::roundf(value * 100.0f) / 100.0f;
+    const sensor_chain_config_t chain_config = {
+        .raw_min = sensor->calibration.raw_at_4ma,
+        .raw_max = sensor->calibration.raw_at_20ma,
+        .out_min = sensor->calibration.pressure_min_bar,
+        .out_max = sensor->calibration.pressure_max_bar,
+        .ema_alpha = g_pressure_config.ema_alpha,
+        .hysteresis = g_pressure_config.hyst_bar,
+        .round_decimals = g_pressure_config.round_decimals,
+        .output_scale = 1.0f,
+        .clamp_negative = false,
+    };
+    sensor->chain.configure(chain_config);
 }
 
 static float pressure_diff_to_clogging_percent(float pressure_diff_bar)
@@ -427,8 +434,10 @@ static bool process_pressure_sensor(pressure_sensor_static_t *sensor, pressure_s
     sample->pressure_ema = NAN;
     sample->pressure_hyst = NAN;
     sample->pressure_rounded = NAN;
+    sample->fault = sensor->fault_detector->fault();
 
     if (!adc_read_raw(sensor->channel, &sample->raw_unfiltered)) {
+        sensor_trace_record(sensor->trace_channel, 0, SENSOR_TRACE_FLAG_ADC_FAIL);
         DEBUG_PUBLISH("tlak",
                       "sensor_proc name=%s ok=0 reason=adc_read_fail ch=%d",
                       sensor->name,
@@ -436,23 +445,23 @@ static bool process_pressure_sensor(pressure_sensor_static_t *sensor, pressure_s
         return false;
     }
 
-
+    sensor_trace_record(sensor->trace_channel, (uint16_t)sample->raw_unfiltered, 0);
     sample->raw_filtered = adc_filter_trimmed_mean(*sensor->filter, sample->raw_unfiltered);
-    sample->pressure_raw = adc_raw_to_pressure_bar(sensor->calibration, sample->raw_filtered);
-    sample->pressure_ema = pressure_filter_ema(sensor, sample->pressure_raw);
-    sample->pressure_hyst = pressure_apply_hysteresis(sensor, sample->pressure_ema);
-    sample->pressure_rounded = round_to_decimals(sample->pressure_hyst, g_pressure_config.round_decimals);
+    sample->fault = sensor->fault_detector->process(sample->raw_unfiltered);
+    process_pressure_chain(sensor, sample);
 
     DEBUG_PUBLISH("tlak",
-                  "sensor_proc name=%4s ok=1 raw=%lu raw_f=%lu p_raw=%.3f p_ema=%.3f p_hys=%.3f p=%.3f",
+                  "sensor_proc name=%4s ok=1 raw=%lu raw_f=%lu p_raw=%.3f p_ema=%.3f p_hys=%.3f p=%.3f f=%s var=%.0f",
                   sensor->name,
                   (unsigned long)sample->raw_unfiltered,
                   (unsigned long)sample->raw_filtered,
                   (double)sample->pressure_raw,
                   (double)sample->pressure_ema,
                   (double)sample->pressure_hyst,
-                  (double)sample->pressure_rounded);
-    return pressure_raw_is_plausible(sample->raw_unfiltered);
+                  (double)sample->pressure_rounded,
+                  analog_fault_to_string(sample->fault),
+                  (double)sensor->fault_detector->variance());
+    return !analog_fault_is_hard(sample->fault);
 }
 
 static void prefill_pressure_sensor(pressure_sensor_static_t *sensor)
@@ -477,6 +486,24 @@ static void warmup_filters(pressure_sensor_static_t *before_sensor,
     ESP_LOGI(TAG, "Buffer tlaku nabit, zacinam publikovat vysledky");
 }
 
+// Prevezme novou konfiguraci; stav filtru (trimmed mean, EMA, hystereze) zustava, takze
+// neni potreba nove nabiti bufferu.
+static void apply_pressure_config(const pressure_live_config_t &config)
+{
+    s_pressure_sensor_before.calibration = config.before;
+    s_pressure_sensor_after.calibration = config.after;
+    g_pressure_config = config.runtime;
+    configure_pressure_chain(&s_pressure_sensor_before);
+    configure_pressure_chain(&s_pressure_sensor_after);
+}
+
+// Odberatel config_store (task webapp); tlak_task si konfiguraci vyzvedne pred dalsim vzorkem.
+static void on_pressure_config_changed(void *ctx)
+{
+    (void)ctx;
+    s_live_config.publish(read_pressure_config());
+}
+
 
 
 static void tlak_task(void *pvParameters)
@@ -487,8 +514,17 @@ static void tlak_task(void *pvParameters)
     ESP_LOGI(TAG, "Spoustim mereni tlaku (pred/za filtrem)...");
 
     warmup_filters(&s_pressure_sensor_before, &s_pressure_sensor_after);
+    SensorEventGate<4> event_gate(PRESSURE_EVENT_HEARTBEAT_US);
+    uint32_t config_version = s_live_config.version();
+    pressure_live_config_t live_config = {};
 
     while (true) {
+        if (s_live_config.fetch(&config_version, &live_config)) {
+            apply_pressure_config(live_config);
+            ESP_LOGI(TAG, "Nova konfigurace tlaku prevzata za behu (verze %lu)", (unsigned long)config_version);
+            publish_config_debug();
+        }
+
         int64_t timestamp_us = esp_timer_get_time();
         pressure_sensor_sample_t pred_filtrem_sensor = {};
         pressure_sensor_sample_t za_filtrem_sensor = {};
@@ -522,17 +558,30 @@ static void tlak_task(void *pvParameters)
                             .za_filtrem = za_filtrem,
                             .rozdil_filtru = rozdil_filtru,
                             .zanesenost_filtru = zanesenost_filtru,
+                            .fault_pred = pred_filtrem_sensor.fault,
+                            .fault_za = za_filtrem_sensor.fault,
                         },
                     },
                 },
             },
         };
 
-        bool queued = sensor_events_publish(&event, pdMS_TO_TICKS(20));
+        // dP i zanesenost jsou odvozene z pred/za, staci hlidat ty dva a stav poruchy.
+        const float published[4] = {pred_filtrem,
+                                    za_filtrem,
+                                    (float)pred_filtrem_sensor.fault,
+                                    (float)za_filtrem_sensor.fault};
+        int queued = -1;
+        if (event_gate.shouldEmit(published, timestamp_us)) {
+            queued = sensor_events_publish(&event, pdMS_TO_TICKS(20)) ? 1 : 0;
+            if (queued == 1) {
+                event_gate.markEmitted(published, timestamp_us);
+            }
+        }
 
         DEBUG_PUBLISH("filtr",
                   "q=%d ts=%lld valid_pred=%d valid_za=%d pred=%.3f za=%.3f dp=%.3f clog=%.1f",
-                  queued ? 1 : 0,
+                  queued,
                   (long long)event.timestamp_us,
                   pred_sensor_valid ? 1 : 0,
                   za_sensor_valid ? 1 : 0,
@@ -569,9 +618,12 @@ void tlak_register_config_items(void)
 
 void tlak_init(void)
 {
-    load_pressure_calibration_config();
-    s_pressure_hysteresis_before = DirectionalHysteresis(g_pressure_config.hyst_bar);
-    s_pressure_hysteresis_after = DirectionalHysteresis(g_pressure_config.hyst_bar);
+    const pressure_live_config_t config = read_pressure_config();
+    s_live_config.publish(config);
+    apply_pressure_config(config);
+    for (const config_item_t *item : PRESSURE_LIVE_ITEMS) {
+        APP_ERROR_CHECK("E775", config_store_subscribe_item(item, on_pressure_config_changed, nullptr));
+    }
 
     APP_ERROR_CHECK("E739", adc_init());
     APP_ERROR_CHECK("E740",
@@ -0,0 +1,121 @@
+#include "unik.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <esp_log.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "config_store.h"
+#include "debug_mqtt.h"
+#include "app_error_check.h"
+#include "leak_detector.hpp"
+
+#define TAG "unik"
+
+namespace {
+
+static constexpr int32_t UNIK_DEFAULT_GAP_MIN = 15;
+static constexpr float UNIK_DEFAULT_MIN_HOURS = 2.0f;
+static constexpr int32_t UNIK_DEFAULT_UNPOWERED_PULSES = 20;
+
+static constexpr int64_t US_PER_MIN = 60LL * 1000LL * 1000LL;
+
+static const config_item_t UNIK_GAP_ITEM = {
+    .key = "unik_gap_min", .label = "Pomaly unik: max. mezera [min]", .description = "Impulsy v klidu s mensi mezerou se berou jako jeden pomaly unik.",
+    .type = CONFIG_VALUE_INT32, .default_string = nullptr, .default_int = UNIK_DEFAULT_GAP_MIN, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 0, .min_int = 1, .max_int = 240, .min_float = 0.0f, .max_float = 0.0f,
+};
+static const config_item_t UNIK_MIN_HOURS_ITEM = {
+    .key = "unik_min_h", .label = "Pomaly unik: min. doba [h]", .description = "Jak dlouho musi impulsy v klidu trvat, nez se vyhlasi pomaly unik.",
+    .type = CONFIG_VALUE_FLOAT, .default_string = nullptr, .default_int = 0, .default_float = UNIK_DEFAULT_MIN_HOURS, .default_bool = false,
+    .max_string_len = 0, .min_int = 0, .max_int = 0, .min_float = 0.25f, .max_float = 48.0f,
+};
+static const config_item_t UNIK_UNPOWERED_ITEM = {
+    .key = "unik_imp_bez", .label = "Impulsu bez cerpadla pro alarm", .description = "Kolik impulsu pri stojicim cerpadle (podle elektromeru) vyhlasi alarm.",
+    .type = CONFIG_VALUE_INT32, .default_string = nullptr, .default_int = UNIK_DEFAULT_UNPOWERED_PULSES, .default_float = 0.0f, .default_bool = false,
+    .max_string_len = 0, .min_int = 1, .max_int = 10000, .min_float = 0.0f, .max_float = 0.0f,
+};
+
+static LeakDetector::Config s_config = {
+    .runoff_us = 5LL * 1000LL * 1000LL,
+    .trickle_gap_us = UNIK_DEFAULT_GAP_MIN * US_PER_MIN,
+    .trickle_min_us = (int64_t)(UNIK_DEFAULT_MIN_HOURS * 60.0f) * US_PER_MIN,
+    .trickle_min_pulses = 8,
+    .unpowered_gap_us = 60LL * 1000LL * 1000LL,
+    .unpowered_pulses = UNIK_DEFAULT_UNPOWERED_PULSES,
+    .after_end_us = 5LL * US_PER_MIN,
+    .after_end_pulses = 10,
+    .meter_stale_us = 30LL * 1000LL * 1000LL,
+};
+
+static LeakDetector s_detector(s_config);
+static uint8_t s_alarms = 0;
+
+} // namespace
+
+void unik_register_config_items(void)
+{
+    APP_ERROR_CHECK("E771", config_store_register_item(&UNIK_GAP_ITEM));
+    APP_ERROR_CHECK("E772", config_store_register_item(&UNIK_MIN_HOURS_ITEM));
+    APP_ERROR_CHECK("E773", config_store_register_item(&UNIK_UNPOWERED_ITEM));
+}
+
+void unik_init(void)
+{
+    s_config.trickle_gap_us = (int64_t)config_store_get_i32_item(&UNIK_GAP_ITEM) * US_PER_MIN;
+    s_config.trickle_min_us = (int64_t)(config_store_get_float_item(&UNIK_MIN_HOURS_ITEM) * 60.0f) * US_PER_MIN;
+    s_config.unpowered_pulses = (uint32_t)config_store_get_i32_item(&UNIK_UNPOWERED_ITEM);
+    s_detector = LeakDetector(s_config);
+
+    ESP_LOGI(TAG,
+             "Detekce uniku: mezera=%lld min min_doba=%lld min bez_cerpadla=%lu imp po_relaci=%lu imp/%lld min",
+             (long long)(s_config.trickle_gap_us / US_PER_MIN),
+             (long long)(s_config.trickle_min_us / US_PER_MIN),
+             (unsigned long)s_config.unpowered_pulses,
+             (unsigned long)s_config.after_end_pulses,
+             (long long)(s_config.after_end_us / US_PER_MIN));
+}
+
+bool unik_on_flow(uint32_t impulsy_celkem, int64_t timestamp_us)
+{
+    const uint8_t alarms = s_detector.onPulseTotal(impulsy_celkem, timestamp_us);
+    if (alarms == s_alarms) {
+        return false;
+    }
+
+    ESP_LOGW(TAG,
+             "Alarmy uniku: pomaly=%d bez_cerpadla=%d po_relaci=%d (epizoda %lu imp / %lld min)",
+             (alarms & LeakDetector::ALARM_TRICKLE) ? 1 : 0,
+             (alarms & LeakDetector::ALARM_UNPOWERED) ? 1 : 0,
+             (alarms & LeakDetector::ALARM_AFTER_END) ? 1 : 0,
+             (unsigned long)s_detector.tricklePulses(),
+             (long long)(s_detector.trickleDurationUs() / US_PER_MIN));
+    DEBUG_PUBLISH("unik", "alarmy 0x%02x -> 0x%02x", (unsigned)s_alarms, (unsigned)alarms);
+    s_alarms = alarms;
+    return true;
+}
+
+void unik_on_power(bool meter_ok, int64_t timestamp_us)
+{
+    s_detector.onMeter(meter_ok, timestamp_us);
+}
+
+void unik_on_pump(bool relace_aktivni, int64_t timestamp_us)
+{
+    s_detector.onPump(relace_aktivni, timestamp_us);
+}
+
+unik_alarmy_t unik_get_alarmy(void)
+{
+    const unik_alarmy_t alarmy = {
+        .pomaly_unik = (s_alarms & LeakDetector::ALARM_TRICKLE) != 0,
+        .bez_cerpadla = (s_alarms & LeakDetector::ALARM_UNPOWERED) != 0,
+        .po_relaci = (s_alarms & LeakDetector::ALARM_AFTER_END) != 0,
+    };
+    return alarmy;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Alarmy uniku nad proudem impulsu prutokomeru (LeakDetector): pomaly unik v klidu,
+// impulsy pri stojicim cerpadle a prutok po konci relace cerpani.
+
+typedef struct {
+    bool pomaly_unik;
+    bool bez_cerpadla;
+    bool po_relaci;
+} unik_alarmy_t;
+
+void unik_register_config_items(void);
+void unik_init(void);
+
+// Vola state_manager. Vraci true, kdyz se zmenil nektery alarm.
+bool unik_on_flow(uint32_t impulsy_celkem, int64_t timestamp_us);
+void unik_on_power(bool meter_ok, int64_t timestamp_us);
+void unik_on_pump(bool relace_aktivni, int64_t timestamp_us);
+
+unik_alarmy_t unik_get_alarmy(void);
@@ -16,6 +16,11 @@
 #include "teplota.h"
 #include "zasoba.h"
 #include "tlak.h"
+#include "filtr_trend.h"
+#include "pump_session.h"
+#include "provozni_citace.h"
+#include "unik.h"
+#include "kws_303l.h"
 #include "network_config.h"
 #include "system_config.h"
 #include "config_store.h"
@@ -223,9 +228,14 @@ void cpp_app_main(void)
 
     APP_ERROR_CHECK("E109", config_store_begin_section("Tlak"));
     tlak_register_config_items(); 
+    filtr_trend_register_config_items();
 
     APP_ERROR_CHECK("E119", config_store_begin_section("Prutokomer"));
     prutokomer_register_config_items();
+    unik_register_config_items();
+
+    // Vsechny polozky do RAM jednim pruchodem NVS; moduly pak ctou jen z RAM.
+    APP_ERROR_CHECK("E120", config_store_load());
 
     APP_ERROR_CHECK("E110", config_webapp_prepare("app_cfg"));
 
@@ -260,6 +270,13 @@ void cpp_app_main(void)
     };
 
 
+    network_sta_options_t sta_options = {};
+    if (network_config_load_sta_options(&sta_options) != ESP_OK) {
+        ESP_LOGW(TAG, "Neplatna pevna IP v konfiguraci (net_ip/net_mask/net_gw/net_dns), pouzivam DHCP");
+        sta_options.static_ip = false;
+    }
+    APP_ERROR_CHECK("E121", network_set_sta_options(&sta_options));
+
     ESP_LOGI(TAG,
              "MQTT cfg pred pripojenim: uri=%s, user=%s, password_set=%s, status_topic=%s",
              mqtt_uri,
@@ -280,6 +297,10 @@ void cpp_app_main(void)
     
     lcd_init(); // Inicializace LCD před spuštěním ostatních úloh, aby mohly ihned zobrazovat informace
 
+    filtr_trend_init();
+    pump_session_init();
+    unik_init();
+    provozni_citace_init();
     state_manager_start();
 
     adc_shared_init();
@@ -292,5 +313,10 @@ void cpp_app_main(void)
     zasoba_init();
     tlak_init();
 
+    // elektromer cerpadla (vykon pro relace cerpani)
+    if (kws_303l_is_enabled()) {
+        kws_303l_init();
+    }
+
 
 }
@@ -22,7 +22,12 @@ extern "C" {
 #include "sensor_events.h"
 #include "debug_mqtt.h"
 #include "app_error_check.h"
-#include "directional_hysteresis.hpp"
+#include "sensor_chain.hpp"
+#include "sensor_trace.h"
+#include "sensor_event_gate.hpp"
+#include "analog_fault_detector.hpp"
+#include "analog_channel_config.hpp"
+#include "live_params.hpp"
 
 #define TAG "zasoba"
 
@@ -53,9 +58,6 @@ static constexpr int32_t LEVEL_MAX_SAMPLE_MS = 1000;
 static constexpr int32_t LEVEL_MIN_ROUND_DECIMALS = 1;
 static constexpr int32_t LEVEL_MAX_ROUND_DECIMALS = 3;
 static constexpr int64_t LEVEL_CFG_DEBUG_PERIOD_US = 10LL * 1000LL * 1000LL;
-static constexpr uint32_t LEVEL_RAW_SANITY_MIN = 0;
-static constexpr uint32_t LEVEL_RAW_SANITY_MAX = 4095;
-static constexpr uint32_t LEVEL_RAW_SANITY_MIN_MARGIN = 80;
 
 static const config_item_t LEVEL_RAW_MIN_ITEM = {
     .key = "lvl_raw_min", .label = "Hladina RAW min", .description = "ADC RAW hodnota odpovidajici minimalni hladine.",
@@ -140,11 +142,26 @@ static level_calibration_config_t g_level_config = {
     .round_decimals = LEVEL_DEFAULT_ROUND_DECIMALS,
 };
 
+static LiveParams<level_calibration_config_t> s_live_config(g_level_config);
+
+static const config_item_t *const LEVEL_LIVE_ITEMS[] = {
+    &LEVEL_RAW_MIN_ITEM,
+    &LEVEL_RAW_MAX_ITEM,
+    &LEVEL_H_MIN_ITEM,
+    &LEVEL_H_MAX_ITEM,
+    &LEVEL_TANK_AREA_ITEM,
+    &LEVEL_EMA_ALPHA_ITEM,
+    &LEVEL_HYST_M_ITEM,
+    &LEVEL_SAMPLE_MS_ITEM,
+    &LEVEL_ROUND_DECIMALS_ITEM,
+};
+
 // Stav filtrace mereni hladiny (31 prvku, 5 orezanych z obou stran)
 static TrimmedMean<31, 5> level_filter;
-static float s_height_ema_value = 0.0f;
-static bool s_height_ema_initialized = false;
-static DirectionalHysteresis s_height_hysteresis(LEVEL_DEFAULT_HYST_M);
+static AnalogFaultDetector s_level_fault_detector(LEVEL_FAULT_DETECTOR_CONFIG);
+// Kalibrace, EMA, hystereze a prepocet na objem (float nebo Q16.16, viz sensor_chain.hpp);
+// parametry nastavuje apply_level_config().
+static SensorChain s_level_chain;
 static int64_t s_last_hysteresis_debug_log_us = 0;
 static int64_t s_last_cfg_debug_publish_us = 0;
 static constexpr int64_t LEVEL_HYST_DEBUG_PERIOD_US = 2LL * 1000LL * 1000LL;
@@ -175,61 +192,57 @@ static void publish_config_debug_periodic(int64_t now_us)
     s_last_cfg_debug_publish_us = now_us;
 }
 
-static void load_level_calibration_config(void)
+static level_calibration_config_t read_level_config(void)
 {
-    g_level_config.adc_raw_min = config_store_get_i32_item(&LEVEL_RAW_MIN_ITEM);
-    g_level_config.adc_raw_max = config_store_get_i32_item(&LEVEL_RAW_MAX_ITEM);
-    g_level_config.height_min = config_store_get_float_item(&LEVEL_H_MIN_ITEM);
-    g_level_config.height_max = config_store_get_float_item(&LEVEL_H_MAX_ITEM);
-    g_level_config.tank_area_m2 = config_store_get_float_item(&LEVEL_TANK_AREA_ITEM);
-    g_level_config.ema_alpha = config_store_get_float_item(&LEVEL_EMA_ALPHA_ITEM);
-    g_level_config.hyst_m = config_store_get_float_item(&LEVEL_HYST_M_ITEM);
-    g_level_config.sample_ms = config_store_get_i32_item(&LEVEL_SAMPLE_MS_ITEM);
-    g_level_config.round_decimals = config_store_get_i32_item(&LEVEL_ROUND_DECIMALS_ITEM);
-
-    if (g_level_config.tank_area_m2 <= 0.0f) {
-        g_level_config.tank_area_m2 = LEVEL_DEFAULT_TANK_AREA_M2;
-        ESP_LOGW(TAG, "Neplatna plocha nadrze, pouzivam default %.3f m2", (double)g_level_config.tank_area_m2);
+    level_calibration_config_t config = {};
+    config.adc_raw_min = config_store_get_i32_item(&LEVEL_RAW_MIN_ITEM);
+    config.adc_raw_max = config_store_get_i32_item(&LEVEL_RAW_MAX_ITEM);
+    config.height_min = config_store_get_float_item(&LEVEL_H_MIN_ITEM);
+    config.height_max = config_store_get_float_item(&LEVEL_H_MAX_ITEM);
+    config.tank_area_m2 = config_store_get_float_item(&LEVEL_TANK_AREA_ITEM);
+    config.ema_alpha = config_store_get_float_item(&LEVEL_EMA_ALPHA_ITEM);
+    config.hyst_m = config_store_get_float_item(&LEVEL_HYST_M_ITEM);
+    config.sample_ms = config_store_get_i32_item(&LEVEL_SAMPLE_MS_ITEM);
+    config.round_decimals = config_store_get_i32_item(&LEVEL_ROUND_DECIMALS_ITEM);
+
+    if (config.tank_area_m2 <= 0.0f) {
+        config.tank_area_m2 = LEVEL_DEFAULT_TANK_AREA_M2;
+        ESP_LOGW(TAG, "Neplatna plocha nadrze, pouzivam default %.3f m2", (double)config.tank_area_m2);
     }
 
-    if (g_level_config.ema_alpha <= 0.0f || g_level_config.ema_alpha > 1.0f) {
-        g_level_config.ema_alpha = LEVEL_DEFAULT_EMA_ALPHA;
-        ESP_LOGW(TAG, "Neplatna ema_alpha, pouzivam default %.3f", (double)g_level_config.ema_alpha);
+    if (config.ema_alpha <= 0.0f || config.ema_alpha > 1.0f) {
+        config.ema_alpha = LEVEL_DEFAULT_EMA_ALPHA;
+        ESP_LOGW(TAG, "Neplatna ema_alpha, pouzivam default %.3f", (double)config.ema_alpha);
     }
 
-    if (g_level_config.hyst_m < 0.0f) {
-        g_level_config.hyst_m = LEVEL_DEFAULT_HYST_M;
-        ESP_LOGW(TAG, "Neplatna hyst_m, pouzivam default %.4f m", (double)g_level_config.hyst_m);
+    if (config.hyst_m < 0.0f) {
+        config.hyst_m = LEVEL_DEFAULT_HYST_M;
+        ESP_LOGW(TAG, "Neplatna hyst_m, pouzivam default %.4f m", (double)config.hyst_m);
     }
 
-    if (g_level_config.sample_ms < 1) {
-        g_level_config.sample_ms = LEVEL_DEFAULT_SAMPLE_MS;
-        ESP_LOGW(TAG, "Neplatna sample_ms, pouzivam default %ld ms", (long)g_level_config.sample_ms);
+    if (config.sample_ms < 1) {
+        config.sample_ms = LEVEL_DEFAULT_SAMPLE_MS;
+        ESP_LOGW(TAG, "Neplatna sample_ms, pouzivam default %ld ms", (long)config.sample_ms);
     }
 
-    if (g_level_config.round_decimals < LEVEL_MIN_ROUND_DECIMALS || g_level_config.round_decimals > LEVEL_MAX_ROUND_DECIMALS) {
-        g_level_config.round_decimals = LEVEL_DEFAULT_ROUND_DECIMALS;
-        ESP_LOGW(TAG, "Neplatna round_decimals, pouzivam default %ld", (long)g_level_config.round_decimals);
+    if (config.round_decimals < LEVEL_MIN_ROUND_DECIMALS || config.round_decimals > LEVEL_MAX_ROUND_DECIMALS) {
+        config.round_decimals = LEVEL_DEFAULT_ROUND_DECIMALS;
+        ESP_LOGW(TAG, "Neplatna round_decimals, pouzivam default %ld", (long)config.round_decimals);
     }
 
     ESP_LOGI(TAG,
              "Nactena kalibrace objemu: raw_min=%ld raw_max=%ld h_min=%.3f m h_max=%.3f m area=%.3f m2 ema=%.3f hyst=%.4f sm=%ld rd=%ld",
-             (long)g_level_config.adc_raw_min,
-             (long)g_level_config.adc_raw_max,
-             g_level_config.height_min,
-             g_level_config.height_max,
-             g_level_config.tank_area_m2,
-             g_level_config.ema_alpha,
-             g_level_config.hyst_m,
-             (long)g_level_config.sample_ms,
-             (long)g_level_config.round_decimals);
-
-}
-
-static bool level_raw_is_plausible(uint32_t raw_value)
-{
-    return (raw_value <= LEVEL_RAW_SANITY_MAX - LEVEL_RAW_SANITY_MIN_MARGIN
-         && raw_value >= LEVEL_RAW_SANITY_MIN + LEVEL_RAW_SANITY_MIN_MARGIN);
+             (long)config.adc_raw_min,
+             (long)config.adc_raw_max,
+             config.height_min,
+             config.height_max,
+             config.tank_area_m2,
+             config.ema_alpha,
+             config.hyst_m,
+             (long)config.sample_ms,
+             (long)config.round_decimals);
+
+    return config;
 }
 
 /**
@@ -279,55 +292,6 @@ static uint32_t adc_filter_trimmed_mean(uint32_t raw_value)
     return level_filter.getValue();
 }
 
-/**
- * Převede RAW ADC hodnotu na výšku hladiny v metrech
- * @param raw_value RAW hodnota z ADC
- * @return výška hladiny v metrech
- */
-static float adc_raw_to_height(uint32_t raw_value)
-{
-    // Linearni interpolace mezi kalibracnimi body RAW -> vyska.
-    const int32_t raw_span = g_level_config.adc_raw_max - g_level_config.adc_raw_min;
-    if (raw_span == 0) {
-        return g_level_config.height_min;
-    }
-
-    float height = g_level_config.height_min + (float)((int)raw_value - g_level_config.adc_raw_min) *
-                   (g_level_config.height_max - g_level_config.height_min) /
-                   (float)raw_span;
-
-    return height;
-}
-
-/**
- * Aplikuje EMA filtr na výšku hladiny
- * @param height_raw_m nefiltrovaná výška hladiny [m]
- * @return filtrovaná výška hladiny [m]
- */
-static float height_filter_ema(float height_raw_m)
-{
-    if (!s_height_ema_initialized) {
-        s_height_ema_value = height_raw_m;
-        s_height_ema_initialized = true;
-    } else {
-        const float alpha = g_level_config.ema_alpha;
-        s_height_ema_value = alpha * height_raw_m
-                           + (1.0f - alpha) * s_height_ema_value;
-    }
-
-    return s_height_ema_value;
-}
-
-/**
- * Aplikuje hysterezi na výšku hladiny
- * @param height_m výška hladiny [m]
- * @return výška hladiny po aplikaci hystereze [m]
- */
-static float height_apply_hysteresis(float height_m)
-{
-    return s_height_hysteresis.process(height_m);
-}
-
 static void log_hysteresis_debug_periodic(int64_t now_us, float input_height_m, float output_height_m)
 {
     if (s_last_hysteresis_debug_log_us != 0
@@ -337,24 +301,24 @@ static void log_hysteresis_debug_periodic(int64_t now_us, float input_height_m,
     s_last_hysteresis_debug_log_us = now_us;
 }
 
-static float height_to_volume_m3(float height_m)
-{
-    if (height_m < 0.0f) {
-        height_m = 0.0f;
-    }
-
-    return height_m * g_level_config.tank_area_m2;
-}
+typedef struct {
+    float hladina_raw;
+    float hladina_ema;
+    float hladina_hyst;
+    float objem_m3_raw;
+    float objem_m3_rounded;
+} level_chain_sample_t;
 
-static float round_to_decimals(float value, int32_t decimals)
+static void process_level_chain(uint32_t raw_trimmed_value, level_chain_sample_t *sample)
 {
-    if (decimals <= 1) {
-        return std::roundf(value * 10.0f) / 10.0f;
-    }
-    if (decimals >= 3) {
-        return std::roundf(value * 1000.0f) / 1000.0f;
-    }
-    return std::roundf(value * 100.0f) / 100.0f;
+    sensor_chain_sample_t chain_sample = {};
+    s_level_chain.process(raw_trimmed_value, &chain_sample);
+
+    sample->hladina_raw = chain_sample.value_raw;
+    sample->hladina_ema = chain_sample.value_ema;
+    sample->hladina_hyst = chain_sample.value_hyst;
+    sample->objem_m3_raw = chain_sample.output;
+    sample->objem_m3_rounded = chain_sample.output_rounded;
 }
 
 // Prednabi filtry tak, aby prvni publikovane hodnoty nebyly zkreslene rozbehem.
@@ -362,8 +326,7 @@ static void warmup_filters(void)
 {
     uint32_t raw_value = 0;
     uint32_t raw_trimmed_value = 0;
-    float height_raw = 0.0f;
-    float height_ema = 0.0f;
+    level_chain_sample_t sample = {};
 
     const size_t buffer_size = level_filter.getBufferSize();
     ESP_LOGI(TAG, "Prebiha nabiti bufferu (%zu mereni)...", buffer_size);
@@ -374,14 +337,38 @@ static void warmup_filters(void)
         }
 
         raw_trimmed_value = adc_filter_trimmed_mean(raw_value);
-        height_raw = adc_raw_to_height(raw_trimmed_value);
-        height_ema = height_filter_ema(height_raw);
-        (void)height_apply_hysteresis(height_ema);
+        (void)s_level_fault_detector.process(raw_value);
+        process_level_chain(raw_trimmed_value, &sample);
     }
 
     ESP_LOGI(TAG, "Buffer nabit, zacinam publikovat vysledky");
 }
 
+// Prevezme novou konfiguraci; stav trimmed mean, EMA a hystereze zustava.
+static void apply_level_config(const level_calibration_config_t &config)
+{
+    g_level_config = config;
+    const sensor_chain_config_t chain_config = {
+        .raw_min = g_level_config.adc_raw_min,
+        .raw_max = g_level_config.adc_raw_max,
+        .out_min = g_level_config.height_min,
+        .out_max = g_level_config.height_max,
+        .ema_alpha = g_level_config.ema_alpha,
+        .hysteresis = g_level_config.hyst_m,
+        .round_decimals = g_level_config.round_decimals,
+        .output_scale = g_level_config.tank_area_m2,
+        .clamp_negative = true,
+    };
+    s_level_chain.configure(chain_config);
+}
+
+// Odberatel config_store (task webapp); zasoba_task si konfiguraci vyzvedne pred dalsim vzorkem.
+static void on_level_config_changed(void *ctx)
+{
+    (void)ctx;
+    s_live_config.publish(read_level_config());
+}
+
 static void zasoba_task(void *pvParameters)
 {
     (void)pvParameters;
@@ -392,34 +379,34 @@ static void zasoba_task(void *pvParameters)
 
     uint32_t raw_value;
     uint32_t raw_trimmed_value;
-    float hladina_raw;
-    float hladina_ema;
-    float hladina_hyst;
-    float objem_m3_raw;
-    float objem_m3_rounded;
+    level_chain_sample_t sample = {};
+    SensorEventGate<3> event_gate(LEVEL_EVENT_HEARTBEAT_US);
+    uint32_t config_version = s_live_config.version();
+    level_calibration_config_t live_config = {};
 
     while (1) {
+        if (s_live_config.fetch(&config_version, &live_config)) {
+            apply_level_config(live_config);
+            ESP_LOGI(TAG, "Nova konfigurace hladiny prevzata za behu (verze %lu)", (unsigned long)config_version);
+            publish_config_debug();
+        }
+
         int64_t timestamp_us = esp_timer_get_time();
 
         // 1) Nacteni surove ADC hodnoty
         const bool adc_ok = adc_read_raw(&raw_value);
-        const bool raw_plausible = adc_ok && level_raw_is_plausible(raw_value);
-
+        sensor_trace_record(SENSOR_TRACE_CH_ZASOBA,
+                            adc_ok ? (uint16_t)raw_value : 0,
+                            adc_ok ? 0 : SENSOR_TRACE_FLAG_ADC_FAIL);
 
-
-        // 2) Trimmed-mean na RAW
+        // 2) Trimmed-mean na RAW a ve stejnem pruchodu detekce poruch smycky
         raw_trimmed_value = adc_filter_trimmed_mean(raw_value);
-        // 3) Prevod RAW -> vyska hladiny [m]
-        hladina_raw = adc_raw_to_height(raw_trimmed_value);
-        // 4) EMA filtr na vysce
-        hladina_ema = height_filter_ema(hladina_raw);
-        // 5) Hystereze na vysce
-        hladina_hyst = height_apply_hysteresis(hladina_ema);
-        log_hysteresis_debug_periodic(timestamp_us, hladina_ema, hladina_hyst);
-        // 6) Prevod vyska -> objem [m3]
-        objem_m3_raw = height_to_volume_m3(hladina_hyst);
-        // 7) Zaokrouhleni na konfigurovany pocet desetinnych mist pro publikaci
-        objem_m3_rounded = round_to_decimals(objem_m3_raw, g_level_config.round_decimals);
+        const analog_fault_t fault = adc_ok ? s_level_fault_detector.process(raw_value)
+                                            : s_level_fault_detector.fault();
+        const bool raw_plausible = adc_ok && !analog_fault_is_hard(fault);
+        // 3) - 7) Kalibrace, EMA, hystereze, objem a zaokrouhleni (float nebo Q16.16)
+        process_level_chain(raw_trimmed_value, &sample);
+        log_hysteresis_debug_periodic(timestamp_us, sample.hladina_ema, sample.hladina_hyst);
 
         app_event_t event = {
             .event_type = EVT_SENSOR,
@@ -429,29 +416,42 @@ static void zasoba_task(void *pvParameters)
                     .sensor_type = SENSOR_EVENT_ZASOBA,
                     .data = {
                         .zasoba = {
-                            .objem = raw_plausible ? objem_m3_rounded : NAN,
-                            .hladina = raw_plausible ? hladina_hyst : NAN,
+                            .objem = raw_plausible ? sample.objem_m3_rounded : NAN,
+                            .hladina = raw_plausible ? sample.hladina_hyst : NAN,
+                            .fault = fault,
                         },
                     },
                 },
             },
         };
 
-        bool queued = sensor_events_publish(&event, pdMS_TO_TICKS(20));
+        // 8) Event jen pri zmene publikovane hodnoty, platnosti nebo heartbeat
+        const float published[3] = {event.data.sensor.data.zasoba.objem,
+                                    event.data.sensor.data.zasoba.hladina,
+                                    (float)fault};
+        int queued = -1;
+        if (event_gate.shouldEmit(published, timestamp_us)) {
+            queued = sensor_events_publish(&event, pdMS_TO_TICKS(20)) ? 1 : 0;
+            if (queued == 1) {
+                event_gate.markEmitted(published, timestamp_us);
+            }
+        }
 
         publish_config_debug_periodic(timestamp_us);
 
         DEBUG_PUBLISH("zasoba",
-                        "q=%d ts=%lld r=%lu rt=%lu h=%.4f he=%.4f hh=%.4f v=%.4f v2=%.3f",
-                        queued ? 1 : 0,
+                        "q=%d ts=%lld r=%lu rt=%lu h=%.4f he=%.4f hh=%.4f v=%.4f v2=%.3f f=%s var=%.0f",
+                        queued,
                         (long long)event.timestamp_us,
                         (unsigned long)raw_value,
                         (unsigned long)raw_trimmed_value,
-                        (double)hladina_raw,
-                        (double)hladina_ema,
-                        (double)hladina_hyst,
-                        (double)objem_m3_raw,
-                        (double)objem_m3_rounded);        
+                        (double)sample.hladina_raw,
+                        (double)sample.hladina_ema,
+                        (double)sample.hladina_hyst,
+                        (double)sample.objem_m3_raw,
+                        (double)sample.objem_m3_rounded,
+                        analog_fault_to_string(fault),
+                        (double)s_level_fault_detector.variance());        
 
         APP_ERROR_CHECK("E766", esp_task_wdt_reset());
         vTaskDelay(pdMS_TO_TICKS(g_level_config.sample_ms));
@@ -460,8 +460,12 @@ static void zasoba_task(void *pvParameters)
 
 void zasoba_init(void)
 {
-    load_level_calibration_config();
-    s_height_hysteresis = DirectionalHysteresis(g_level_config.hyst_m);
+    const level_calibration_config_t config = read_level_config();
+    s_live_config.publish(config);
+    apply_level_config(config);
+    for (const config_item_t *item : LEVEL_LIVE_ITEMS) {
+        APP_ERROR_CHECK("E776", config_store_subscribe_item(item, on_level_config_changed, nullptr));
+    }
 
     APP_ERROR_CHECK("E767", adc_init());
 
@@ -0,0 +1,242 @@
+// Zatez NVS z config_store (components/config_store) nad emulovanym NVS (tools/host/).
+// Zaregistruje polozky s mixem typu jako firmware a precte je stejne jako moduly pri startu
+// (config_store_get_* podle klice). Vypise otevreni NVS, cteni, zapisy a commity:
+//  - prvni start (prazdne NVS, zapisuji se vychozi hodnoty),
+//  - dalsi start (vse uz v NVS),
+//  - ulozeni formulare webapp (vsechny polozky, zmenena jen jedna),
+// a cas na hostu (jen pro porovnani verzi, ne cas na cili): dalsi start, ulozeni formulare
+// bez zmeny (jen vyhledani polozek podle klice a porovnani v RAM) a samotne vyhledani klice.
+// Po kazdem startu se kontroluje, ze precteny hodnoty odpovidaji ocekavanym; jinak vraci 1.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -I tools/host -I components/config_store/include tools/config_store_bench.cpp tools/host/host_flash.cpp components/config_store/config_store.cpp -o config_store_bench
+//
+// Pouziti:
+//   ./config_store_bench [--items=42] [--repeat=2000]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "host_flash.h"
+#include "config_store.h"
+
+namespace {
+
+static const char *NVS_NAMESPACE = "cfg";
+static const size_t ITEMS_PER_SECTION = 8;
+static const size_t STRING_BUFFER_LEN = 64;
+
+struct bench_options_t {
+    size_t items;
+    unsigned repeat;
+};
+
+struct bench_items_t {
+    std::vector<std::string> keys;
+    std::vector<config_item_t> items;
+};
+
+// Typy se stridaji priblizne v pomeru firmware: hlavne cela cisla a floaty.
+static bench_items_t make_items(size_t count)
+{
+    static const config_value_type_t TYPES[] = {
+        CONFIG_VALUE_INT32, CONFIG_VALUE_FLOAT, CONFIG_VALUE_INT32, CONFIG_VALUE_FLOAT,
+        CONFIG_VALUE_BOOL, CONFIG_VALUE_FLOAT, CONFIG_VALUE_INT32, CONFIG_VALUE_STRING,
+    };
+
+    bench_items_t result;
+    result.keys.reserve(count);
+    result.items.reserve(count);
+    for (size_t index = 0; index < count; ++index) {
+        char key[16];
+        std::snprintf(key, sizeof(key), "bench_%03u", (unsigned)index);
+        result.keys.emplace_back(key);
+
+        config_item_t item = {};
+        item.label = "bench";
+        item.description = "";
+        item.type = TYPES[index % (sizeof(TYPES) / sizeof(TYPES[0]))];
+        item.default_string = "voda-septik";
+        item.default_int = (int32_t)index * 10;
+        item.default_float = 0.5f + (float)index;
+        item.default_bool = (index % 2) == 0;
+        item.max_string_len = 32;
+        item.min_int = 0;
+        item.max_int = 100000;
+        item.min_float = 0.0f;
+        item.max_float = 1000.0f;
+        result.items.push_back(item);
+    }
+    // Klice az po naplneni vektoru (c_str() se uz nepresune).
+    for (size_t index = 0; index < count; ++index) {
+        result.items[index].key = result.keys[index].c_str();
+    }
+    return result;
+}
+
+static void register_items(const bench_items_t &items)
+{
+    config_store_prepare(NVS_NAMESPACE);
+    for (size_t index = 0; index < items.items.size(); ++index) {
+        if (index % ITEMS_PER_SECTION == 0) {
+            char section[16];
+            std::snprintf(section, sizeof(section), "Sekce %u", (unsigned)(index / ITEMS_PER_SECTION));
+            config_store_begin_section(section);
+        }
+        config_store_register_item(&items.items[index]);
+    }
+}
+
+// Precte vsechny polozky jako moduly pri startu; vraci pocet neocekavanych hodnot.
+static unsigned read_items(const bench_items_t &items, size_t changed_index)
+{
+    unsigned mismatches = 0;
+    for (size_t index = 0; index < items.items.size(); ++index) {
+        const config_item_t &item = items.items[index];
+        const bool changed = index == changed_index;
+        switch (item.type) {
+        case CONFIG_VALUE_INT32:
+            mismatches += config_store_get_i32(item.key) != item.default_int + (changed ? 1 : 0);
+            break;
+        case CONFIG_VALUE_FLOAT:
+            mismatches += std::fabs(config_store_get_float(item.key) - (item.default_float + (changed ? 1.0f : 0.0f))) > 1e-6f;
+            break;
+        case CONFIG_VALUE_BOOL:
+            mismatches += config_store_get_bool(item.key) != (changed ? !item.default_bool : item.default_bool);
+            break;
+        case CONFIG_VALUE_STRING: {
+            char buffer[STRING_BUFFER_LEN];
+            config_store_get_string(item.key, buffer, sizeof(buffer));
+            mismatches += std::strcmp(buffer, changed ? "zmeneno" : item.default_string) != 0;
+            break;
+        }
+        }
+    }
+    return mismatches;
+}
+
+// Ulozeni formulare: webapp zapise vsechny polozky, zmenena je jen polozka changed_index.
+static unsigned save_form(const bench_items_t &items, size_t changed_index)
+{
+    unsigned failures = 0;
+    for (size_t index = 0; index < items.items.size(); ++index) {
+        const config_item_t &item = items.items[index];
+        const bool changed = index == changed_index;
+        esp_err_t result = ESP_OK;
+        switch (item.type) {
+        case CONFIG_VALUE_INT32:
+            result = config_store_set_i32(item.key, item.default_int + (changed ? 1 : 0));
+            break;
+        case CONFIG_VALUE_FLOAT:
+            result = config_store_set_float(item.key, item.default_float + (changed ? 1.0f : 0.0f));
+            break;
+        case CONFIG_VALUE_BOOL:
+            result = config_store_set_bool(item.key, changed ? !item.default_bool : item.default_bool);
+            break;
+        case CONFIG_VALUE_STRING:
+            result = config_store_set_string(item.key, changed ? "zmeneno" : item.default_string);
+            break;
+        }
+        failures += result != ESP_OK;
+    }
+    return failures;
+}
+
+static void print_stats(const char *phase, const host_nvs_stats_t &stats)
+{
+    std::printf("%-18s otevreni=%llu cteni=%llu set=%llu zapisu=%llu commitu=%llu\n",
+                phase,
+                (unsigned long long)stats.opens,
+                (unsigned long long)stats.reads,
+                (unsigned long long)stats.sets,
+                (unsigned long long)stats.writes,
+                (unsigned long long)stats.commits);
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr, "Pouziti: %s [--items=42] [--repeat=2000]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench_options_t options = {42, 2000};
+    for (int index = 1; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strncmp(arg, "--items=", 8) == 0) {
+            options.items = (size_t)std::atoi(arg + 8);
+        } else if (std::strncmp(arg, "--repeat=", 9) == 0) {
+            options.repeat = (unsigned)std::max(1, std::atoi(arg + 9));
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.items == 0 || options.items > 64) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const bench_items_t items = make_items(options.items);
+    const size_t no_change = options.items;
+    const size_t changed_index = options.items / 2;
+    unsigned failures = 0;
+
+    host_flash_reset();
+    register_items(items);
+    failures += read_items(items, no_change);
+    print_stats("prvni start:", host_nvs_stats());
+
+    host_nvs_clear_stats();
+    register_items(items);
+    failures += read_items(items, no_change);
+    print_stats("dalsi start:", host_nvs_stats());
+
+    host_nvs_clear_stats();
+    failures += save_form(items, changed_index);
+    print_stats("ulozeni formulare:", host_nvs_stats());
+
+    register_items(items);
+    failures += read_items(items, changed_index);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < options.repeat; ++round) {
+        register_items(items);
+        failures += read_items(items, changed_index);
+    }
+    const double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    // Formular webapp prochazi pole podle klice; stejne hodnoty se do NVS nezapisuji.
+    const auto save_start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < options.repeat; ++round) {
+        failures += save_form(items, changed_index);
+    }
+    const double save_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - save_start).count();
+
+    // Vyhledani klice posledni registrovane polozky (nejhorsi pripad linearniho pruchodu).
+    const char *last_key = items.keys.back().c_str();
+    size_t found = 0;
+    const auto find_start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < options.repeat * 100U; ++round) {
+        found += config_store_find_item(last_key) != nullptr;
+    }
+    const double find_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - find_start).count();
+    failures += found != options.repeat * 100U;
+
+    std::printf("polozek=%u, na hostu: dalsi start %.2f us, ulozeni formulare %.2f us, vyhledani klice %.1f ns\n%s\n",
+                (unsigned)options.items,
+                elapsed_us / (double)options.repeat,
+                save_us / (double)options.repeat,
+                find_ns / (double)(options.repeat * 100U),
+                failures == 0 ? "OK" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
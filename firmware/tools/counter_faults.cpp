@@ -0,0 +1,200 @@
+// Vypadky napajeni pri preteceni FlashMonotonicCounter ve formatu A/B (init_dual_bank).
+// Scenar (prirustky pres nekolik preteceni, mezi nimi erase_step()) se nejdriv probehne
+// bez vypadku, aby se spocital pocet zapisu a mazani. Pak se pro kazdou z techto operaci
+// a kazdy zpusob preruseni (bez ucinku, polovina, cela) scenar zopakuje s vypadkem
+// prave na ni. Po "zapnuti" se citac nacte z flash a kontroluje se:
+//  - hodnota je mezi potvrzenou hodnotou a potvrzenou + rozpracovany prirustek,
+//  - citac dal pocita (dalsi preteceni) a po dalsim nacteni drzi hodnotu,
+//  - zadny zapis nepotreboval bit 1 z 0.
+// Pri poruseni kontrol vraci 1.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -I tools/host -I main tools/counter_faults.cpp tools/host/host_flash.cpp main/flash_monotonic_counter.cpp -o counter_faults
+//
+// Pouziti:
+//   ./counter_faults [--sectors=2] [--erase-size=256] [--verbose]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "host_flash.h"
+#include "flash_monotonic_counter.h"
+
+namespace {
+
+static const char *PARTITION_LABEL = "ctr";
+
+struct fault_options_t {
+    uint32_t sectors;
+    uint32_t erase_size;
+    bool verbose;
+};
+
+// Prirustky scenare; opakuji se, dokud soucet neprekroci tri banky.
+static const uint32_t STEP_PATTERN[] = {1, 7, 64, 300, 3, 1000, 2, 511};
+
+struct run_result_t {
+    bool init_ok;
+    uint64_t confirmed;         // soucet prirustku, ktere vratily ESP_OK
+    uint64_t in_flight;         // prirustek, behem ktereho prisel vypadek
+    uint64_t ops;
+};
+
+static run_result_t run_scenario(const fault_options_t &options, uint64_t total_steps)
+{
+    run_result_t result = {};
+    FlashMonotonicCounter counter;
+    result.init_ok = counter.init_dual_bank(PARTITION_LABEL, 0, 0) == ESP_OK;
+    if (!result.init_ok) {
+        result.ops = host_flash_mutating_ops();
+        return result;
+    }
+
+    size_t index = 0;
+    while (result.confirmed < total_steps && !host_flash_power_lost()) {
+        const uint32_t steps = STEP_PATTERN[index % (sizeof(STEP_PATTERN) / sizeof(STEP_PATTERN[0]))];
+        if (counter.increment(steps) != ESP_OK) {
+            result.in_flight = steps;
+            break;
+        }
+        result.confirmed += steps;
+        if (index % 3 == 2 && counter.erase_step() != ESP_OK) {
+            break;
+        }
+        ++index;
+    }
+    (void)options;
+    result.ops = host_flash_mutating_ops();
+    return result;
+}
+
+static uint64_t invalid_writes()
+{
+    return host_flash_stats(PARTITION_LABEL).invalid_writes;
+}
+
+// Po vypadku: nacteni, kontrola hodnoty a dalsi pocitani pres preteceni.
+static bool check_recovery(const fault_options_t &options, const run_result_t &run, uint32_t bank_bits, const char *label)
+{
+    FlashMonotonicCounter counter;
+    if (counter.init_dual_bank(PARTITION_LABEL, 0, 0) != ESP_OK) {
+        std::printf("%s: init po vypadku selhal\n", label);
+        return false;
+    }
+
+    const uint64_t value = counter.value();
+    const uint64_t low = run.init_ok ? run.confirmed : 0;
+    const uint64_t high = run.confirmed + run.in_flight;
+    if (value < low || value > high) {
+        std::printf("%s: hodnota %llu mimo <%llu, %llu>\n", label,
+                    (unsigned long long)value, (unsigned long long)low, (unsigned long long)high);
+        return false;
+    }
+
+    uint64_t expected = value;
+    for (uint32_t round = 0; round * 97U < 2 * bank_bits + 17; ++round) {
+        if (counter.increment(97) != ESP_OK) {
+            std::printf("%s: increment po vypadku selhal\n", label);
+            return false;
+        }
+        expected += 97;
+        if (round % 4 == 3 && counter.erase_step() != ESP_OK) {
+            std::printf("%s: erase_step po vypadku selhal\n", label);
+            return false;
+        }
+    }
+
+    FlashMonotonicCounter reloaded;
+    if (reloaded.init_dual_bank(PARTITION_LABEL, 0, 0) != ESP_OK
+        || counter.value() != expected
+        || reloaded.value() != expected) {
+        std::printf("%s: po dalsim pocitani %llu / %llu, ocekavano %llu\n", label,
+                    (unsigned long long)counter.value(),
+                    (unsigned long long)reloaded.value(),
+                    (unsigned long long)expected);
+        return false;
+    }
+
+    if (invalid_writes() != 0) {
+        std::printf("%s: %llu zapisu 1 z 0\n", label, (unsigned long long)invalid_writes());
+        return false;
+    }
+
+    if (options.verbose) {
+        std::printf("%s: ok hodnota=%llu <%llu, %llu>\n", label,
+                    (unsigned long long)value, (unsigned long long)low, (unsigned long long)high);
+    }
+    return true;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr, "Pouziti: %s [--sectors=2] [--erase-size=256] [--verbose]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    fault_options_t options = {2, 256, false};
+    for (int index = 1; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strncmp(arg, "--sectors=", 10) == 0) {
+            options.sectors = (uint32_t)std::atoi(arg + 10);
+        } else if (std::strncmp(arg, "--erase-size=", 13) == 0) {
+            options.erase_size = (uint32_t)std::atoi(arg + 13);
+        } else if (std::strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.sectors < 2 || options.sectors % 2 != 0 || options.erase_size < 64) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    host_log_enabled = options.verbose;
+    const uint32_t bank_bits = (options.sectors / 2 * options.erase_size - 32) * 8;
+    const uint64_t total_steps = 3ULL * bank_bits;
+
+    host_flash_reset();
+    host_flash_add_partition(PARTITION_LABEL, options.sectors * options.erase_size, options.erase_size);
+    const run_result_t reference = run_scenario(options, total_steps);
+    if (!reference.init_ok || reference.confirmed < total_steps) {
+        std::printf("Scenar bez vypadku selhal\n");
+        return 1;
+    }
+    std::printf("sektoru=%u erase_size=%u bitu v bance=%u prirustku=%llu operaci=%llu\n",
+                options.sectors,
+                options.erase_size,
+                bank_bits,
+                (unsigned long long)reference.confirmed,
+                (unsigned long long)reference.ops);
+
+    static const char *MODE_NAMES[] = {"bez ucinku", "polovina", "cela"};
+    unsigned failures = 0;
+    unsigned checked = 0;
+    for (uint64_t cut = 0; cut < reference.ops; ++cut) {
+        for (int mode = HOST_FLASH_CUT_NONE; mode <= HOST_FLASH_CUT_FULL; ++mode) {
+            host_flash_reset();
+            host_flash_add_partition(PARTITION_LABEL, options.sectors * options.erase_size, options.erase_size);
+            host_flash_cut_power_at(cut, static_cast<host_flash_cut_t>(mode));
+            const run_result_t run = run_scenario(options, total_steps);
+            host_flash_power_on();
+
+            char label[64];
+            std::snprintf(label, sizeof(label), "vypadek %llu (%s)", (unsigned long long)cut, MODE_NAMES[mode]);
+            if (!check_recovery(options, run, bank_bits, label)) {
+                ++failures;
+            }
+            ++checked;
+        }
+    }
+
+    std::printf("vypadku=%u chyb=%u\n%s\n", checked, failures, failures == 0 ? "OK" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+// Kontrola shody float a Q16.16 cesty (SENSOR_MATH_FIXED_POINT) nad zaznamem z cmd/trace dump.
+// Kazdy analogovy kanal projde TrimmedMean<31, 5> a pak soucasne SensorChainFloat
+// i SensorChainQ16 (main/sensor_chain.hpp). Po kazdem stupni se odchylka porovna s mezemi
+// z README (Celociselna cesta vypoctu) a main/fixed_point.hpp:
+// - kalibrace: <= 1 LSB,
+// - EMA: <= 0.5/alpha LSB plus 1 LSB chyby kalibrace na vstupu; pri zmene vstupu navic
+//   zpozdeni z kvantovani alpha (<= 0.5 LSB * |vstup - EMA| / alpha),
+// - hystereze: v mezich EMA; pokud jedna cesta tesne u prahu prepne a druha drzi,
+//   lisi se nejvyse o sirku hystereze, dokud vstup pasmo neopusti,
+// - publikovana hodnota: odchylka pred zaokrouhlenim plus nejvyse 1 posledni cislice.
+// K mezim se pricita zaokrouhleni samotne float cesty (FLT_EPSILON * |hodnota|, u EMA / alpha).
+// Pri prekroceni vypise prvni porusujici vzorky a skonci s kodem 1.
+// Nakonec zmeri cas retezce na vzorek pro obe cesty (bez TrimmedMean, na hostu; pomer
+// float/Q16 na ESP32 se muze lisit, cisla slouzi k porovnani zmen kodu).
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -I main tools/fixed_point_equiv.cpp -o fixed_point_equiv
+//
+// Pouziti:
+//   ./fixed_point_equiv trace.bin [--repeat=N] [klic=hodnota ...]
+// Klice jsou stejne jako u tools/trace_replay.cpp (tlk_*, lvl_*, tank_area_m2).
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
+#include "trace_common.hpp"
+
+namespace {
+
+static constexpr double LSB = 1.0 / (double)q16::ONE;
+static constexpr double CALIBRATION_BOUND_LSB = 1.0;
+static constexpr size_t MAX_REPORTED_VIOLATIONS = 5;
+
+struct equiv_stats_t {
+    size_t samples;
+    double calibration_max_lsb;
+    double ema_max_lsb;
+    double ema_bound_lsb;
+    size_t hold_events;
+    size_t hold_max_samples;
+    size_t last_digit_diffs;
+    size_t violations;
+    double float_ns;
+    double q16_ns;
+};
+
+static double float_slack_lsb(float value)
+{
+    return (double)FLT_EPSILON * std::fabs((double)value) / LSB;
+}
+
+static double diff_lsb(float a, float b)
+{
+    return std::fabs((double)a - (double)b) / LSB;
+}
+
+static void report_violation(equiv_stats_t *stats, const char *name, const char *stage, size_t index,
+                             uint32_t raw, float float_value, float q16_value)
+{
+    stats->violations += 1;
+    if (stats->violations <= MAX_REPORTED_VIOLATIONS) {
+        std::printf("  CHYBA %s vzorek=%zu raw=%u %s: float=%.6f q16=%.6f (%.1f LSB)\n",
+                    name, index, (unsigned)raw, stage, (double)float_value, (double)q16_value,
+                    diff_lsb(float_value, q16_value));
+    }
+}
+
+template<typename Chain>
+static double time_chain(const sensor_chain_config_t &params, const std::vector<uint32_t> &raw, unsigned repeat)
+{
+    volatile float sink = 0.0f;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned pass = 0; pass < repeat; ++pass) {
+        Chain chain;
+        chain.configure(params);
+        sensor_chain_sample_t sample = {};
+        for (const uint32_t value : raw) {
+            chain.process(value, &sample);
+            sink = sample.output_rounded;
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+    const double samples = (double)raw.size() * (double)repeat;
+    return samples > 0.0 ? (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / samples : 0.0;
+}
+
+static equiv_stats_t compare_channel(const char *name,
+                                     const std::vector<sample_t> &samples,
+                                     const sensor_chain_config_t &params,
+                                     unsigned repeat)
+{
+    equiv_stats_t stats = {};
+    TrimmedMean<31, 5> filter;
+    std::vector<uint32_t> raw;
+    raw.reserve(samples.size());
+    for (const sample_t &sample : samples) {
+        filter.insert(sample.adc_ok ? sample.raw : 0);
+        raw.push_back(filter.getValue());
+    }
+
+    SensorChainFloat float_chain;
+    SensorChainQ16 q16_chain;
+    float_chain.configure(params);
+    q16_chain.configure(params);
+    std::vector<sensor_chain_sample_t> f(raw.size());
+    std::vector<sensor_chain_sample_t> q(raw.size());
+    for (size_t index = 0; index < raw.size(); ++index) {
+        float_chain.process(raw[index], &f[index]);
+        q16_chain.process(raw[index], &q[index]);
+    }
+
+    stats.samples = raw.size();
+    const double hysteresis_lsb = (double)params.hysteresis / LSB;
+    size_t hold_samples = 0;
+    const double alpha_error = std::fabs(q16::to_float(q16::from_float(params.ema_alpha)) - (double)params.ema_alpha);
+    double alpha_lag_lsb = 0.0;
+    stats.ema_bound_lsb = 0.5 / (double)params.ema_alpha + CALIBRATION_BOUND_LSB;
+    const float digit = 1.0f / (float)q16::pow10_for_decimals(params.round_decimals);
+
+    for (size_t index = 0; index < raw.size(); ++index) {
+        const sensor_chain_sample_t &fs = f[index];
+        const sensor_chain_sample_t &qs = q[index];
+
+        const double calibration_lsb = diff_lsb(fs.value_raw, qs.value_raw);
+        stats.calibration_max_lsb = std::max(stats.calibration_max_lsb, calibration_lsb);
+        if (calibration_lsb > CALIBRATION_BOUND_LSB + float_slack_lsb(fs.value_raw)) {
+            report_violation(&stats, name, "kalibrace", index, raw[index], fs.value_raw, qs.value_raw);
+        }
+
+        // Kvantovana alpha: behem zmeny vstupu se EMA lisi o alpha_error * |vstup - EMA|, s utlumem (1 - alpha).
+        const float previous_ema = index > 0 ? f[index - 1].value_ema : fs.value_raw;
+        alpha_lag_lsb = (1.0 - (double)params.ema_alpha) * alpha_lag_lsb
+                      + alpha_error * std::fabs((double)fs.value_raw - (double)previous_ema) / LSB;
+        const double ema_lsb = diff_lsb(fs.value_ema, qs.value_ema);
+        const double ema_limit = stats.ema_bound_lsb + alpha_lag_lsb
+                               + float_slack_lsb(fs.value_ema) / (double)params.ema_alpha;
+        stats.ema_max_lsb = std::max(stats.ema_max_lsb, ema_lsb);
+        if (ema_lsb > ema_limit) {
+            report_violation(&stats, name, "EMA", index, raw[index], fs.value_ema, qs.value_ema);
+        }
+
+        // Prepnuti nebo smer hystereze rozhodnuty do meze EMA od prahu (i od nuly): jedna cesta
+        // prevezme EMA, druha drzi. Dokud vstup pasmo neopusti, lisi se nejvyse o sirku hystereze.
+        const double hyst_lsb = diff_lsb(fs.value_hyst, qs.value_hyst);
+        if (hyst_lsb > ema_limit) {
+            if (hyst_lsb > hysteresis_lsb + ema_limit) {
+                report_violation(&stats, name, "hystereze", index, raw[index], fs.value_hyst, qs.value_hyst);
+            }
+            if (hold_samples == 0) {
+                stats.hold_events += 1;
+            }
+            hold_samples += 1;
+            stats.hold_max_samples = std::max(stats.hold_max_samples, hold_samples);
+        } else {
+            hold_samples = 0;
+        }
+
+        // Vystup = hystereze * meritko: +0.5 LSB za q16::mul a 0.5 LSB kvantovani meritka na jednotku
+        // hodnoty. Zaokrouhleni pak prida nejvyse 1 posledni cislici.
+        const double output_lsb = diff_lsb(fs.output, qs.output);
+        const double output_limit = std::max(hyst_lsb, ema_limit) * (double)params.output_scale
+                                  + 0.5 + 0.5 * std::fabs((double)fs.value_hyst)
+                                  + float_slack_lsb(fs.output) / (double)params.ema_alpha;
+        if (output_lsb > output_limit) {
+            report_violation(&stats, name, "vystup", index, raw[index], fs.output, qs.output);
+        }
+        const double rounded_diff = std::fabs((double)fs.output_rounded - (double)qs.output_rounded);
+        if (rounded_diff > output_lsb * LSB + (double)digit * 1.001) {
+            report_violation(&stats, name, "publikace", index, raw[index], fs.output_rounded, qs.output_rounded);
+        } else if (rounded_diff > 0.0) {
+            stats.last_digit_diffs += 1;
+        }
+    }
+
+    stats.float_ns = time_chain<SensorChainFloat>(params, raw, repeat);
+    stats.q16_ns = time_chain<SensorChainQ16>(params, raw, repeat);
+    return stats;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Pouziti: %s trace.bin [--repeat=N] [klic=hodnota ...]\n"
+                 "  --repeat=N  pocet pruchodu pro mereni casu (vychozi 200)\n",
+                 argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    unsigned repeat = 200;
+    param_map_t params;
+    for (int index = 2; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strncmp(arg, "--repeat=", 9) == 0) {
+            repeat = (unsigned)std::max(1, std::atoi(arg + 9));
+        } else if (const char *eq = std::strchr(arg, '=')) {
+            params[std::string(arg, (size_t)(eq - arg))] = std::atof(eq + 1);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    trace_header_t header = {};
+    std::vector<sample_t> channels[CH_COUNT];
+    if (!load_trace(argv[1], &header, channels)) {
+        return 1;
+    }
+
+    struct {
+        trace_channel_t channel;
+        const char *name;
+        sensor_chain_config_t params;
+    } analog[] = {
+        {CH_TLAK_PRED, "tlak_pred", pressure_params(params, "b")},
+        {CH_TLAK_ZA, "tlak_za", pressure_params(params, "a")},
+        {CH_ZASOBA, "objem", level_params(params)},
+    };
+
+    size_t violations = 0;
+    size_t compared = 0;
+    for (const auto &entry : analog) {
+        const std::vector<sample_t> &samples = channels[entry.channel];
+        if (samples.empty()) {
+            continue;
+        }
+        const equiv_stats_t stats = compare_channel(entry.name, samples, entry.params, repeat);
+        std::printf("%-10s vzorku=%-7zu kalibrace max=%.2f/%.0f LSB  EMA max=%.2f LSB (mez %.1f + alpha)  "
+                    "drzeni hystereze=%zu (max %zu vz.)  posledni cislice=%zu  float=%.1f ns  q16=%.1f ns  %s\n",
+                    entry.name,
+                    stats.samples,
+                    stats.calibration_max_lsb,
+                    CALIBRATION_BOUND_LSB,
+                    stats.ema_max_lsb,
+                    stats.ema_bound_lsb,
+                    stats.hold_events,
+                    stats.hold_max_samples,
+                    stats.last_digit_diffs,
+                    stats.float_ns,
+                    stats.q16_ns,
+                    stats.violations == 0 ? "OK" : "CHYBA");
+        violations += stats.violations;
+        compared += 1;
+    }
+
+    if (compared == 0) {
+        std::fprintf(stderr, "Trace neobsahuje analogove kanaly\n");
+        return 1;
+    }
+    if (violations > 0) {
+        std::printf("Prekrocene meze: %zu vzorku\n", violations);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,424 @@
+// Deterministicky simulator prutokomeru ve virtualnim case. Prehraje FLOW_SIMULATOR_PROFILE
+// (main/flow_simulator_profile.hpp) jako vlak impulsu s jitterem, zakmity a vypadky a posila ho
+// pres stejny odhad prutoku (flow_rate_estimator.hpp) a totalizer (flow_totalizer.hpp) jako
+// pocitani_pulsu() a flow_persist_task() v prutokomer.cpp. Kontroluje presnost, zpozdeni nuly
+// a davkovane zapisy citace; pri poruseni limitu vraci 1, takze jde pustit jako kontrolu pred
+// nahranim firmware.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -I main tools/flow_sim.cpp -o flow_sim
+//
+// Pouziti:
+//   ./flow_sim [--runs=N] [--seed=S] [--jitter=0.03] [--bounce=0.0] [--dropout=0.0]
+//              [--decimation=1] [--ppl=38] [--csv]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "flow_rate_estimator.hpp"
+#include "flow_simulator_profile.hpp"
+#include "flow_totalizer.hpp"
+
+namespace {
+
+// Shodne s prutokomer.cpp.
+static const int64_t SAMPLE_PERIOD_US = 200000;
+static const size_t RING_SIZE = 128;
+static const FlowRateEstimator::Config ESTIMATOR_CONFIG = {16, 4000000, 1000000, 3000000, 4.0f, 0.05f};
+
+// Po profilu se jeste simuluje klid, aby se zmerilo i posledni zastaveni a dopsani zbytku.
+static const int64_t TAIL_US = 8000000;
+// Presnost se meri jen v ustalenych krocich (start == end) az okno odhadu neobsahuje prechod.
+static const int64_t HOLD_SETTLE_US = (int64_t)ESTIMATOR_CONFIG.max_window_us + SAMPLE_PERIOD_US;
+
+// Limity pro cisty signal (jitter do ~5 %, bez zakmitu a vypadku).
+static const double LIMIT_HOLD_REL_ERROR_MEAN = 0.02;
+static const double LIMIT_HOLD_REL_ERROR_MAX = 0.08;
+// Nula nejpozdeji po zero_max_us bez impulsu, zaokrouhleno na periodu vzorkovani.
+static const double LIMIT_STOP_LATENCY_S = (double)(ESTIMATOR_CONFIG.zero_max_us + SAMPLE_PERIOD_US) / 1e6 + 1e-6;
+static const double LIMIT_START_LATENCY_S = 1.5;
+
+// Davkovani zapisu citace jako FLOW_COUNTER_STEPS_PER_LITER, FLOW_PERSIST_BATCH_LITERS,
+// FLOW_PERSIST_PERIOD_US a FLOW_PERSIST_IDLE_US.
+static const uint32_t STEPS_PER_LITER = 10;
+static const uint32_t PERSIST_BATCH_LITERS = 10;
+static const int64_t PERSIST_PERIOD_US = 60LL * 1000LL * 1000LL;
+static const int64_t PERSIST_IDLE_US = 5LL * 1000LL * 1000LL;
+
+struct sim_options_t {
+    unsigned runs;
+    unsigned seed;
+    double jitter;
+    double bounce;
+    double dropout;
+    uint32_t decimation;
+    uint32_t pulses_per_liter;
+    bool csv;
+};
+
+// Citac ve RAM misto FlashMonotonicCounter; pocita volani increment() = zapisy do flash.
+struct counting_counter_t {
+    uint64_t value;
+    uint64_t writes;
+
+    int increment(uint32_t steps)
+    {
+        value += steps;
+        writes += 1;
+        return 0;
+    }
+};
+
+struct run_stats_t {
+    double true_liters;
+    double counted_liters;
+    uint64_t generated_pulses;
+    uint64_t counted_pulses;
+    double hold_rel_error_sum;
+    double hold_rel_error_max;
+    size_t hold_samples;
+    double stop_latency_max_s;
+    double start_latency_max_s;
+    size_t stops;
+    bool totalizer_ok;
+    double unpersisted_max_liters;
+    double idle_unpersisted_max_pulses;
+    uint64_t flash_writes;
+};
+
+struct pulse_t {
+    int64_t t_us;
+};
+
+// Nastaveny prutok v case t podle profilu; za koncem profilu 0.
+static double setpoint_at(int64_t t_us)
+{
+    int64_t step_start_us = 0;
+    for (size_t index = 0; index < FLOW_SIMULATOR_PROFILE_STEPS; ++index) {
+        const flow_simulator_profile_step_t &step = FLOW_SIMULATOR_PROFILE[index];
+        const uint32_t updates = flow_simulator_step_updates(step);
+        const int64_t step_us = (int64_t)updates * FLOW_SIMULATOR_PROFILE_UPDATE_MS * 1000;
+        if (t_us < step_start_us + step_us) {
+            const uint32_t update_index = (uint32_t)((t_us - step_start_us) / (FLOW_SIMULATOR_PROFILE_UPDATE_MS * 1000));
+            return (double)flow_simulator_step_setpoint(step, update_index);
+        }
+        step_start_us += step_us;
+    }
+    return 0.0;
+}
+
+static const flow_simulator_profile_step_t *step_at(int64_t t_us, int64_t *elapsed_us)
+{
+    int64_t step_start_us = 0;
+    for (size_t index = 0; index < FLOW_SIMULATOR_PROFILE_STEPS; ++index) {
+        const flow_simulator_profile_step_t &step = FLOW_SIMULATOR_PROFILE[index];
+        const int64_t step_us = (int64_t)flow_simulator_step_updates(step) * FLOW_SIMULATOR_PROFILE_UPDATE_MS * 1000;
+        if (t_us < step_start_us + step_us) {
+            *elapsed_us = t_us - step_start_us;
+            return &step;
+        }
+        step_start_us += step_us;
+    }
+    return nullptr;
+}
+
+static int64_t profile_duration_us(void)
+{
+    int64_t total_us = 0;
+    for (size_t index = 0; index < FLOW_SIMULATOR_PROFILE_STEPS; ++index) {
+        total_us += (int64_t)flow_simulator_step_updates(FLOW_SIMULATOR_PROFILE[index]) * FLOW_SIMULATOR_PROFILE_UPDATE_MS * 1000;
+    }
+    return total_us;
+}
+
+// Vlak impulsu s fazovym akumulatorem (prutok se meni jen na hranicich updatu profilu).
+// Skutecny objem se pocita ze vsech impulsu, cidlo muze impuls ztratit (dropout)
+// nebo pridat zakmit 20-300 us za hranou (bounce).
+static std::vector<pulse_t> generate_pulses(const sim_options_t &options, std::mt19937 &rng, int64_t end_us,
+                                            uint64_t *generated_pulses)
+{
+    std::normal_distribution<double> jitter(0.0, options.jitter);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> bounce_delay(20.0, 300.0);
+
+    std::vector<pulse_t> pulses;
+    const int64_t update_us = (int64_t)FLOW_SIMULATOR_PROFILE_UPDATE_MS * 1000;
+    double phase = unit(rng);
+    *generated_pulses = 0;
+    for (int64_t t0 = 0; t0 < end_us; t0 += update_us) {
+        const double pulses_per_us = setpoint_at(t0) * (double)options.pulses_per_liter / 60e6;
+        if (pulses_per_us <= 0.0) {
+            continue;
+        }
+
+        double t = (double)t0;
+        while (true) {
+            const double interval_us = (1.0 - phase) / pulses_per_us;
+            if (t + interval_us >= (double)(t0 + update_us)) {
+                phase += ((double)(t0 + update_us) - t) * pulses_per_us;
+                break;
+            }
+            t += interval_us;
+            // Jitter posune jen hranu, ne fazi, takze se nescita do objemu.
+            const double edge_us = t + jitter(rng) / pulses_per_us;
+            phase = 0.0;
+            *generated_pulses += 1;
+
+            if (unit(rng) < options.dropout) {
+                continue;
+            }
+            pulses.push_back({(int64_t)std::llround(std::max(edge_us, 0.0))});
+            if (unit(rng) < options.bounce) {
+                pulses.push_back({pulses.back().t_us + (int64_t)bounce_delay(rng)});
+            }
+        }
+    }
+
+    std::sort(pulses.begin(), pulses.end(), [](const pulse_t &a, const pulse_t &b) {
+        return a.t_us < b.t_us;
+    });
+    return pulses;
+}
+
+static run_stats_t simulate(const sim_options_t &options, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    const int64_t end_us = profile_duration_us() + TAIL_US;
+    run_stats_t stats = {};
+
+    const std::vector<pulse_t> pulses = generate_pulses(options, rng, end_us, &stats.generated_pulses);
+    stats.true_liters = (double)stats.generated_pulses / (double)options.pulses_per_liter;
+
+    const FlowRateEstimator estimator(ESTIMATOR_CONFIG);
+    counting_counter_t counter = {0, 0};
+    FlowTotalizer totalizer(STEPS_PER_LITER, PERSIST_BATCH_LITERS * STEPS_PER_LITER, PERSIST_PERIOD_US, PERSIST_IDLE_US);
+    totalizer.start(0, options.pulses_per_liter, 0);
+
+    std::vector<uint32_t> ring;
+    ring.reserve(RING_SIZE);
+    size_t next_pulse = 0;
+    uint64_t pulse_total = 0;
+    uint64_t counted_total = 0;
+    int64_t last_total_change_us = 0;
+    uint64_t last_total = 0;
+
+    int64_t stop_since_us = -1;
+    bool waiting_for_start = false;
+    uint64_t start_pulse_total = 0;
+    double previous_setpoint = 0.0;
+
+    for (int64_t now_us = SAMPLE_PERIOD_US; now_us <= end_us; now_us += SAMPLE_PERIOD_US) {
+        while (next_pulse < pulses.size() && pulses[next_pulse].t_us <= now_us) {
+            pulse_total += 1;
+            if (pulse_total % options.decimation == 0) {
+                if (ring.size() == RING_SIZE) {
+                    ring.erase(ring.begin());
+                }
+                ring.push_back((uint32_t)pulses[next_pulse].t_us);
+            }
+            ++next_pulse;
+        }
+
+        // Stejny zero timeout podle celkoveho poctu jako vypocitej_surovy_prutok().
+        if (pulse_total != last_total) {
+            last_total = pulse_total;
+            last_total_change_us = now_us;
+        }
+        double l_min = 0.0;
+        if (!ring.empty() && (now_us - last_total_change_us) <= (int64_t)ESTIMATOR_CONFIG.zero_max_us) {
+            const FlowRateEstimator::Estimate estimate =
+                estimator.estimate(ring.data(), (uint32_t)ring.size(), options.decimation, (uint32_t)now_us);
+            l_min = (double)estimate.pulses_per_s * 60.0 / (double)options.pulses_per_liter;
+        }
+
+        const uint32_t sampled = (uint32_t)(pulse_total - counted_total);
+        counted_total = pulse_total;
+        totalizer.addPulses(sampled, now_us);
+        // Persistencni task: jeden increment(n) na splatnou davku.
+        if (totalizer.batchDue(now_us)) {
+            const uint32_t steps = totalizer.pendingSteps();
+            if (counter.increment(steps) == 0) {
+                totalizer.commitSteps(steps, now_us);
+            }
+        }
+        const double unpersisted_pulses = (double)totalizer.unpersistedTicks() / (double)STEPS_PER_LITER;
+        stats.unpersisted_max_liters = std::max(stats.unpersisted_max_liters,
+                                                unpersisted_pulses / (double)options.pulses_per_liter);
+        // Po dotekle davce zbyva v RAM (a po vypadku napajeni se ztrati) mene nez jeden krok.
+        if (now_us - last_total_change_us > PERSIST_IDLE_US) {
+            stats.idle_unpersisted_max_pulses = std::max(stats.idle_unpersisted_max_pulses, unpersisted_pulses);
+        }
+
+        // Setpoint posledniho uplynuleho updatu, tj. prutok ktery cidlo prave generuje.
+        const double setpoint = setpoint_at(now_us - 1);
+        if (setpoint <= 0.0 && previous_setpoint > 0.0) {
+            stop_since_us = now_us;
+        }
+        if (setpoint > 0.0 && previous_setpoint <= 0.0) {
+            waiting_for_start = true;
+            start_pulse_total = pulse_total;
+        }
+        previous_setpoint = setpoint;
+
+        if (stop_since_us >= 0 && l_min == 0.0) {
+            stats.stop_latency_max_s = std::max(stats.stop_latency_max_s, (double)(now_us - stop_since_us) / 1e6);
+            stats.stops += 1;
+            stop_since_us = -1;
+        }
+        // Rozjezd se meri od impulsu, se kterym ma odhad poprve dva casy (drive nemuze
+        // nic spocitat); doba cekani na impulsy pri pomalem nabehu se nepocita.
+        const uint64_t first_estimate_pulse = start_pulse_total + 2U * options.decimation;
+        if (waiting_for_start && l_min > 0.0 && pulse_total >= first_estimate_pulse) {
+            const int64_t pulse_us = pulses[first_estimate_pulse - 1U].t_us;
+            stats.start_latency_max_s = std::max(stats.start_latency_max_s, (double)(now_us - pulse_us) / 1e6);
+            waiting_for_start = false;
+        }
+
+        int64_t elapsed_us = 0;
+        const flow_simulator_profile_step_t *step = step_at(now_us - 1, &elapsed_us);
+        if (step != nullptr && step->start_l_min == step->end_l_min && step->end_l_min > 0.0f
+            && elapsed_us >= HOLD_SETTLE_US) {
+            const double rel_error = std::fabs(l_min - setpoint) / setpoint;
+            stats.hold_rel_error_sum += rel_error;
+            stats.hold_rel_error_max = std::max(stats.hold_rel_error_max, rel_error);
+            stats.hold_samples += 1;
+        }
+
+        if (options.csv) {
+            std::printf("%u,%lld,%.3f,%.3f,%.3f\n",
+                        seed,
+                        (long long)now_us,
+                        setpoint,
+                        l_min,
+                        (double)totalizer.totalLiters());
+        }
+    }
+
+    stats.counted_pulses = pulse_total;
+    stats.counted_liters = (double)totalizer.totalLiters();
+    stats.flash_writes = counter.writes;
+    // Citac + RAM presne odpovida impulsum, v RAM nikdy neni vic nez davka a zbytek kroku
+    // a v klidu zbyva mene nez jeden krok.
+    const uint64_t batch_ticks = (uint64_t)(PERSIST_BATCH_LITERS * STEPS_PER_LITER + 1U) * options.pulses_per_liter;
+    stats.totalizer_ok = counter.value * options.pulses_per_liter + totalizer.unpersistedTicks() == pulse_total * STEPS_PER_LITER
+                      && totalizer.persistedSteps() == counter.value
+                      && totalizer.unpersistedTicks() < batch_ticks
+                      && stats.idle_unpersisted_max_pulses < (double)options.pulses_per_liter / (double)STEPS_PER_LITER;
+    return stats;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Pouziti: %s [--runs=N] [--seed=S] [--jitter=0.03] [--bounce=0.0] [--dropout=0.0]\n"
+                 "         [--decimation=1] [--ppl=38] [--csv]\n",
+                 argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    sim_options_t options = {100, 1, 0.03, 0.0, 0.0, 1, 38, false};
+    for (int index = 1; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strncmp(arg, "--runs=", 7) == 0) {
+            options.runs = (unsigned)std::max(1, std::atoi(arg + 7));
+        } else if (std::strncmp(arg, "--seed=", 7) == 0) {
+            options.seed = (unsigned)std::atoi(arg + 7);
+        } else if (std::strncmp(arg, "--jitter=", 9) == 0) {
+            options.jitter = std::atof(arg + 9);
+        } else if (std::strncmp(arg, "--bounce=", 9) == 0) {
+            options.bounce = std::atof(arg + 9);
+        } else if (std::strncmp(arg, "--dropout=", 10) == 0) {
+            options.dropout = std::atof(arg + 10);
+        } else if (std::strncmp(arg, "--decimation=", 13) == 0) {
+            options.decimation = (uint32_t)std::max(1, std::atoi(arg + 13));
+        } else if (std::strncmp(arg, "--ppl=", 6) == 0) {
+            options.pulses_per_liter = (uint32_t)std::max(1, std::atoi(arg + 6));
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            options.csv = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    double hold_error_sum = 0.0;
+    size_t hold_samples = 0;
+    double hold_error_max = 0.0;
+    double stop_latency_max = 0.0;
+    double start_latency_max = 0.0;
+    double volume_error_max = 0.0;
+    uint64_t flash_writes = 0;
+    double unpersisted_max = 0.0;
+    double idle_unpersisted_max = 0.0;
+    double true_liters = 0.0;
+    unsigned totalizer_failures = 0;
+    unsigned missing_stops = 0;
+
+    if (options.csv) {
+        std::printf("seed,t_us,setpoint_l_min,odhad_l_min,celkem_l\n");
+    }
+    for (unsigned run = 0; run < options.runs; ++run) {
+        const run_stats_t stats = simulate(options, options.seed + run);
+        hold_error_sum += stats.hold_rel_error_sum;
+        hold_samples += stats.hold_samples;
+        hold_error_max = std::max(hold_error_max, stats.hold_rel_error_max);
+        stop_latency_max = std::max(stop_latency_max, stats.stop_latency_max_s);
+        start_latency_max = std::max(start_latency_max, stats.start_latency_max_s);
+        volume_error_max = std::max(volume_error_max, std::fabs(stats.counted_liters - stats.true_liters));
+        flash_writes += stats.flash_writes;
+        unpersisted_max = std::max(unpersisted_max, stats.unpersisted_max_liters);
+        idle_unpersisted_max = std::max(idle_unpersisted_max, stats.idle_unpersisted_max_pulses);
+        true_liters += stats.true_liters;
+        totalizer_failures += stats.totalizer_ok ? 0 : 1;
+        missing_stops += stats.stops == 0 ? 1 : 0;
+    }
+    if (options.csv) {
+        return 0;
+    }
+
+    const double hold_error_mean = hold_samples > 0 ? hold_error_sum / (double)hold_samples : 0.0;
+    const double virtual_s = (double)options.runs * (double)(profile_duration_us() + TAIL_US) / 1e6;
+    std::printf("behu=%u virtualne=%.0f s jitter=%.3f bounce=%.3f dropout=%.3f decimace=%u ppl=%u\n",
+                options.runs,
+                virtual_s,
+                options.jitter,
+                options.bounce,
+                options.dropout,
+                (unsigned)options.decimation,
+                (unsigned)options.pulses_per_liter);
+    std::printf("ustaleny prutok: |chyba| prumer=%.2f %% max=%.2f %%\n", hold_error_mean * 100.0, hold_error_max * 100.0);
+    std::printf("zpozdeni: nula max=%.2f s rozjezd max=%.2f s\n", stop_latency_max, start_latency_max);
+    std::printf("totalizer: max |objem - skutecnost|=%.3f l, zapisu citace=%.3f na litr, chyb=%u\n",
+                volume_error_max,
+                true_liters > 0.0 ? (double)flash_writes / true_liters : 0.0,
+                totalizer_failures);
+    std::printf("persistence: krok=1/%u l, davka=%u l / %lld s / klid %lld s, max nezapsano v RAM=%.2f l, v klidu=%.1f impulsu\n",
+                (unsigned)STEPS_PER_LITER,
+                (unsigned)PERSIST_BATCH_LITERS,
+                (long long)(PERSIST_PERIOD_US / 1000000),
+                (long long)(PERSIST_IDLE_US / 1000000),
+                unpersisted_max,
+                idle_unpersisted_max);
+
+    // Limity presnosti plati jen pro cisty signal, zakmity a vypadky je zamerne porusuji.
+    const bool clean = options.bounce == 0.0 && options.dropout == 0.0 && options.jitter <= 0.05;
+    bool ok = totalizer_failures == 0 && missing_stops == 0 && stop_latency_max <= LIMIT_STOP_LATENCY_S;
+    if (clean) {
+        ok = ok
+          && hold_error_mean <= LIMIT_HOLD_REL_ERROR_MEAN
+          && hold_error_max <= LIMIT_HOLD_REL_ERROR_MAX
+          && start_latency_max <= LIMIT_START_LATENCY_S
+          && volume_error_max <= 1.0 / (double)options.pulses_per_liter;
+    }
+    std::printf("%s\n", ok ? "OK" : "SELHALO");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Hostova nahrada app_error_check.h: chybovy kod a esp_err na stderr a abort() (na cili
+// nahlaseni kodu a restart pres ESP_ERROR_CHECK).
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp_err.h"
+
+#define APP_ERROR_CHECK(error_code_literal, expr)                                          \
+    do {                                                                                   \
+        esp_err_t __app_err_rc = (expr);                                                   \
+        if (__app_err_rc != ESP_OK) {                                                      \
+            std::fprintf(stderr, "%s: %s\n", (error_code_literal), esp_err_to_name(__app_err_rc)); \
+            std::abort();                                                                  \
+        }                                                                                  \
+    } while (0)
@@ -0,0 +1,14 @@
+#pragma once
+
+// Hostova nahrada esp_log.h: chyby a varovani na stderr (pokud host_log_enabled), zbytek zahodit.
+
+#include <cstdio>
+
+extern bool host_log_enabled;
+
+#define ESP_LOGE(tag, format, ...) \
+    do { if (host_log_enabled) std::fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, format, ...) \
+    do { if (host_log_enabled) std::fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); } while (0)
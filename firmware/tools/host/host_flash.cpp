@@ -0,0 +1,408 @@
+#include "host_flash.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "nvs.h"
+
+bool host_log_enabled = true;
+
+namespace {
+
+struct host_partition_t {
+    esp_partition_t info;
+    std::vector<uint8_t> data;
+    host_flash_stats_t stats;
+};
+
+std::map<std::string, std::unique_ptr<host_partition_t>> s_partitions;
+std::map<std::string, uint64_t> s_nvs;
+std::map<std::string, std::vector<uint8_t>> s_nvs_blobs;
+std::map<std::string, std::string> s_nvs_strings;
+std::map<nvs_handle_t, std::string> s_nvs_handles;
+nvs_handle_t s_next_nvs_handle = 1;
+host_nvs_stats_t s_nvs_stats = {};
+
+uint64_t s_mutating_ops = 0;
+bool s_cut_armed = false;
+uint64_t s_cut_at = 0;
+host_flash_cut_t s_cut_mode = HOST_FLASH_CUT_NONE;
+bool s_power_lost = false;
+
+// Vraci, kolik z size bajtu ma operace skutecne zpracovat (size = cela).
+size_t begin_mutating_op(size_t size)
+{
+    if (s_power_lost) {
+        return 0;
+    }
+    const uint64_t op = s_mutating_ops++;
+    if (!s_cut_armed || op != s_cut_at) {
+        return size;
+    }
+    s_power_lost = true;
+    s_cut_armed = false;
+    switch (s_cut_mode) {
+    case HOST_FLASH_CUT_HALF: return (size + 1) / 2;
+    case HOST_FLASH_CUT_FULL: return size;
+    default: return 0;
+    }
+}
+
+host_partition_t *find(const esp_partition_t *partition)
+{
+    if (partition == nullptr) {
+        return nullptr;
+    }
+    auto it = s_partitions.find(partition->label);
+    return it == s_partitions.end() || &it->second->info != partition ? nullptr : it->second.get();
+}
+
+bool in_range(const host_partition_t *p, size_t offset, size_t size)
+{
+    return offset <= p->data.size() && size <= p->data.size() - offset;
+}
+
+std::string nvs_key(nvs_handle_t handle, const char *key)
+{
+    auto it = s_nvs_handles.find(handle);
+    return it == s_nvs_handles.end() || key == nullptr ? std::string() : it->second + "/" + key;
+}
+
+template <typename T>
+esp_err_t nvs_get(nvs_handle_t handle, const char *key, T *out_value)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty() || out_value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_nvs_stats.reads += 1;
+    auto it = s_nvs.find(full_key);
+    if (it == s_nvs.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *out_value = (T)it->second;
+    return ESP_OK;
+}
+
+// Jako NVS v ESP-IDF: zapis stejne hodnoty flash nezmeni, jiny zapis je jeden zaznam ve flash
+// (atomicky; pri vypadku napajeni se bud provede cely, nebo vubec).
+template <typename Map, typename Value>
+esp_err_t nvs_store(Map &map, const std::string &full_key, const Value &value)
+{
+    s_nvs_stats.sets += 1;
+    auto it = map.find(full_key);
+    if (it != map.end() && it->second == value) {
+        return ESP_OK;
+    }
+    if (s_power_lost || begin_mutating_op(1) == 0) {
+        return ESP_FAIL;
+    }
+    map[full_key] = value;
+    s_nvs_stats.writes += 1;
+    return s_power_lost ? ESP_FAIL : ESP_OK;
+}
+
+template <typename T>
+esp_err_t nvs_set(nvs_handle_t handle, const char *key, T value)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return nvs_store(s_nvs, full_key, (uint64_t)value);
+}
+
+} // namespace
+
+void host_flash_add_partition(const char *label, uint32_t size, uint32_t erase_size)
+{
+    std::unique_ptr<host_partition_t> partition(new host_partition_t());
+    partition->info.type = ESP_PARTITION_TYPE_DATA;
+    partition->info.subtype = 0x40;
+    partition->info.address = 0;
+    partition->info.size = size;
+    partition->info.erase_size = erase_size;
+    std::strncpy(partition->info.label, label, sizeof(partition->info.label) - 1);
+    partition->data.assign(size, 0xFF);
+    partition->stats.sector_erases.assign(size / erase_size, 0);
+    s_partitions[label] = std::move(partition);
+}
+
+void host_flash_reset()
+{
+    s_partitions.clear();
+    s_nvs.clear();
+    s_nvs_blobs.clear();
+    s_nvs_strings.clear();
+    s_nvs_handles.clear();
+    s_nvs_stats = host_nvs_stats_t();
+    s_mutating_ops = 0;
+    s_cut_armed = false;
+    s_power_lost = false;
+}
+
+void host_flash_cut_power_at(uint64_t ops, host_flash_cut_t mode)
+{
+    s_cut_armed = true;
+    s_cut_at = ops;
+    s_cut_mode = mode;
+}
+
+void host_flash_power_on()
+{
+    s_power_lost = false;
+    s_cut_armed = false;
+}
+
+bool host_flash_power_lost()
+{
+    return s_power_lost;
+}
+
+uint64_t host_flash_mutating_ops()
+{
+    return s_mutating_ops;
+}
+
+host_flash_stats_t host_flash_stats(const char *label)
+{
+    auto it = s_partitions.find(label);
+    return it == s_partitions.end() ? host_flash_stats_t() : it->second->stats;
+}
+
+void host_flash_clear_stats(const char *label)
+{
+    auto it = s_partitions.find(label);
+    if (it != s_partitions.end()) {
+        const size_t sectors = it->second->stats.sector_erases.size();
+        it->second->stats = host_flash_stats_t();
+        it->second->stats.sector_erases.assign(sectors, 0);
+    }
+}
+
+uint64_t host_nvs_commits()
+{
+    return s_nvs_stats.commits;
+}
+
+host_nvs_stats_t host_nvs_stats()
+{
+    return s_nvs_stats;
+}
+
+void host_nvs_clear_stats()
+{
+    s_nvs_stats = host_nvs_stats_t();
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+    default: return "ESP_ERR_?";
+    }
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, int subtype, const char *label)
+{
+    (void)subtype;
+    if (label == nullptr) {
+        return nullptr;
+    }
+    auto it = s_partitions.find(label);
+    return it == s_partitions.end() || it->second->info.type != type ? nullptr : &it->second->info;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    host_partition_t *p = find(partition);
+    if (p == nullptr || dst == nullptr || !in_range(p, src_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::memcpy(dst, p->data.data() + src_offset, size);
+    p->stats.reads += 1;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    host_partition_t *p = find(partition);
+    if (p == nullptr || src == nullptr || !in_range(p, dst_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const bool was_lost = s_power_lost;
+    const size_t done = begin_mutating_op(size);
+    if (was_lost) {
+        return ESP_FAIL;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(src);
+    for (size_t i = 0; i < done; ++i) {
+        uint8_t &cell = p->data[dst_offset + i];
+        if ((bytes[i] & ~cell) != 0) {
+            p->stats.invalid_writes += 1;
+        }
+        cell &= bytes[i];
+    }
+    p->stats.writes += 1;
+    p->stats.bytes_written += done;
+    return s_power_lost ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    host_partition_t *p = find(partition);
+    const uint32_t erase_size = partition != nullptr ? partition->erase_size : 1;
+    if (p == nullptr || !in_range(p, offset, size) || offset % erase_size != 0 || size % erase_size != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const bool was_lost = s_power_lost;
+    const size_t done = begin_mutating_op(size);
+    if (was_lost) {
+        return ESP_FAIL;
+    }
+    std::memset(p->data.data() + offset, 0xFF, done);
+    for (size_t sector = offset / erase_size; sector < (offset + size) / erase_size; ++sector) {
+        p->stats.sector_erases[sector] += 1;
+    }
+    p->stats.erase_ops += 1;
+    return s_power_lost ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name_space, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    if (name_space == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_handle = s_next_nvs_handle++;
+    s_nvs_handles[*out_handle] = name_space;
+    s_nvs_stats.opens += 1;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    s_nvs_handles.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    if (s_nvs_handles.find(handle) == s_nvs_handles.end()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_power_lost) {
+        return ESP_FAIL;
+    }
+    s_nvs_stats.commits += 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_nvs.count(full_key) + s_nvs_blobs.count(full_key) + s_nvs_strings.count(full_key) == 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (s_power_lost || begin_mutating_op(1) == 0) {
+        return ESP_FAIL;
+    }
+    s_nvs.erase(full_key);
+    s_nvs_blobs.erase(full_key);
+    s_nvs_strings.erase(full_key);
+    s_nvs_stats.writes += 1;
+    return s_power_lost ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) { return nvs_get(handle, key, out_value); }
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) { return nvs_set(handle, key, value); }
+esp_err_t nvs_get_i64(nvs_handle_t handle, const char *key, int64_t *out_value) { return nvs_get(handle, key, out_value); }
+esp_err_t nvs_set_i64(nvs_handle_t handle, const char *key, int64_t value) { return nvs_set(handle, key, value); }
+esp_err_t nvs_get_u64(nvs_handle_t handle, const char *key, uint64_t *out_value) { return nvs_get(handle, key, out_value); }
+esp_err_t nvs_set_u64(nvs_handle_t handle, const char *key, uint64_t value) { return nvs_set(handle, key, value); }
+esp_err_t nvs_get_i32(nvs_handle_t handle, const char *key, int32_t *out_value) { return nvs_get(handle, key, out_value); }
+esp_err_t nvs_set_i32(nvs_handle_t handle, const char *key, int32_t value) { return nvs_set(handle, key, value); }
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value) { return nvs_get(handle, key, out_value); }
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) { return nvs_set(handle, key, value); }
+
+// Jako v ESP-IDF: out_value == nullptr vrati jen delku, kratky buffer je chyba.
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty() || length == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_nvs_stats.reads += 1;
+    auto it = s_nvs_blobs.find(full_key);
+    if (it == s_nvs_blobs.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == nullptr) {
+        *length = it->second.size();
+        return ESP_OK;
+    }
+    if (*length < it->second.size()) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    std::memcpy(out_value, it->second.data(), it->second.size());
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty() || (value == nullptr && length > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    return nvs_store(s_nvs_blobs, full_key, std::vector<uint8_t>(bytes, bytes + length));
+}
+
+// Delka vcetne ukoncovaci nuly, jako nvs_get_str v ESP-IDF.
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty() || length == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_nvs_stats.reads += 1;
+    auto it = s_nvs_strings.find(full_key);
+    if (it == s_nvs_strings.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    const size_t required = it->second.size() + 1;
+    if (out_value == nullptr) {
+        *length = required;
+        return ESP_OK;
+    }
+    if (*length < required) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    std::memcpy(out_value, it->second.c_str(), required);
+    *length = required;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    const std::string full_key = nvs_key(handle, key);
+    if (full_key.empty() || value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return nvs_store(s_nvs_strings, full_key, std::string(value));
+}
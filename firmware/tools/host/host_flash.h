@@ -0,0 +1,58 @@
+#pragma once
+
+// Emulace NOR flash a NVS pro hostove nastroje v tools/ (wear model, simulace vypadku).
+//
+// Zapis bity jen nuluje (novy obsah = stary AND zapisovany), mazani jde jen po celych
+// sektorech erase_size a nastavi je na 0xFF. Kazdy oddil pocita cteni, zapisy, zapsane
+// bajty a mazani po sektorech; zapis, ktery by potreboval bit 1 z 0, se pocita jako chyba
+// pouziti (na skutecne flash by se tise ztratil).
+
+#include <cstdint>
+#include <vector>
+
+struct host_flash_stats_t {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t bytes_written;
+    uint64_t erase_ops;
+    uint64_t invalid_writes;           // pokus o 1 z 0
+    std::vector<uint64_t> sector_erases;
+};
+
+// Prida (nebo znovu zalozi smazany) oddil typu data.
+void host_flash_add_partition(const char *label, uint32_t size, uint32_t erase_size = 4096);
+// Smaze vsechny oddily a NVS.
+void host_flash_reset();
+host_flash_stats_t host_flash_stats(const char *label);
+void host_flash_clear_stats(const char *label);
+
+// Volani NVS od host_flash_reset() / host_nvs_clear_stats(). writes jsou jen zmeny (zapis
+// stejne hodnoty NVS ve flash preskoci), sets vsechna volani nvs_set_*.
+struct host_nvs_stats_t {
+    uint64_t opens;
+    uint64_t reads;
+    uint64_t sets;
+    uint64_t writes;
+    uint64_t commits;
+};
+
+uint64_t host_nvs_commits();
+host_nvs_stats_t host_nvs_stats();
+void host_nvs_clear_stats();
+
+// Simulace vypadku napajeni. Zapisy a mazani (vsech oddilu) a zmeny NVS se cisluji od
+// host_flash_reset(); zmena NVS je atomicka (HALF se chova jako FULL).
+// Operace s poradim ops (od 0) se provede jen zcasti podle mode a vrati ESP_FAIL a vsechny
+// dalsi zapisy a mazani selzou bez ucinku, dokud se nezavola host_flash_power_on().
+enum host_flash_cut_t {
+    HOST_FLASH_CUT_NONE,        // operace nema zadny ucinek
+    HOST_FLASH_CUT_HALF,        // zapise se prvni polovina bajtu / smaze prvni polovina rozsahu
+    HOST_FLASH_CUT_FULL,        // operace probehne cela, napajeni zmizi hned po ni
+};
+void host_flash_cut_power_at(uint64_t ops, host_flash_cut_t mode);
+void host_flash_power_on();
+bool host_flash_power_lost();
+uint64_t host_flash_mutating_ops();
+
+// Vypis ESP_LOGE/ESP_LOGW z emulovaneho kodu (vychozi zapnuto).
+extern bool host_log_enabled;
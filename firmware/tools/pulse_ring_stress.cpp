@@ -0,0 +1,174 @@
+// Zatezovy test PulseTimestampRing (main/pulse_ring.hpp) na hostu. Producent (vlakno misto ISR)
+// vola push() s casy v pevnem kroku, ktere projdou pretecenim 2^32. Konzument soucasne vola
+// snapshot() s ruznym max_count. U kazdeho snapshotu kontroluje:
+// - rozdil sousednich casu je presne krok (monotonni, bez mezer a bez prepsanych slotu),
+// - posledni cas odpovida vracene sekvenci,
+// - pocet nepresahuje max_count ani kapacitu - 1 (slot pro prave probihajici zapis se
+//   nevraci nikdy) a sekvence mezi snapshoty neklesa.
+// Bezi pro kapacitu firmware (FLOW_PULSE_SOURCE_MAX_TIMESTAMPS) i pro malou kapacitu, kde
+// producent behem kopirovani prepisuje nejcasteji. Pri chybe vypise prvni nalezy a vrati 1.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -pthread -I main tools/pulse_ring_stress.cpp -o pulse_ring_stress
+// Kontrola datovych zavodu (TSan nemodeluje atomic_thread_fence, varovani -Wtsan proto vypiname):
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -Wno-tsan -pthread -I main tools/pulse_ring_stress.cpp -o pulse_ring_stress
+//
+// Pouziti:
+//   ./pulse_ring_stress [--pulses=N] [--seed=S]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "pulse_ring.hpp"
+#include "flow_pulse_source.h"
+
+namespace {
+
+static constexpr uint32_t TIMESTAMP_STEP_US = 7;
+// Prvni cas kousek pod 2^32, aby test prosel i pretecenim dolnich 32 bitu esp_timer_get_time().
+static constexpr uint32_t FIRST_TIMESTAMP_US = 0xFFFFFFFFu - 1000u * TIMESTAMP_STEP_US;
+static constexpr uint64_t MAX_REPORTED_ERRORS = 5;
+
+template<uint32_t Capacity>
+static uint32_t max_returned(uint32_t sequence, uint32_t max_count)
+{
+    uint32_t limit = sequence < Capacity - 1U ? sequence : Capacity - 1U;
+    return limit < max_count ? limit : max_count;
+}
+
+struct stress_stats_t {
+    uint64_t snapshots;
+    uint64_t timestamps;
+    uint64_t short_snapshots;
+    uint64_t errors;
+};
+
+static uint32_t timestamp_for(uint32_t sequence)
+{
+    return FIRST_TIMESTAMP_US + sequence * TIMESTAMP_STEP_US;
+}
+
+static void report(stress_stats_t *stats, const char *what, uint32_t sequence, uint32_t count, uint32_t index,
+                   uint32_t value)
+{
+    stats->errors += 1;
+    if (stats->errors <= MAX_REPORTED_ERRORS) {
+        std::printf("  CHYBA %s: seq=%u n=%u index=%u hodnota=%u\n", what, (unsigned)sequence, (unsigned)count,
+                    (unsigned)index, (unsigned)value);
+    }
+}
+
+template<uint32_t Capacity>
+static stress_stats_t run_stress(uint32_t pulses, uint32_t seed)
+{
+    PulseTimestampRing<Capacity> ring;
+
+    stress_stats_t stats = {};
+    std::atomic<bool> done(false);
+
+    // Producent: strida plnou rychlost a kratke pauzy (davky impulsu jako pri rozbehu cerpadla).
+    std::thread producer([&]() {
+        std::minstd_rand rng(seed);
+        for (uint32_t sequence = 0; sequence < pulses; ++sequence) {
+            ring.push(timestamp_for(sequence));
+            if ((rng() & 0x3FFu) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::minstd_rand rng(seed ^ 0x5bd1e995u);
+    uint32_t out[Capacity];
+    uint32_t last_sequence = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        const uint32_t max_count = 1u + (uint32_t)(rng() % Capacity);
+        uint32_t sequence = 0;
+        const uint32_t count = ring.snapshot(out, max_count, &sequence);
+
+        stats.snapshots += 1;
+        stats.timestamps += count;
+        if (count > max_returned<Capacity>(sequence, max_count)) {
+            report(&stats, "pocet nad limit", sequence, count, 0, max_count);
+            continue;
+        }
+        if (sequence < last_sequence) {
+            report(&stats, "sekvence klesla", sequence, count, 0, last_sequence);
+        }
+        last_sequence = sequence;
+
+        if (count < max_returned<Capacity>(sequence, max_count)) {
+            stats.short_snapshots += 1;
+        }
+        if (count == 0) {
+            continue;
+        }
+        if (out[count - 1] != timestamp_for(sequence - 1u)) {
+            report(&stats, "posledni cas neodpovida sekvenci", sequence, count, count - 1, out[count - 1]);
+            continue;
+        }
+        for (uint32_t index = 1; index < count; ++index) {
+            if ((uint32_t)(out[index] - out[index - 1]) != TIMESTAMP_STEP_US) {
+                report(&stats, "casy nejsou souvisle", sequence, count, index, out[index]);
+                break;
+            }
+        }
+    }
+    producer.join();
+
+    uint32_t sequence = 0;
+    const uint32_t count = ring.snapshot(out, Capacity, &sequence);
+    // V klidu musi snapshot vratit vse, co kapacita dovoli.
+    if (sequence != pulses || count != max_returned<Capacity>(pulses, Capacity)
+        || (count > 0 && out[count - 1] != timestamp_for(pulses - 1u))) {
+        report(&stats, "koncovy stav", sequence, count, 0, count > 0 ? out[count - 1] : 0);
+    }
+    return stats;
+}
+
+template<uint32_t Capacity>
+static bool run_and_print(uint32_t pulses, uint32_t seed)
+{
+    const stress_stats_t stats = run_stress<Capacity>(pulses, seed);
+    std::printf("kapacita=%-4u impulsu=%-9u snapshotu=%-9llu prumer=%.1f zkracenych=%-8llu %s\n",
+                (unsigned)Capacity,
+                (unsigned)pulses,
+                (unsigned long long)stats.snapshots,
+                stats.snapshots > 0 ? (double)stats.timestamps / (double)stats.snapshots : 0.0,
+                (unsigned long long)stats.short_snapshots,
+                stats.errors == 0 ? "OK" : "CHYBA");
+    return stats.errors == 0;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr, "Pouziti: %s [--pulses=N] [--seed=S]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t pulses = 5000000;
+    uint32_t seed = 1;
+    for (int index = 1; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strncmp(arg, "--pulses=", 9) == 0) {
+            pulses = (uint32_t)std::strtoul(arg + 9, nullptr, 10);
+        } else if (std::strncmp(arg, "--seed=", 7) == 0) {
+            seed = (uint32_t)std::strtoul(arg + 7, nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = run_and_print<FLOW_PULSE_SOURCE_MAX_TIMESTAMPS>(pulses, seed);
+    ok = run_and_print<8>(pulses, seed) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+// Spolecny kod pro tools/trace_replay.cpp a tools/trace_tune.cpp: nacteni zaznamu
+// z cmd/trace dump a prehrani kanalu pres stejny retezec jako firmware (sensor_chain.hpp).
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "trimmed_mean.hpp"
+#include "sensor_chain.hpp"
+#include "sensor_event_gate.hpp"
+#include "analog_channel_config.hpp"
+
+namespace {
+
+// Musi odpovidat sensor_trace.h (hlavicka tam zavisi na ESP-IDF).
+static constexpr uint32_t TRACE_MAGIC = 0x52545356u;
+static constexpr uint8_t TRACE_VERSION = 1u;
+static constexpr uint8_t TRACE_FLAG_ADC_FAIL = 0x01u;
+
+enum trace_channel_t : uint8_t {
+    CH_TLAK_PRED = 0,
+    CH_TLAK_ZA,
+    CH_ZASOBA,
+    CH_FLOW_PULSE,
+    CH_COUNT,
+};
+
+#pragma pack(push, 1)
+struct trace_header_t {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t record_size;
+    uint16_t channel_mask;
+    uint32_t record_count;
+    uint32_t dropped_count;
+    uint32_t start_time_us;
+};
+
+struct trace_record_t {
+    uint32_t timestamp_us;
+    uint16_t value;
+    uint8_t channel;
+    uint8_t flags;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(trace_header_t) == 20, "trace_header_t musi odpovidat sensor_trace_header_t");
+static_assert(sizeof(trace_record_t) == 8, "trace_record_t musi odpovidat sensor_trace_record_t");
+
+struct sample_t {
+    int64_t t_us;
+    uint16_t raw;
+    bool adc_ok;
+};
+
+struct chain_stats_t {
+    size_t samples;
+    size_t fault_samples;
+    size_t publishes;
+    size_t settle_events;
+    double settle_mean_ms;
+    double settle_max_ms;
+    double abs_error_mean;
+    float last_output;
+};
+
+typedef std::map<std::string, double> param_map_t;
+
+static double param(const param_map_t &params, const char *key, double fallback)
+{
+    const auto it = params.find(key);
+    return it != params.end() ? it->second : fallback;
+}
+
+// Prehraje kanal jako firmware (tlak.cpp / zasoba.cpp): TrimmedMean (na zarizeni <31,5>),
+// AnalogFaultDetector nad surovym RAW a warmup po velikosti bufferu bez publikace.
+// Publikace = event, ktery propusti SensorEventGate: zmena publikovanych hodnot (u hladiny
+// objem i vyska po hysterezi), platnosti nebo poruchy, jinak heartbeat 30 s. Oba tlaky
+// posilaji na zarizeni spolecny event, zde se publikace pocitaji po kanalech.
+// Usazeni: interval, kdy se publikovana hodnota lisi od kalibrovaneho trimmed-mean
+// vstupu o vic nez 5 jednotek posledniho desetinneho mista.
+template<typename Chain, typename Filter = TrimmedMean<31, 5>>
+static chain_stats_t replay_channel(trace_channel_t channel,
+                                    const std::vector<sample_t> &samples,
+                                    const sensor_chain_config_t &params,
+                                    const char *csv_name)
+{
+    const bool level = channel == CH_ZASOBA;
+    chain_stats_t stats = {};
+    Filter filter;
+    Chain chain;
+    chain.configure(params);
+    AnalogFaultDetector detector(level ? LEVEL_FAULT_DETECTOR_CONFIG : PRESSURE_FAULT_DETECTOR_CONFIG);
+    SensorEventGate<3> event_gate(level ? LEVEL_EVENT_HEARTBEAT_US : PRESSURE_EVENT_HEARTBEAT_US);
+
+    const double band = 5.0 / std::pow(10.0, params.round_decimals);
+    const size_t warmup = filter.getBufferSize();
+    bool settling = false;
+    int64_t settle_start_us = 0;
+    double settle_sum_ms = 0.0;
+    double error_sum = 0.0;
+    size_t valid_samples = 0;
+    size_t processed = 0;
+    uint16_t last_raw = 0;
+
+    for (const sample_t &sample : samples) {
+        sensor_chain_sample_t chain_sample = {};
+        analog_fault_t fault = detector.fault();
+        bool valid = false;
+        // Pri chybe ADC vlozi zasoba.cpp do filtru posledni platny RAW, tlak.cpp vzorek preskoci.
+        if (sample.adc_ok || level) {
+            if (sample.adc_ok) {
+                last_raw = sample.raw;
+                fault = detector.process(sample.raw);
+            }
+            filter.insert(last_raw);
+            chain.process(filter.getValue(), &chain_sample);
+            valid = sample.adc_ok && !analog_fault_is_hard(fault);
+        }
+        processed += 1;
+        if (processed <= warmup) {
+            continue;
+        }
+
+        stats.samples += 1;
+        if (fault != ANALOG_FAULT_NONE) {
+            stats.fault_samples += 1;
+        }
+
+        const float output = valid ? chain_sample.output_rounded : NAN;
+        const float published[3] = {output,
+                                    (level && valid) ? chain_sample.value_hyst : NAN,
+                                    (float)fault};
+        if (event_gate.shouldEmit(published, sample.t_us)) {
+            event_gate.markEmitted(published, sample.t_us);
+            stats.publishes += 1;
+        }
+        if (!valid) {
+            continue;
+        }
+        stats.last_output = output;
+        valid_samples += 1;
+
+        const float reference = chain_sample.value_raw * params.output_scale;
+        const double error = std::fabs((double)reference - (double)output);
+        error_sum += error;
+        if (!settling && error > band) {
+            settling = true;
+            settle_start_us = sample.t_us;
+        } else if (settling && error <= band) {
+            settling = false;
+            const double duration_ms = (double)(sample.t_us - settle_start_us) / 1000.0;
+            settle_sum_ms += duration_ms;
+            stats.settle_max_ms = duration_ms > stats.settle_max_ms ? duration_ms : stats.settle_max_ms;
+            stats.settle_events += 1;
+        }
+
+        if (csv_name != nullptr) {
+            std::printf("%s,%lld,%u,%.5f,%.5f\n", csv_name, (long long)sample.t_us, (unsigned)sample.raw,
+                        (double)reference, (double)output);
+        }
+    }
+
+    stats.settle_mean_ms = stats.settle_events > 0 ? settle_sum_ms / (double)stats.settle_events : 0.0;
+    stats.abs_error_mean = valid_samples > 0 ? error_sum / (double)valid_samples : 0.0;
+    return stats;
+}
+
+static bool load_trace(const char *path,
+                       trace_header_t *header,
+                       std::vector<sample_t> channels[CH_COUNT])
+{
+    FILE *file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Nelze otevrit %s\n", path);
+        return false;
+    }
+
+    bool ok = std::fread(header, sizeof(*header), 1, file) == 1
+           && header->magic == TRACE_MAGIC
+           && header->version == TRACE_VERSION
+           && header->record_size == sizeof(trace_record_t);
+    if (!ok) {
+        std::fprintf(stderr, "%s neni platny trace (magic/verze)\n", path);
+        std::fclose(file);
+        return false;
+    }
+
+    // Casy jsou dolnich 32 bitu mikrosekund; rozbaleni pretekani vuci startu zaznamu.
+    uint32_t previous_us = header->start_time_us;
+    int64_t unwrapped_us = 0;
+    for (uint32_t index = 0; index < header->record_count; ++index) {
+        trace_record_t record = {};
+        if (std::fread(&record, sizeof(record), 1, file) != 1) {
+            std::fprintf(stderr, "Trace je zkraceny (%u/%u zaznamu)\n", (unsigned)index, (unsigned)header->record_count);
+            break;
+        }
+        unwrapped_us += (int64_t)(uint32_t)(record.timestamp_us - previous_us);
+        previous_us = record.timestamp_us;
+        if (record.channel >= CH_COUNT) {
+            continue;
+        }
+        channels[record.channel].push_back({unwrapped_us, record.value, (record.flags & TRACE_FLAG_ADC_FAIL) == 0});
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+static sensor_chain_config_t pressure_params(const param_map_t &p, const char *prefix)
+{
+    const std::string base = std::string("tlk_") + prefix + "_";
+    return {
+        (int32_t)param(p, (base + "raw_4ma").c_str(), 480),
+        (int32_t)param(p, (base + "raw_20ma").c_str(), 3740),
+        (float)param(p, (base + "p_min").c_str(), 0.0),
+        (float)param(p, (base + "p_max").c_str(), 10.0),
+        (float)param(p, "tlk_ema_alpha", 0.55),
+        (float)param(p, "tlk_hyst_bar", 0.02),
+        (int32_t)param(p, "tlk_round_dec", 2),
+        1.0f,
+        false,
+    };
+}
+
+static sensor_chain_config_t level_params(const param_map_t &p)
+{
+    return {
+        (int32_t)param(p, "lvl_raw_min", 480),
+        (int32_t)param(p, "lvl_raw_max", 3720),
+        (float)param(p, "lvl_h_min", 0.0),
+        (float)param(p, "lvl_h_max", 1.9),
+        (float)param(p, "lvl_ema_alpha", 0.25),
+        (float)param(p, "lvl_hyst_m", 0.002),
+        (int32_t)param(p, "lvl_round_dec", 2),
+        (float)param(p, "tank_area_m2", 5.4),
+        true,
+    };
+}
+
+} // namespace
@@ -0,0 +1,167 @@
+// Offline prehrani zaznamu surovych vzorku cidel (cmd/trace dump) pres filtracni retezce
+// z main/tlak.cpp a main/zasoba.cpp. TrimmedMean i kalibrace, EMA, hystereze
+// a zaokrouhleni se berou primo z firmware hlavicek (trimmed_mean.hpp, sensor_chain.hpp),
+// ktere pouzivaji process_pressure_chain() / process_level_chain(). Impulsy prutokomeru jdou
+// pres FlowRateEstimator se stejnym nastavenim jako v prutokomer.cpp.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -I main tools/trace_replay.cpp -o trace_replay
+//
+// Pouziti:
+//   ./trace_replay trace.bin [--fixed] [--csv] [klic=hodnota ...]
+// Klice odpovidaji config_store polozkam (tlk_*, lvl_*, tank_area_m2, flow_pulses_l)
+// a lze je zkopirovat primo z konfiguracni webapp.
+
+#include "trace_common.hpp"
+#include "flow_rate_estimator.hpp"
+
+namespace {
+
+static void print_stats(const char *name, const char *unit, const chain_stats_t &stats, double duration_s)
+{
+    std::printf("%-10s vzorku=%-7zu poruch=%-6zu publikaci=%-6zu (%.2f/min) posledni=%.4f %s "
+                "usazeni: udalosti=%zu prumer=%.0f ms max=%.0f ms  |chyba| prumer=%.5f\n",
+                name,
+                stats.samples,
+                stats.fault_samples,
+                stats.publishes,
+                duration_s > 0.0 ? (double)stats.publishes * 60.0 / duration_s : 0.0,
+                (double)stats.last_output,
+                unit,
+                stats.settle_events,
+                stats.settle_mean_ms,
+                stats.settle_max_ms,
+                stats.abs_error_mean);
+}
+
+static void print_flow(const std::vector<sample_t> &pulses, double pulses_per_liter)
+{
+    if (pulses.empty()) {
+        std::printf("prutok     impulsu=0\n");
+        return;
+    }
+
+    // Stejne nastaveni a perioda vzorkovani (200 ms) jako pocitani_pulsu() v prutokomer.cpp.
+    static const FlowRateEstimator estimator(FlowRateEstimator::Config{16, 4000000, 1000000, 3000000, 4.0f, 0.05f});
+    static const int64_t SAMPLE_PERIOD_US = 200000;
+    static const size_t RING_SIZE = 128;
+
+    std::vector<uint32_t> timestamps;
+    timestamps.reserve(RING_SIZE);
+    double max_l_min = 0.0;
+    double confidence_sum = 0.0;
+    size_t flowing_samples = 0;
+    size_t next_pulse = 0;
+    const int64_t end_us = pulses.back().t_us + 3000000;
+    for (int64_t now_us = pulses.front().t_us; now_us <= end_us; now_us += SAMPLE_PERIOD_US) {
+        while (next_pulse < pulses.size() && pulses[next_pulse].t_us <= now_us) {
+            if (timestamps.size() == RING_SIZE) {
+                timestamps.erase(timestamps.begin());
+            }
+            timestamps.push_back((uint32_t)pulses[next_pulse].t_us);
+            ++next_pulse;
+        }
+
+        const FlowRateEstimator::Estimate estimate =
+            estimator.estimate(timestamps.data(), (uint32_t)timestamps.size(), 1, (uint32_t)now_us);
+        const double l_min = (double)estimate.pulses_per_s * 60.0 / pulses_per_liter;
+        max_l_min = l_min > max_l_min ? l_min : max_l_min;
+        if (estimate.pulses_per_s > 0.0f) {
+            confidence_sum += (double)estimate.confidence;
+            flowing_samples += 1;
+        }
+    }
+
+    std::printf("prutok     impulsu=%zu objem=%.2f l max=%.1f l/min duvera prumer=%.2f\n",
+                pulses.size(),
+                (double)pulses.size() / pulses_per_liter,
+                max_l_min,
+                flowing_samples > 0 ? confidence_sum / (double)flowing_samples : 0.0);
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Pouziti: %s trace.bin [--fixed] [--csv] [klic=hodnota ...]\n"
+                 "  --fixed  pouzije Q16.16 cestu (SENSOR_MATH_FIXED_POINT=1)\n"
+                 "  --csv    vypise prubeh: kanal,t_us,raw,reference,vystup\n",
+                 argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bool fixed = false;
+    bool csv = false;
+    param_map_t params;
+    for (int index = 2; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strcmp(arg, "--fixed") == 0) {
+            fixed = true;
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (const char *eq = std::strchr(arg, '=')) {
+            params[std::string(arg, (size_t)(eq - arg))] = std::atof(eq + 1);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    trace_header_t header = {};
+    std::vector<sample_t> channels[CH_COUNT];
+    if (!load_trace(argv[1], &header, channels)) {
+        return 1;
+    }
+
+    int64_t duration_us = 0;
+    for (const auto &channel : channels) {
+        if (!channel.empty() && channel.back().t_us > duration_us) {
+            duration_us = channel.back().t_us;
+        }
+    }
+    const double duration_s = (double)duration_us / 1e6;
+
+    if (!csv) {
+        std::printf("trace: zaznamu=%u zahozeno=%u delka=%.1f s cesta=%s\n",
+                    (unsigned)header.record_count,
+                    (unsigned)header.dropped_count,
+                    duration_s,
+                    fixed ? "Q16.16" : "float");
+    }
+
+    struct {
+        trace_channel_t channel;
+        const char *name;
+        const char *unit;
+        sensor_chain_config_t params;
+    } analog[] = {
+        {CH_TLAK_PRED, "tlak_pred", "bar", pressure_params(params, "b")},
+        {CH_TLAK_ZA, "tlak_za", "bar", pressure_params(params, "a")},
+        {CH_ZASOBA, "objem", "m3", level_params(params)},
+    };
+
+    for (const auto &entry : analog) {
+        const std::vector<sample_t> &samples = channels[entry.channel];
+        if (samples.empty()) {
+            continue;
+        }
+        const char *csv_name = csv ? entry.name : nullptr;
+        const chain_stats_t stats = fixed ? replay_channel<SensorChainQ16>(entry.channel, samples, entry.params, csv_name)
+                                          : replay_channel<SensorChainFloat>(entry.channel, samples, entry.params, csv_name);
+        if (!csv) {
+            print_stats(entry.name, entry.unit, stats, duration_s);
+        }
+    }
+
+    if (!csv) {
+        print_flow(channels[CH_FLOW_PULSE], param(params, "flow_pulses_l", 38));
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+// Hledani nastaveni filtru tlaku/hladiny nad zaznamem z cmd/trace dump.
+// Projde mrizku ema_alpha x hystereze x velikost TrimmedMean okna (paralelne na vsech
+// jadrech), kazdou kombinaci prehraje stejne jako tools/trace_replay.cpp a vypise
+// Pareto-optimalni sadu podle: doby usazeni, poctu publikaci za minutu a prumerne chyby.
+//
+// Preklad (Linux):
+//   g++ -std=c++17 -O2 -Wall -pthread -I main tools/trace_tune.cpp -o trace_tune
+//
+// Pouziti:
+//   ./trace_tune trace.bin tlak|zasoba [--fixed] [--alpha=od:do:krok] [--hyst=od:do:krok]
+//                [--threads=N] [klic=hodnota ...]
+// Vystupni radky jsou primo config_store klice (webapp / trace_replay), velikost
+// TrimmedMean okna je parametr sablony ve firmware a je uvedena jen v komentari.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "trace_common.hpp"
+
+namespace {
+
+struct sweep_range_t {
+    double from;
+    double to;
+    double step;
+};
+
+struct window_variant_t {
+    unsigned buffer_size;
+    unsigned trim_count;
+};
+
+// Okna, ktera prichazi v uvahu pro TrimmedMean<BufferSize, TrimCount> (firmware: 31/5).
+static const window_variant_t WINDOW_VARIANTS[] = {
+    {15, 3},
+    {21, 4},
+    {31, 5},
+    {41, 7},
+    {63, 10},
+};
+
+struct candidate_t {
+    double alpha;
+    double hysteresis;
+    size_t window_index;
+
+    double settle_ms;
+    double publishes_per_min;
+    double abs_error;
+    bool pareto;
+};
+
+template<typename Chain>
+static chain_stats_t replay_with_window(size_t window_index,
+                                        trace_channel_t channel,
+                                        const std::vector<sample_t> &samples,
+                                        const sensor_chain_config_t &params)
+{
+    switch (window_index) {
+        case 0: return replay_channel<Chain, TrimmedMean<15, 3>>(channel, samples, params, nullptr);
+        case 1: return replay_channel<Chain, TrimmedMean<21, 4>>(channel, samples, params, nullptr);
+        case 2: return replay_channel<Chain, TrimmedMean<31, 5>>(channel, samples, params, nullptr);
+        case 3: return replay_channel<Chain, TrimmedMean<41, 7>>(channel, samples, params, nullptr);
+        default: return replay_channel<Chain, TrimmedMean<63, 10>>(channel, samples, params, nullptr);
+    }
+}
+
+static bool parse_range(const char *text, sweep_range_t *range)
+{
+    return std::sscanf(text, "%lf:%lf:%lf", &range->from, &range->to, &range->step) == 3
+        && range->step > 0.0
+        && range->to >= range->from;
+}
+
+static std::vector<double> expand_range(const sweep_range_t &range)
+{
+    std::vector<double> values;
+    for (double value = range.from; value <= range.to + range.step * 1e-6; value += range.step) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+static bool dominates(const candidate_t &a, const candidate_t &b)
+{
+    const bool no_worse = a.settle_ms <= b.settle_ms
+                       && a.publishes_per_min <= b.publishes_per_min
+                       && a.abs_error <= b.abs_error;
+    const bool better = a.settle_ms < b.settle_ms
+                     || a.publishes_per_min < b.publishes_per_min
+                     || a.abs_error < b.abs_error;
+    return no_worse && better;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Pouziti: %s trace.bin tlak|zasoba [--fixed] [--alpha=od:do:krok] [--hyst=od:do:krok]\n"
+                 "         [--threads=N] [klic=hodnota ...]\n",
+                 argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const bool tune_pressure = std::strcmp(argv[2], "tlak") == 0;
+    if (!tune_pressure && std::strcmp(argv[2], "zasoba") != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bool fixed = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    sweep_range_t alpha_range = {0.05, 1.0, 0.05};
+    sweep_range_t hyst_range = tune_pressure ? sweep_range_t{0.0, 0.05, 0.005} : sweep_range_t{0.0, 0.01, 0.001};
+    param_map_t params;
+
+    for (int index = 3; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (std::strcmp(arg, "--fixed") == 0) {
+            fixed = true;
+        } else if (std::strncmp(arg, "--alpha=", 8) == 0) {
+            if (!parse_range(arg + 8, &alpha_range)) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (std::strncmp(arg, "--hyst=", 7) == 0) {
+            if (!parse_range(arg + 7, &hyst_range)) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (std::strncmp(arg, "--threads=", 10) == 0) {
+            threads = std::max(1, std::atoi(arg + 10));
+        } else if (const char *eq = std::strchr(arg, '=')) {
+            params[std::string(arg, (size_t)(eq - arg))] = std::atof(eq + 1);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    trace_header_t header = {};
+    std::vector<sample_t> channels[CH_COUNT];
+    if (!load_trace(argv[1], &header, channels)) {
+        return 1;
+    }
+
+    const trace_channel_t tuned_channels[2] = {
+        tune_pressure ? CH_TLAK_PRED : CH_ZASOBA,
+        tune_pressure ? CH_TLAK_ZA : CH_COUNT,
+    };
+
+    int64_t duration_us = 0;
+    for (const trace_channel_t channel : tuned_channels) {
+        if (channel != CH_COUNT && !channels[channel].empty()) {
+            duration_us = std::max(duration_us, channels[channel].back().t_us);
+        }
+    }
+    if (duration_us <= 0) {
+        std::fprintf(stderr, "Trace neobsahuje vzorky kanalu %s\n", argv[2]);
+        return 1;
+    }
+    const double duration_min = (double)duration_us / 60e6;
+
+    std::vector<candidate_t> candidates;
+    for (const double alpha : expand_range(alpha_range)) {
+        for (const double hysteresis : expand_range(hyst_range)) {
+            for (size_t window = 0; window < sizeof(WINDOW_VARIANTS) / sizeof(WINDOW_VARIANTS[0]); ++window) {
+                candidates.push_back({alpha, hysteresis, window, 0.0, 0.0, 0.0, false});
+            }
+        }
+    }
+
+    std::atomic<size_t> next_index(0);
+    auto worker = [&]() {
+        while (true) {
+            const size_t index = next_index.fetch_add(1);
+            if (index >= candidates.size()) {
+                return;
+            }
+
+            candidate_t &candidate = candidates[index];
+            size_t used_channels = 0;
+            for (const trace_channel_t channel : tuned_channels) {
+                if (channel == CH_COUNT || channels[channel].empty()) {
+                    continue;
+                }
+
+                sensor_chain_config_t chain = tune_pressure
+                                           ? pressure_params(params, channel == CH_TLAK_PRED ? "b" : "a")
+                                           : level_params(params);
+                chain.ema_alpha = (float)candidate.alpha;
+                chain.hysteresis = (float)candidate.hysteresis;
+
+                const chain_stats_t stats =
+                    fixed ? replay_with_window<SensorChainQ16>(candidate.window_index, channel, channels[channel], chain)
+                          : replay_with_window<SensorChainFloat>(candidate.window_index, channel, channels[channel], chain);
+
+                candidate.settle_ms = std::max(candidate.settle_ms, stats.settle_mean_ms);
+                candidate.publishes_per_min += (double)stats.publishes / duration_min;
+                candidate.abs_error += stats.abs_error_mean;
+                used_channels += 1;
+            }
+            if (used_channels > 0) {
+                candidate.abs_error /= (double)used_channels;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned index = 0; index < threads; ++index) {
+        pool.emplace_back(worker);
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    for (candidate_t &candidate : candidates) {
+        candidate.pareto = std::none_of(candidates.begin(), candidates.end(), [&](const candidate_t &other) {
+            return dominates(other, candidate);
+        });
+    }
+
+    std::vector<const candidate_t *> front;
+    for (const candidate_t &candidate : candidates) {
+        if (candidate.pareto) {
+            front.push_back(&candidate);
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const candidate_t *a, const candidate_t *b) {
+        return a->publishes_per_min < b->publishes_per_min;
+    });
+
+    const char *alpha_key = tune_pressure ? "tlk_ema_alpha" : "lvl_ema_alpha";
+    const char *hyst_key = tune_pressure ? "tlk_hyst_bar" : "lvl_hyst_m";
+
+    std::printf("# %s: %zu kombinaci, %zu Pareto-optimalnich, %u vlaken, cesta=%s, delka=%.1f min\n",
+                argv[2],
+                candidates.size(),
+                front.size(),
+                threads,
+                fixed ? "Q16.16" : "float",
+                duration_min);
+    for (const candidate_t *candidate : front) {
+        const window_variant_t &window = WINDOW_VARIANTS[candidate->window_index];
+        std::printf("%s=%.3f %s=%.4f  # TrimmedMean<%u,%u> usazeni=%.0f ms publikaci=%.1f/min chyba=%.5f\n",
+                    alpha_key,
+                    candidate->alpha,
+                    hyst_key,
+                    candidate->hysteresis,
+                    window.buffer_size,
+                    window.trim_count,
+                    candidate->settle_ms,
+                    candidate->publishes_per_min,
+                    candidate->abs_error);
+    }
+    return 0;
+}